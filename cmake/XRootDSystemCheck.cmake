@@ -6,6 +6,7 @@ include( CheckFunctionExists )
 include( CheckLibraryExists )
 include( CheckIncludeFile )
 include( CheckCXXSourceRuns )
+include( CheckCXXSourceCompiles )
 include( XRootDUtils )
 
 #-------------------------------------------------------------------------------
@@ -30,6 +31,22 @@ endif()
 check_include_file( shadow.h HAVE_SHADOWPW )
 compiler_define_if_found( HAVE_SHADOWPW HAVE_SHADOWPW )
 
+#-------------------------------------------------------------------------------
+# io_uring with read/write opcodes and opcode probing (Linux 5.6 headers)
+#-------------------------------------------------------------------------------
+check_cxx_source_compiles(
+"
+  #include <sys/syscall.h>
+  #include <linux/io_uring.h>
+  int main()
+  {
+    struct io_uring_probe probe;
+    return IORING_OP_READ + IORING_REGISTER_PROBE + __NR_io_uring_enter
+         + (int)sizeof(probe);
+  }
+" HAVE_IO_URING )
+compiler_define_if_found( HAVE_IO_URING HAVE_IO_URING )
+
 #-------------------------------------------------------------------------------
 # Some socket related functions
 #-------------------------------------------------------------------------------
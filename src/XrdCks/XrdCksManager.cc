@@ -30,11 +30,11 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
 #include <unistd.h>
-#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/stat.h>
   
@@ -53,6 +53,35 @@
 #include "XrdSys/XrdSysPlugin.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+// Calculations of the same checksum for the same file are done only once no
+// matter how many threads ask for it at the same time. Each one in progress
+// is represented by a csJob; latecomers wait on jobCV for its result. These
+// are kept here rather than in the manager as it may be used as a base class.
+//
+namespace
+{
+struct csJob
+      {csJob        *Next;
+       char         *Key;
+       XrdCksData    Cks;
+       int           rc;
+       int           Waiting;
+       bool          Done;
+       bool          isSet;
+                     csJob(const char *key) : Next(0), Key(strdup(key)), rc(0),
+                                              Waiting(0), Done(false),
+                                              isSet(false) {}
+                    ~csJob() {if (Key) free(Key);}
+      };
+
+XrdSysCondVar jobCV(0);
+csJob        *jobList = 0;
+}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -102,10 +131,10 @@ XrdCksManager::~XrdCksManager()
   
 int XrdCksManager::Calc(const char *Pfn, XrdCksData &Cks, int doSet)
 {
-   XrdCksCalc *csP;
    csInfo *csIP = &csTab[0];
-   time_t MTime;
-   int rc;
+   csJob  *jP, *pP;
+   int rc, rcSet = 0;
+   bool needSet;
 
 // Determine which checksum to get
 //
@@ -113,48 +142,82 @@ int XrdCksManager::Calc(const char *Pfn, XrdCksData &Cks, int doSet)
    if (!(*Cks.Name)) Cks.Set(csIP->Name);
       else if (!(csIP = Find(Cks.Name))) return -ENOTSUP;
 
-// If we need not set the checksum then see if we can get it from the
-// extended attributes.
-
-// Obtain a new checksum object
-//
-   if (!(csP = csIP->Obj->New())) return -ENOMEM;
-
-// Use the calculator to get and possibly set the checksum
-//
-   if (!(rc = Calc(Pfn, MTime, csP)))
-      {memcpy(Cks.Value, csP->Final(), csIP->Len);
-       Cks.fmTime = static_cast<long long>(MTime);
-       Cks.csTime = static_cast<int>(time(0) - MTime);
-       Cks.Length = csIP->Len;
-       csP->Recycle();
-       if (doSet)
+// If this checksum is already being calculated for this file, simply wait for
+// the result. Should the calculating thread not have set it, we do so here.
+//
+   jobCV.Lock();
+   jP = jobList;
+   while(jP && (strcmp(jP->Key, Pfn) || strcmp(jP->Cks.Name, csIP->Name)))
+        jP = jP->Next;
+   if (jP)
+      {jP->Waiting++;
+       do {jobCV.Wait();} while(!jP->Done);
+       if (!(rc = jP->rc)) Cks = jP->Cks;
+       needSet = (!rc && doSet && !jP->isSet);
+       if (!(--jP->Waiting)) delete jP;
+       jobCV.UnLock();
+       if (needSet)
           {XrdOucXAttr<XrdCksXAttr> xCS;
            memcpy(&xCS.Attr.Cks, &Cks, sizeof(xCS.Attr.Cks));
            if ((rc = xCS.Set(Pfn))) return -rc;
           }
+       return rc;
       }
 
+// We will do the calculation. Make it known so others can wait for it.
+//
+   jP = new csJob(Pfn);
+   jP->Cks.Set(csIP->Name);
+   jP->Next = jobList; jobList = jP;
+   jobCV.UnLock();
+
+// Calculate the checksum and possibly set it
+//
+   rc = Digest(Pfn, Cks, csIP, doSet);
+   if (rc > 0) {rcSet = rc; rc = 0;}
+
+// Post the result to anyone waiting for it and remove the job from the list
+//
+   jobCV.Lock();
+   if (!(jP->rc = rc)) {jP->Cks = Cks; jP->isSet = (doSet && !rcSet);}
+   jP->Done = true;
+   if (jobList == jP) jobList = jP->Next;
+      else {pP = jobList;
+            while(pP->Next != jP) pP = pP->Next;
+            pP->Next = jP->Next;
+           }
+   if (jP->Waiting) jobCV.Broadcast();
+      else delete jP;
+   jobCV.UnLock();
+
 // All done
 //
-   return rc;
+   return (rcSet ? rcSet : rc);
 }
 
 /******************************************************************************/
   
 int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
 {
+   static const int    maxBuff = 8388608;
+   static const time_t rptIntvl = 60;
    class ioFD
         {public:
-         int FD;
-             ioFD() : FD(-1) {}
-            ~ioFD() {if (FD >= 0) close(FD);}
+         int   FD;
+         void *Buff;
+               ioFD() : FD(-1), Buff(0) {}
+              ~ioFD() {if (FD >= 0) close(FD);
+                       if (Buff) free(Buff);
+                      }
         } In;
    struct stat Stat;
-   char *inBuff;
+   const char *csName;
+   char  *inBuff, pBuff[64];
    off_t  Offset=0, fileSize;
    size_t ioSize, calcSize;
-   int rc;
+   ssize_t rdLen = 0;
+   time_t rptTime;
+   int rc, csLen;
 
 // Open the input file
 //
@@ -167,24 +230,51 @@ int XrdCksManager::Calc(const char *Pfn, time_t &MTime, XrdCksCalc *csP)
    calcSize = fileSize = Stat.st_size;
    MTime = Stat.st_mtime;
 
-// We now compute checksum 64MB at a time using mmap I/O
+// Allocate a page aligned buffer. We use the segment size up to a point as
+// there is little to be gained with larger reads while memory use adds up.
 //
-   ioSize = (fileSize < (off_t)segSize ? fileSize : segSize); rc = 0;
+   ioSize = (segSize < maxBuff ? segSize : maxBuff);
+   if (fileSize < (off_t)ioSize) ioSize = fileSize;
+   if (!ioSize) return 0;
+   if ((rc = posix_memalign(&In.Buff, sysconf(_SC_PAGESIZE), ioSize)))
+      return -rc;
+   inBuff = (char *)In.Buff;
+#if defined(__linux__)
+   posix_fadvise(In.FD, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+// Compute the checksum a buffer at a time. Before digesting a buffer we ask
+// the kernel to start reading the next one so that i/o and computation are
+// overlapped. Long running calculations periodically report their progress.
+//
+   rptTime = time(0) + rptIntvl;
    while(calcSize)
-        {if ((inBuff = (char *)mmap(0, ioSize, PROT_READ, 
-                       MAP_NORESERVE|MAP_PRIVATE, In.FD, Offset)) == MAP_FAILED)
-            {rc = errno; eDest->Emsg("Cks", rc, "memory map", Pfn); break;}
-         madvise(inBuff, ioSize, MADV_SEQUENTIAL);
-         csP->Update(inBuff, ioSize);
-         calcSize -= ioSize; Offset += ioSize;
-         if (munmap(inBuff, ioSize) < 0)
-            {rc = errno; eDest->Emsg("Cks",rc,"unmap memory for",Pfn); break;}
-         if (calcSize < (size_t)segSize) ioSize = calcSize;
+        {do {rdLen = pread(In.FD, inBuff, ioSize, Offset);}
+            while(rdLen < 0 && errno == EINTR);
+         if (rdLen <= 0) break;
+#if defined(__linux__)
+         if ((size_t)rdLen < calcSize)
+            posix_fadvise(In.FD, Offset+rdLen, ioSize, POSIX_FADV_WILLNEED);
+#endif
+         csP->Update(inBuff, rdLen);
+         calcSize -= rdLen; Offset += rdLen;
+         if (calcSize < ioSize) ioSize = calcSize;
+         if (calcSize && time(0) >= rptTime)
+            {csName = csP->Type(csLen);
+             snprintf(pBuff, sizeof(pBuff), "%d%% of %s checksum done for",
+                      static_cast<int>((Offset*100)/fileSize), csName);
+             eDest->Emsg("Cks", pBuff, Pfn);
+             rptTime += rptIntvl;
+            }
         }
 
 // Return if we failed
 //
-   if (calcSize) return (rc ? -rc : -EIO);
+   if (calcSize)
+      {rc = (rdLen < 0 ? errno : EIO);
+       eDest->Emsg("Cks", rc, "read", Pfn);
+       return -rc;
+      }
    return 0;
 }
 
@@ -432,6 +522,44 @@ int XrdCksManager::Del(const char *Pfn, XrdCksData &Cks)
    return xCS.Del(Pfn);
 }
 
+/******************************************************************************/
+/*                                D i g e s t                                 */
+/******************************************************************************/
+
+// Returns 0 upon success, -errno if the checksum could not be calculated, and
+// errno if it was calculated but could not be set.
+//
+int XrdCksManager::Digest(const char *Pfn, XrdCksData &Cks, csInfo *csIP,
+                          int doSet)
+{
+   XrdCksCalc *csP;
+   time_t MTime;
+   int rc;
+
+// Obtain a new checksum object
+//
+   if (!(csP = csIP->Obj->New())) return -ENOMEM;
+
+// Use the calculator to get and possibly set the checksum
+//
+   if (!(rc = Calc(Pfn, MTime, csP)))
+      {memcpy(Cks.Value, csP->Final(), csIP->Len);
+       Cks.fmTime = static_cast<long long>(MTime);
+       Cks.csTime = static_cast<int>(time(0) - MTime);
+       Cks.Length = csIP->Len;
+       csP->Recycle();
+       if (doSet)
+          {XrdOucXAttr<XrdCksXAttr> xCS;
+           memcpy(&xCS.Attr.Cks, &Cks, sizeof(xCS.Attr.Cks));
+           if ((rc = xCS.Set(Pfn))) return (rc < 0 ? -rc : rc);
+          }
+      } else csP->Recycle();
+
+// All done
+//
+   return rc;
+}
+
 /******************************************************************************/
 /*                                   G e t                                    */
 /******************************************************************************/
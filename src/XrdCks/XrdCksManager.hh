@@ -79,7 +79,8 @@ protected:
 /* Calc()     returns 0 if the checksum was successfully calculated using the
               supplied CksObj and places the file's modification time in MTime.
               Otherwise, it returns -errno. The default implementation uses
-              open(), fstat(), mmap(), and unmap() to calculate the results.
+              open(), fstat(), and aligned pread() calls, hinting the kernel to
+              read the next segment while the current one is being digested.
 */
 virtual int         Calc(const char *Pfn, time_t &MTime, XrdCksCalc *CksObj);
 
@@ -104,6 +105,7 @@ struct csInfo
       };
 
 int     Config(const char *cFN, csInfo &Info);
+int     Digest(const char *Pfn, XrdCksData &Cks, csInfo *csIP, int doSet);
 csInfo *Find(const char *Name);
 
 static const int csMax = 8;
@@ -27,6 +27,7 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <stdio.h>
 #include "XrdFfs/XrdFfsDent.hh"
 
 #ifdef __cplusplus
@@ -265,6 +266,162 @@ void XrdFfsDent_cache_destroy()
         XrdFfsDent_dentcache_free(&XrdFfsDentCaches[i]);
 }
 
+/* 
+   managing a cache of stat() results collected by readdir. "ls -l" stat()s
+   every entry right after readdir(), so keeping the stat info that came 
+   with the directory listing saves one round trip (or one round trip to 
+   each data server) per entry. Entries expire after XrdFfsDentStats_life
+   seconds (0 disables the cache) and are removed when a file or directory 
+   is changed through XrootdFS. Listings are made with the credentials of
+   the user (sss), so entries are kept per uid and only returned to the user
+   whose listing produced them.
+ */
+
+struct XrdFfsDentstat {
+    char *path;
+    uid_t uid;
+    time_t t0;
+    struct stat st;
+    struct XrdFfsDentstat *next;
+};
+
+#define XrdFfsDent_NSTATBUCKETS 16384
+#define XrdFfsDent_MAXSTATS 1000000
+struct XrdFfsDentstat *XrdFfsDentStats[XrdFfsDent_NSTATBUCKETS];
+int XrdFfsDentStats_n = 0;
+time_t XrdFfsDentStats_life = 10;
+pthread_mutex_t XrdFfsDentStats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* the uid is not hashed so that _remove() finds the entries of all users */
+unsigned int XrdFfsDent_stat_hash(const char *path)
+{
+    unsigned int h = 2166136261U;
+    while (*path != '\0')
+    {
+        h ^= (unsigned char)*path++;
+        h *= 16777619U;
+    }
+    return h % XrdFfsDent_NSTATBUCKETS;
+}
+
+/* _unlink() removes *p from its bucket, must be called with the mutex locked */
+void XrdFfsDent_stat_unlink(struct XrdFfsDentstat **p)
+{
+    struct XrdFfsDentstat *x = *p;
+    *p = x->next;
+    free(x->path);
+    free(x);
+    XrdFfsDentStats_n--;
+}
+
+/* _purge() removes all expired entries, must be called with the mutex locked */
+void XrdFfsDent_stat_purge()
+{
+    struct XrdFfsDentstat **p;
+    time_t t1 = time(NULL);
+    int i;
+
+    for (i = 0; i < XrdFfsDent_NSTATBUCKETS; i++)
+    {
+        p = &XrdFfsDentStats[i];
+        while (*p != NULL)
+            if ((t1 - (*p)->t0) >= XrdFfsDentStats_life)
+                XrdFfsDent_stat_unlink(p);
+            else
+                p = &(*p)->next;
+    }
+}
+
+void XrdFfsDent_stat_cache_setlife(int life)
+{
+    pthread_mutex_lock(&XrdFfsDentStats_mutex);
+    XrdFfsDentStats_life = (life > 0 ? life : 0);
+    if (XrdFfsDentStats_life == 0) XrdFfsDent_stat_purge();
+    pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+}
+
+void XrdFfsDent_stat_cache_fill(const char *dname, const char *dentname, struct stat *st, uid_t uid)
+{
+    struct XrdFfsDentstat *x;
+    char path[1024];
+    unsigned int h;
+    int n;
+
+    if (dname[0] == '/' && dname[1] == '\0') dname = "";
+    n = snprintf(path, sizeof(path), "%s/%s", dname, dentname);
+    if (n >= (int)sizeof(path)) return;
+    h = XrdFfsDent_stat_hash(path);
+
+    pthread_mutex_lock(&XrdFfsDentStats_mutex);
+    if (XrdFfsDentStats_life == 0)
+    {
+        pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+        return;
+    }
+    for (x = XrdFfsDentStats[h]; x != NULL; x = x->next)
+        if (x->uid == uid && ! strcmp(x->path, path)) break;
+    if (x == NULL)
+    {
+        if (XrdFfsDentStats_n >= XrdFfsDent_MAXSTATS) XrdFfsDent_stat_purge();
+        if (XrdFfsDentStats_n >= XrdFfsDent_MAXSTATS) 
+        {
+            pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+            return;
+        }
+        x = (struct XrdFfsDentstat*) malloc(sizeof(struct XrdFfsDentstat));
+        x->path = strdup(path);
+        x->uid = uid;
+        x->next = XrdFfsDentStats[h];
+        XrdFfsDentStats[h] = x;
+        XrdFfsDentStats_n++;
+    }
+    x->t0 = time(NULL);
+    memcpy((void*)&x->st, (void*)st, sizeof(struct stat));
+    pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+}
+
+int XrdFfsDent_stat_cache_search(const char *path, struct stat *st, uid_t uid)
+{
+    struct XrdFfsDentstat **p;
+    int rval = 0;
+
+    pthread_mutex_lock(&XrdFfsDentStats_mutex);
+    p = &XrdFfsDentStats[XrdFfsDent_stat_hash(path)];
+    while (*p != NULL)
+    {
+        if ((*p)->uid == uid && ! strcmp((*p)->path, path))
+        {
+            if ((time(NULL) - (*p)->t0) < XrdFfsDentStats_life)
+            {
+                memcpy((void*)st, (void*)&(*p)->st, sizeof(struct stat));
+                rval = 1;
+            }
+            else
+                XrdFfsDent_stat_unlink(p);
+            break;
+        }
+        p = &(*p)->next;
+    }
+    pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+    return rval;
+}
+
+void XrdFfsDent_stat_cache_remove(const char *path)
+{
+    struct XrdFfsDentstat **p;
+
+    pthread_mutex_lock(&XrdFfsDentStats_mutex);
+    p = &XrdFfsDentStats[XrdFfsDent_stat_hash(path)];
+    while (*p != NULL)
+    {
+        if (! strcmp((*p)->path, path))
+            XrdFfsDent_stat_unlink(p);
+        else
+            p = &(*p)->next;
+    }
+    pthread_mutex_unlock(&XrdFfsDentStats_mutex);
+}
+
 /*
 #include <stdio.h>
 
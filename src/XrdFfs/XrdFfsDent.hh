@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <pthread.h>
+#include <sys/stat.h>
 
 #ifdef __cplusplus
   extern "C" {
@@ -51,6 +52,11 @@ void XrdFfsDent_cache_destroy();
 int  XrdFfsDent_cache_fill(char *dname, char ***dnarray, int nents);
 int  XrdFfsDent_cache_search(char *dname, char *dentname);
 
+void XrdFfsDent_stat_cache_setlife(int life);
+void XrdFfsDent_stat_cache_fill(const char *dname, const char *dentname, struct stat *st, uid_t uid);
+int  XrdFfsDent_stat_cache_search(const char *path, struct stat *st, uid_t uid);
+void XrdFfsDent_stat_cache_remove(const char *path);
+
 #ifdef __cplusplus
   }
 #endif
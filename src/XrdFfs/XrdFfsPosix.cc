@@ -47,6 +47,8 @@
 #include <stdlib.h>
 #include <syslog.h>
 #include "XrdFfs/XrdFfsPosix.hh"
+#include "XrdPosix/XrdPosixAdmin.hh"
+#include "XrdPosix/XrdPosixMap.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsDent.hh"
@@ -58,19 +60,24 @@
 
 #define MAXROOTURLLEN 1024 // this is also defined in other files
 
-int XrdFfsPosix_stat(const char *path, struct stat *buf)
+void XrdFfsPosix_fix_hpss_mode(struct stat *buf)
 {
-    int rc; 
-    errno = 0;
-    rc = XrdPosixXrootd::Stat(path, buf);
-    if (rc == 0 && S_ISBLK(buf->st_mode)) /* If 'buf' come from HPSS, xrootd will return it as a block device! */
-    {                                     /* So we re-mark it to a regular file */
+    if (S_ISBLK(buf->st_mode))    /* If 'buf' come from HPSS, xrootd will return it as a block device! */
+    {                             /* So we re-mark it to a regular file */
         buf->st_mode &= 0007777;
         if ( buf->st_mode & S_IXUSR )
             buf->st_mode |= 0040000;   /* a directory */
         else
             buf->st_mode |= 0100000;   /* a file */
     }
+}
+
+int XrdFfsPosix_stat(const char *path, struct stat *buf)
+{
+    int rc; 
+    errno = 0;
+    rc = XrdPosixXrootd::Stat(path, buf);
+    if (rc == 0) XrdFfsPosix_fix_hpss_mode(buf);
     return rc;
 }
 
@@ -89,6 +96,57 @@ int XrdFfsPosix_closedir(DIR *dirp)
     return XrdPosixXrootd::Closedir(dirp);
 }
 
+/*
+   XrdFfsPosix_readdirplus() lists a directory and gets the stat info of all 
+   entries in one kXR_dirlist request (with the dstat option), instead of one 
+   stat() per entry. On success, the number of entries is returned and *names 
+   and *stats point to arrays allocated by malloc(), the caller should free 
+   them (and each name). An entry the server didn't return stat info for has 
+   st_mode == 0.
+ */
+int XrdFfsPosix_readdirplus(const char *url, char ***names, struct stat **stats)
+{
+    XrdPosixAdmin adm(url);
+    XrdCl::DirectoryList *dl = NULL;
+    XrdCl::StatInfo *si;
+    dev_t rdv;
+    int i, n;
+
+    errno = 0;
+    if (!adm.isOK()) return -1;
+    if (XrdPosixMap::Result(adm.Xrd.DirList(adm.Url.GetPathWithParams(),
+                                            XrdCl::DirListFlags::Stat, dl)))
+    {
+        delete dl;
+        return -1;
+    }
+
+    n = dl->GetSize();
+    *names = (char**) malloc(sizeof(char*) * (n > 0 ? n : 1));
+    *stats = (struct stat*) malloc(sizeof(struct stat) * (n > 0 ? n : 1));
+    for (i = 0; i < n; i++)
+    {
+        (*names)[i] = strdup(dl->At(i)->GetName().c_str());
+        memset((void*)&(*stats)[i], 0, sizeof(struct stat));
+        if ((si = dl->At(i)->GetStatInfo()) == NULL) continue;
+
+        rdv = 0;
+        (*stats)[i].st_mode    = XrdPosixMap::Flags2Mode(&rdv, si->GetFlags());
+        (*stats)[i].st_rdev    = rdv;
+        (*stats)[i].st_size    = si->GetSize();
+        (*stats)[i].st_blocks  = si->GetSize()/512+1;
+        (*stats)[i].st_blksize = 64*1024;
+        (*stats)[i].st_nlink   = 1;
+        (*stats)[i].st_uid     = getuid();
+        (*stats)[i].st_gid     = getgid();
+        (*stats)[i].st_atime   = (*stats)[i].st_mtime = (*stats)[i].st_ctime = si->GetModTime();
+        (*stats)[i].st_ino     = strtoll(si->GetId().c_str(), 0, 10);
+        XrdFfsPosix_fix_hpss_mode(&(*stats)[i]);
+    }
+    delete dl;
+    return n;
+}
+
 int XrdFfsPosix_mkdir(const char *path, mode_t mode)
 {
     return XrdPosixXrootd::Mkdir(path, mode);
@@ -409,6 +467,8 @@ int XrdFfsPosix_truncateall(const char *rdrurl, const char *path, off_t size, ui
 
 struct XrdFfsPosixX_readdirall_args {
     char *url;
+    const char *path;
+    uid_t uid;
     int *res;
     int *err;
     struct XrdFfsDentnames **dents;
@@ -426,28 +486,33 @@ struct XrdFfsPosixX_readdirall_args {
 void* XrdFfsPosix_x_readdirall(void* x)
 {
     struct XrdFfsPosixX_readdirall_args *args = (struct XrdFfsPosixX_readdirall_args*) x;
-    DIR *dp;
-    struct dirent *de;
+    char **names;
+    struct stat *stats;
+    int i, n;
 
 /*
-   Xrootd's Opendir will not return NULL even under some error. For instance,
-   when it is supposed to return ENOENT or ENOTDIR, it actually returns 
-   EINPROGRESS (115), and DIR *dp will not be NULL.
+   The stat info of each entry comes with the listing, put it in the stat
+   cache so that the getattr() FUSE issues for each entry right after 
+   readdir() (e.g. ls -l) doesn't have to go to all data servers again.
  */
-    dp = XrdFfsPosix_opendir(args->url);
-    if ( dp == NULL && errno != 0)
+    n = XrdFfsPosix_readdirplus(args->url, &names, &stats);
+    if (n < 0)
     {
         *(args->err) = errno;
         *(args->res) = -1;
-        if (dp != NULL)
-            XrdFfsPosix_closedir(dp);
     }
     else
     {
         *(args->res) = 0;
-        while ((de = XrdFfsPosix_readdir(dp)) != NULL)
-            XrdFfsDent_names_add(args->dents, de->d_name);
-        XrdFfsPosix_closedir(dp);
+        for (i = 0; i < n; i++)
+        {
+            XrdFfsDent_names_add(args->dents, names[i]);
+            if (stats[i].st_mode != 0 && args->path != NULL)
+                XrdFfsDent_stat_cache_fill(args->path, names[i], &stats[i], args->uid);
+            free(names[i]);
+        }
+        free(names);
+        free(stats);
     }
     return NULL;
 }
@@ -491,6 +556,8 @@ int XrdFfsPosix_readdirall(const char *rdrurl, const char *path, char*** direnta
         strncat(newurls[i], path,  MAXROOTURLLEN - strlen(newurls[i]) -1);
         XrdFfsMisc_xrd_secsss_editurl(newurls[i], user_uid, 0);
         args[i].url = newurls[i];
+        args[i].path = (path[0] == '/' ? path : NULL);
+        args[i].uid = user_uid;
         args[i].err = &errno_i[i];
         args[i].res = &res_i[i];
         args[i].dents = &dir_i[i];
@@ -49,6 +49,7 @@ int            XrdFfsPosix_stat(const char *file_name, struct stat *buf);
 DIR           *XrdFfsPosix_opendir(const char *dirname);
 struct dirent *XrdFfsPosix_readdir(DIR *dirp);
 int            XrdFfsPosix_closedir(DIR *dir);
+int            XrdFfsPosix_readdirplus(const char *url, char ***names, struct stat **stats);
 int            XrdFfsPosix_mkdir(const char *path, mode_t mode);
 int            XrdFfsPosix_rmdir(const char *path);
 
@@ -35,8 +35,23 @@
    Note that fuse 2.8.0 pre2 or above and kernel 2.6.27 or above provide
    a big_writes option to allow > 4KByte writing. It will make this 
    smiple write caching obsolete. 
+
+   Sequential writes are collected in a per file buffer of 
+   XrdFfsWcacheBufsize bytes. When the buffer is full, it is handed to the 
+   task queue to be written in the background (write-behind) and a new 
+   buffer is started. At most XrdFfsWcacheMaxInflight buffers per file are
+   in flight, after that the writer waits for the oldest one. An error of a
+   write-behind is reported by the next write or flush. A non-sequential 
+   write, a read, and XrdFfsWcache_flush() wait for all of them, so the 
+   order of overlapping writes is kept.
+
+   Reads that follow each other sequentially grow a readahead window, 
+   doubling (with each prefetch) up to XrdFfsWcacheRAsize bytes. The data 
+   read ahead is kept for the following reads and once half of it is 
+   consumed, the next window is prefetched through the task queue. 
 */
-#define XrdFfsWcacheBufsize 131072
+#define XrdFfsWcacheMinBufsize 131072
+#define XrdFfsWcacheMaxWB 16
 
 #if defined(__linux__)
 /* For pread()/pwrite() */
@@ -58,16 +73,46 @@
 #ifndef NOXRD
     #include "XrdFfs/XrdFfsPosix.hh"
 #endif
+#ifndef NOUSE_QUEUE
+    #include "XrdFfs/XrdFfsQueue.hh"
+#endif
 
 #ifdef __cplusplus
   extern "C" {
 #endif
 
+size_t XrdFfsWcacheBufsize = 4*1024*1024;
+int    XrdFfsWcacheMaxInflight = 2;
+size_t XrdFfsWcacheRAsize = 4*1024*1024;
+
+/* a write-behind or a prefetch */
+struct XrdFfsWcacheIO {
+    int fd;
+    char *buf;
+    size_t len;
+    off_t offset;
+    ssize_t rc;
+    int err;
+    struct XrdFfsQueueTasks *task;
+};
+
 struct XrdFfsWcacheFilebuf {
     off_t offset;
     size_t len;
     char *buf;
     pthread_mutex_t *mlock;
+
+    struct XrdFfsWcacheIO *wb[XrdFfsWcacheMaxWB];  /* write-behinds in flight, oldest first */
+    int nwb;
+    int wberr;                 /* errno of a failed write-behind, not yet reported */
+
+    off_t ranext;              /* offset the next sequential read is expected at */
+    size_t rawin;              /* current readahead window */
+    off_t raoffset;            /* data read ahead */
+    size_t ralen;
+    size_t raasked;            /* ralen < raasked means end of file */
+    char *rabuf;
+    struct XrdFfsWcacheIO *pf; /* prefetch in flight */
 };
 
 struct XrdFfsWcacheFilebuf *XrdFfsWcacheFbufs;
@@ -75,6 +120,148 @@ struct XrdFfsWcacheFilebuf *XrdFfsWcacheFbufs;
 /* #include "xrdposix.h" */
 
 int XrdFfsPosix_baseFD, XrdFfsWcacheNFILES;
+
+void* XrdFfsWcache_x_pwrite(void *x)
+{
+    struct XrdFfsWcacheIO *io = (struct XrdFfsWcacheIO*) x;
+
+    io->rc = XrdFfsPosix_pwrite(io->fd, io->buf, io->len, io->offset);
+    io->err = errno;
+    return NULL;
+}
+
+void* XrdFfsWcache_x_pread(void *x)
+{
+    struct XrdFfsWcacheIO *io = (struct XrdFfsWcacheIO*) x;
+
+    io->rc = XrdFfsPosix_pread(io->fd, io->buf, io->len, io->offset);
+    io->err = errno;
+    return NULL;
+}
+
+struct XrdFfsWcacheIO *XrdFfsWcache_io_start(void* (*func)(void*), int fd, char *buf, size_t len, off_t offset)
+{
+    struct XrdFfsWcacheIO *io = (struct XrdFfsWcacheIO*) malloc(sizeof(struct XrdFfsWcacheIO));
+
+    io->fd = fd;
+    io->buf = buf;
+    io->len = len;
+    io->offset = offset;
+    io->rc = -1;
+    io->err = 0;
+#ifdef NOUSE_QUEUE
+    io->task = NULL;
+    func((void*) io);
+#else
+    io->task = XrdFfsQueue_create_task(func, (void**) io, 0);
+#endif
+    return io;
+}
+
+void XrdFfsWcache_io_wait(struct XrdFfsWcacheIO *io)
+{
+#ifndef NOUSE_QUEUE
+    XrdFfsQueue_wait_task(io->task);
+    XrdFfsQueue_free_task(io->task);
+    io->task = NULL;
+#endif
+}
+
+/* 
+   The following functions work on the index into XrdFfsWcacheFbufs[] and 
+   must be called with the mlock held.
+ */
+
+/* wait until no more than 'keep' write-behinds are in flight */
+void XrdFfsWcache_wb_wait(int fd, int keep)
+{
+    struct XrdFfsWcacheFilebuf *fb = &XrdFfsWcacheFbufs[fd];
+    struct XrdFfsWcacheIO *io;
+    int i;
+
+    while (fb->nwb > keep)
+    {
+        io = fb->wb[0];
+        XrdFfsWcache_io_wait(io);
+        if (io->rc != (ssize_t)io->len && fb->wberr == 0)
+            fb->wberr = (io->err != 0 ? io->err : EIO);
+        free(io->buf);
+        free(io);
+        for (i = 1; i < fb->nwb; i++)
+            fb->wb[i-1] = fb->wb[i];
+        fb->nwb--;
+    }
+}
+
+void XrdFfsWcache_ra_drop(int fd)
+{
+    struct XrdFfsWcacheFilebuf *fb = &XrdFfsWcacheFbufs[fd];
+
+    if (fb->pf != NULL)
+    {
+        XrdFfsWcache_io_wait(fb->pf);
+        free(fb->pf->buf);
+        free(fb->pf);
+        fb->pf = NULL;
+    }
+    if (fb->rabuf != NULL)
+        free(fb->rabuf);
+    fb->rabuf = NULL;
+    fb->ralen = 0;
+    fb->raasked = 0;
+    fb->raoffset = 0;
+}
+
+/* 
+   write out the buffer. With 'async', the buffer is written in the 
+   background, otherwise this returns after all data reached the server.
+ */
+ssize_t XrdFfsWcache_flush_locked(int fd, int async)
+{
+    struct XrdFfsWcacheFilebuf *fb = &XrdFfsWcacheFbufs[fd];
+    ssize_t rc = 0;
+
+    if (fb->len != 0 && fb->buf != NULL)
+    {
+        if (async && XrdFfsWcacheMaxInflight > 0)
+        {
+            XrdFfsWcache_wb_wait(fd, XrdFfsWcacheMaxInflight - 1);
+            fb->wb[fb->nwb++] = XrdFfsWcache_io_start(XrdFfsWcache_x_pwrite, fd + XrdFfsPosix_baseFD, 
+                                                      fb->buf, fb->len, fb->offset);
+            fb->buf = NULL;
+            fb->offset = 0;
+            fb->len = 0;
+        }
+        else
+        {
+            XrdFfsWcache_wb_wait(fd, 0);
+            rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, fb->buf, fb->len, fb->offset);
+            if (rc > 0)
+            {
+                fb->offset = 0;
+                fb->len = 0;
+            }
+        }
+    }
+    if (! async) 
+        XrdFfsWcache_wb_wait(fd, 0);
+
+    if (fb->wberr != 0)
+    {
+        errno = fb->wberr;
+        fb->wberr = 0;
+        return -1;
+    }
+    return rc;
+}
+
+void XrdFfsWcache_setparms(size_t bufsize, int maxinflight, size_t rasize)
+{
+    XrdFfsWcacheBufsize = (bufsize < XrdFfsWcacheMinBufsize ? XrdFfsWcacheMinBufsize : bufsize);
+    XrdFfsWcacheMaxInflight = (maxinflight < 0 ? 0 : (maxinflight > XrdFfsWcacheMaxWB ? XrdFfsWcacheMaxWB : maxinflight));
+    XrdFfsWcacheRAsize = rasize;
+}
+
 void XrdFfsWcache_init(int basefd, int maxfd)
 {
     int fd;
@@ -95,13 +282,14 @@ void XrdFfsWcache_init(int basefd, int maxfd)
     XrdFfsWcacheFbufs = (struct XrdFfsWcacheFilebuf*)malloc(sizeof(struct XrdFfsWcacheFilebuf) * XrdFfsWcacheNFILES);
     for (fd = 0; fd < XrdFfsWcacheNFILES; fd++)
     {
-        XrdFfsWcacheFbufs[fd].offset = 0;
-        XrdFfsWcacheFbufs[fd].len = 0;
-        XrdFfsWcacheFbufs[fd].buf = NULL;
-        XrdFfsWcacheFbufs[fd].mlock = NULL;
+        memset(&XrdFfsWcacheFbufs[fd], 0, sizeof(struct XrdFfsWcacheFilebuf));
     }
 }
 
+/* 
+   The write buffer is allocated at the first cached write, so that files 
+   which are only read don't hold one.
+ */
 int XrdFfsWcache_create(int fd) 
 {
     XrdFfsWcache_destroy(fd);
@@ -109,9 +297,11 @@ int XrdFfsWcache_create(int fd)
 
     XrdFfsWcacheFbufs[fd].offset = 0;
     XrdFfsWcacheFbufs[fd].len = 0;
-    XrdFfsWcacheFbufs[fd].buf = (char*)malloc(XrdFfsWcacheBufsize);
-    if (XrdFfsWcacheFbufs[fd].buf == NULL)
-        return 0;
+    XrdFfsWcacheFbufs[fd].buf = NULL;
+    XrdFfsWcacheFbufs[fd].nwb = 0;
+    XrdFfsWcacheFbufs[fd].wberr = 0;
+    XrdFfsWcacheFbufs[fd].ranext = 0;
+    XrdFfsWcacheFbufs[fd].rawin = 0;
     XrdFfsWcacheFbufs[fd].mlock = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
     if (XrdFfsWcacheFbufs[fd].mlock == NULL)
         return 0;
@@ -120,11 +310,23 @@ int XrdFfsWcache_create(int fd)
     return 1;
 }
 
-void XrdFfsWcache_destroy(int fd)
+/*
+   Returns -1 with errno set if a write-behind failed and the error was not
+   reported yet. The caller should flush first, this only cleans up.
+ */
+int XrdFfsWcache_destroy(int fd)
 {
+    int err;
 /*  XrdFfsWcache_flush(fd); */
     fd -= XrdFfsPosix_baseFD;
 
+    if (fd < 0 || fd >= XrdFfsWcacheNFILES)
+        return 0;
+
+    XrdFfsWcache_wb_wait(fd, 0);
+    err = XrdFfsWcacheFbufs[fd].wberr;
+    XrdFfsWcacheFbufs[fd].wberr = 0;
+    XrdFfsWcache_ra_drop(fd);
     XrdFfsWcacheFbufs[fd].offset = 0;
     XrdFfsWcacheFbufs[fd].len = 0;
     if (XrdFfsWcacheFbufs[fd].buf != NULL) 
@@ -136,6 +338,13 @@ void XrdFfsWcache_destroy(int fd)
         free(XrdFfsWcacheFbufs[fd].mlock);
     }
     XrdFfsWcacheFbufs[fd].mlock = NULL;
+
+    if (err != 0)
+    {
+        errno = err;
+        return -1;
+    }
+    return 0;
 }
 
 ssize_t XrdFfsWcache_flush(int fd)
@@ -143,16 +352,12 @@ ssize_t XrdFfsWcache_flush(int fd)
     ssize_t rc;
     fd -= XrdFfsPosix_baseFD;
 
-    if (XrdFfsWcacheFbufs[fd].len == 0 || XrdFfsWcacheFbufs[fd].buf == NULL )
+    if (fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
         return 0;
 
-    rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, 
-                            XrdFfsWcacheFbufs[fd].buf, XrdFfsWcacheFbufs[fd].len, XrdFfsWcacheFbufs[fd].offset);
-    if (rc > 0)
-    {
-        XrdFfsWcacheFbufs[fd].offset = 0;
-        XrdFfsWcacheFbufs[fd].len = 0;
-    }
+    pthread_mutex_lock(XrdFfsWcacheFbufs[fd].mlock);
+    rc = XrdFfsWcache_flush_locked(fd, 0);
+    pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
     return rc;
 }
 
@@ -163,22 +368,36 @@ ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
     fd -= XrdFfsPosix_baseFD;
 
 /* do not use caching under these cases */
-    if (len > XrdFfsWcacheBufsize/2 || fd >= XrdFfsWcacheNFILES)
+    if (fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
+        return XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+
+    pthread_mutex_lock(XrdFfsWcacheFbufs[fd].mlock);
+
+/* data read ahead may be overwritten */
+    XrdFfsWcache_ra_drop(fd);
+
+    if (len > XrdFfsWcacheBufsize/2)
     {
-        rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+        rc = XrdFfsWcache_flush_locked(fd, 0);
+        if (rc >= 0)
+            rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+        pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
         return rc;
     }
 
-    pthread_mutex_lock(XrdFfsWcacheFbufs[fd].mlock);
     rc = XrdFfsWcacheFbufs[fd].len;
 /* 
    in the following two cases, a XrdFfsWcache_flush is required:
    1. current offset isnn't pointing to the tail of data in buffer
-   2. adding new data will exceed the current buffer 
+      (wait for all writes to finish, they may overlap with this one)
+   2. adding new data will exceed the current buffer (write behind)
 */ 
-    if (offset != (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheFbufs[fd].len) ||
-        (off_t)(offset + len) > (XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheBufsize))
-        rc = XrdFfsWcache_flush(fd + XrdFfsPosix_baseFD);
+    if (offset != (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheFbufs[fd].len))
+        rc = XrdFfsWcache_flush_locked(fd, 0);
+    else if ((off_t)(offset + len) > (off_t)(XrdFfsWcacheFbufs[fd].offset + XrdFfsWcacheBufsize))
+        rc = XrdFfsWcache_flush_locked(fd, 1);
+    else if (XrdFfsWcacheFbufs[fd].wberr != 0)
+        rc = XrdFfsWcache_flush_locked(fd, 1);
 
     errno = 0;
     if (rc < 0) 
@@ -188,6 +407,14 @@ ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
         return -1;
     }
 
+    if (XrdFfsWcacheFbufs[fd].buf == NULL &&
+        (XrdFfsWcacheFbufs[fd].buf = (char*)malloc(XrdFfsWcacheBufsize)) == NULL)
+    {
+        rc = XrdFfsPosix_pwrite(fd + XrdFfsPosix_baseFD, buf, len, offset);
+        pthread_mutex_unlock(XrdFfsWcacheFbufs[fd].mlock);
+        return rc;
+    }
+
     bufptr = &XrdFfsWcacheFbufs[fd].buf[XrdFfsWcacheFbufs[fd].len];
     memcpy(bufptr, buf, len);
     if (XrdFfsWcacheFbufs[fd].len == 0)
@@ -198,6 +425,94 @@ ssize_t XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset)
     return (ssize_t)len;
 }
 
+ssize_t XrdFfsWcache_pread(int fd, char *buf, size_t len, off_t offset)
+{
+    struct XrdFfsWcacheFilebuf *fb;
+    ssize_t rc;
+    size_t n;
+    char *rabuf;
+    fd -= XrdFfsPosix_baseFD;
+
+    if (fd >= XrdFfsWcacheNFILES || XrdFfsWcacheFbufs[fd].mlock == NULL)
+        return XrdFfsPosix_pread(fd + XrdFfsPosix_baseFD, buf, len, offset);
+
+    fb = &XrdFfsWcacheFbufs[fd];
+    pthread_mutex_lock(fb->mlock);
+/* in case is the file is reading/writing. A write-behind error is kept for
+   the next write, fsync or release to report. */
+    if (XrdFfsWcache_flush_locked(fd, 0) < 0 && fb->wberr == 0)
+        fb->wberr = (errno != 0 ? errno : EIO);
+
+/* a prefetch covering this read becomes the data read ahead */
+    if (fb->pf != NULL && offset >= fb->pf->offset && offset < (off_t)(fb->pf->offset + fb->pf->len))
+    {
+        XrdFfsWcache_io_wait(fb->pf);
+        if (fb->rabuf != NULL) free(fb->rabuf);
+        fb->rabuf = fb->pf->buf;
+        fb->raoffset = fb->pf->offset;
+        fb->ralen = (fb->pf->rc > 0 ? fb->pf->rc : 0);
+        fb->raasked = fb->pf->len;
+        free(fb->pf);
+        fb->pf = NULL;
+        if (fb->ralen == fb->raasked && fb->rawin < XrdFfsWcacheRAsize)
+            fb->rawin = (2*fb->rawin > XrdFfsWcacheRAsize ? XrdFfsWcacheRAsize : 2*fb->rawin);
+    }
+
+    if (fb->rabuf != NULL && offset >= fb->raoffset && 
+        (off_t)(offset + len) <= (off_t)(fb->raoffset + fb->ralen))
+    {
+        memcpy(buf, fb->rabuf + (offset - fb->raoffset), len);
+        rc = len;
+    }
+    else
+    {
+/* grow the window while reads are sequential, drop it otherwise */
+        if (offset == fb->ranext && XrdFfsWcacheRAsize > len)
+            fb->rawin = (fb->rawin == 0 ? 4*len : 2*fb->rawin);
+        else
+            fb->rawin = 0;
+        if (fb->rawin > XrdFfsWcacheRAsize) fb->rawin = XrdFfsWcacheRAsize;
+
+        if (fb->rawin <= len)
+        {
+            XrdFfsWcache_ra_drop(fd);
+            fb->ranext = offset + len;
+            pthread_mutex_unlock(fb->mlock);
+            return XrdFfsPosix_pread(fd + XrdFfsPosix_baseFD, buf, len, offset);
+        }
+
+        XrdFfsWcache_ra_drop(fd);
+        if ((rabuf = (char*)malloc(fb->rawin)) == NULL)
+            rc = XrdFfsPosix_pread(fd + XrdFfsPosix_baseFD, buf, len, offset);
+        else
+        {
+            rc = XrdFfsPosix_pread(fd + XrdFfsPosix_baseFD, rabuf, fb->rawin, offset);
+            if (rc < 0)
+                free(rabuf);
+            else
+            {
+                fb->rabuf = rabuf;
+                fb->raoffset = offset;
+                fb->ralen = rc;
+                fb->raasked = fb->rawin;
+                n = ((size_t)rc < len ? rc : len);
+                memcpy(buf, rabuf, n);
+                rc = n;
+            }
+        }
+    }
+    if (rc > 0) fb->ranext = offset + rc;
+
+/* once half of the data read ahead is consumed, prefetch the next window */
+    if (fb->rawin > 0 && fb->pf == NULL && fb->rabuf != NULL && fb->ralen == fb->raasked &&
+        fb->ranext >= (off_t)(fb->raoffset + fb->ralen/2) && (rabuf = (char*)malloc(fb->rawin)) != NULL)
+        fb->pf = XrdFfsWcache_io_start(XrdFfsWcache_x_pread, fd + XrdFfsPosix_baseFD,
+                                       rabuf, fb->rawin, fb->raoffset + fb->ralen);
+
+    pthread_mutex_unlock(fb->mlock);
+    return rc;
+}
+
 #ifdef __cplusplus
   }
 #endif
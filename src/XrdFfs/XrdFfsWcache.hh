@@ -31,11 +31,13 @@
   extern "C" {
 #endif
 
+void    XrdFfsWcache_setparms(size_t bufsize, int maxinflight, size_t rasize);
 void    XrdFfsWcache_init(int basefd, int maxfd);
 int     XrdFfsWcache_create(int fd);
-void    XrdFfsWcache_destroy(int fd);
+int     XrdFfsWcache_destroy(int fd);
 ssize_t  XrdFfsWcache_flush(int fd);
 ssize_t  XrdFfsWcache_pwrite(int fd, char *buf, size_t len, off_t offset);
+ssize_t  XrdFfsWcache_pread(int fd, char *buf, size_t len, off_t offset);
 
 #ifdef __cplusplus
   }
@@ -64,7 +64,7 @@
 #include "XrdFfs/XrdFfsMisc.hh"
 #include "XrdFfs/XrdFfsWcache.hh"
 #include "XrdFfs/XrdFfsQueue.hh"
-//#include "XrdFfs/XrdFfsDent.hh"
+#include "XrdFfs/XrdFfsDent.hh"
 #include "XrdFfs/XrdFfsFsinfo.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
@@ -80,12 +80,16 @@ struct XROOTDFS {
     bool ofsfwd;
     int  nworkers;
     int  maxfd;
+    int  statcachelife;
+    int  wbsize;
+    int  wbinflight;
+    int  rasize;
 };
 
 int cwdfd; // File descript of the initial working dir
 
 struct XROOTDFS xrootdfs;
-static struct fuse_opt xrootdfs_opts[14];
+static struct fuse_opt xrootdfs_opts[18];
 
 enum { OPT_KEY_HELP, OPT_KEY_SECSSS, };
 
@@ -127,7 +131,10 @@ static void* xrootdfs_init(struct fuse_conn_info *conn)
 /* put Xrootd related initialization calls here, after fuse daemonize itself. */
     XrdPosixXrootd *abc = new XrdPosixXrootd(-xrootdfs.maxfd);
     XrdFfsMisc_xrd_init(xrootdfs.rdr,xrootdfs.urlcachelife,0);
+    XrdFfsWcache_setparms((size_t)xrootdfs.wbsize * 1024 * 1024, xrootdfs.wbinflight,
+                          (size_t)xrootdfs.rasize * 1024 * 1024);
     XrdFfsWcache_init(abc->fdOrigin(), xrootdfs.maxfd);
+    XrdFfsDent_stat_cache_setlife(xrootdfs.statcachelife);
 /*
    From FAQ:
       Miscellaneous threads should be started from the init() method.
@@ -179,7 +186,10 @@ static int xrootdfs_getattr(const char *path, struct stat *stbuf)
     res = XrdFfsPosix_stat(rootpath, stbuf);
 */
 
-    if (xrootdfs.cns != NULL && xrootdfs.fastls != NULL)
+/* an "ls -l" right after readdir() is answered with the stat info that came with the listing */
+    if (XrdFfsDent_stat_cache_search(path, stbuf, fuse_get_context()->uid))
+        res = 0;
+    else if (xrootdfs.cns != NULL && xrootdfs.fastls != NULL)
     {
         strncat(rootpath,xrootdfs.cns, MAXROOTURLLEN - strlen(rootpath) -1);
         strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
@@ -314,6 +324,34 @@ static int xrootdfs_readdir(const char *path, void *buf, fuse_fill_dir_t filler,
         strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
 
         XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, 0);
+/*
+   _getattr() trusts CNS for file info only when fastls is set (and not to RDR),
+   only then can the stat info from the CNS listing be cached for it.
+ */
+        if (xrootdfs.fastls != NULL && strcmp(xrootdfs.fastls, "RDR") != 0)
+        {
+            int i, n;
+            char **names;
+            struct stat *stats;
+
+            n = XrdFfsPosix_readdirplus(rootpath, &names, &stats);
+            if (n < 0)
+                return -errno;
+
+            for (i = 0; i < n; i++)
+            {
+                if (stats[i].st_mode != 0)
+                    XrdFfsDent_stat_cache_fill(path, names[i], &stats[i], fuse_get_context()->uid);
+                if (filler(buf, names[i], (stats[i].st_mode != 0 ? &stats[i] : NULL), 0))
+                    break;
+            }
+            for (i = 0; i < n; i++)
+                free(names[i]);
+            free(names);
+            free(stats);
+            return 0;
+        }
+
         dp = XrdFfsPosix_opendir(rootpath);
         if (dp == NULL)
             return -errno;
@@ -363,6 +401,7 @@ static int xrootdfs_mknod(const char *path, mode_t mode, dev_t rdev)
     char rootpath[MAXROOTURLLEN];
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, 0);
+    XrdFfsDent_stat_cache_remove(path);
     if (S_ISREG(mode))
     {
         rootpath[0]='\0';
@@ -416,6 +455,7 @@ static int xrootdfs_mkdir(const char *path, mode_t mode)
     if CNS is defined, only mkdir() on CNS. Otherwise, mkdir() on redirector
  */
     rootpath[0]='\0';
+    XrdFfsDent_stat_cache_remove(path);
 
     if (xrootdfs.cns != NULL)
         strncat(rootpath,xrootdfs.cns, MAXROOTURLLEN - strlen(rootpath) -1);
@@ -452,6 +492,7 @@ static int xrootdfs_unlink(const char *path)
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, 0);
+    XrdFfsDent_stat_cache_remove(path);
     if (xrootdfs.ofsfwd == true)
     {
         XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, 0);
@@ -488,6 +529,7 @@ static int xrootdfs_rmdir(const char *path)
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, 0);
+    XrdFfsDent_stat_cache_remove(path);
     if (xrootdfs.ofsfwd == true)
     { 
         XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, 0);
@@ -558,6 +600,8 @@ static int xrootdfs_rename(const char *from, const char *to)
  */
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, 0);
+    XrdFfsDent_stat_cache_remove(from);
+    XrdFfsDent_stat_cache_remove(to);
     XrdFfsMisc_xrd_secsss_editurl(from_path, fuse_get_context()->uid, 0);
 
     XrdFfsPosix_stat(from_path, &stbuf);
@@ -638,6 +682,7 @@ static int xrootdfs_ftruncate(const char *path, off_t size,
 //  char rootpath[1024];
                                                                                                                                            
     fd = (int) fi->fh;
+    XrdFfsDent_stat_cache_remove(path);
     XrdFfsWcache_flush(fd);
     res = XrdFfsPosix_ftruncate(fd, size);
     if (res == -1)
@@ -671,6 +716,7 @@ static int xrootdfs_truncate(const char *path, off_t size)
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, 0);
+    XrdFfsDent_stat_cache_remove(path);
     if (xrootdfs.ofsfwd == true)
     {
         XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, 0);
@@ -722,6 +768,7 @@ static int xrootdfs_open(const char *path, struct fuse_file_info *fi)
     strncat(rootpath,path, MAXROOTURLLEN - strlen(rootpath) -1);
 
     XrdFfsMisc_xrd_secsss_register(fuse_get_context()->uid, fuse_get_context()->gid, &lid);
+    if ((fi->flags & O_ACCMODE) != O_RDONLY) XrdFfsDent_stat_cache_remove(path);
     XrdFfsMisc_xrd_secsss_editurl(rootpath, fuse_get_context()->uid, &lid);
     res = XrdFfsPosix_open(rootpath, fi->flags, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
     if (res == -1)
@@ -739,8 +786,7 @@ static int xrootdfs_read(const char *path, char *buf, size_t size, off_t offset,
     int res;
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);  /* in case is the file is reading/writing */
-    res = XrdFfsPosix_pread(fd, buf, size, offset);
+    res = XrdFfsWcache_pread(fd, buf, size, offset);  /* also flushes, in case the file is reading/writing */
     if (res == -1)
         res = -errno;
 
@@ -758,6 +804,7 @@ static int xrootdfs_write(const char *path, const char *buf, size_t size,
    truncate a file before calling xrootdfs_write() 
 */
     fd = (int) fi->fh;
+    XrdFfsDent_stat_cache_remove(path);
 //    res = XrdFfsPosix_pwrite(fd, buf, size, offset);
     res = XrdFfsWcache_pwrite(fd, (char *)buf, size, offset);
     if (res == -1)
@@ -833,20 +880,34 @@ static int xrootdfs_statfs(const char *path, struct statvfs *stbuf)
  */
 }
 
+static int xrootdfs_flush(const char *path, struct fuse_file_info *fi)
+{
+    int fd;
+
+    fd = (int) fi->fh;
+/* called on every close(), so errors of write-behinds reach the application */
+    if (XrdFfsWcache_flush(fd) < 0)
+        return -EIO;
+    return 0;
+}
+
 static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
 {
     /* Just a stub.  This method is optional and can safely be left
        unimplemented */
 
-    int fd, oflag;
+    int fd, oflag, rc = 0;
     struct stat xrdfile, cnsfile;
     char rootpath[MAXROOTURLLEN];
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
-    XrdFfsWcache_destroy(fd);
+    if (XrdFfsWcache_flush(fd) < 0)
+        rc = -EIO;
+    if (XrdFfsWcache_destroy(fd) < 0)
+        rc = -EIO;
     XrdFfsPosix_close(fd);
     fi->fh = 0;
+    if ((fi->flags & O_ACCMODE) != O_RDONLY) XrdFfsDent_stat_cache_remove(path);
 /* 
    Return at here because the current version of Cluster Name Space daemon 
    doesn't implement the 'truncate' functon we originally planned.
@@ -854,7 +915,7 @@ static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
     return 0;
 */
     if (xrootdfs.cns == NULL || (fi->flags & 0100001) == (0100000 | O_RDONLY))
-        return 0;
+        return rc;
 
     int res;
     char xattr[256], xrdtoken[256];
@@ -925,7 +986,7 @@ static int xrootdfs_release(const char *path, struct fuse_file_info *fi)
         }
     }
 
-    return 0;
+    return rc;
 }
 
 static int xrootdfs_fsync(const char *path, int isdatasync,
@@ -934,7 +995,9 @@ static int xrootdfs_fsync(const char *path, int isdatasync,
     int fd;
 
     fd = (int) fi->fh;
-    XrdFfsWcache_flush(fd);
+/* errors of write-behinds are reported here (or by the next write) */
+    if (XrdFfsWcache_flush(fd) < 0)
+        return -errno;
     XrdFfsPosix_fsync(fd);
     return 0;
 }
@@ -1169,6 +1232,10 @@ static void xrootdfs_usage(const char *progname)
 "    -o maxfd=N               number of virtual file descriptors for posix requests, default 8192 (min 2048)\n"
 "    -o nworkers=N            number of workers to handle parallel requests to data servers, default 4\n"
 "    -o fastls=RDR            set to RDR when CNS is presented will cause stat() to go to redirector\n"
+"    -o statcachelife=N       seconds to keep the stat info returned by readdir for getattr, default 10 (0 disables)\n"
+"    -o wbsize=N              size in MB of the per file write buffer, default 4\n"
+"    -o wbinflight=N          number of full write buffers written in the background per file, default 2 (0 writes synchronously)\n"
+"    -o rasize=N              max readahead in MB for sequential reads, default 4 (0 disables)\n"
 "\n", progname);
 }
 
@@ -1220,6 +1287,7 @@ int main(int argc, char *argv[])
     xrootdfs_oper.read		= xrootdfs_read;
     xrootdfs_oper.write		= xrootdfs_write;
     xrootdfs_oper.statfs	= xrootdfs_statfs;
+    xrootdfs_oper.flush		= xrootdfs_flush;
     xrootdfs_oper.release	= xrootdfs_release;
     xrootdfs_oper.fsync		= xrootdfs_fsync;
     xrootdfs_oper.setxattr	= xrootdfs_setxattr;
@@ -1300,7 +1368,25 @@ int main(int argc, char *argv[])
     xrootdfs_opts[12].offset = offsetof(struct XROOTDFS, maxfd);
     xrootdfs_opts[12].value = 0;
 
-    xrootdfs_opts[13].templ = NULL;
+/* life time of the stat info collected by readdir */
+    xrootdfs_opts[13].templ = "statcachelife=%d";
+    xrootdfs_opts[13].offset = offsetof(struct XROOTDFS, statcachelife);
+    xrootdfs_opts[13].value = 0;
+
+/* size (MB) of the write-behind buffer, number of them in flight per file, max readahead (MB) */
+    xrootdfs_opts[14].templ = "wbsize=%d";
+    xrootdfs_opts[14].offset = offsetof(struct XROOTDFS, wbsize);
+    xrootdfs_opts[14].value = 0;
+
+    xrootdfs_opts[15].templ = "wbinflight=%d";
+    xrootdfs_opts[15].offset = offsetof(struct XROOTDFS, wbinflight);
+    xrootdfs_opts[15].value = 0;
+
+    xrootdfs_opts[16].templ = "rasize=%d";
+    xrootdfs_opts[16].offset = offsetof(struct XROOTDFS, rasize);
+    xrootdfs_opts[16].value = 0;
+
+    xrootdfs_opts[17].templ = NULL;
 
 /* initialize struct xrootdfs */
 //    memset(&xrootdfs, 0, sizeof(xrootdfs));
@@ -1313,6 +1399,10 @@ int main(int argc, char *argv[])
     xrootdfs.urlcachelife = strdup("3650d"); /* 10 years */
     xrootdfs.nworkers = 4;
     xrootdfs.maxfd = 8192;
+    xrootdfs.statcachelife = 10;
+    xrootdfs.wbsize = 4;
+    xrootdfs.wbinflight = 2;
+    xrootdfs.rasize = 4;
 
 /* Get options from environment variables first */
     xrootdfs.rdr = getenv("XROOTDFS_RDRURL");
@@ -1323,6 +1413,10 @@ int main(int argc, char *argv[])
     if (getenv("XROOTDFS_OFSFWD") != NULL && ! strcmp(getenv("XROOTDFS_OFSFWD"),"1")) xrootdfs.ofsfwd = true;
     if (getenv("XROOTDFS_NWORKERS") != NULL) sscanf(getenv("XROOTDFS_NWORKERS"), "%d", &xrootdfs.nworkers);
     if (getenv("XROOTDFS_MAXFD") != NULL) sscanf(getenv("XROOTDFS_MAXFD"), "%d", &xrootdfs.maxfd);
+    if (getenv("XROOTDFS_STATCACHELIFE") != NULL) sscanf(getenv("XROOTDFS_STATCACHELIFE"), "%d", &xrootdfs.statcachelife);
+    if (getenv("XROOTDFS_WBSIZE") != NULL) sscanf(getenv("XROOTDFS_WBSIZE"), "%d", &xrootdfs.wbsize);
+    if (getenv("XROOTDFS_WBINFLIGHT") != NULL) sscanf(getenv("XROOTDFS_WBINFLIGHT"), "%d", &xrootdfs.wbinflight);
+    if (getenv("XROOTDFS_RASIZE") != NULL) sscanf(getenv("XROOTDFS_RASIZE"), "%d", &xrootdfs.rasize);
 
 /* Parse XrootdFS options, will overwrite those defined in environment variables */
     fuse_opt_parse(&args, &xrootdfs, xrootdfs_opts, xrootdfs_opt_proc);
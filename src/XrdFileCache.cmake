@@ -23,6 +23,7 @@ add_library(
   XrdFileCache/XrdFileCacheVRead.cc
   XrdFileCache/XrdFileCacheStats.hh
   XrdFileCache/XrdFileCacheInfo.cc          XrdFileCache/XrdFileCacheInfo.hh
+  XrdFileCache/XrdFileCacheJournal.cc       XrdFileCache/XrdFileCacheJournal.hh
   XrdFileCache/XrdFileCacheIO.cc            XrdFileCache/XrdFileCacheIO.hh
   XrdFileCache/XrdFileCacheIOEntireFile.cc  XrdFileCache/XrdFileCacheIOEntireFile.hh
   XrdFileCache/XrdFileCacheIOFileBlock.cc   XrdFileCache/XrdFileCacheIOFileBlock.hh
@@ -23,6 +23,7 @@
 
 #include "XrdCl/XrdClConstants.hh"
 #include "XrdCl/XrdClURL.hh"
+#include "XrdCl/XrdClFile.hh"
 #include "XrdSys/XrdSysPthread.hh"
 #include "XrdSys/XrdSysTimer.hh"
 #include "XrdOss/XrdOss.hh"
@@ -54,6 +55,13 @@ void *ProcessWriteTaskThread(void* c)
    return NULL;
 }
 
+void *ProcessUploadsThread(void* c)
+{
+   Cache *cache = static_cast<Cache*>(c);
+   cache->ProcessUploads();
+   return NULL;
+}
+
 void *PrefetchThread(void* ptr)
 {
    Cache* cache = static_cast<Cache*>(ptr);
@@ -85,6 +93,12 @@ XrdOucCache2 *XrdOucGetCache2(XrdSysLogger *logger,
    pthread_t tid2;
    XrdSysThread::Run(&tid2, PrefetchThread, (void*)(&factory), 0, "XrdFileCache Prefetch ");
 
+   if (factory.GetJournal())
+   {
+      pthread_t tid3;
+      XrdSysThread::Run(&tid3, ProcessUploadsThread, (void*)(&factory), 0, "XrdFileCache WriteBack ");
+   }
+
 
    pthread_t tid;
    XrdSysThread::Run(&tid, CacheDirCleanupThread, NULL, 0, "XrdFileCache CacheDirCleanup");
@@ -128,7 +142,12 @@ Cache::Cache() : XrdOucCache(),
    m_trace(0),
    m_traceID("Manager"),
    m_prefetch_condVar(0),
-   m_RAMblocks_used(0)
+   m_RAMblocks_used(0),
+   m_DirectBlocks_used(0),
+   m_HotBlocks_used(0),
+   m_journal(0),
+   m_aging(0),
+   m_active_cond(0)
 {
    m_trace = new XrdOucTrace(&m_log);
    // default log level is Warning
@@ -139,6 +158,12 @@ Cache::Cache() : XrdOucCache(),
 
 XrdOucCacheIO2 *Cache::Attach(XrdOucCacheIO2 *io, int Options)
 {
+   if ((Options & optRW) && m_configuration.m_write_mode == Configuration::kWriteOff)
+   {
+      TRACE(Info, "Cache::Attach() write caching disabled, not caching " << io->Path());
+      return io;
+   }
+
    if (Cache::GetInstance().Decide(io))
    {
       TRACE(Debug, "Cache::Attach() " << io->Path());
@@ -146,7 +171,7 @@ XrdOucCacheIO2 *Cache::Attach(XrdOucCacheIO2 *io, int Options)
       if (Cache::GetInstance().RefConfiguration().m_hdfsmode)
          cio = new IOFileBlock(io, m_stats, *this);
       else
-         cio = new IOEntireFile(io, m_stats, *this);
+         cio = new IOEntireFile(io, m_stats, *this, (Options & optRW) != 0);
 
       TRACE_PC(Info, const char* loc = io->Location(),
                "Cache::Attach() " << io->Path() << " location: " <<
@@ -172,9 +197,17 @@ void Cache::Detach(File* file)
 {
    TRACE(Debug, "Cache::Detach() file = " << file);
 
-   std::map<std::string, File*>::iterator it = m_active.find(file->GetLocalPath());
-   assert (it != m_active.end());
-   m_active.erase(it);
+   {
+      XrdSysCondVarHelper lock(m_active_cond);
+      while (m_aging == file)
+      {
+         m_active_cond.Wait();
+      }
+      std::map<std::string, File*>::iterator it = m_active.find(file->GetLocalPath());
+      assert (it != m_active.end());
+      m_active.erase(it);
+   }
+   RemoveUploadQEntriesFor(file);
    delete file;
 }
 
@@ -237,6 +270,178 @@ Cache::ProcessWriteTasks()
    }
 }
 
+//______________________________________________________________________________
+void
+Cache::ScheduleUpload(File* file)
+{
+   XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+   for (std::list<File*>::iterator i = m_uploadQ.queue.begin(); i != m_uploadQ.queue.end(); ++i)
+   {
+      if (*i == file) return;
+   }
+   m_uploadQ.queue.push_back(file);
+   m_uploadQ.condVar.Broadcast();
+}
+
+//______________________________________________________________________________
+void
+Cache::RetryUpload(const std::string &lpath, const Journal::Pending &p)
+{
+   XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+   Journal::Pending &q = m_abandoned[lpath];
+   q.m_url  = p.m_url;
+   q.m_base = p.m_base;
+   q.m_ranges.insert(q.m_ranges.end(), p.m_ranges.begin(), p.m_ranges.end());
+   m_uploadQ.condVar.Broadcast();
+}
+
+//______________________________________________________________________________
+void
+Cache::RemoveUploadQEntriesFor(File* file)
+{
+   XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+   m_uploadQ.queue.remove(file);
+   while (m_uploadQ.current == file)
+   {
+      m_uploadQ.condVar.Wait();
+   }
+}
+
+//______________________________________________________________________________
+void
+Cache::ProcessUploads()
+{
+   // Retry uploads left over from the previous run, or given up by files
+   // closed in this run, until they succeed, while also serving files
+   // written in this run.
+   time_t nextRecoveryAttempt = 0;
+
+   while (true)
+   {
+      {
+         XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+         for (Journal::PendingMap_i pi = m_abandoned.begin(); pi != m_abandoned.end(); ++pi)
+         {
+            Journal::Pending &q = m_recovered[pi->first];
+            q.m_url  = pi->second.m_url;
+            q.m_base = pi->second.m_base;
+            q.m_ranges.insert(q.m_ranges.end(), pi->second.m_ranges.begin(), pi->second.m_ranges.end());
+         }
+         m_abandoned.clear();
+      }
+
+      if ( ! m_recovered.empty() && time(0) >= nextRecoveryAttempt)
+      {
+         Journal::PendingMap_i pi = m_recovered.begin();
+         while (pi != m_recovered.end())
+         {
+            if (UploadRecovered(pi->first, pi->second))
+               m_recovered.erase(pi++);
+            else
+               ++pi;
+         }
+         nextRecoveryAttempt = time(0) + 60;
+      }
+
+      File *file;
+      {
+         XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+         while (m_uploadQ.queue.empty() && m_abandoned.empty())
+         {
+            if (m_recovered.empty())
+               m_uploadQ.condVar.Wait();
+            else if (m_uploadQ.condVar.Wait(60))
+               break;
+         }
+         if (m_uploadQ.queue.empty()) continue;
+
+         file = m_uploadQ.queue.front();
+         m_uploadQ.queue.pop_front();
+         m_uploadQ.current = file;
+      }
+
+      file->Upload();
+
+      {
+         XrdSysCondVarHelper _lck(m_uploadQ.condVar);
+         m_uploadQ.current = 0;
+         m_uploadQ.condVar.Broadcast();
+      }
+   }
+}
+
+//______________________________________________________________________________
+bool
+Cache::UploadRecovered(const std::string &lpath, Journal::Pending &p)
+{
+   // Upload ranges recorded in the journal by a previous run. The data is
+   // read from the local copy, which holds the latest content.
+
+   TRACE(Info, "Cache::UploadRecovered() " << lpath << " to " << p.m_url << ", " << p.m_ranges.size() << " ranges");
+
+   XrdOucEnv myEnv;
+   XrdOssDF *local = m_output_fs->newFile(m_configuration.m_username.c_str());
+   if (local->Open(lpath.c_str(), O_RDONLY, 0600, myEnv) != XrdOssOK)
+   {
+      TRACE(Error, "Cache::UploadRecovered() can not open local file " << lpath << ", dropping its journal records");
+      delete local;
+      m_journal->MarkClean(lpath, m_journal->LastSeq());
+      return true;
+   }
+
+   XrdCl::File origin;
+   bool ok = origin.Open(p.m_url, XrdCl::OpenFlags::Update).IsOK();
+   if ( ! ok)
+   {
+      TRACE(Warning, "Cache::UploadRecovered() can not open origin " << p.m_url << ", will retry");
+   }
+
+   long long maxSeq = 0;
+   std::vector<char> buf(m_configuration.m_bufferSize);
+   for (std::vector<Journal::Range>::iterator ri = p.m_ranges.begin(); ok && ri != p.m_ranges.end(); ++ri)
+   {
+      long long off = ri->m_off;
+      long long end = ri->m_off + ri->m_size;
+      while (ok && off < end)
+      {
+         long long n  = std::min((long long) buf.size(), end - off);
+         ssize_t   rs = local->Read(&buf[0], off - p.m_base, n);
+         ok = (rs == n) && origin.Write(off, n, &buf[0]).IsOK();
+         off += n;
+      }
+      if (ri->m_seq > maxSeq) maxSeq = ri->m_seq;
+   }
+
+   if (origin.IsOpen())
+   {
+      ok = origin.Close().IsOK() && ok;
+   }
+   local->Close();
+   delete local;
+
+   if ( ! ok) return false;
+
+   // Clear dirty state in cinfo unless the file got reopened meanwhile.
+   std::string ifn = lpath + Info::m_infoExtension;
+   XrdOssDF *infoFile = m_output_fs->newFile(m_configuration.m_username.c_str());
+   if ( ! HaveActiveFileWithLocalPath(lpath) && infoFile->Open(ifn.c_str(), O_RDWR, 0600, myEnv) == XrdOssOK)
+   {
+      Info info(m_trace);
+      if (info.Read(infoFile, ifn))
+      {
+         info.ClearDirty();
+         info.Write(infoFile, ifn);
+         infoFile->Fsync();
+      }
+      infoFile->Close();
+   }
+   delete infoFile;
+
+   m_journal->MarkClean(lpath, maxSeq);
+   TRACE(Info, "Cache::UploadRecovered() finished " << lpath);
+   return true;
+}
+
 //______________________________________________________________________________
 
 bool
@@ -258,32 +463,102 @@ Cache::RAMBlockReleased()
    m_RAMblocks_used--;
 }
 
+bool
+Cache::RequestDirectBlock()
+{
+   // Allow up to 1/8 of configured RAM on top, without it each reader would
+   // issue its own remote request for the same data.
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   if ( m_DirectBlocks_used < Cache::GetInstance().RefConfiguration().m_NRamBuffers / 8 + 1 )
+   {
+      m_DirectBlocks_used++;
+      return true;
+   }
+   return false;
+}
+
+void
+Cache::DirectBlockReleased()
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   m_DirectBlocks_used--;
+}
+
+bool
+Cache::RequestHotBlock()
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   if ( m_HotBlocks_used < Cache::GetInstance().RefConfiguration().m_NHotBlocks )
+   {
+      m_HotBlocks_used++;
+      return true;
+   }
+   return false;
+}
+
+void
+Cache::HotBlockReleased()
+{
+   XrdSysMutexHelper lock(&m_RAMblock_mutex);
+   m_HotBlocks_used--;
+}
+
 void
 Cache::AddActive(File* file)
 {
-   XrdSysMutexHelper lock(&m_active_mutex);
+   XrdSysCondVarHelper lock(m_active_cond);
    m_active[file->GetLocalPath()] = file;
+   m_active_cond.Broadcast();
 }
 
 
 File* Cache::GetFileWithLocalPath(std::string path, IO* iIo)
 {
-   XrdSysMutexHelper lock(&m_active_mutex);
+   XrdSysCondVarHelper lock(m_active_cond);
 
-   std::map<std::string, File*>::iterator it = m_active.find(path);
-   if (it != m_active.end())
+   while (true)
    {
-      it->second->WakeUp(iIo);
-      return it->second;
+      std::map<std::string, File*>::iterator it = m_active.find(path);
+      if (it == m_active.end())
+      {
+         // reserve, caller creates the File and calls AddActive()
+         m_active[path] = 0;
+         return 0;
+      }
+      if (it->second)
+      {
+         it->second->WakeUp(iIo);
+         return it->second;
+      }
+      m_active_cond.Wait();
    }
+}
+
+bool Cache::ReservePath(const std::string& path)
+{
+   XrdSysCondVarHelper lock(m_active_cond);
 
+   if (m_active.find(path) != m_active.end()) return false;
 
-   return 0;
+   m_active[path] = 0;
+   return true;
+}
+
+void Cache::ReleasePath(const std::string& path)
+{
+   XrdSysCondVarHelper lock(m_active_cond);
+
+   std::map<std::string, File*>::iterator it = m_active.find(path);
+   if (it != m_active.end() && it->second == 0)
+   {
+      m_active.erase(it);
+      m_active_cond.Broadcast();
+   }
 }
 
 bool Cache::HaveActiveFileWithLocalPath(std::string path)
 {
-   XrdSysMutexHelper lock(&m_active_mutex);
+   XrdSysCondVarHelper lock(m_active_cond);
 
    std::map<std::string, File*>::iterator it = m_active.find(path);
 
@@ -27,6 +27,7 @@
 #include "XrdCl/XrdClDefaultEnv.hh"
 #include "XrdFileCacheFile.hh"
 #include "XrdFileCacheDecision.hh"
+#include "XrdFileCacheJournal.hh"
 
 class XrdOucStream;
 class XrdSysError;
@@ -48,8 +49,13 @@ namespace XrdFileCache
 //----------------------------------------------------------------------------
 struct Configuration
 {
+   enum WriteMode_e { kWriteOff, kWriteThrough, kWriteBack };
+
    Configuration() :
       m_hdfsmode(false),
+      m_block_cksum(true),
+      m_write_mode(kWriteOff),
+      m_journal_path("/.xrdpfc_writeback.journal"),
       m_data_space("public"),
       m_meta_space("public"),
       m_diskUsageLWM(-1),
@@ -59,10 +65,18 @@ struct Configuration
       m_RamAbsAvailable(0),
       m_NRamBuffers(-1),
       m_prefetch_max_blocks(10),
-      m_hdfsbsize(128*1024*1024)
+      m_hdfsbsize(128*1024*1024),
+      m_RamTierAbs(0),
+      m_NHotBlocks(0),
+      m_tier_promote(3),
+      m_tier_demote(24*3600)
    {}
 
    bool m_hdfsmode;                     //!< flag for enabling block-level operation
+   bool m_block_cksum;                  //!< store and verify per-block checksums
+
+   WriteMode_e m_write_mode;            //!< caching of client writes
+   std::string m_journal_path;          //!< write-back journal, in oss namespace
 
    std::string m_username;              //!< username passed to oss plugin
    std::string m_data_space;            //!< oss space for data files
@@ -78,6 +92,12 @@ struct Configuration
    size_t    m_prefetch_max_blocks;     //!< maximum number of blocks to prefetch per file
 
    long long m_hdfsbsize;               //!< used with m_hdfsmode, default 128MB
+
+   long long   m_RamTierAbs;            //!< RAM for hot blocks kept after they are on disk
+   int         m_NHotBlocks;            //!< number of hot blocks, cached
+   std::string m_fast_space;            //!< oss space for recently used data files, empty if not tiered
+   int         m_tier_promote;          //!< accesses within demote period to get into a faster tier
+   int         m_tier_demote;           //!< idle seconds before data file leaves the fast space
 };
 
 struct TmpConfiguration
@@ -171,15 +191,72 @@ public:
    //---------------------------------------------------------------------
    void RemoveWriteQEntriesFor(File *f);
 
+   //---------------------------------------------------------------------
+   //! Age blocks in the RAM tier. Called from CacheDirCleanup() once every
+   //! purge interval, which also moves data files between disk tiers.
+   //---------------------------------------------------------------------
+   void ManageTiers();
+
    //---------------------------------------------------------------------
    //! Separate task which writes blocks from ram to disk.
    //---------------------------------------------------------------------
    void ProcessWriteTasks();
 
+   //---------------------------------------------------------------------
+   //! Queue file with locally written data for upload to origin.
+   //---------------------------------------------------------------------
+   void ScheduleUpload(File* f);
+
+   //---------------------------------------------------------------------
+   //! Take over ranges a closing file could not upload. They are retried
+   //! together with the uploads left over from the previous run.
+   //---------------------------------------------------------------------
+   void RetryUpload(const std::string &lpath, const Journal::Pending &p);
+
+   //---------------------------------------------------------------------
+   //! Remove file from upload queue, wait if upload is in progress.
+   //! This method is used at the time of File destruction.
+   //---------------------------------------------------------------------
+   void RemoveUploadQEntriesFor(File* f);
+
+   //---------------------------------------------------------------------
+   //! Separate task which uploads write-back data to origin. Starts by
+   //! resuming uploads recorded in the journal before last shutdown.
+   //---------------------------------------------------------------------
+   void ProcessUploads();
+
+   //---------------------------------------------------------------------
+   //! Write-back journal, 0 if write-back is not enabled.
+   //---------------------------------------------------------------------
+   Journal* GetJournal() const { return m_journal; }
+
    bool RequestRAMBlock();
 
    void RAMBlockReleased();
 
+   //---------------------------------------------------------------------
+   //! Reserve memory for a block read while RAM for caching is exhausted.
+   //! Such blocks are not cached but shared by concurrent readers.
+   //---------------------------------------------------------------------
+   bool RequestDirectBlock();
+
+   void DirectBlockReleased();
+
+   //---------------------------------------------------------------------
+   //! Reserve memory in the RAM tier for a hot block.
+   //---------------------------------------------------------------------
+   bool RequestHotBlock();
+
+   void HotBlockReleased();
+
+   //---------------------------------------------------------------------
+   //! Reserve local path while its data file is relocated between tiers.
+   //! Fails if the path is in use, attaching IOs wait until release.
+   //---------------------------------------------------------------------
+   bool ReservePath(const std::string& path);
+
+   void ReleasePath(const std::string& path);
+
    void RegisterPrefetchFile(File*);
    void DeRegisterPrefetchFile(File*);
 
@@ -194,6 +271,12 @@ public:
 
    XrdSysError& GetSysError() { return m_log; }
 
+   //---------------------------------------------------------------------
+   //! Get active File for local path. If there is none the path is reserved
+   //! and 0 is returned: the caller must create the File and pass it to
+   //! AddActive(). Concurrent callers wait for that instead of creating
+   //! their own File for the same path.
+   //---------------------------------------------------------------------
    File* GetFileWithLocalPath(std::string, IO* io);
 
    bool  HaveActiveFileWithLocalPath(std::string);
@@ -207,6 +290,9 @@ private:
    bool ConfigXeq(char *, XrdOucStream &);
    bool xdlib(XrdOucStream &);
    bool xtrace(XrdOucStream &);
+   bool xwritemode(XrdOucStream &);
+   bool UploadRecovered(const std::string &lpath, Journal::Pending &p);
+
    static Cache     *m_factory;         //!< this object
 
    XrdSysError m_log;                   //!< XrdFileCache namespace logger
@@ -226,6 +312,8 @@ private:
 
    XrdSysMutex m_RAMblock_mutex;              //!< central lock for this class
    int m_RAMblocks_used;
+   int m_DirectBlocks_used;                   //!< RAM blocks beyond limit for shared direct reads
+   int m_HotBlocks_used;                      //!< blocks pinned in the RAM tier
 
    struct WriteQ
    {
@@ -237,6 +325,20 @@ private:
 
    WriteQ m_writeQ;
 
+   struct UploadQ
+   {
+      UploadQ() : condVar(0), current(0) {}
+      XrdSysCondVar condVar;                //!< upload list condVar
+      File*         current;                //!< file being uploaded
+      std::list<File*> queue;               //!< container
+   };
+
+   UploadQ m_uploadQ;
+
+   Journal               *m_journal;         //!< write-back journal
+   Journal::PendingMap_t  m_recovered;       //!< uploads pending from previous run
+   Journal::PendingMap_t  m_abandoned;       //!< given up by closed files, m_uploadQ.condVar
+
    struct DiskNetIO
    {
       DiskNetIO(IO* iIO, File* iFile) : io(iIO), file(iFile){}
@@ -244,8 +346,9 @@ private:
       File* file;
    };
 
-   std::map<std::string, File*>         m_active;
-   XrdSysMutex m_active_mutex;
+   std::map<std::string, File*>         m_active;          //!< 0 marks File being created
+   File                                *m_aging;           //!< File in AgeHotBlocks()
+   XrdSysCondVar m_active_cond;
 
    // prefetching
    typedef std::vector<File*>  PrefetchList;
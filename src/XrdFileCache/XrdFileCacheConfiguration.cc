@@ -98,6 +98,53 @@ bool Cache::xtrace(XrdOucStream &Config)
    return false;
 }
 
+/* Function: xwritemode
+
+   Purpose:  To parse the directive: writemode {off | through | back} [journal <path>]
+
+             off      writes are passed to origin, files opened for update
+                      are not cached (default).
+             through  writes are passed to origin, blocks cached on disk
+                      are updated.
+             back     writes are acknowledged once they are on local disk
+                      and recorded in the journal, upload to origin is
+                      asynchronous.
+             <path>   journal location in the oss namespace.
+
+   Output: true upon success or false upon failure.
+ */
+bool Cache::xwritemode(XrdOucStream &Config)
+{
+   const char *val;
+
+   if (! (val = Config.GetWord()))
+   {
+      m_log.Emsg("Config", "writemode value not specified");
+      return false;
+   }
+
+   if      (! strcmp(val, "off"))     m_configuration.m_write_mode = Configuration::kWriteOff;
+   else if (! strcmp(val, "through")) m_configuration.m_write_mode = Configuration::kWriteThrough;
+   else if (! strcmp(val, "back"))    m_configuration.m_write_mode = Configuration::kWriteBack;
+   else
+   {
+      m_log.Emsg("Config", "invalid writemode value", val);
+      return false;
+   }
+
+   if ((val = Config.GetWord()))
+   {
+      if (strcmp(val, "journal") || ! (val = Config.GetWord()) || val[0] != '/')
+      {
+         m_log.Emsg("Config", "writemode journal requires an absolute path");
+         return false;
+      }
+      m_configuration.m_journal_path = val;
+   }
+
+   return true;
+}
+
 //______________________________________________________________________________
 
 bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char *parameters)
@@ -162,6 +209,10 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
       {
          retval = xtrace(Config);
       }
+      else if (! strcmp(var,"pfc.writemode"))
+      {
+         retval = xwritemode(Config);
+      }
       else if (! strncmp(var,"pfc.", 4))
       {
          retval = ConfigParameters(std::string(var+4), Config, tmpc);
@@ -187,6 +238,18 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
          return false;
       }
 
+      // watermarks apply to data in both disk tiers
+      if ( ! m_configuration.m_fast_space.empty())
+      {
+         XrdOssVSInfo fP;
+         if (m_output_fs->StatVS(&fP, m_configuration.m_fast_space.c_str(), 1) < 0)
+         {
+            m_log.Emsg("Cache::ConfigParameters() error obtaining stat info for space ", m_configuration.m_fast_space.c_str());
+            return false;
+         }
+         sP.Total += fP.Total;
+      }
+
       if (::isalpha(*(tmpc.m_diskUsageLWM.rbegin())) && ::isalpha(*(tmpc.m_diskUsageHWM.rbegin())))
       {
          if (XrdOuca2x::a2sz(m_log, "Error getting disk usage low watermark",  tmpc.m_diskUsageLWM.c_str(), &m_configuration.m_diskUsageLWM, 0, sP.Total) ||
@@ -224,6 +287,7 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
       return false;
    }
    m_configuration.m_NRamBuffers = static_cast<int>(m_configuration.m_RamAbsAvailable/ m_configuration.m_bufferSize);
+   m_configuration.m_NHotBlocks  = static_cast<int>(m_configuration.m_RamTierAbs / m_configuration.m_bufferSize);
 
    // Set tracing to debug if this is set in environment
    char* cenv = getenv("XRDDEBUG");
@@ -252,11 +316,36 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
                       m_configuration.m_meta_space.c_str(),
                       m_trace->What);
 
+      if (m_configuration.m_write_mode != Configuration::kWriteOff)
+      {
+         char buff2[1024];
+         const char *wm = (m_configuration.m_write_mode == Configuration::kWriteBack) ? "back" : "through";
+         snprintf(buff2, sizeof(buff2), "\n       pfc.writemode %s journal %s", wm, m_configuration.m_journal_path.c_str());
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "%s", buff2);
+      }
+
+      if (m_configuration.m_RamTierAbs || ! m_configuration.m_fast_space.empty())
+      {
+         char buff2[512];
+         snprintf(buff2, sizeof(buff2), "\n       pfc.tiers ram %lld ssd %s promote %d demote %d",
+                  m_configuration.m_RamTierAbs,
+                  m_configuration.m_fast_space.empty() ? "<none>" : m_configuration.m_fast_space.c_str(),
+                  m_configuration.m_tier_promote, m_configuration.m_tier_demote);
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "%s", buff2);
+      }
+
+      if ( ! m_configuration.m_block_cksum)
+      {
+         char buff2[64];
+         snprintf(buff2, sizeof(buff2), "\n       pfc.blockcksum off");
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "%s", buff2);
+      }
+
       if (m_configuration.m_hdfsmode)
       {
          char buff2[512];
-         snprintf(buff2, sizeof(buff2), "\tpfc.hdfsmode hdfsbsize %lld\n", m_configuration.m_hdfsbsize);
-         loff += snprintf(&buff[loff], strlen(buff2), "%s", buff2);
+         snprintf(buff2, sizeof(buff2), "\n       pfc.hdfsmode hdfsbsize %lld", m_configuration.m_hdfsbsize);
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "%s", buff2);
       }
 
       char unameBuff[256];
@@ -267,13 +356,26 @@ bool Cache::Config(XrdSysLogger *logger, const char *config_filename, const char
       }
       else
       {
-         snprintf(unameBuff, sizeof(unameBuff), "\tpfc.user %s \n", m_configuration.m_username.c_str());
-         loff += snprintf(&buff[loff], strlen(unameBuff), "%s", unameBuff);
+         snprintf(unameBuff, sizeof(unameBuff), "\n       pfc.user %s", m_configuration.m_username.c_str());
+         loff += snprintf(&buff[loff], sizeof(buff) - loff, "%s", unameBuff);
       }
 
       m_log.Say( buff);
    }
 
+   // Write-back needs the journal before any file is attached
+   if (retval && m_configuration.m_write_mode == Configuration::kWriteBack)
+   {
+      m_journal = new Journal(m_trace);
+      if ( ! m_journal->Open(m_output_fs, m_configuration.m_journal_path, m_configuration.m_username.c_str(),
+                             m_configuration.m_meta_space.c_str(), m_recovered))
+      {
+         TRACE(Error, "Cache::Config() can not open write-back journal " << m_configuration.m_journal_path);
+         delete m_journal; m_journal = 0;
+         retval = false;
+      }
+   }
+
    m_log.Say("------ File Caching Proxy interface initialization ", retval ? "completed" : "failed");
 
    if (ofsCfg) delete ofsCfg;
@@ -365,6 +467,60 @@ bool Cache::ConfigParameters(std::string part, XrdOucStream& config, TmpConfigur
          return false;
       }
    }
+   else if ( part == "tiers" )
+   {
+      const char* params;
+      while ((params = config.GetWord()))
+      {
+         if (! strcmp(params, "ram"))
+         {
+            if (XrdOuca2x::a2sz(m_log, "get RAM tier size", config.GetWord(), &m_configuration.m_RamTierAbs, 0, 256ll*1024*1024*1024))
+               return false;
+         }
+         else if (! strcmp(params, "ssd"))
+         {
+            params = config.GetWord();
+            if ( ! params)
+            {
+               m_log.Emsg("Config", "tiers ssd requires an oss space name.");
+               return false;
+            }
+            m_configuration.m_fast_space = params;
+         }
+         else if (! strcmp(params, "promote"))
+         {
+            if (XrdOuca2x::a2i(m_log, "get tier promote count", config.GetWord(), &m_configuration.m_tier_promote, 1, 1000000))
+               return false;
+         }
+         else if (! strcmp(params, "demote"))
+         {
+            if (XrdOuca2x::a2tm(m_log, "get tier demote time", config.GetWord(), &m_configuration.m_tier_demote, 60))
+               return false;
+         }
+         else
+         {
+            m_log.Emsg("Config", "unknown tiers parameter", params);
+            return false;
+         }
+      }
+   }
+   else if ( part == "blockcksum" )
+   {
+      const char* params = config.GetWord();
+      if (params && ! strcmp(params, "on"))
+      {
+         m_configuration.m_block_cksum = true;
+      }
+      else if (params && ! strcmp(params, "off"))
+      {
+         m_configuration.m_block_cksum = false;
+      }
+      else
+      {
+         m_log.Emsg("Config", "blockcksum requires on or off.");
+         return false;
+      }
+   }
    else if ( part == "hdfsmode" )
    {
       m_configuration.m_hdfsmode = true;
@@ -83,6 +83,13 @@ File::File(IO *io, std::string& disk_file_path, long long iOffset, long long iFi
    m_syncer(new DiskSyncer(this, "XrdFileCache::DiskSyncer")),
    m_non_flushed_cnt(0),
    m_in_sync(false),
+   m_hot_cnt(0),
+   m_upload_in_progress(false),
+   m_dirty_seq(0),
+   m_clean_seq(0),
+   m_upload_fails(0),
+   m_upload_retry(0),
+   m_upload_errno(0),
    m_downloadCond(0),
    m_prefetchState(kOff),
    m_prefetchReadCnt(0),
@@ -114,6 +121,12 @@ File::~File()
    delete m_syncer;
    m_syncer = NULL;
 
+   if (m_stats.m_ReadVCnt > 0)
+   {
+      TRACEF(Info, "File::~File() readv count " << m_stats.m_ReadVCnt << ", full hits " << m_stats.m_ReadVFullHit
+             << ", full misses " << m_stats.m_ReadVFullMiss << ", byte hit ratio " << m_stats.ReadVHitRatio());
+   }
+
    TRACEF(Debug, "File::~File() ended, prefetch score = " <<  m_prefetchScore);
 }
 
@@ -138,6 +151,34 @@ bool File::ioActive()
 
    if (! m_is_open) return false;
 
+   // keep origin open until locally written data is uploaded
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+
+      if (UploadPending())
+      {
+         TRACEF(Debug, "File::ioActive upload pending");
+         if ( ! m_upload_in_progress && time(0) >= m_upload_retry)
+            cache()->ScheduleUpload(this);
+         return true;
+      }
+
+      // Upload was given up while the file was open; let the cache keep
+      // retrying it after the file is closed.
+      if (m_upload_errno && ! m_dirty.empty())
+      {
+         Journal::Pending p;
+         p.m_url  = m_io->GetInput()->Path();
+         p.m_base = m_offset;
+         for (RangeMap_i ri = m_dirty.begin(); ri != m_dirty.end(); ++ri)
+            p.m_ranges.push_back(Journal::Range(m_dirty_seq, ri->first, ri->second - ri->first));
+         m_dirty.clear();
+
+         TRACEF(Error, "File::ioActive upload to origin failed, errno=" << m_upload_errno
+                << "; " << p.m_ranges.size() << " ranges will be retried in background");
+         cache()->RetryUpload(m_temp_filename, p);
+      }
+   }
 
    // remove failed blocks and check if map is empty
    m_downloadCond.Lock();
@@ -148,6 +189,7 @@ bool File::ioActive()
       cache()->DeRegisterPrefetchFile(this);
    }
 
+   UnpinAllBlocks();
 
    // High debug print
    // for (BlockMap_i it = m_block_map.begin(); it != m_block_map.end(); ++it)
@@ -243,7 +285,9 @@ bool File::Open()
    // Create the data file itself.
    char size_str[16]; sprintf(size_str, "%lld", m_fileSize);
    myEnv.Put("oss.asize",  size_str);
-   myEnv.Put("oss.cgroup", Cache::GetInstance().RefConfiguration().m_data_space.c_str());
+   // new data files start in the fast tier, if there is one
+   const Configuration &conf = Cache::GetInstance().RefConfiguration();
+   myEnv.Put("oss.cgroup", conf.m_fast_space.empty() ? conf.m_data_space.c_str() : conf.m_fast_space.c_str());
    if (myOss.Create(myUser, m_temp_filename.c_str(), 0600, myEnv, XRDOSS_mkpath) != XrdOssOK)
    {
       TRACEF(Error, "File::Open() Create failed for data file " << m_temp_filename
@@ -286,9 +330,13 @@ bool File::Open()
       return false;
    }
 
-   if (fileExisted && m_cfi.Read(m_infoFile, ifn))
+   // Info with a different size is stale, unless it holds data that was
+   // written locally and not uploaded yet.
+   if (fileExisted && m_cfi.Read(m_infoFile, ifn) &&
+       (m_cfi.GetFileSize() == m_fileSize || m_cfi.HasDirtyBlocks()))
    {
       TRACEF(Debug, "Read existing info file.");
+      m_fileSize = m_cfi.GetFileSize();
    }
    else
    {
@@ -348,13 +396,17 @@ bool File::overlap(int blk,            // block to query
 
 //------------------------------------------------------------------------------
 
-Block* File::PrepareBlockRequest(int i, bool prefetch)
+Block* File::PrepareBlockRequest(int i, bool prefetch, bool direct)
 {
    // Must be called w/ block_map locked.
    // Checks on size etc should be done before.
    //
    // Reference count is 0 so increase it in calling function if you want to
    // catch the block while still in memory.
+   //
+   // A direct block is requested when RAM for caching is exhausted. It is
+   // kept in the block map only while being read, so concurrent readers of
+   // the same block share a single remote read.
 
    const long long BS = m_cfi.GetBufferSize();
    const int last_block = m_cfi.GetSizeInBits() - 1;
@@ -362,14 +414,14 @@ Block* File::PrepareBlockRequest(int i, bool prefetch)
    long long off     = i * BS;
    long long this_bs = (i == last_block) ? m_fileSize - off : BS;
 
-   Block *b = new Block(this, off, this_bs, prefetch); // should block be reused to avoid recreation
+   Block *b = new Block(this, off, this_bs, prefetch, direct); // should block be reused to avoid recreation
 
    m_block_map[i] = b;
 
    // Actual Read request is issued in ProcessBlockRequests().
    TRACEF(Dump, "File::PrepareBlockRequest() " <<  i << "prefetch" <<  prefetch << "address " << (void*)b);
 
-   if (m_prefetchState == kOn && m_block_map.size() > Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
+   if (m_prefetchState == kOn && m_block_map.size() - m_hot_cnt > Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
    {
       m_prefetchState = kHold;
       cache()->DeRegisterPrefetchFile(this);
@@ -440,7 +492,7 @@ int File::ReadBlocksFromDisk(std::list<int>& blocks,
 
       overlap(*ii, BS, req_off, req_size, off, blk_off, size);
 
-      long long rs = m_output->Read(req_buf + off, *ii * BS + blk_off -m_offset, size);
+      long long rs = ReadBlockFromDisk(*ii, req_buf + off, blk_off, size);
       TRACEF(Dump, "File::ReadBlocksFromDisk block idx = " <<  *ii << " size= " << size);
 
       if (rs < 0)
@@ -458,12 +510,215 @@ int File::ReadBlocksFromDisk(std::list<int>& blocks,
       total += rs;
    }
 
-   m_stats.m_BytesDisk += total;
    return total;
 }
 
 //------------------------------------------------------------------------------
 
+int File::ReadBlockFromDisk(int idx, char* buff, long long blk_off, long long size)
+{
+   // Read part of a block from disk. If the block has a checksum the whole
+   // block is read and verified, once per open of the file. A corrupt block
+   // is marked as missing, so it will be downloaded again, and the requested
+   // part is read from origin. A corrupt block written locally and maybe not
+   // yet uploaded is left alone and the read fails, origin has older data.
+
+   const long long BS     = m_cfi.GetBufferSize();
+   const long long blkBeg = idx * BS;
+   const int       pfIdx  = offsetIdx(idx);
+
+   const Configuration &conf = Cache::GetInstance().RefConfiguration();
+
+   unsigned int cks;
+   long long    blkLen;
+   bool         verify  = false;
+   bool         promote = false;
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      if (conf.m_block_cksum && ! BlockVerified(pfIdx))
+         verify = m_cfi.GetBlockCksum(pfIdx, cks);
+      if (conf.m_NHotBlocks > 0 && m_prefetchState != kStopped)
+      {
+         std::map<int, int>::iterator hi = m_block_hits.find(idx);
+         promote = hi != m_block_hits.end() && hi->second >= conf.m_tier_promote;
+      }
+      blkLen = std::min(BS, m_offset + m_fileSize - blkBeg);
+   }
+
+   if ( ! verify && ! promote)
+   {
+      int rs = m_output->Read(buff, blkBeg + blk_off - m_offset, size);
+      if (rs > 0) m_stats.m_BytesDisk += rs;
+      return rs;
+   }
+
+   std::vector<char> blk(blkLen);
+   int rs = m_output->Read(&blk[0], blkBeg - m_offset, blkLen);
+   if (rs == blkLen && ( ! verify || Info::CalcBlockCksum(&blk[0], blkLen) == cks))
+   {
+      if (verify)
+      {
+         XrdSysCondVarHelper _lck(m_downloadCond);
+         if ((int) m_block_verified.size() <= pfIdx) m_block_verified.resize(pfIdx + 1, false);
+         m_block_verified[pfIdx] = true;
+      }
+      memcpy(buff, &blk[blk_off], size);
+      m_stats.m_BytesDisk += size;
+      if (promote) PromoteBlock(idx, blk);
+      return size;
+   }
+   if (rs < 0) return rs;
+   if ( ! verify)
+   {
+      TRACEF(Error, "File::ReadBlockFromDisk incomplete block " << idx << " size = " << rs);
+      return -1;
+   }
+
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      if (m_cfi.TestDirtyBit(pfIdx))
+      {
+         TRACEF(Error, "File::ReadBlockFromDisk dirty block " << idx << " failed checksum verification");
+         errno = EIO;
+         return -EIO;
+      }
+      TRACEF(Error, "File::ReadBlockFromDisk block " << idx << " failed checksum verification, fetching from origin");
+      m_cfi.ResetBit(pfIdx);
+      ClearBlockVerified(pfIdx);
+      if (m_prefetchState == kComplete)
+      {
+         m_prefetchState = kOn;
+         cache()->RegisterPrefetchFile(this);
+      }
+   }
+
+   rs = m_io->GetInput()->Read(buff, blkBeg + blk_off, size);
+   if (rs > 0) m_stats.m_BytesMissed += rs;
+   return rs;
+}
+
+//==============================================================================
+// RAM tier
+//==============================================================================
+
+void File::CountBlockHit(int idx)
+{
+   // Must be called w/ block_map locked.
+   if (Cache::GetInstance().RefConfiguration().m_NHotBlocks > 0)
+      ++m_block_hits[idx];
+}
+
+//------------------------------------------------------------------------------
+
+void File::PromoteBlock(int idx, std::vector<char>& data)
+{
+   // Keep a copy of a frequently read block in RAM. When the RAM tier is full
+   // the coldest block of this file is dropped if it is colder than this one;
+   // other files give up their blocks in AgeHotBlocks().
+
+   if ( ! cache()->RequestHotBlock())
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+
+      Block *coldest = 0;
+      int    minHits = m_block_hits[idx];
+      for (BlockMap_i bi = m_block_map.begin(); bi != m_block_map.end(); ++bi)
+      {
+         if ( ! bi->second->m_pinned) continue;
+         int h = m_block_hits[bi->first];
+         if (h < minHits)
+         {
+            minHits = h;
+            coldest = bi->second;
+         }
+      }
+      if ( ! coldest) return;
+
+      UnpinBlock(coldest);
+      // released only if nobody is reading it at the moment
+      if ( ! cache()->RequestHotBlock()) return;
+   }
+
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   if (m_prefetchState == kStopped || m_block_map.find(idx) != m_block_map.end())
+   {
+      cache()->HotBlockReleased();
+      return;
+   }
+
+   Block *b = new Block(this, idx * m_cfi.GetBufferSize(), 0, false);
+   b->m_buff.swap(data);
+   b->m_downloaded = true;
+   b->m_hot        = true;
+   b->m_pinned     = true;
+   inc_ref_count(b);
+   m_block_map[idx] = b;
+   ++m_hot_cnt;
+
+   TRACEF(Dump, "File::PromoteBlock() block " << idx << " hits " << m_block_hits[idx]);
+}
+
+//------------------------------------------------------------------------------
+
+void File::UnpinBlock(Block* b)
+{
+   // Must be called w/ block_map locked.
+   b->m_pinned = false;
+   --m_hot_cnt;
+   dec_ref_count(b);
+}
+
+//------------------------------------------------------------------------------
+
+void File::UnpinAllBlocks()
+{
+   // Must be called w/ block_map locked.
+   BlockList_t pinned;
+   for (BlockMap_i bi = m_block_map.begin(); bi != m_block_map.end(); ++bi)
+   {
+      if (bi->second->m_pinned) pinned.push_back(bi->second);
+   }
+   for (BlockList_i bi = pinned.begin(); bi != pinned.end(); ++bi)
+   {
+      UnpinBlock(*bi);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void File::AgeHotBlocks()
+{
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   std::map<int, int>::iterator hi = m_block_hits.begin();
+   while (hi != m_block_hits.end())
+   {
+      hi->second /= 2;
+      if (hi->second == 0)
+         m_block_hits.erase(hi++);
+      else
+         ++hi;
+   }
+
+   const int promote = Cache::GetInstance().RefConfiguration().m_tier_promote;
+
+   BlockList_t cold;
+   for (BlockMap_i bi = m_block_map.begin(); bi != m_block_map.end(); ++bi)
+   {
+      if ( ! bi->second->m_pinned) continue;
+      hi = m_block_hits.find(bi->first);
+      if (hi == m_block_hits.end() || hi->second < promote) cold.push_back(bi->second);
+   }
+   for (BlockList_i bi = cold.begin(); bi != cold.end(); ++bi)
+   {
+      TRACEF(Dump, "File::AgeHotBlocks() demote block " << (*bi)->m_offset/m_cfi.GetBufferSize());
+      UnpinBlock(*bi);
+   }
+}
+
+//------------------------------------------------------------------------------
+
 int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
 {
    if ( ! isOpen())
@@ -496,6 +751,7 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
    for (int block_idx = idx_first; block_idx <= idx_last; ++block_idx)
    {
       TRACEF(Dump, "File::Read() idx " << block_idx);
+      CountBlockHit(block_idx);
       BlockMap_i bi = m_block_map.find(block_idx);
 
       // In RAM or incoming?
@@ -514,11 +770,14 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
       // Then we have to get it ...
       else
       {
-         // Is there room for one more RAM Block?
-         if (cache()->RequestRAMBlock())
+         // Is there room for one more RAM Block? If not, fetch a direct
+         // block that other readers can share while it is in flight.
+         bool ram    = cache()->RequestRAMBlock();
+         bool direct = ! ram && cache()->RequestDirectBlock();
+         if (ram || direct)
          {
-            TRACEF(Dump, "File::Read() inc_ref_count new " <<  (void*)iUserBuff << " idx = " << block_idx);
-            Block *b = PrepareBlockRequest(block_idx, false);
+            TRACEF(Dump, "File::Read() inc_ref_count new " <<  (void*)iUserBuff << " idx = " << block_idx << " direct = " << direct);
+            Block *b = PrepareBlockRequest(block_idx, false, direct);
             if ( ! b)
             {
                preProcOK = false;
@@ -635,7 +894,10 @@ int File::Read(char* iUserBuff, long long iUserOff, int iUserSize)
             TRACEF(Dump, "File::Read() ub=" << (void*)iUserBuff  << " from finished block " << (*bi)->m_offset/BS << " size " << size_to_copy);
             memcpy(&iUserBuff[user_off], &((*bi)->m_buff[off_in_block]), size_to_copy);
             bytes_read += size_to_copy;
-            m_stats.m_BytesRam += size_to_copy;
+            if ((*bi)->m_direct)
+               m_stats.m_BytesMissed += size_to_copy;
+            else
+               m_stats.m_BytesRam += size_to_copy;
             if ((*bi)->m_prefetch)
                prefetchHitsRam++;
          }
@@ -741,11 +1003,17 @@ void File::WriteBlockToDisk(Block* b)
    TRACEF(Dump, "File::WriteToDisk() success set bit for block " <<  b->m_offset << " size " <<  size);
    int pfIdx =  (b->m_offset - m_offset)/m_cfi.GetBufferSize();
 
+   unsigned int cks = 0;
+   const bool   do_cks = Cache::GetInstance().RefConfiguration().m_block_cksum;
+   if (do_cks) cks = Info::CalcBlockCksum(&b->m_buff[0], size);
+
    bool schedule_sync = false;
    {
       XrdSysCondVarHelper _lck(m_downloadCond);
 
       m_cfi.SetBitWritten(pfIdx);
+      if (do_cks) m_cfi.SetBlockCksum(pfIdx, cks);
+      ClearBlockVerified(pfIdx);
 
       if (b->m_prefetch)
          m_cfi.SetBitPrefetch(pfIdx);
@@ -778,6 +1046,398 @@ void File::WriteBlockToDisk(Block* b)
    }
 }
 
+//==============================================================================
+// Write and helpers
+//==============================================================================
+
+void File::WaitBlockIdle(int i)
+{
+   // Must be called w/ block_map locked.
+   // Waits until block is written to disk and released by all readers.
+
+   BlockMap_i bi;
+   while ((bi = m_block_map.find(i)) != m_block_map.end())
+   {
+      if (bi->second->m_pinned)
+      {
+         // RAM tier copy is about to become stale
+         UnpinBlock(bi->second);
+         continue;
+      }
+      if (bi->second->is_failed() && bi->second->m_refcnt == 1)
+      {
+         TRACEF(Debug, "File::WaitBlockIdle remove failed block " << i);
+         free_block(bi->second);
+         break;
+      }
+      m_downloadCond.Wait();
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void File::AddDirtyRange(RangeMap_t& rm, long long off, long long end)
+{
+   // Insert range [off, end) merging it with overlapping or adjacent ones.
+
+   RangeMap_i ri = rm.upper_bound(off);
+   if (ri != rm.begin())
+   {
+      RangeMap_i pi = ri; --pi;
+      if (pi->second >= off)
+      {
+         off = pi->first;
+         end = std::max(end, pi->second);
+         rm.erase(pi);
+      }
+   }
+   while (ri != rm.end() && ri->first <= end)
+   {
+      end = std::max(end, ri->second);
+      rm.erase(ri++);
+   }
+   rm[off] = end;
+}
+
+//------------------------------------------------------------------------------
+
+int File::WriteToCache(const char* buff, long long off, int size, bool dirty)
+{
+   // Copy written data into cached blocks. A block not yet on disk can only be
+   // cached if the write covers all its bytes that exist on origin. In
+   // write-back mode (dirty) the missing part is fetched from origin first,
+   // otherwise the block is left to be downloaded on a later read.
+
+   const long long BS  = m_cfi.GetBufferSize();
+   const long long end = off + size;
+   const int idx_first = off / BS;
+   const int idx_last  = (end - 1) / BS;
+
+   std::map<int, std::vector<char> > fetched;
+
+   long long oldEnd;
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      oldEnd = m_offset + m_fileSize;
+   }
+
+   // Fetch existing data for partially written edge blocks.
+   if (dirty)
+   {
+      int edges[2] = { idx_first, idx_last };
+      for (int e = 0; e < 2; ++e)
+      {
+         const int       i      = edges[e];
+         const long long blkBeg = i * BS;
+         const long long oldBlk = std::min(blkBeg + BS, oldEnd);
+
+         if (fetched.count(i) || blkBeg >= oldBlk) continue;
+         if (off <= blkBeg && end >= oldBlk)       continue;
+
+         {
+            XrdSysCondVarHelper _lck(m_downloadCond);
+            if (m_cfi.TestBit(offsetIdx(i)) || m_block_map.find(i) != m_block_map.end()) continue;
+         }
+
+         std::vector<char> &b = fetched[i];
+         b.resize(oldBlk - blkBeg);
+         int rs = m_io->GetInput()->Read(&b[0], blkBeg, b.size());
+         if (rs != (int) b.size())
+         {
+            TRACEF(Error, "File::WriteToCache() failed to fetch block " << i << " from origin, ret=" << rs);
+            if (rs >= 0) errno = EIO;
+            return -1;
+         }
+      }
+   }
+
+   XrdSysCondVarHelper _lck(m_downloadCond);
+
+   if (end > m_offset + m_fileSize)
+   {
+      m_fileSize = end - m_offset;
+      m_cfi.ExtendFileSize(m_fileSize);
+   }
+
+   bool schedule_sync = false;
+
+   for (int i = idx_first; i <= idx_last; ++i)
+   {
+      WaitBlockIdle(i);
+
+      const long long blkBeg = i * BS;
+      const long long oldBlk = std::min(blkBeg + BS, oldEnd);
+      const long long wBeg   = std::max(off, blkBeg);
+      const long long wEnd   = std::min(end, blkBeg + BS);
+      const int       pfIdx  = offsetIdx(i);
+
+      const char *src  = buff + (wBeg - off);
+      long long   dOff = wBeg;
+      long long   dLen = wEnd - wBeg;
+
+      std::vector<char> merged;
+      if ( ! m_cfi.TestBit(pfIdx) && blkBeg < oldBlk && (wBeg > blkBeg || wEnd < oldBlk))
+      {
+         std::map<int, std::vector<char> >::iterator fi = fetched.find(i);
+         if (fi == fetched.end())
+         {
+            if (dirty)
+            {
+               // block download failed while we were waiting for it
+               TRACEF(Error, "File::WriteToCache() block " << i << " not available for merge");
+               errno = EIO;
+               return -1;
+            }
+            TRACEF(Dump, "File::WriteToCache() block " << i << " not cached, skipping");
+            continue;
+         }
+         merged.swap(fi->second);
+         if ((long long) merged.size() < wEnd - blkBeg) merged.resize(wEnd - blkBeg);
+         memcpy(&merged[wBeg - blkBeg], src, wEnd - wBeg);
+         src  = &merged[0];
+         dOff = blkBeg;
+         dLen = merged.size();
+      }
+
+      ssize_t ws = m_output->Write(src, dOff - m_offset, dLen);
+      if (ws != dLen)
+      {
+         TRACEF(Error, "File::WriteToCache() disk write failed for block " << i << ", ret=" << ws);
+         if ( ! dirty)
+         {
+            // Origin already has the new data, cached copies of this and
+            // the following blocks are stale now.
+            for (int j = i; j <= idx_last; ++j)
+            {
+               if (m_cfi.TestBit(offsetIdx(j))) m_cfi.ResetBit(offsetIdx(j));
+            }
+            if (m_prefetchState == kComplete)
+            {
+               m_prefetchState = kOn;
+               cache()->RegisterPrefetchFile(this);
+            }
+         }
+         if (ws < 0) errno = -ws;
+         else        errno = EIO;
+         return -1;
+      }
+
+      // Checksum is known only if the whole block was just written.
+      const long long blkLen = std::min(BS, m_offset + m_fileSize - blkBeg);
+      if (Cache::GetInstance().RefConfiguration().m_block_cksum && dOff == blkBeg && dLen == blkLen)
+         m_cfi.SetBlockCksum(pfIdx, Info::CalcBlockCksum(src, dLen));
+      else
+         m_cfi.ResetBlockCksum(pfIdx);
+      ClearBlockVerified(pfIdx);
+
+      m_cfi.SetBitWritten(pfIdx);
+      if (dirty)
+      {
+         m_cfi.SetBitDirty(pfIdx);
+         AddDirtyRange(m_dirty, wBeg, wEnd);
+      }
+
+      if (m_in_sync)
+      {
+         m_writes_during_sync.push_back(pfIdx);
+      }
+      else
+      {
+         m_cfi.SetBitSynced(pfIdx);
+         if (++m_non_flushed_cnt >= 100)
+         {
+            schedule_sync     = true;
+            m_in_sync         = true;
+            m_non_flushed_cnt = 0;
+         }
+      }
+   }
+
+   m_cfi.UpdateDownloadCompleteStatus();
+   m_stats.m_BytesWritten += size;
+
+   if (schedule_sync)
+   {
+      XrdPosixGlobals::schedP->Schedule(m_syncer);
+   }
+
+   return size;
+}
+
+//------------------------------------------------------------------------------
+
+int File::Write(char* iUserBuff, long long iUserOff, int iUserSize)
+{
+   const Configuration &conf = Cache::GetInstance().RefConfiguration();
+
+   if ( ! isOpen() || conf.m_write_mode == Configuration::kWriteOff)
+   {
+      return m_io->GetInput()->Write(iUserBuff, iUserOff, iUserSize);
+   }
+
+   if (iUserSize <= 0) return 0;
+
+   if (conf.m_write_mode == Configuration::kWriteThrough)
+   {
+      int retval = m_io->GetInput()->Write(iUserBuff, iUserOff, iUserSize);
+      if (retval > 0 && WriteToCache(iUserBuff, iUserOff, retval, false) < 0)
+      {
+         TRACEF(Error, "File::Write() failed to update cached blocks after write to origin");
+      }
+      return retval;
+   }
+
+   // write-back
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      if (m_upload_errno)
+      {
+         errno = m_upload_errno;
+         return -1;
+      }
+   }
+
+   if (WriteToCache(iUserBuff, iUserOff, iUserSize, true) < 0)
+      return -1;
+
+   if (m_output->Fsync() != XrdOssOK)
+   {
+      TRACEF(Error, "File::Write() fsync of data file failed");
+      errno = EIO;
+      return -1;
+   }
+
+   Journal *journal = cache()->GetJournal();
+   long long seq = journal->AddDirty(m_temp_filename, m_io->GetInput()->Path(), m_offset, iUserOff, iUserSize);
+   if (seq < 0)
+   {
+      TRACEF(Error, "File::Write() journal update failed");
+      return -1;
+   }
+
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+      if (seq > m_dirty_seq) m_dirty_seq = seq;
+   }
+
+   // Upload() marks the record clean, also if the range itself was taken
+   // by an upload already in progress.
+   cache()->ScheduleUpload(this);
+
+   return iUserSize;
+}
+
+//------------------------------------------------------------------------------
+
+bool File::UploadPending()
+{
+   // Must be called w/ m_downloadCond locked.
+
+   if (m_upload_errno) return false;
+
+   return ! m_dirty.empty() || m_dirty_seq > m_clean_seq || m_upload_in_progress;
+}
+
+//------------------------------------------------------------------------------
+
+void File::Upload()
+{
+   RangeMap_t      ranges;
+   XrdOucCacheIO2 *io;
+   long long       seq, prev_clean;
+
+   Journal *journal = cache()->GetJournal();
+
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+
+      if (m_upload_in_progress || ! UploadPending()) return;
+
+      if (time(0) < m_upload_retry) return;
+
+      // Data of every journal record up to m_dirty_seq was added to m_dirty
+      // before the record was written, so it is either in this snapshot or
+      // was uploaded already. Records written later are handled by the next
+      // upload, which is scheduled below.
+      seq        = m_dirty_seq;
+      prev_clean = m_clean_seq;
+      ranges.swap(m_dirty);
+      m_upload_in_progress = true;
+      io = m_io->GetInput();
+   }
+
+   TRACEF(Debug, "File::Upload() " << ranges.size() << " ranges");
+
+   std::vector<char> buf(BufferSize());
+   long long uploaded = 0;
+   bool ok = true;
+
+   for (RangeMap_i ri = ranges.begin(); ok && ri != ranges.end(); ++ri)
+   {
+      long long off = ri->first;
+      while (ok && off < ri->second)
+      {
+         long long n  = std::min((long long) buf.size(), ri->second - off);
+         ssize_t   rs = m_output->Read(&buf[0], off - m_offset, n);
+         ok = (rs == n) && (io->Write(&buf[0], off, n) == n);
+         if (ok) uploaded += n;
+         off += n;
+      }
+   }
+
+   int  err = (ok ? 0 : (errno ? errno : EIO));
+   bool again, gaveup = false;
+   {
+      XrdSysCondVarHelper _lck(m_downloadCond);
+
+      m_upload_in_progress = false;
+      m_stats.m_BytesUploaded += uploaded;
+
+      if (ok)
+      {
+         m_upload_fails = 0;
+         m_upload_retry = 0;
+         if (seq > m_clean_seq) m_clean_seq = seq;
+      }
+      else
+      {
+         for (RangeMap_i ri = ranges.begin(); ri != ranges.end(); ++ri)
+            AddDirtyRange(m_dirty, ri->first, ri->second);
+
+         // Back off exponentially; give up after kMaxUploadRetries attempts.
+         // The ranges are then handed to the cache on close, see ioActive().
+         if (++m_upload_fails >= kMaxUploadRetries)
+         {
+            m_upload_errno = err;
+            gaveup = true;
+         }
+         else
+         {
+            m_upload_retry = time(0) + (1 << m_upload_fails);
+         }
+      }
+
+      again = ok && UploadPending();
+      if (ok && m_dirty.empty()) m_cfi.ClearDirty();
+   }
+
+   if (gaveup)
+   {
+      TRACEF(Error, "File::Upload() upload to origin failed " << kMaxUploadRetries
+             << " times, giving up; errno=" << err);
+   }
+   else if ( ! ok)
+   {
+      // Retried from ioActive() or on next write after the backoff period.
+      TRACEF(Warning, "File::Upload() upload to origin failed, errno=" << err);
+   }
+   else
+   {
+      if (seq > prev_clean) journal->MarkClean(m_temp_filename, seq);
+      if (again) cache()->ScheduleUpload(this);
+   }
+}
+
 //------------------------------------------------------------------------------
 
 void File::Sync()
@@ -831,6 +1491,7 @@ void File::free_block(Block* b)
    int i = b->m_offset/BufferSize();
    TRACEF(Dump, "File::free_block block " << b << "  idx =  " <<  i);
    size_t ret = m_block_map.erase(i);
+   m_downloadCond.Broadcast();
    if (ret != 1)
    {
       // assert might be a better option than a warning
@@ -838,11 +1499,16 @@ void File::free_block(Block* b)
    }
    else
    {
+      if (b->m_direct)
+         cache()->DirectBlockReleased();
+      else if (b->m_hot)
+         cache()->HotBlockReleased();
+      else
+         cache()->RAMBlockReleased();
       delete b;
-      cache()->RAMBlockReleased();
    }
 
-   if (m_prefetchState == kHold && m_block_map.size() < Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
+   if (m_prefetchState == kHold && m_block_map.size() - m_hot_cnt < Cache::GetInstance().RefConfiguration().m_prefetch_max_blocks)
    {
       m_prefetchState = kOn;
       cache()->RegisterPrefetchFile(this);
@@ -856,7 +1522,13 @@ void File::ProcessBlockResponse(Block* b, int res)
    m_downloadCond.Lock();
 
    TRACEF(Dump, "File::ProcessBlockResponse " << (void*)b << "  " << b->m_offset/BufferSize());
-   if (res >= 0)
+   if (res >= 0 && b->m_direct)
+   {
+      b->m_downloaded = true;
+      // all readers might have given up already
+      if (b->m_refcnt == 0) free_block(b);
+   }
+   else if (res >= 0)
    {
       b->m_downloaded = true;
       TRACEF(Dump, "File::ProcessBlockResponse inc_ref_count " <<  (int)(b->m_offset/BufferSize()));
@@ -66,10 +66,13 @@ public:
    int                 m_refcnt;
    int                 m_errno;                         // stores negative errno
    bool                m_downloaded;
+   bool                m_direct;                        // shared by readers only, not written to disk
+   bool                m_hot;                           // copy of block on disk held in RAM tier
+   bool                m_pinned;                        // RAM tier holds a reference
 
-   Block(File *f, long long off, int size, bool m_prefetch) :
+   Block(File *f, long long off, int size, bool m_prefetch, bool direct = false) :
       m_offset(off), m_file(f), m_prefetch(m_prefetch), m_refcnt(0),
-      m_errno(0), m_downloaded(false)
+      m_errno(0), m_downloaded(false), m_direct(direct), m_hot(false), m_pinned(false)
    {
       m_buff.resize(size);
    }
@@ -145,6 +148,20 @@ public:
 
    int Read(char* buff, long long offset, int size);
 
+   //----------------------------------------------------------------------
+   //! \brief Write according to the configured write mode.
+   //!
+   //! In write-through mode data is written to origin and cached blocks are
+   //! updated. In write-back mode data is written to disk and the journal,
+   //! and uploaded to origin asynchronously.
+   //----------------------------------------------------------------------
+   int Write(char* buff, long long offset, int size);
+
+   //----------------------------------------------------------------------
+   //! Upload ranges written in write-back mode to origin.
+   //----------------------------------------------------------------------
+   void Upload();
+
    //----------------------------------------------------------------------
    //! \brief Data and cinfo files are open.
    //----------------------------------------------------------------------
@@ -184,6 +201,11 @@ public:
 
    void WakeUp(IO* io);
 
+   //----------------------------------------------------------------------
+   //! Decay block access counts and release RAM tier blocks no longer hot.
+   //----------------------------------------------------------------------
+   void AgeHotBlocks();
+
 
 private:
    enum PrefetchState_e { kOff=-1, kOn, kHold, kStopped, kComplete };
@@ -214,9 +236,29 @@ private:
    typedef std::map<int, Block*>  BlockMap_t;
    typedef BlockMap_t::iterator BlockMap_i;
 
+   typedef std::map<long long, long long> RangeMap_t;   // offset -> end
+   typedef RangeMap_t::iterator RangeMap_i;
+
 
    BlockMap_t m_block_map;
 
+   std::vector<bool> m_block_verified; //!< block checksums verified since open
+
+   // RAM tier
+   std::map<int, int> m_block_hits;    //!< recent accesses per block index
+   int                m_hot_cnt;       //!< pinned blocks in m_block_map
+
+   // write-back
+   RangeMap_t m_dirty;                 //!< ranges written locally, not yet uploaded
+   bool       m_upload_in_progress;
+   long long  m_dirty_seq;             //!< last journal record of this file
+   long long  m_clean_seq;             //!< last journal record marked clean
+   int        m_upload_fails;          //!< consecutive failed uploads
+   time_t     m_upload_retry;          //!< earliest time of next upload attempt
+   int        m_upload_errno;          //!< set when upload was given up
+
+   static const int kMaxUploadRetries = 5;   //!< fits in XrdPosixFile close retries
+
    XrdSysCondVar m_downloadCond;
 
    Stats m_stats;                   //!< cache statistics, used in IO detach
@@ -239,7 +281,7 @@ private:
                 long long &blk_off,    // offset in block
                 long long &size);
    // Read
-   Block* PrepareBlockRequest(int i, bool prefetch);
+   Block* PrepareBlockRequest(int i, bool prefetch, bool direct = false);
    
    void   ProcessBlockRequests(BlockList_t& blks);
 
@@ -249,17 +291,42 @@ private:
    int    ReadBlocksFromDisk(IntList_t& blocks,
                              char* req_buf, long long req_off, long long req_size);
 
+   int    ReadBlockFromDisk(int idx, char* buff, long long blk_off, long long size);
+
+   bool   BlockVerified(int i) const
+          { return i < (int) m_block_verified.size() && m_block_verified[i]; }
+   void   ClearBlockVerified(int i)
+          { if (i < (int) m_block_verified.size()) m_block_verified[i] = false; }
+
+   // RAM tier
+   void   CountBlockHit(int idx);
+   void   PromoteBlock(int idx, std::vector<char>& data);
+   void   UnpinBlock(Block* b);
+   void   UnpinAllBlocks();
+
    // VRead
    bool VReadValidate     (const XrdOucIOVec *readV, int n);
    bool VReadPreProcess   (const XrdOucIOVec *readV, int n,
                            ReadVBlockListRAM&  blks_to_process,
                            ReadVBlockListDisk& blks_on_disk,
+                           BlockList_t&        blks_to_request,
+                           std::vector<XrdOucIOVec>& chunkVec,
+                           long long& bytes_hit, long long& bytes_miss);
+   DirectResponseHandler*
+        VReadRequestRemote(BlockList_t& blks_to_request,
                            std::vector<XrdOucIOVec>& chunkVec);
    int  VReadFromDisk     (const XrdOucIOVec *readV, int n,
                            ReadVBlockListDisk& blks_on_disk);
    int  VReadProcessBlocks(const XrdOucIOVec *readV, int n,
                            std::vector<ReadVChunkListRAM>& blks_to_process,
-                           std::vector<ReadVChunkListRAM>& blks_rocessed);
+                           std::vector<ReadVChunkListRAM>& blks_rocessed,
+                           bool wait = true);
+
+   // Write
+   int    WriteToCache(const char* buff, long long off, int size, bool dirty);
+   void   WaitBlockIdle(int i);
+   void   AddDirtyRange(RangeMap_t& rm, long long off, long long end);
+   bool   UploadPending();
 
    long long BufferSize();
    void AppendIOStatToFileInfo();
@@ -34,9 +34,10 @@ using namespace XrdFileCache;
 //______________________________________________________________________________
 
 
-IOEntireFile::IOEntireFile(XrdOucCacheIO2 *io, XrdOucCacheStats &stats, Cache & cache)
+IOEntireFile::IOEntireFile(XrdOucCacheIO2 *io, XrdOucCacheStats &stats, Cache & cache, bool rw)
    : IO(io, stats, cache),
    m_file(0),
+   m_rw(rw),
    m_localStat(0)
 {
    XrdCl::URL url(GetInput()->Path());
@@ -107,7 +108,13 @@ int IOEntireFile::initCachedStat(const char* path)
       if (infoFile->Open(path, O_RDONLY, 0600, myEnv) == XrdOssOK)
       {
          Info info(m_cache.GetTrace());
-         if (info.Read(infoFile, path))
+         bool infoOK = info.Read(infoFile, path);
+         if (infoOK && m_rw && ! info.HasDirtyBlocks())
+         {
+            // file may have been truncated on open, origin size is authoritative
+            TRACEIO(Debug, "IOEntireFile::initCachedStat file open for update, using stat from origin");
+         }
+         else if (infoOK)
          {
             tmpStat.st_size = info.GetFileSize();
             TRACEIO(Info, "IOEntireFile::initCachedStat successfuly read size from info file = " << tmpStat.st_size);
@@ -217,3 +224,24 @@ int IOEntireFile::ReadV (const XrdOucIOVec *readV, int n)
    return m_file->ReadV(readV, n);
 }
 
+/*
+ * Perform a write through the cache
+ */
+int IOEntireFile::Write(char *buff, long long off, int size)
+{
+   TRACEIO(Dump, "IOEntireFile::Write() "<< this << " off: " << off << " size: " << size );
+
+   if (off < 0)
+   {
+      errno = EINVAL;
+      return -1;
+   }
+
+   int retval = m_file->Write(buff, off, size);
+
+   if (retval > 0 && m_localStat && off + retval > m_localStat->st_size)
+      m_localStat->st_size = off + retval;
+
+   return retval;
+}
+
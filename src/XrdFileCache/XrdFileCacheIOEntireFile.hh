@@ -43,7 +43,7 @@ public:
    //------------------------------------------------------------------------
    //! Constructor
    //------------------------------------------------------------------------
-   IOEntireFile(XrdOucCacheIO2 *io, XrdOucCacheStats &stats, Cache &cache);
+   IOEntireFile(XrdOucCacheIO2 *io, XrdOucCacheStats &stats, Cache &cache, bool rw = false);
 
    //------------------------------------------------------------------------
    //! Destructor
@@ -71,6 +71,17 @@ public:
    //---------------------------------------------------------------------
    virtual int ReadV(const XrdOucIOVec *readV, int n);
 
+   //---------------------------------------------------------------------
+   //! Pass Write request to the corresponding File object.
+   //!
+   //! @param Buffer
+   //! @param Offset
+   //! @param Length
+   //!
+   //! @return number of bytes written
+   //---------------------------------------------------------------------
+   virtual int Write(char *Buffer, long long Offset, int Length);
+
    //---------------------------------------------------------------------
    //! Detach itself from Cache. Note: this will delete the object.
    //!
@@ -90,6 +101,7 @@ public:
 
 private:
    File* m_file;
+   bool              m_rw;               //!< file is open for update
    struct stat      *m_localStat;
    int     initCachedStat(const char* path);
 };
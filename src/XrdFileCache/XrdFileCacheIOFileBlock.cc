@@ -261,6 +261,31 @@ bool IOFileBlock::ioActive()
    return active;
 }
 
+//______________________________________________________________________________
+File* IOFileBlock::locateBlockFile(int blockIdx, long long fileSize)
+{
+   XrdSysMutexHelper lock(&m_mutex);
+
+   std::map<int, File*>::iterator it = m_blocks.find(blockIdx);
+   if (it != m_blocks.end())
+   {
+      return it->second;
+   }
+
+   size_t pbs = m_blocksize;
+   // check if this is last block
+   int lastIOFileBlock = (fileSize-1)/m_blocksize;
+   if (blockIdx == lastIOFileBlock )
+   {
+      pbs = fileSize - blockIdx*m_blocksize;
+      // TRACEIO(Dump, "IOFileBlock::Read() last block, change output file size to " << pbs);
+   }
+
+   File *fb = newBlockFile(blockIdx*m_blocksize, pbs);
+   m_blocks.insert(std::pair<int,File*>(blockIdx, fb));
+   return fb;
+}
+
 //______________________________________________________________________________
 int IOFileBlock::Read(char *buff, long long off, int size)
 {
@@ -287,28 +312,7 @@ int IOFileBlock::Read(char *buff, long long off, int size)
    for (int blockIdx = idx_first; blockIdx <= idx_last; ++blockIdx )
    {
       // locate block
-      File* fb;
-      m_mutex.Lock();
-      std::map<int, File*>::iterator it = m_blocks.find(blockIdx);
-      if (it != m_blocks.end())
-      {
-         fb = it->second;
-      }
-      else
-      {
-         size_t pbs = m_blocksize;
-         // check if this is last block
-         int lastIOFileBlock = (fileSize-1)/m_blocksize;
-         if (blockIdx == lastIOFileBlock )
-         {
-            pbs = fileSize - blockIdx*m_blocksize;
-            // TRACEIO(Dump, "IOFileBlock::Read() last block, change output file size to " << pbs);
-         }
-
-         fb = newBlockFile(blockIdx*m_blocksize, pbs);
-         m_blocks.insert(std::pair<int,File*>(blockIdx, (File*) fb));
-      }
-      m_mutex.UnLock();
+      File* fb = locateBlockFile(blockIdx, fileSize);
 
       // edit size if read request is reaching more than a block
       int readBlockSize = size;
@@ -355,3 +359,49 @@ int IOFileBlock::Read(char *buff, long long off, int size)
 
    return bytes_read;
 }
+
+//______________________________________________________________________________
+int IOFileBlock::Write(char *buff, long long off, int size)
+{
+   // Block files have a fixed size, writes can not extend the file.
+
+   long long fileSize = FSize();
+
+   if (off < 0)
+   {
+      errno = EINVAL;
+      return -1;
+   }
+   if (off + size > fileSize)
+   {
+      TRACEIO(Warning, "IOFileBlock::Write() write past end of file not supported in block mode");
+      errno = ENOTSUP;
+      return -1;
+   }
+   if (size <= 0) return 0;
+
+   int idx_first = off/m_blocksize;
+   int idx_last  = (off + size - 1) / m_blocksize;
+   int bytes_written = 0;
+
+   for (int blockIdx = idx_first; blockIdx <= idx_last; ++blockIdx)
+   {
+      File* fb = locateBlockFile(blockIdx, fileSize);
+
+      int writeBlockSize = std::min((long long) size, (blockIdx + 1) * m_blocksize - off);
+
+      int retvalBlock = fb->Write(buff, off, writeBlockSize);
+      if (retvalBlock != writeBlockSize)
+      {
+         TRACEIO(Error, "IOFileBlock::Write() write error, retval" << retvalBlock);
+         return (retvalBlock < 0 && bytes_written == 0) ? retvalBlock : bytes_written + std::max(retvalBlock, 0);
+      }
+
+      bytes_written += retvalBlock;
+      buff += retvalBlock;
+      off  += retvalBlock;
+      size -= retvalBlock;
+   }
+
+   return bytes_written;
+}
@@ -60,6 +60,11 @@ public:
    //---------------------------------------------------------------------
    virtual int Read(char *Buffer, long long Offset, int Length);
 
+   //---------------------------------------------------------------------
+   //! Pass Write request to the corresponding File objects.
+   //---------------------------------------------------------------------
+   virtual int Write(char *Buffer, long long Offset, int Length);
+
    //! \brief Virtual method of XrdOucCacheIO.
    //! Called to check if destruction needs to be done in a separate task.
    virtual bool ioActive();
@@ -81,6 +86,7 @@ private:
    void GetBlockSizeFromPath();
    int initLocalStat();
    File* newBlockFile(long long off, int blocksize);
+   File* locateBlockFile(int blockIdx, long long fileSize);
    void  CloseInfoFile();
 };
 }
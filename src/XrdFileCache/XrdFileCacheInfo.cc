@@ -21,10 +21,14 @@
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <algorithm>
 
 #include "XrdOss/XrdOss.hh"
 #include "XrdCks/XrdCksCalcmd5.hh"
+#include "XrdOuc/XrdOucCRC.hh"
 #include "XrdOuc/XrdOucSxeq.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "XrdCl/XrdClLog.hh"
@@ -93,13 +97,64 @@ struct FpHelper
       return WriteRaw(&loc, sizeof(T));
    }
 };
+
+//------------------------------------------------------------------------------
+// Fixed layout of cinfo files since version 4. The header is followed by
+// sections at 8-byte aligned offsets: synced, dirty and cksummed bit-vectors,
+// array of per-block checksums and m_maxNumAccess slots of AStat records.
+// The whole file can be mmap'ed and is covered by the md5 in the header.
+//------------------------------------------------------------------------------
+struct HdrV4
+{
+   int       m_version;
+   int       m_hdrSize;
+   long long m_bufferSize;
+   long long m_fileSize;
+   long long m_creationTime;
+   long long m_accessCnt;
+   int       m_nBlocks;
+   int       m_nAStats;
+   long long m_secOff[5];
+   long long m_totSize;
+   char      m_cksum[16];
+};
+
+enum SecV4_e { kSynced = 0, kDirty, kCksummed, kCksums, kAStats };
+
+inline long long Align8(long long x) { return (x + 7) & ~7ll; }
+
+long long CalcLayoutV4(long long nBits, long long nAStats, long long *off)
+{
+   const long long nBytes = nBits ? (nBits - 1)/8 + 1 : 0;
+
+   off[kSynced]   = Align8(sizeof(HdrV4));
+   off[kDirty]    = Align8(off[kSynced]   + nBytes);
+   off[kCksummed] = Align8(off[kDirty]    + nBytes);
+   off[kCksums]   = Align8(off[kCksummed] + nBytes);
+   off[kAStats]   = Align8(off[kCksums]   + nBits * sizeof(unsigned int));
+
+   return off[kAStats] + nAStats * sizeof(XrdFileCache::Info::AStat);
+}
+
+void CksumV4(XrdCksCalc *calc, const char *buff, long long size, char *digest)
+{
+   // md5 of whole file with the header checksum field zeroed.
+   HdrV4 hdr;
+   memcpy(&hdr, buff, sizeof(HdrV4));
+   memset(hdr.m_cksum, 0, 16);
+
+   calc->Init();
+   calc->Update((const char*) &hdr, sizeof(HdrV4));
+   calc->Update(buff + sizeof(HdrV4), size - sizeof(HdrV4));
+   memcpy(digest, calc->Final(), 16);
+}
 }
 
 using namespace XrdFileCache;
 
 const char*  Info::m_infoExtension  = ".cinfo";
 const char*  Info::m_traceID        = "Cinfo";
-const int    Info::m_defaultVersion = 2;
+const int    Info::m_defaultVersion = 4;
 const size_t Info::m_maxNumAccess   = 20;
 
 //------------------------------------------------------------------------------
@@ -116,6 +171,9 @@ Info::Info(XrdOucTrace* trace, bool prefetchBuffer) :
 Info::~Info()
 {
    if (m_store.m_buff_synced) free(m_store.m_buff_synced);
+   if (m_store.m_buff_dirty) free(m_store.m_buff_dirty);
+   if (m_store.m_buff_cksummed) free(m_store.m_buff_cksummed);
+   if (m_store.m_blk_cksum) free(m_store.m_blk_cksum);
    if (m_buff_written) free(m_buff_written);
    if (m_buff_prefetch) free(m_buff_prefetch);
    delete m_cksCalc;
@@ -145,14 +203,21 @@ void Info::ResizeBits(int s)
    // drop buffer in case of failed/partial reads
 
    if (m_store.m_buff_synced) free(m_store.m_buff_synced);
+   if (m_store.m_buff_dirty) free(m_store.m_buff_dirty);
+   if (m_store.m_buff_cksummed) free(m_store.m_buff_cksummed);
+   if (m_store.m_blk_cksum) free(m_store.m_blk_cksum);
    if (m_buff_written) free(m_buff_written);
    if (m_buff_prefetch) free(m_buff_prefetch);
 
    m_sizeInBits = s;
    m_buff_written      = (unsigned char*) malloc(GetSizeInBytes());
    m_store.m_buff_synced = (unsigned char*) malloc(GetSizeInBytes());
+   m_store.m_buff_dirty  = (unsigned char*) malloc(GetSizeInBytes());
    memset(m_buff_written,      0, GetSizeInBytes());
    memset(m_store.m_buff_synced,       0, GetSizeInBytes());
+   memset(m_store.m_buff_dirty,        0, GetSizeInBytes());
+   m_store.m_buff_cksummed = (unsigned char*) calloc(GetSizeInBytes(), 1);
+   m_store.m_blk_cksum     = (unsigned int*)  calloc(m_sizeInBits, sizeof(unsigned int));
 
    if (m_hasPrefetchBuffer)
    {
@@ -161,6 +226,47 @@ void Info::ResizeBits(int s)
    }
 }
 
+//------------------------------------------------------------------------------
+
+unsigned char* Info::ReallocBits(unsigned char* buff, int oldSizeInBytes)
+{
+   unsigned char *nb = (unsigned char*) malloc(GetSizeInBytes());
+   memset(nb, 0, GetSizeInBytes());
+   if (buff)
+   {
+      memcpy(nb, buff, oldSizeInBytes);
+      free(buff);
+   }
+   return nb;
+}
+
+void Info::ExtendFileSize(long long fs)
+{
+   if (fs <= m_store.m_fileSize) return;
+
+   const int oldBytes = GetSizeInBytes();
+   const int oldBits  = m_sizeInBits;
+
+   m_store.m_fileSize = fs;
+   m_sizeInBits       = (fs - 1)/m_store.m_bufferSize + 1;
+
+   m_buff_written        = ReallocBits(m_buff_written,        oldBytes);
+   m_store.m_buff_synced = ReallocBits(m_store.m_buff_synced, oldBytes);
+   m_store.m_buff_dirty  = ReallocBits(m_store.m_buff_dirty,  oldBytes);
+   m_store.m_buff_cksummed = ReallocBits(m_store.m_buff_cksummed, oldBytes);
+
+   unsigned int *cks = (unsigned int*) calloc(m_sizeInBits, sizeof(unsigned int));
+   if (m_store.m_blk_cksum)
+   {
+      memcpy(cks, m_store.m_blk_cksum, oldBits * sizeof(unsigned int));
+      free(m_store.m_blk_cksum);
+   }
+   m_store.m_blk_cksum = cks;
+
+   if (m_hasPrefetchBuffer)
+      m_buff_prefetch    = ReallocBits(m_buff_prefetch,       oldBytes);
+}
+
 
 //------------------------------------------------------------------------------
 
@@ -183,7 +289,126 @@ bool Info::Read(XrdOssDF* fp, const std::string &fname)
    }
    else if (abs(m_store.m_version) == 1)
       return ReadV1(fp, fname);
+   else if (abs(m_store.m_version) <= 3)
+      return ReadV3(fp, fname);
+
+   return ReadV4(fp, fname);
+}
+
+//------------------------------------------------------------------------------
+
+bool Info::ReadV4(XrdOssDF* fp, const std::string &fname)
+{
+   std::string trace_pfx("Info:::ReadV4() ");
+   trace_pfx += fname + " ";
+
+   struct stat st;
+   if (fp->Fstat(&st) != XrdOssOK || st.st_size < (off_t) sizeof(HdrV4))
+   {
+      TRACE(Warning, trace_pfx << " file too short or stat failed");
+      return false;
+   }
+
+   // Map the whole file, fall back to a single read if the oss has no fd.
+   const long long   fsize = st.st_size;
+   void             *map   = MAP_FAILED;
+   std::vector<char> copy;
+   const char       *buff;
+
+   if (fp->getFD() >= 0)
+      map = mmap(0, fsize, PROT_READ, MAP_SHARED, fp->getFD(), 0);
+
+   if (map != MAP_FAILED)
+   {
+      buff = (const char*) map;
+   }
+   else
+   {
+      copy.resize(fsize);
+      if (fp->Read(&copy[0], 0, fsize) != fsize)
+      {
+         TRACE(Warning, trace_pfx << " oss read failed");
+         return false;
+      }
+      buff = &copy[0];
+   }
+
+   bool    ok = false;
+   HdrV4   hdr;
+   memcpy(&hdr, buff, sizeof(HdrV4));
+
+   // Validate the header before anything it describes is touched.
+   long long secOff[5];
+   bool      hdrOK = hdr.m_hdrSize == (int) sizeof(HdrV4) &&
+                     hdr.m_totSize >= (long long) sizeof(HdrV4) &&
+                     hdr.m_totSize <= fsize &&
+                     hdr.m_bufferSize > 0 && hdr.m_fileSize >= 0 &&
+                     hdr.m_nAStats >= 0 && hdr.m_nAStats <= (int) m_maxNumAccess &&
+                     hdr.m_nBlocks == (hdr.m_fileSize ? (hdr.m_fileSize - 1)/hdr.m_bufferSize + 1 : 0);
+   if (hdrOK)
+   {
+      hdrOK = hdr.m_totSize == CalcLayoutV4(hdr.m_nBlocks, m_maxNumAccess, secOff) &&
+              ! memcmp(hdr.m_secOff, secOff, sizeof(secOff));
+   }
+
+   if ( ! hdrOK)
+   {
+      TRACE(Error, trace_pfx << " inconsistent header");
+   }
+   else
+   {
+      if ( ! m_cksCalc) m_cksCalc = new XrdCksCalcmd5();
+      char tmpCksum[16];
+      CksumV4(m_cksCalc, buff, hdr.m_totSize, tmpCksum);
+
+      if (memcmp(hdr.m_cksum, tmpCksum, 16))
+      {
+         TRACE(Error, trace_pfx << " buffer cksum and saved cksum don't match");
+      }
+      else
+      {
+         m_store.m_version    = hdr.m_version;
+         m_store.m_bufferSize = hdr.m_bufferSize;
+         SetFileSize(hdr.m_fileSize);
+
+         long long off[5];
+         LayoutV4(off);
+
+         memcpy(m_store.m_buff_synced,   buff + off[kSynced],    GetSizeInBytes());
+         memcpy(m_store.m_buff_dirty,    buff + off[kDirty],     GetSizeInBytes());
+         memcpy(m_store.m_buff_cksummed, buff + off[kCksummed],  GetSizeInBytes());
+         memcpy(m_store.m_blk_cksum,     buff + off[kCksums],    m_sizeInBits * sizeof(unsigned int));
+         memcpy(m_buff_written, m_store.m_buff_synced, GetSizeInBytes());
+         memcpy(m_store.m_cksum, hdr.m_cksum, 16);
+
+         m_store.m_creationTime = hdr.m_creationTime;
+         m_store.m_accessCnt    = hdr.m_accessCnt;
+
+         int vs = std::min(hdr.m_nAStats, (int) m_maxNumAccess);
+         m_store.m_astats.resize(vs);
+         if (vs) memcpy(&m_store.m_astats[0], buff + off[kAStats], vs * sizeof(AStat));
+
+         m_complete = ! IsAnythingEmptyInRng(0, m_sizeInBits);
+         TRACE(Dump, trace_pfx << " complete "<< m_complete << " access_cnt " << m_store.m_accessCnt);
+         ok = true;
+      }
+   }
+
+   if (map != MAP_FAILED) munmap(map, fsize);
+
+   return ok;
+}
+
+//------------------------------------------------------------------------------
+
+bool Info::ReadV3(XrdOssDF* fp, const std::string &fname)
+{
+   std::string trace_pfx("Info:::ReadV3() ");
+   trace_pfx += fname + " ";
 
+   FpHelper r(fp, 0, m_trace, m_traceID, trace_pfx + "oss read failed");
+
+   if (r.Read(m_store.m_version)) return false;
    if (r.Read(m_store.m_bufferSize)) return false;
 
    long long fs;
@@ -193,10 +418,17 @@ bool Info::Read(XrdOssDF* fp, const std::string &fname)
    if (r.ReadRaw(m_store.m_buff_synced, GetSizeInBytes())) return false;
    memcpy(m_buff_written, m_store.m_buff_synced, GetSizeInBytes());
 
+   // dirty state was added in version 3
+   unsigned char *dirty = 0;
+   if (abs(m_store.m_version) >= 3)
+   {
+      if (r.ReadRaw(m_store.m_buff_dirty, GetSizeInBytes())) return false;
+      dirty = &m_store.m_buff_dirty[0];
+   }
 
    if (r.ReadRaw(m_store.m_cksum, 16)) return false;
    char tmpCksum[16];
-   GetCksum(&m_store.m_buff_synced[0], &tmpCksum[0]);
+   GetCksum(&m_store.m_buff_synced[0], &tmpCksum[0], dirty);
 
    /*
       // debug print cksum
@@ -292,7 +524,13 @@ bool Info::ReadV1(XrdOssDF* fp, const std::string &fname)
 }
 
 //------------------------------------------------------------------------------
-void Info::GetCksum( unsigned char* buff, char* digest)
+unsigned int Info::CalcBlockCksum(const char* buff, long long size)
+{
+   return XrdOucCRC::CRC32((const unsigned char*) buff, size);
+}
+
+//------------------------------------------------------------------------------
+void Info::GetCksum( unsigned char* buff, char* digest, unsigned char* buff2)
 {
    if (m_cksCalc)
       m_cksCalc->Init();
@@ -300,6 +538,7 @@ void Info::GetCksum( unsigned char* buff, char* digest)
       m_cksCalc = new XrdCksCalcmd5();
 
    m_cksCalc->Update((const char*)buff, GetSizeInBytes());
+   if (buff2) m_cksCalc->Update((const char*)buff2, GetSizeInBytes());
    memcpy(digest, m_cksCalc->Final(), 16);
 }
 
@@ -311,6 +550,13 @@ void Info::DisableDownloadStatus()
 }
 //------------------------------------------------------------------------------
 
+long long Info::LayoutV4(long long* off) const
+{
+   return CalcLayoutV4(m_sizeInBits, m_maxNumAccess, off);
+}
+
+//------------------------------------------------------------------------------
+
 bool Info::Write(XrdOssDF* fp, const std::string &fname)
 {
    std::string trace_pfx("Info:::Write() ");
@@ -322,24 +568,47 @@ bool Info::Write(XrdOssDF* fp, const std::string &fname)
       return false;
    }
 
-   FpHelper w(fp, 0, m_trace, m_traceID, trace_pfx + "oss write failed");
-
+   // Assemble the image in memory and store it with a single write.
    m_store.m_version = m_defaultVersion;
-   if (w.Write(m_store.m_version)) return false;
-   if (w.Write(m_store.m_bufferSize)) return false;
-   if (w.Write(m_store.m_fileSize)) return false;
-
-   if (w.WriteRaw(m_store.m_buff_synced, GetSizeInBytes())) return false;
-
-   GetCksum(&m_store.m_buff_synced[0], &m_store.m_cksum[0]);
-   if (w.Write(m_store.m_cksum)) return false;
-
-   if (w.Write(m_store.m_creationTime)) return false;
 
-   if (w.Write(m_store.m_accessCnt)) return false;
-   for (std::vector<AStat>::iterator it = m_store.m_astats.begin(); it != m_store.m_astats.end(); ++it)
+   HdrV4 hdr;
+   memset(&hdr, 0, sizeof(HdrV4));
+   hdr.m_version      = m_store.m_version;
+   hdr.m_hdrSize      = sizeof(HdrV4);
+   hdr.m_bufferSize   = m_store.m_bufferSize;
+   hdr.m_fileSize     = m_store.m_fileSize;
+   hdr.m_creationTime = m_store.m_creationTime;
+   hdr.m_accessCnt    = m_store.m_accessCnt;
+   hdr.m_nBlocks      = m_sizeInBits;
+   hdr.m_nAStats      = std::min(m_store.m_astats.size(), m_maxNumAccess);
+   hdr.m_totSize      = LayoutV4(hdr.m_secOff);
+
+   std::vector<char> buff(hdr.m_totSize, 0);
+   memcpy(&buff[hdr.m_secOff[kSynced]],   m_store.m_buff_synced,   GetSizeInBytes());
+   memcpy(&buff[hdr.m_secOff[kDirty]],    m_store.m_buff_dirty,    GetSizeInBytes());
+   memcpy(&buff[hdr.m_secOff[kCksummed]], m_store.m_buff_cksummed, GetSizeInBytes());
+   if (m_sizeInBits)
+      memcpy(&buff[hdr.m_secOff[kCksums]], m_store.m_blk_cksum, m_sizeInBits * sizeof(unsigned int));
+   if (hdr.m_nAStats)
+      memcpy(&buff[hdr.m_secOff[kAStats]], &m_store.m_astats[0], hdr.m_nAStats * sizeof(AStat));
+   memcpy(&buff[0], &hdr, sizeof(HdrV4));
+
+   if ( ! m_cksCalc) m_cksCalc = new XrdCksCalcmd5();
+   CksumV4(m_cksCalc, &buff[0], buff.size(), m_store.m_cksum);
+   memcpy(&buff[offsetof(HdrV4, m_cksum)], m_store.m_cksum, 16);
+
+   bool ok = true;
+   FpHelper w(fp, 0, m_trace, m_traceID, trace_pfx + "oss write failed");
+   if (w.WriteRaw(&buff[0], buff.size()))
+   {
+      ok = false;
+   }
+   else
    {
-      if (w.WriteRaw(&(*it), sizeof(AStat))) return false;
+      // Files converted from older versions can be longer.
+      struct stat st;
+      if (fp->Fstat(&st) == XrdOssOK && st.st_size > (off_t) buff.size())
+         fp->Ftruncate(buff.size());
    }
 
    // Can this really fail?
@@ -348,7 +617,7 @@ bool Info::Write(XrdOssDF* fp, const std::string &fname)
       TRACE(Error, trace_pfx << "un-lock failed");
    }
 
-   return true;
+   return ok;
 }
 
 //------------------------------------------------------------------------------
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <assert.h>
+#include <string.h>
 #include <vector>
 
 #include "XrdSys/XrdSysPthread.hh"
@@ -64,12 +65,16 @@ public:
       long long          m_bufferSize;             //!< prefetch buffer size
       long long          m_fileSize;               //!< number of file blocks
       unsigned char     *m_buff_synced;            //!< disk written state vector
+      unsigned char     *m_buff_dirty;             //!< blocks written locally, not yet uploaded to origin
+      unsigned char     *m_buff_cksummed;          //!< blocks with a valid entry in m_blk_cksum
+      unsigned int      *m_blk_cksum;              //!< crc32 of each block as written to disk
       char               m_cksum[16];              //!< cksum of downloaded information
       time_t             m_creationTime;           //!< time the info file was created
       size_t             m_accessCnt;              //!< number of written AStat structs
       std::vector<AStat> m_astats;                 //!< number of last m_maxAcessCnts
 
-      Store () : m_version(1), m_bufferSize(-1), m_fileSize(0), m_buff_synced(0),m_creationTime(0), m_accessCnt(0) {}
+      Store () : m_version(1), m_bufferSize(-1), m_fileSize(0), m_buff_synced(0), m_buff_dirty(0),
+                 m_buff_cksummed(0), m_blk_cksum(0), m_creationTime(0), m_accessCnt(0) {}
    };
 
 
@@ -103,10 +108,58 @@ public:
    //---------------------------------------------------------------------
    void SetBitPrefetch(int i);
 
+   //! \brief Mark block as modified locally and pending upload to origin
+   //!
+   //! @param i block index
+   //---------------------------------------------------------------------
+   void SetBitDirty(int i);
+
+   //---------------------------------------------------------------------
+   //! Clear all dirty bits, called when all local writes reached origin
+   //---------------------------------------------------------------------
+   void ClearDirty();
+
+   //---------------------------------------------------------------------
+   //! \brief Store checksum of block data as written to disk
+   //!
+   //! @param i    block index
+   //! @param cks  checksum, see CalcBlockCksum()
+   //---------------------------------------------------------------------
+   void SetBlockCksum(int i, unsigned int cks);
+
+   //---------------------------------------------------------------------
+   //! Forget checksum of a block, e.g. after a partial overwrite
+   //---------------------------------------------------------------------
+   void ResetBlockCksum(int i);
+
+   //---------------------------------------------------------------------
+   //! \brief Get checksum of a block
+   //!
+   //! @return false if the block has no valid checksum
+   //---------------------------------------------------------------------
+   bool GetBlockCksum(int i, unsigned int &cks) const;
+
+   //---------------------------------------------------------------------
+   //! Mark block as not downloaded, used when its data is found corrupt
+   //---------------------------------------------------------------------
+   void ResetBit(int i);
+
+   //---------------------------------------------------------------------
+   //! Checksum used for block data
+   //---------------------------------------------------------------------
+   static unsigned int CalcBlockCksum(const char* buff, long long size);
+
    void SetBufferSize(long long);
    
    void SetFileSize(long long);
 
+   //---------------------------------------------------------------------
+   //! \brief Grow file size keeping the state of existing blocks
+   //!
+   //! @param fs new file size, ignored if not larger than current one
+   //---------------------------------------------------------------------
+   void ExtendFileSize(long long fs);
+
    //---------------------------------------------------------------------
    //! \brief Reserve buffer for fileSize/bufferSize bytes
    //!
@@ -185,11 +238,26 @@ public:
    //---------------------------------------------------------------------
    bool TestPrefetchBit(int i) const;
 
+   //---------------------------------------------------------------------
+   //! Test if block at the given index has not been uploaded to origin
+   //---------------------------------------------------------------------
+   bool TestDirtyBit(int i) const;
+
+   //---------------------------------------------------------------------
+   //! Check if any block is waiting to be uploaded to origin
+   //---------------------------------------------------------------------
+   bool HasDirtyBlocks() const;
+
    //---------------------------------------------------------------------
    //! Get complete status
    //---------------------------------------------------------------------
    bool IsComplete() const;
 
+   //---------------------------------------------------------------------
+   //! Get number of blocks with a valid checksum
+   //---------------------------------------------------------------------
+   int GetNCksummedBlocks() const;
+
    //---------------------------------------------------------------------
    //! Get number of downloaded blocks
    //---------------------------------------------------------------------
@@ -221,9 +289,9 @@ public:
    const Store& RefStoredData() const { return m_store; }
 
    //---------------------------------------------------------------------
-   //! Get md5 cksum
+   //! Get md5 cksum, optionally continued over a second bit-vector
    //---------------------------------------------------------------------
-   void GetCksum( unsigned char* buff, char* digest);
+   void GetCksum( unsigned char* buff, char* digest, unsigned char* buff2 = 0);
 
    const static char*   m_infoExtension;
    const static char*   m_traceID;
@@ -248,8 +316,14 @@ protected:
 private:
    inline unsigned char cfiBIT(int n) const { return 1 << n; }
 
-   // split reading for V1
+   unsigned char* ReallocBits(unsigned char* buff, int oldSizeInBytes);
+
+   // split reading for V1, V2/V3 and the fixed layout used since V4
    bool ReadV1(XrdOssDF* fp, const std::string &fname);
+   bool ReadV3(XrdOssDF* fp, const std::string &fname);
+   bool ReadV4(XrdOssDF* fp, const std::string &fname);
+
+   long long LayoutV4(long long* offsets) const;
    XrdCksCalc*   m_cksCalc;
 };
 
@@ -274,6 +348,51 @@ inline bool Info::TestPrefetchBit(int i) const
    return (m_buff_prefetch[cn] & cfiBIT(off)) == cfiBIT(off);
 }
 
+inline bool Info::TestDirtyBit(int i) const
+{
+   if (!m_store.m_buff_dirty) return false;
+
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   return (m_store.m_buff_dirty[cn] & cfiBIT(off)) == cfiBIT(off);
+}
+
+inline bool Info::HasDirtyBlocks() const
+{
+   if (!m_store.m_buff_dirty) return false;
+
+   for (int i = 0; i < GetSizeInBytes(); ++i)
+      if (m_store.m_buff_dirty[i]) return true;
+
+   return false;
+}
+
+inline bool Info::GetBlockCksum(int i, unsigned int &cks) const
+{
+   if (!m_store.m_buff_cksummed) return false;
+
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   if ((m_store.m_buff_cksummed[cn] & cfiBIT(off)) != cfiBIT(off)) return false;
+
+   cks = m_store.m_blk_cksum[i];
+   return true;
+}
+
+inline int Info::GetNCksummedBlocks() const
+{
+   int cnt = 0;
+   unsigned int cks;
+   for (int i = 0; i < m_sizeInBits; ++i)
+      if (GetBlockCksum(i, cks)) cnt++;
+
+   return cnt;
+}
+
 inline int Info::GetNDownloadedBlocks() const
 {
    int cntd = 0;
@@ -355,6 +474,52 @@ inline void Info::SetBitPrefetch(int i)
    m_buff_prefetch[cn] |= cfiBIT(off);
 }
 
+inline void Info::SetBitDirty(int i)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   m_store.m_buff_dirty[cn] |= cfiBIT(off);
+}
+
+inline void Info::ClearDirty()
+{
+   if (m_store.m_buff_dirty) memset(m_store.m_buff_dirty, 0, GetSizeInBytes());
+}
+
+inline void Info::SetBlockCksum(int i, unsigned int cks)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   m_store.m_buff_cksummed[cn] |= cfiBIT(off);
+   m_store.m_blk_cksum[i] = cks;
+}
+
+inline void Info::ResetBlockCksum(int i)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   m_store.m_buff_cksummed[cn] &= ~cfiBIT(off);
+   m_store.m_blk_cksum[i] = 0;
+}
+
+inline void Info::ResetBit(int i)
+{
+   const int cn = i/8;
+   assert(cn < GetSizeInBytes());
+
+   const int off = i - cn*8;
+   m_buff_written[cn]        &= ~cfiBIT(off);
+   m_store.m_buff_synced[cn] &= ~cfiBIT(off);
+   if (m_buff_prefetch) m_buff_prefetch[cn] &= ~cfiBIT(off);
+   ResetBlockCksum(i);
+   m_complete = false;
+}
 
 inline long long Info::GetBufferSize() const
 {
@@ -0,0 +1,259 @@
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by Board of Trustees of the Leland Stanford, Jr., University
+// Author: Alja Mrak-Tadel, Matevz Tadel
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "XrdOss/XrdOss.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdOuc/XrdOucTrace.hh"
+
+#include "XrdFileCacheJournal.hh"
+#include "XrdFileCacheTrace.hh"
+
+using namespace XrdFileCache;
+
+const char *Journal::m_traceID = "Journal";
+const int   Journal::m_magic   = 0x70666a31; // "pfj1"
+
+//------------------------------------------------------------------------------
+
+Journal::Journal(XrdOucTrace* trace) :
+   m_trace(trace),
+   m_fp(0),
+   m_woff(0),
+   m_seq(0)
+{}
+
+Journal::~Journal()
+{
+   if (m_fp)
+   {
+      m_fp->Close();
+      delete m_fp;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+bool Journal::Open(XrdOss* oss, const std::string &path, const char* user,
+                   const char* space, PendingMap_t &pending)
+{
+   XrdOucEnv myEnv;
+   myEnv.Put("oss.cgroup", space);
+
+   m_path = path;
+
+   if (oss->Create(user, path.c_str(), 0600, myEnv, XRDOSS_mkpath) != XrdOssOK)
+   {
+      TRACE(Error, "Journal::Open() Create failed for " << path << ", err=" << strerror(errno));
+      return false;
+   }
+
+   m_fp = oss->newFile(user);
+   if (m_fp->Open(path.c_str(), O_RDWR, 0600, myEnv) != XrdOssOK)
+   {
+      TRACE(Error, "Journal::Open() Open failed for " << path << ", err=" << strerror(errno));
+      delete m_fp; m_fp = 0;
+      return false;
+   }
+
+   Replay(pending);
+
+   return Compact(pending);
+}
+
+//------------------------------------------------------------------------------
+
+bool Journal::Replay(PendingMap_t &pending)
+{
+   // Read records until the end of file or the first incomplete record,
+   // which can be left over by a crash in the middle of Append().
+
+   long long off = 0;
+   int       nrec = 0;
+   RecHdr    hdr;
+   std::vector<char> buf;
+
+   while (m_fp->Read(&hdr, off, sizeof(RecHdr)) == (ssize_t) sizeof(RecHdr))
+   {
+      if (hdr.m_magic != m_magic || hdr.m_lpathLen <= 0 || hdr.m_urlLen < 0 ||
+          hdr.m_lpathLen > 4096 || hdr.m_urlLen > 4096)
+      {
+         TRACE(Warning, "Journal::Replay() bad record at offset " << off << ", ignoring the rest");
+         break;
+      }
+
+      off += sizeof(RecHdr);
+      buf.resize(hdr.m_lpathLen + hdr.m_urlLen);
+      if (m_fp->Read(&buf[0], off, buf.size()) != (ssize_t) buf.size())
+      {
+         TRACE(Warning, "Journal::Replay() incomplete record at offset " << off);
+         break;
+      }
+      off += buf.size();
+      ++nrec;
+
+      std::string lpath(&buf[0], hdr.m_lpathLen);
+      if (hdr.m_seq > m_seq) m_seq = hdr.m_seq;
+
+      if (hdr.m_type == kDirty)
+      {
+         Pending &p = pending[lpath];
+         p.m_url.assign(&buf[hdr.m_lpathLen], hdr.m_urlLen);
+         p.m_base = hdr.m_base;
+         p.m_ranges.push_back(Range(hdr.m_seq, hdr.m_off, hdr.m_size));
+      }
+      else if (hdr.m_type == kClean)
+      {
+         PendingMap_i pi = pending.find(lpath);
+         if (pi == pending.end()) continue;
+
+         std::vector<Range> &r = pi->second.m_ranges;
+         std::vector<Range> left;
+         for (std::vector<Range>::iterator i = r.begin(); i != r.end(); ++i)
+         {
+            if (i->m_seq > hdr.m_seq) left.push_back(*i);
+         }
+         r.swap(left);
+         if (r.empty()) pending.erase(pi);
+      }
+   }
+
+   TRACE(Info, "Journal::Replay() read " << nrec << " records, " << pending.size() << " files with pending uploads");
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool Journal::Compact(PendingMap_t &pending)
+{
+   // Rewrite journal so that it only contains the pending records.
+
+   XrdSysMutexHelper _lck(&m_mutex);
+
+   if (m_fp->Ftruncate(0) != XrdOssOK)
+   {
+      TRACE(Error, "Journal::Compact() truncate failed for " << m_path);
+      return false;
+   }
+   m_woff = 0;
+   m_active.clear();
+
+   for (PendingMap_i pi = pending.begin(); pi != pending.end(); ++pi)
+   {
+      std::vector<Range> &r = pi->second.m_ranges;
+      for (std::vector<Range>::iterator i = r.begin(); i != r.end(); ++i)
+      {
+         if ( ! Append(kDirty, i->m_seq, pi->first, pi->second.m_url, pi->second.m_base, i->m_off, i->m_size))
+            return false;
+         m_active[pi->first] = i->m_seq;
+      }
+   }
+
+   return m_fp->Fsync() == XrdOssOK;
+}
+
+//------------------------------------------------------------------------------
+
+bool Journal::Append(int type, long long seq, const std::string &lpath,
+                     const std::string &url, long long base, long long off, long long size)
+{
+   // Must be called with m_mutex locked.
+
+   RecHdr hdr;
+   memset(&hdr, 0, sizeof(RecHdr));
+   hdr.m_magic    = m_magic;
+   hdr.m_type     = type;
+   hdr.m_seq      = seq;
+   hdr.m_base     = base;
+   hdr.m_off      = off;
+   hdr.m_size     = size;
+   hdr.m_lpathLen = lpath.size();
+   hdr.m_urlLen   = url.size();
+
+   std::vector<char> buf(sizeof(RecHdr) + lpath.size() + url.size());
+   memcpy(&buf[0], &hdr, sizeof(RecHdr));
+   memcpy(&buf[sizeof(RecHdr)], lpath.data(), lpath.size());
+   if ( ! url.empty()) memcpy(&buf[sizeof(RecHdr) + lpath.size()], url.data(), url.size());
+
+   ssize_t ret = m_fp->Write(&buf[0], m_woff, buf.size());
+   if (ret != (ssize_t) buf.size())
+   {
+      TRACE(Error, "Journal::Append() write failed for " << lpath << " ret=" << ret);
+      return false;
+   }
+   m_woff += ret;
+   return true;
+}
+
+//------------------------------------------------------------------------------
+
+long long Journal::AddDirty(const std::string &lpath, const std::string &url,
+                            long long base, long long off, long long size)
+{
+   XrdSysMutexHelper _lck(&m_mutex);
+
+   long long seq = ++m_seq;
+   if ( ! Append(kDirty, seq, lpath, url, base, off, size) || m_fp->Fsync() != XrdOssOK)
+   {
+      errno = EIO;
+      return -1;
+   }
+
+   m_active[lpath] = seq;
+   return seq;
+}
+
+//------------------------------------------------------------------------------
+
+bool Journal::MarkClean(const std::string &lpath, long long seq)
+{
+   XrdSysMutexHelper _lck(&m_mutex);
+
+   std::map<std::string, long long>::iterator ai = m_active.find(lpath);
+   if (ai == m_active.end()) return true;
+
+   if (seq >= ai->second) m_active.erase(ai);
+
+   // Nothing pending any more, start from an empty journal.
+   if (m_active.empty())
+   {
+      TRACE(Debug, "Journal::MarkClean() no pending uploads, truncating journal");
+      if (m_fp->Ftruncate(0) == XrdOssOK)
+      {
+         m_woff = 0;
+         return m_fp->Fsync() == XrdOssOK;
+      }
+   }
+
+   if ( ! Append(kClean, seq, lpath, std::string(), 0, 0, 0))
+      return false;
+
+   return m_fp->Fsync() == XrdOssOK;
+}
+
+//------------------------------------------------------------------------------
+
+long long Journal::LastSeq()
+{
+   XrdSysMutexHelper _lck(&m_mutex);
+   return m_seq;
+}
@@ -0,0 +1,146 @@
+#ifndef __XRDFILECACHE_JOURNAL_HH__
+#define __XRDFILECACHE_JOURNAL_HH__
+//----------------------------------------------------------------------------------
+// Copyright (c) 2026 by Board of Trustees of the Leland Stanford, Jr., University
+// Author: Alja Mrak-Tadel, Matevz Tadel
+//----------------------------------------------------------------------------------
+// XRootD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// XRootD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with XRootD.  If not, see <http://www.gnu.org/licenses/>.
+//----------------------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdOss;
+class XrdOssDF;
+class XrdOucTrace;
+
+namespace XrdFileCache
+{
+//----------------------------------------------------------------------------
+//! \brief Durable log of locally written ranges not yet uploaded to origin.
+//!
+//! Used in write-back mode. Every client write is recorded, and synced,
+//! before it is acknowledged. A clean record for a file cancels all earlier
+//! records for the same file with lower or equal sequence number. Pending
+//! records are replayed on startup so interrupted uploads can be resumed.
+//----------------------------------------------------------------------------
+class Journal
+{
+public:
+   struct Range
+   {
+      long long m_seq;       //!< sequence number of the record
+      long long m_off;       //!< offset in the origin file
+      long long m_size;      //!< size of the written range
+
+      Range(long long seq, long long off, long long size) :
+         m_seq(seq), m_off(off), m_size(size) {}
+   };
+
+   struct Pending
+   {
+      std::string        m_url;     //!< origin URL the ranges belong to
+      long long          m_base;    //!< origin offset of local file start (block mode)
+      std::vector<Range> m_ranges;  //!< ranges still to be uploaded
+
+      Pending() : m_base(0) {}
+   };
+
+   typedef std::map<std::string, Pending> PendingMap_t;
+   typedef PendingMap_t::iterator         PendingMap_i;
+
+   //------------------------------------------------------------------------
+   //! Constructor.
+   //------------------------------------------------------------------------
+   Journal(XrdOucTrace* trace);
+
+   //------------------------------------------------------------------------
+   //! Destructor.
+   //------------------------------------------------------------------------
+   ~Journal();
+
+   //---------------------------------------------------------------------
+   //! \brief Open or create the journal and replay existing records
+   //!
+   //! @param oss      oss used by the cache
+   //! @param path     journal path in the oss namespace
+   //! @param user     oss user name
+   //! @param space    oss space the journal is placed in
+   //! @param pending  output, files with ranges not yet uploaded
+   //!
+   //! @return true on success
+   //---------------------------------------------------------------------
+   bool Open(XrdOss* oss, const std::string &path, const char* user,
+             const char* space, PendingMap_t &pending);
+
+   //---------------------------------------------------------------------
+   //! \brief Durably record a locally written range
+   //!
+   //! @return sequence number of the record, negative on error
+   //---------------------------------------------------------------------
+   long long AddDirty(const std::string &lpath, const std::string &url,
+                      long long base, long long off, long long size);
+
+   //---------------------------------------------------------------------
+   //! \brief Record that all ranges of lpath up to seq reached origin
+   //!
+   //! @return true on success
+   //---------------------------------------------------------------------
+   bool MarkClean(const std::string &lpath, long long seq);
+
+   //---------------------------------------------------------------------
+   //! Sequence number of the last record written
+   //---------------------------------------------------------------------
+   long long LastSeq();
+
+   XrdOucTrace* GetTrace() const { return m_trace; }
+
+private:
+   enum RecType_e { kDirty = 1, kClean = 2 };
+
+   struct RecHdr
+   {
+      int       m_magic;
+      int       m_type;
+      long long m_seq;
+      long long m_base;
+      long long m_off;
+      long long m_size;
+      int       m_lpathLen;
+      int       m_urlLen;
+   };
+
+   bool Append(int type, long long seq, const std::string &lpath,
+               const std::string &url, long long base, long long off, long long size);
+   bool Replay(PendingMap_t &pending);
+   bool Compact(PendingMap_t &pending);
+
+   XrdOucTrace   *m_trace;
+   XrdOssDF      *m_fp;
+   std::string    m_path;
+   XrdSysMutex    m_mutex;
+   long long      m_woff;                        //!< current end of journal
+   long long      m_seq;                         //!< last used sequence number
+
+   std::map<std::string, long long> m_active;    //!< lpath -> last dirty seq
+
+   static const char *m_traceID;
+   static const int   m_magic;
+};
+}
+
+#endif
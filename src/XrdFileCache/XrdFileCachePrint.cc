@@ -19,6 +19,7 @@
 #include <iostream>
 #include <fcntl.h>
 #include <vector>
+#include <algorithm>
 #include "XrdFileCachePrint.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucStream.hh"
@@ -31,7 +32,8 @@
 
 using namespace XrdFileCache;
 
-Print::Print(XrdOss* oss, bool v, const char* path) : m_oss(oss), m_verbose(v), m_ossUser("nobody")
+Print::Print(XrdOss* oss, bool v, const char* path, bool convert) :
+   m_oss(oss), m_verbose(v), m_convert(convert), m_ossUser("nobody")
 {
    if (isInfoFile(path))
    {
@@ -62,7 +64,7 @@ void Print::printFile(const std::string& path)
 {
    printf("printing %s ...\n", path.c_str());
    XrdOssDF* fh = m_oss->newFile(m_ossUser);
-   fh->Open((path).c_str(),O_RDONLY, 0600, m_env);
+   fh->Open((path).c_str(), m_convert ? O_RDWR : O_RDONLY, 0600, m_env);
 
    XrdSysLogger log;
    XrdSysError err(&log);
@@ -74,10 +76,17 @@ void Print::printFile(const std::string& path)
       return;
    }
 
+   if (m_convert && ! convertFile(fh, cfi, path))
+   {
+      printf("conversion of %s failed\n", path.c_str());
+   }
 
-   int cntd = 0;
+   int cntd = 0, cntdirty = 0;
    for (int i = 0; i < cfi.GetSizeInBits(); ++i)
+   {
       if (cfi.TestBit(i)) cntd++;
+      if (cfi.TestDirtyBit(i)) cntdirty++;
+   }
 
    const Info::Store& store = cfi.RefStoredData();
    char creationBuff[1000];
@@ -90,6 +99,11 @@ void Print::printFile(const std::string& path)
           cfi.GetFileSize(),cfi.GetBufferSize(), cfi.GetSizeInBits(), cntd,
           (cfi.GetSizeInBits() == cntd) ? "complete" : "");
 
+   if (cntdirty)
+      printf("nDirty %d blocks not yet uploaded to origin\n", cntdirty);
+
+   printf("nCksummed %d blocks with checksum\n", cfi.GetNCksummedBlocks());
+
 
    if (m_verbose)
    {
@@ -107,7 +121,7 @@ void Print::printFile(const std::string& path)
       {
          if (i % 64 == 0)
             printf("\n%*d ", n_db, i);
-         printf("%c", cfi.TestBit(i) ? 'x' : '.');
+         printf("%c", cfi.TestDirtyBit(i) ? 'd' : (cfi.TestBit(i) ? 'x' : '.'));
       }
       printf("\n");
    }
@@ -145,6 +159,43 @@ void Print::printFile(const std::string& path)
    printf("\n");
 }
 
+bool Print::convertFile(XrdOssDF* fh, Info& cfi, const std::string& path)
+{
+   // Checksum downloaded blocks of the data file. Blocks that can not be
+   // read are left without checksum and are not verified by the cache.
+   std::string dataPath = path.substr(0, path.size() - strlen(Info::m_infoExtension));
+
+   XrdOssDF* dh = m_oss->newFile(m_ossUser);
+   if (dh->Open(dataPath.c_str(), O_RDONLY, 0600, m_env) != XrdOssOK)
+   {
+      printf("can't open data file %s\n", dataPath.c_str());
+      delete dh;
+      return false;
+   }
+
+   const long long BS = cfi.GetBufferSize();
+   std::vector<char> buff(BS);
+   for (int i = 0; i < cfi.GetSizeInBits(); ++i)
+   {
+      if ( ! cfi.TestBit(i)) continue;
+
+      long long off = i * BS;
+      long long len = std::min(BS, cfi.GetFileSize() - off);
+      if (dh->Read(&buff[0], off, len) == len)
+         cfi.SetBlockCksum(i, Info::CalcBlockCksum(&buff[0], len));
+      else
+         cfi.ResetBlockCksum(i);
+   }
+   dh->Close();
+   delete dh;
+
+   int oldVersion = cfi.GetVersion();
+   if ( ! cfi.Write(fh, path)) return false;
+
+   printf("converted from version %d to %d\n", oldVersion, cfi.GetVersion());
+   return true;
+}
+
 void Print::printDir(XrdOssDF* iOssDF, const std::string& path)
 {
    // printf("---------> print dir %s \n", path.c_str());
@@ -182,8 +233,9 @@ void Print::printDir(XrdOssDF* iOssDF, const std::string& path)
 
 int main(int argc, char *argv[])
 {
-   static const char* usage = "Usage: pfc_print [-c config_file] [-v] path\n\n";
+   static const char* usage = "Usage: pfc_print [-c config_file] [-v] [-u] path\n\n";
    bool verbose = false;
+   bool convert = false;
    const char* cfgn = 0;
 
    XrdOucEnv myEnv;
@@ -196,6 +248,7 @@ int main(int argc, char *argv[])
    XrdOucArgs Spec(&err, "pfc_print: ",    "",
                    "verbose",        1, "v",
                    "config",       1, "c",
+                   "upgrade",      1, "u",
                    (const char *)0);
 
 
@@ -218,6 +271,11 @@ int main(int argc, char *argv[])
          verbose = true;
          break;
       }
+      case 'u':
+      {
+         convert = true;
+         break;
+      }
       default:
       {
          printf("%s", usage);
@@ -267,13 +325,13 @@ int main(int argc, char *argv[])
                std::string tmp = Config.GetWord();
                tmp += &path[6];
                // printf("Absolute path %s \n", tmp.c_str());
-               XrdFileCache::Print p(oss, verbose, tmp.c_str());
+               XrdFileCache::Print p(oss, verbose, tmp.c_str(), convert);
             }
          }
       }
       else
       {
-         XrdFileCache::Print p(oss, verbose, path);
+         XrdFileCache::Print p(oss, verbose, path, convert);
       }
    }
 }
@@ -23,17 +23,20 @@ class XrdOssDF;
 
 namespace XrdFileCache
 {
+class Info;
+
 class Print {
 public:
    //------------------------------------------------------------------------
    //! Constructor.
    //------------------------------------------------------------------------
-   Print(XrdOss* oss, bool v, const char* path);
+   Print(XrdOss* oss, bool v, const char* path, bool convert = false);
 
 private:
    XrdOss*     m_oss;      //! file system
    XrdOucEnv   m_env;      //! env used by file system
    bool        m_verbose;  //! print each block
+   bool        m_convert;  //! rewrite info files in current format
    const char* m_ossUser;  //! file system user
 
    //---------------------------------------------------------------------
@@ -46,6 +49,11 @@ private:
    //---------------------------------------------------------------------
    void printFile(const std::string& path);
 
+   //---------------------------------------------------------------------
+   //! Add block checksums from data file and rewrite in current format
+   //---------------------------------------------------------------------
+   bool convertFile(XrdOssDF* fh, Info& cfi, const std::string& path);
+
    //---------------------------------------------------------------------
    //! Print information in meta-data file recursivly
    //---------------------------------------------------------------------
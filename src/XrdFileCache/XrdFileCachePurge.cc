@@ -1,12 +1,16 @@
 #include "XrdFileCache.hh"
 #include "XrdFileCacheTrace.hh"
+#include "XrdFileCacheFile.hh"
 
 using namespace XrdFileCache;
 
 #include <fcntl.h>
+#include "XrdOss/XrdOss.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 
+#include <set>
+
 namespace
 {
 class FPurgeState
@@ -49,13 +53,70 @@ private:
    long long nByteAccum;
 };
 
+//------------------------------------------------------------------------------
+// Data files and their usage, collected for moving between disk tiers.
+//------------------------------------------------------------------------------
+class FTierState
+{
+public:
+   struct FT
+   {
+      std::string path;       //!< data file path
+      long long   nByte;      //!< downloaded bytes
+      int         nRecent;    //!< accesses within demote period
+      FT(const std::string& p, long long n, int r) : path(p), nByte(n), nRecent(r) {}
+   };
+
+   typedef std::multimap<time_t, FT> map_t;
+   typedef map_t::iterator           map_i;
+
+   map_t fast;    //!< files in the fast space, by last access
+   map_t slow;    //!< promotion candidates in the slow space, by last access
+
+   time_t recentLimit;
+};
+
 XrdOucTrace* GetTrace()
 {
    // needed for logging macros
    return Cache::GetInstance().GetTrace();
 }
 
-void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState& purgeState)
+void CheckTierFile(Info& cinfo, const std::string& infoPath, FTierState& state)
+{
+   Cache& factory = Cache::GetInstance();
+   const Configuration &conf = factory.RefConfiguration();
+
+   const std::vector<Info::AStat> &as = cinfo.RefStoredData().m_astats;
+
+   time_t lastAccess = cinfo.RefStoredData().m_creationTime;
+   int    nRecent    = 0;
+   for (std::vector<Info::AStat>::const_iterator i = as.begin(); i != as.end(); ++i)
+   {
+      lastAccess = std::max(lastAccess, std::max(i->AttachTime, i->DetachTime));
+      if (i->AttachTime >= state.recentLimit) ++nRecent;
+   }
+
+   std::string dataPath = infoPath.substr(0, infoPath.size() - strlen(XrdFileCache::Info::m_infoExtension));
+
+   char xa[1024];
+   int  xalen = sizeof(xa);
+   if (factory.GetOss()->StatXA(dataPath.c_str(), xa, xalen) == XrdOssOK)
+   {
+      XrdOucEnv   xaEnv(xa, xalen);
+      const char *cgroup = xaEnv.Get("oss.cgroup");
+      FTierState::FT ft(dataPath, cinfo.GetNDownloadedBytes(), nRecent);
+
+      if (cgroup && conf.m_fast_space == cgroup)
+         state.fast.insert(std::make_pair(lastAccess, ft));
+      else if (cgroup && conf.m_data_space == cgroup && nRecent >= conf.m_tier_promote)
+         state.slow.insert(std::make_pair(lastAccess, ft));
+   }
+}
+
+// Collects purge candidates if purgeState is given and files to move between
+// disk tiers if tierState is given, so both share one namespace scan.
+void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState* purgeState, FTierState* tierState)
 {
    char buff[256];
    XrdOucEnv env;
@@ -88,10 +149,20 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
             if (fh->Open(np.c_str(), O_RDONLY, 0600, env) == XrdOssOK && cinfo.Read(fh, np))
             {
                time_t accessTime;
-               if (cinfo.GetLatestDetachTime(accessTime))
+               if (cinfo.HasDirtyBlocks())
+               {
+                  // local writes not uploaded yet, the only copy is in the cache
+                  TRACE(Debug, "FillFileMapRecurse() skipping " << np << ", it has blocks pending upload");
+               }
+               else if ( ! purgeState)
+               {
+                  CheckTierFile(cinfo, np, *tierState);
+               }
+               else if (cinfo.GetLatestDetachTime(accessTime))
                {
                   TRACE(Dump, "FillFileMapRecurse() checking " << buff << " accessTime  " << accessTime);
-                  purgeState.checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+                  purgeState->checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+                  if (tierState) CheckTierFile(cinfo, np, *tierState);
                }
                else
                {
@@ -106,7 +177,8 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
                   {
                      accessTime = fstat.st_mtime;
                      TRACE(Dump, "FillFileMapRecurse() have access time for " << np << " via stat: " << accessTime);
-                     purgeState.checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+                     purgeState->checkFile(accessTime, np.c_str(), cinfo.GetNDownloadedBytes());
+                     if (tierState) CheckTierFile(cinfo, np, *tierState);
                   }
                   else
                   {
@@ -120,6 +192,10 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
                   }
                }
             }
+            else if ( ! purgeState)
+            {
+               TRACE(Debug, "FillFileMapRecurse() can't open or read " << np << ", skipping");
+            }
             else
             {
                TRACE(Warning, "FillFileMapRecurse() can't open or read " << np << ", err " << strerror(errno)
@@ -132,7 +208,7 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
          }
          else if (dh->Opendir(np.c_str(), env) == XrdOssOK)
          {
-            FillFileMapRecurse(dh, np, purgeState);
+            FillFileMapRecurse(dh, np, purgeState, tierState);
          }
 
          delete dh; dh = 0;
@@ -140,15 +216,128 @@ void FillFileMapRecurse( XrdOssDF* iOssDF, const std::string& path, FPurgeState&
       }
    }
 }
+
+bool RelocateFile(const std::string& dataPath, const std::string& space)
+{
+   static const char* m_traceID = "Tiers";
+   Cache& factory = Cache::GetInstance();
+
+   // keep the file from being attached while it is moved
+   if ( ! factory.ReservePath(dataPath))
+   {
+      TRACE(Debug, "RelocateFile() " << dataPath << " in use, skipping");
+      return false;
+   }
+
+   int rc = factory.GetOss()->Reloc(factory.RefConfiguration().m_username.c_str(),
+                                    dataPath.c_str(), space.c_str());
+   factory.ReleasePath(dataPath);
+
+   if (rc != XrdOssOK)
+   {
+      TRACE(Warning, "RelocateFile() " << dataPath << " to " << space << " failed, err " << strerror(-rc));
+      return false;
+   }
+   TRACE(Info, "RelocateFile() moved " << dataPath << " to " << space);
+   return true;
+}
+
+void ManageDiskTiers(FTierState& state, const std::set<std::string>& removed)
+{
+   // Fast space keeps recently used files, the data space the rest.
+   static const char* m_traceID = "Tiers";
+   Cache& factory = Cache::GetInstance();
+   const Configuration &conf = factory.RefConfiguration();
+
+   XrdOssVSInfo fP;
+   if (factory.GetOss()->StatVS(&fP, conf.m_fast_space.c_str(), 1) < 0)
+   {
+      TRACE(Error, "ManageDiskTiers() can't get statvs for oss space " << conf.m_fast_space);
+      return;
+   }
+
+   const long long lwm  = static_cast<long long>(fP.Total * 0.90);
+   const long long hwm  = static_cast<long long>(fP.Total * 0.95);
+   long long       used = fP.Total - fP.Free;
+
+   // Demote idle files, and oldest ones while the fast space is too full.
+   bool pressure = used > hwm;
+   for (FTierState::map_i it = state.fast.begin(); it != state.fast.end(); ++it)
+   {
+      bool idle = it->first < state.recentLimit;
+      if ( ! idle && ! (pressure && used > lwm)) break;
+
+      if (removed.count(it->second.path)) continue;
+
+      if (RelocateFile(it->second.path, conf.m_data_space))
+         used -= it->second.nByte;
+   }
+
+   // Promote frequently accessed files, most recently used first.
+   for (FTierState::map_t::reverse_iterator it = state.slow.rbegin(); it != state.slow.rend(); ++it)
+   {
+      if (used + it->second.nByte > lwm) continue;
+
+      if (removed.count(it->second.path)) continue;
+
+      if (RelocateFile(it->second.path, conf.m_fast_space))
+         used += it->second.nByte;
+   }
+}
+}
+
+//------------------------------------------------------------------------------
+
+void Cache::ManageTiers()
+{
+   // RAM tier, let blocks that stopped being read make room for others.
+   // Files are aged one at a time outside of m_active_cond, Detach() waits
+   // for the file being aged.
+   if (m_configuration.m_NHotBlocks <= 0) return;
+
+   std::vector<std::string> paths;
+   {
+      XrdSysCondVarHelper lock(m_active_cond);
+      for (std::map<std::string, File*>::iterator it = m_active.begin(); it != m_active.end(); ++it)
+      {
+         if (it->second) paths.push_back(it->first);
+      }
+   }
+
+   for (std::vector<std::string>::iterator pi = paths.begin(); pi != paths.end(); ++pi)
+   {
+      File *file;
+      {
+         XrdSysCondVarHelper lock(m_active_cond);
+         std::map<std::string, File*>::iterator it = m_active.find(*pi);
+         if (it == m_active.end() || ! it->second) continue;
+         file = m_aging = it->second;
+      }
+
+      file->AgeHotBlocks();
+
+      {
+         XrdSysCondVarHelper lock(m_active_cond);
+         m_aging = 0;
+         m_active_cond.Broadcast();
+      }
+   }
 }
+
+//------------------------------------------------------------------------------
+
 void Cache::CacheDirCleanup()
 {
    XrdOucEnv env;
    XrdOss*      oss = Cache::GetInstance().GetOss();
    XrdOssVSInfo sP;
 
+   const bool diskTiers = ! m_configuration.m_fast_space.empty();
+
    while (1)
    {
+      ManageTiers();
+
       // get amount of space to erase
       long long bytesToRemove = 0;
       if (oss->StatVS(&sP, m_configuration.m_data_space.c_str(), 1) < 0)
@@ -159,6 +348,13 @@ void Cache::CacheDirCleanup()
       else
       {
          long long ausage = sP.Total - sP.Free;
+
+         XrdOssVSInfo fP;
+         if (diskTiers && oss->StatVS(&fP, m_configuration.m_fast_space.c_str(), 1) >= 0)
+         {
+            ausage += fP.Total - fP.Free;
+         }
+
          TRACE(Info, "Cache::CacheDirCleanup() used disk space " << ausage << " bytes.");
          if (ausage > m_configuration.m_diskUsageHWM)
          {
@@ -167,15 +363,20 @@ void Cache::CacheDirCleanup()
          }
       }
 
-      if (bytesToRemove > 0)
+      if (bytesToRemove > 0 || diskTiers)
       {
-         // make a sorted map of file patch by access time
+         // make a sorted map of file patch by access time, and collect
+         // files for the disk tiers in the same pass
+         FPurgeState purgeState(bytesToRemove * 5 / 4); // prepare 20% more volume than required
+         FTierState  tierState;
+         tierState.recentLimit = time(0) - m_configuration.m_tier_demote;
+
+         std::set<std::string> removed;
+
          XrdOssDF* dh = oss->newDir(m_configuration.m_username.c_str());
          if (dh->Opendir("", env) == XrdOssOK)
          {
-            FPurgeState purgeState(bytesToRemove * 5 / 4); // prepare 20% more volume than required
-
-            FillFileMapRecurse(dh, "", purgeState);
+            FillFileMapRecurse(dh, "", bytesToRemove > 0 ? &purgeState : 0, diskTiers ? &tierState : 0);
 
             // loop over map and remove files with highest value of access time
             struct stat fstat;
@@ -203,12 +404,15 @@ void Cache::CacheDirCleanup()
                   bytesToRemove -= it->second.nByte;
 
                   oss->Unlink(dataPath.c_str());
+                  removed.insert(dataPath);
                   TRACE(Info, "Cache::CacheDirCleanup() removed file: %s " << dataPath << " size " << it->second.nByte);
                }
 
                if (bytesToRemove <= 0)
                   break;
             }
+
+            if (diskTiers) ManageDiskTiers(tierState, removed);
          }
          dh->Close();
          delete dh; dh = 0;
@@ -35,11 +35,44 @@ public:
    //----------------------------------------------------------------------
    Stats() {
       m_BytesDisk = m_BytesRam = m_BytesMissed = 0;
+      m_BytesWritten = m_BytesUploaded = 0;
+      m_ReadVCnt = m_ReadVFullHit = m_ReadVFullMiss = 0;
+      m_ReadVBytesHit = m_ReadVBytesMiss = 0;
    }
 
    long long m_BytesDisk;         //!< number of bytes served from disk cache
    long long m_BytesRam;          //!< number of bytes served from RAM cache
    long long m_BytesMissed;       //!< number of bytes served directly from XrdCl
+   long long m_BytesWritten;      //!< number of bytes written by clients into the cache
+   long long m_BytesUploaded;     //!< number of written bytes uploaded to origin
+   int       m_ReadVCnt;          //!< number of vector reads
+   int       m_ReadVFullHit;      //!< number of vector reads served entirely from cache
+   int       m_ReadVFullMiss;     //!< number of vector reads served entirely from origin
+   long long m_ReadVBytesHit;     //!< vector read bytes found in cache
+   long long m_ReadVBytesMiss;    //!< vector read bytes requested from origin
+
+   //----------------------------------------------------------------------
+   //! Account a vector read, hit and miss bytes as classified before reading.
+   //----------------------------------------------------------------------
+   inline void AddReadV(long long bytesHit, long long bytesMiss)
+   {
+      ++m_ReadVCnt;
+      if (bytesMiss == 0)     ++m_ReadVFullHit;
+      else if (bytesHit == 0) ++m_ReadVFullMiss;
+      m_ReadVBytesHit  += bytesHit;
+      m_ReadVBytesMiss += bytesMiss;
+      if (bytesHit  > 0) ++Hits;
+      if (bytesMiss > 0) ++Miss;
+   }
+
+   //----------------------------------------------------------------------
+   //! Fraction of vector read bytes served from cache.
+   //----------------------------------------------------------------------
+   inline double ReadVHitRatio() const
+   {
+      long long tot = m_ReadVBytesHit + m_ReadVBytesMiss;
+      return tot > 0 ? (double) m_ReadVBytesHit / tot : 0;
+   }
 
    inline void AddStat(Stats &Src)
    {
@@ -49,6 +82,13 @@ public:
       m_BytesDisk += Src.m_BytesDisk;
       m_BytesRam += Src.m_BytesRam;
       m_BytesMissed += Src.m_BytesMissed;
+      m_BytesWritten += Src.m_BytesWritten;
+      m_BytesUploaded += Src.m_BytesUploaded;
+      m_ReadVCnt       += Src.m_ReadVCnt;
+      m_ReadVFullHit   += Src.m_ReadVFullHit;
+      m_ReadVFullMiss  += Src.m_ReadVFullMiss;
+      m_ReadVBytesHit  += Src.m_ReadVBytesHit;
+      m_ReadVBytesMiss += Src.m_ReadVBytesMiss;
 
       m_MutexXfc.UnLock();
    }
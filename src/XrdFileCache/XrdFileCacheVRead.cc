@@ -12,6 +12,8 @@
 #include "XrdCl/XrdClXRootDResponses.hh"
 #include "XrdPosix/XrdPosixFile.hh"
 
+#include <algorithm>
+
 namespace XrdFileCache
 {
 // a list of IOVec chuncks that match a given block index
@@ -72,6 +74,32 @@ struct ReadVBlockListDisk
       bv.back().arr.push_back(chunkIdx);
    }
 };
+
+// Limits of a single kXR_readv request as enforced by the server.
+const int       kMaxRVecSize  = 1024;
+const long long kMaxRVecChunk = 2097136;
+
+// Response handler for one remote readv that carries whole blocks to be
+// cached together with direct chunks that go to the user buffer.
+class VReadRemoteHandler : public XrdOucCacheIOCB
+{
+public:
+   std::vector<Block*>       m_blocks;
+   std::vector<XrdOucIOVec>  m_iov;
+   DirectResponseHandler    *m_direct;
+
+   VReadRemoteHandler() : m_direct(0) {}
+
+   virtual void Done(int res)
+   {
+      for (std::vector<Block*>::iterator i = m_blocks.begin(); i != m_blocks.end(); ++i)
+         (*i)->m_file->ProcessBlockResponse(*i, res);
+
+      if (m_direct) m_direct->Done(res);
+
+      delete this;
+   }
+};
 }
 
 using namespace XrdFileCache;
@@ -98,26 +126,33 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
    ReadVBlockListRAM blocks_to_process;
    std::vector<ReadVChunkListRAM> blks_processed;
    ReadVBlockListDisk blocks_on_disk;
+   BlockList_t                    blks_to_request;
    std::vector<XrdOucIOVec>       chunkVec;
    DirectResponseHandler         *direct_handler = 0;
+   long long                      bytes_hit = 0, bytes_miss = 0;
 
    // TODO The following call never fails (other than with out of mem exception).
    // This should be implemented in PrepareBlockRequest().
-   if ( ! VReadPreProcess(readV, n, blocks_to_process, blocks_on_disk, chunkVec))
+   if ( ! VReadPreProcess(readV, n, blocks_to_process, blocks_on_disk, blks_to_request,
+                          chunkVec, bytes_hit, bytes_miss))
    {
       bytesRead = -1;
       errno = ENOMEM;
    }
 
-   // issue a client read
+   // issue a single remote readv for all the misses, cached segments are
+   // served while it is in flight
+
+   direct_handler = VReadRequestRemote(blks_to_request, chunkVec);
 
+   // copy from blocks already in RAM
    if (bytesRead >= 0)
    {
-      if ( ! chunkVec.empty())
-      {
-         direct_handler = new DirectResponseHandler(1);
-         m_io->GetInput()->ReadV(*direct_handler, &chunkVec[0], chunkVec.size());
-      }
+      int br = VReadProcessBlocks(readV, n, blocks_to_process.bv, blks_processed, false);
+      if (br < 0)
+         bytesRead = br;
+      else
+         bytesRead += br;
    }
 
    // disk read
@@ -130,7 +165,7 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
          bytesRead += dr;
    }
 
-   // read from cached blocks
+   // wait for blocks still being downloaded
    if (bytesRead >= 0)
    {
       int br = VReadProcessBlocks(readV, n, blocks_to_process.bv, blks_processed);
@@ -141,7 +176,7 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
    }
 
    // check direct requests have arrived, get bytes read from read handle
-   if (bytesRead >= 0 && direct_handler != 0)
+   if (direct_handler != 0)
    {
       XrdSysCondVarHelper _lck(direct_handler->m_cond);
 
@@ -150,7 +185,11 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
          direct_handler->m_cond.Wait();
       }
 
-      if (direct_handler->m_errno == 0)
+      if (bytesRead < 0)
+      {
+         // error already reported
+      }
+      else if (direct_handler->m_errno == 0)
       {
          for (std::vector<XrdOucIOVec>::iterator i = chunkVec.begin(); i != chunkVec.end(); ++i)
          {
@@ -184,6 +223,13 @@ int File::ReadV(const XrdOucIOVec *readV, int n)
    for (std::vector<ReadVChunkListRAM>::iterator i = blks_processed.begin(); i != blks_processed.end(); ++i)
       delete i->arr;
 
+   if (bytesRead >= 0)
+   {
+      m_stats.AddReadV(bytes_hit, bytes_miss);
+   }
+
+   TRACEF(Debug, "ReadV " << n << " chunks, hit " << bytes_hit << " miss " << bytes_miss << " bytes, hit ratio "
+          << (bytes_hit + bytes_miss > 0 ? (double) bytes_hit / (bytes_hit + bytes_miss) : 0));
    TRACEF(Dump, "VRead exit, total = " << bytesRead);
    return bytesRead;
 }
@@ -208,9 +254,11 @@ bool File::VReadValidate(const XrdOucIOVec *vr, int n)
 bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
                            ReadVBlockListRAM        &blocks_to_process,
                            ReadVBlockListDisk       &blocks_on_disk,
-                           std::vector<XrdOucIOVec> &chunkVec)
+                           BlockList_t              &blks_to_request,
+                           std::vector<XrdOucIOVec> &chunkVec,
+                           long long &bytes_hit, long long &bytes_miss)
 {
-   BlockList_t blks_to_request;
+   const long long BS = m_cfi.GetBufferSize();
 
    m_downloadCond.Lock();
 
@@ -222,28 +270,40 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
       for (int block_idx = blck_idx_first; block_idx <= blck_idx_last; ++block_idx)
       {
          TRACEF(Dump, "VReadPreProcess chunk "<<  readV[iov_idx].size << "@"<< readV[iov_idx].offset);
+         CountBlockHit(block_idx);
+
+         long long off;      // offset in user buffer
+         long long blk_off;  // offset in block
+         long long size;     // size to copy
+         overlap(block_idx, BS, readV[iov_idx].offset, readV[iov_idx].size, off, blk_off, size);
 
          BlockMap_i bi = m_block_map.find(block_idx);
          if (bi != m_block_map.end())
          {
             if (blocks_to_process.AddEntry(bi->second, iov_idx))
                inc_ref_count(bi->second);
+            bytes_hit += size;
 
             TRACEF(Dump, "VReadPreProcess block "<< block_idx <<" in map");
          }
          else if (m_cfi.TestBit(offsetIdx(block_idx)))
          {
             blocks_on_disk.AddEntry(block_idx, iov_idx);
+            bytes_hit += size;
 
             TRACEF(Dump, "VReadPreProcess block "<< block_idx <<" , chunk idx = " << iov_idx << " on disk");
          }
          else
          {
-            if (Cache::GetInstance().RequestRAMBlock())
+            bytes_miss += size;
+
+            bool ram    = Cache::GetInstance().RequestRAMBlock();
+            bool direct = ! ram && Cache::GetInstance().RequestDirectBlock();
+            if (ram || direct)
             {
-               Block *b = PrepareBlockRequest(block_idx, false);
+               Block *b = PrepareBlockRequest(block_idx, false, direct);
                // TODO this can not fail (other than out of memory which we don't handle).
-               if (! b) return false;
+               if (! b) { m_downloadCond.UnLock(); return false; }
                inc_ref_count(b);
                blocks_to_process.AddEntry(b, iov_idx);
                blks_to_request.push_back(b);
@@ -252,12 +312,19 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
             }
             else
             {
-               long long off;      // offset in user buffer
-               long long blk_off;      // offset in block
-               long long size;      // size to copy
-               const long long BS = m_cfi.GetBufferSize();
-               overlap(block_idx, BS, readV[iov_idx].offset, readV[iov_idx].size, off, blk_off, size);
-               chunkVec.push_back(XrdOucIOVec2(readV[iov_idx].data+off, BS*block_idx + blk_off,size));
+               // Pieces of one chunk that span several uncached blocks are
+               // contiguous in both the file and the user buffer, merge them.
+               if ( ! chunkVec.empty() &&
+                    chunkVec.back().offset + chunkVec.back().size == BS*block_idx + blk_off &&
+                    chunkVec.back().data   + chunkVec.back().size == readV[iov_idx].data + off &&
+                    chunkVec.back().size   + size <= kMaxRVecChunk)
+               {
+                  chunkVec.back().size += size;
+               }
+               else
+               {
+                  chunkVec.push_back(XrdOucIOVec2(readV[iov_idx].data+off, BS*block_idx + blk_off,size));
+               }
 
                TRACEF(Dump, "VReadPreProcess direct read " << block_idx);
             }
@@ -267,13 +334,77 @@ bool File::VReadPreProcess(const XrdOucIOVec *readV, int n,
 
    m_downloadCond.UnLock();
 
-   ProcessBlockRequests(blks_to_request);
-
    return true;
 }
 
 //------------------------------------------------------------------------------
 
+DirectResponseHandler* File::VReadRequestRemote(BlockList_t              &blks_to_request,
+                                                std::vector<XrdOucIOVec> &chunkVec)
+{
+   // Requests blocks to be cached and direct chunks with as few remote readv
+   // calls as the protocol limits allow, normally just one. Returns the
+   // handler to wait on for direct chunks, 0 if there are none.
+   // This *must not* be called with block_map locked.
+
+   std::vector<VReadRemoteHandler*> rvs;
+
+   for (BlockList_i bi = blks_to_request.begin(); bi != blks_to_request.end(); ++bi)
+   {
+      Block     *b      = *bi;
+      long long  bsize  = b->get_size();
+      int        npiece = (bsize + kMaxRVecChunk - 1) / kMaxRVecChunk;
+
+      if (rvs.empty() || rvs.back()->m_iov.size() + npiece > (size_t) kMaxRVecSize)
+         rvs.push_back(new VReadRemoteHandler);
+
+      rvs.back()->m_blocks.push_back(b);
+      for (long long boff = 0; boff < bsize; boff += kMaxRVecChunk)
+      {
+         long long psize = std::min(kMaxRVecChunk, bsize - boff);
+         rvs.back()->m_iov.push_back(XrdOucIOVec2(b->get_buff() + boff, b->get_offset() + boff, psize));
+      }
+   }
+
+   DirectResponseHandler *direct_handler = 0;
+
+   if ( ! chunkVec.empty())
+   {
+      direct_handler = new DirectResponseHandler(0);
+
+      for (std::vector<XrdOucIOVec>::iterator i = chunkVec.begin(); i != chunkVec.end(); ++i)
+      {
+         // A chunk can span a whole block, split it like blocks above.
+         for (long long coff = 0; coff < i->size; coff += kMaxRVecChunk)
+         {
+            if (rvs.empty() || rvs.back()->m_iov.size() >= (size_t) kMaxRVecSize)
+               rvs.push_back(new VReadRemoteHandler);
+
+            if (rvs.back()->m_direct == 0)
+            {
+               rvs.back()->m_direct = direct_handler;
+               ++direct_handler->m_to_wait;
+            }
+            long long csize = std::min(kMaxRVecChunk, i->size - coff);
+            rvs.back()->m_iov.push_back(XrdOucIOVec2(i->data + coff, i->offset + coff, csize));
+         }
+      }
+   }
+
+   TRACEF(Dump, "VReadRequestRemote " << blks_to_request.size() << " blocks, " << chunkVec.size()
+          << " direct chunks in " << rvs.size() << " readv requests");
+
+   for (std::vector<VReadRemoteHandler*>::iterator i = rvs.begin(); i != rvs.end(); ++i)
+   {
+      VReadRemoteHandler *h = *i;
+      m_io->GetInput()->ReadV(*h, &h->m_iov[0], h->m_iov.size());
+   }
+
+   return direct_handler;
+}
+
+//------------------------------------------------------------------------------
+
 int File::VReadFromDisk(const XrdOucIOVec *readV, int n, ReadVBlockListDisk& blocks_on_disk)
 {
    int bytes_read = 0;
@@ -292,11 +423,10 @@ int File::VReadFromDisk(const XrdOucIOVec *readV, int n, ReadVBlockListDisk& blo
 
          overlap(blockIdx, m_cfi.GetBufferSize(), readV[chunkIdx].offset, readV[chunkIdx].size, off, blk_off, size);
 
-         int rs = m_output->Read(readV[chunkIdx].data + off,  blockIdx*m_cfi.GetBufferSize() + blk_off - m_offset, size);
+         int rs = ReadBlockFromDisk(blockIdx, readV[chunkIdx].data + off, blk_off, size);
          if (rs >=0)
          {
             bytes_read += rs;
-            m_stats.m_BytesDisk += rs;
          }
          else
          {
@@ -315,7 +445,8 @@ int File::VReadFromDisk(const XrdOucIOVec *readV, int n, ReadVBlockListDisk& blo
 
 int File::VReadProcessBlocks(const XrdOucIOVec *readV, int n,
                              std::vector<ReadVChunkListRAM>& blocks_to_process,
-                             std::vector<ReadVChunkListRAM>& blocks_processed)
+                             std::vector<ReadVChunkListRAM>& blocks_processed,
+                             bool wait)
 {
    int bytes_read = 0;
    while ((! blocks_to_process.empty()) && (bytes_read >= 0))
@@ -340,6 +471,7 @@ int File::VReadProcessBlocks(const XrdOucIOVec *readV, int n,
 
          if (finished.empty())
          {
+            if ( ! wait) break;
             m_downloadCond.Wait();
             continue;
          }
@@ -360,7 +492,10 @@ int File::VReadProcessBlocks(const XrdOucIOVec *readV, int n,
                overlap(block_idx, m_cfi.GetBufferSize(), readV[*chunkIt].offset, readV[*chunkIt].size, off, blk_off, size);
                memcpy(readV[*chunkIt].data + off,  &(bi->block->m_buff[blk_off]), size);
                bytes_read         += size;
-               m_stats.m_BytesRam += size;
+               if (bi->block->m_direct)
+                  m_stats.m_BytesMissed += size;
+               else
+                  m_stats.m_BytesRam    += size;
             }
          }
          else
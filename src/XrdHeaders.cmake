@@ -72,6 +72,7 @@ set( XROOTD_PUBLIC_HEADERS
   XrdOuc/XrdOucCompiler.hh
   XrdPosix/XrdPosixCallBack.hh
   XrdPosix/XrdPosixExtern.hh
+  XrdPosix/XrdPosixIOQueue.hh
   XrdPosix/XrdPosixOsDep.hh
   XrdPosix/XrdPosixXrootd.hh
   XrdPosix/XrdPosixXrootdPath.hh
@@ -121,6 +122,7 @@ set( XROOTD_PRIVATE_HEADERS
   XrdOfs/XrdOfsEvr.hh
   XrdOfs/XrdOfsHandle.hh
   XrdOfs/XrdOfsTrace.hh
+  XrdOfs/XrdOfsTPCEngine.hh
   XrdOfs/XrdOfsTPCInfo.hh
   XrdSys/XrdSysPriv.hh
 
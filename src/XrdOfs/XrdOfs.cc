@@ -766,10 +766,14 @@ int            XrdOfsFile::fctl(const int               cmd,
                                 const char             *args,
                                       XrdOucErrInfo    &out_error)
 {
-// See if we can do this
+// See if we can do this. The file descriptor is only used for sendfile(),
+// so none is returned when the storage system says it must not be used.
 //
    if (cmd == SFS_FCTL_GETFD)
-      {out_error.setErrCode(oh->Select().getFD());
+      {XrdOssDF &theFile = oh->Select();
+       if (theFile.Fctl(XrdOssDF::Fctl_noSendFile, 0, 0) > 0)
+          out_error.setErrCode(-1);
+          else out_error.setErrCode(theFile.getFD());
        return SFS_OK;
       }
 
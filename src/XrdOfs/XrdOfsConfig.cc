@@ -1188,7 +1188,9 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
                                          [require {all|client|dest} <auth>[+]]
                                          [restrict <path>] [streams <num>]
                                          [echo] [scan {stderr | stdout}]
-                                         [autorm] [pgm <path> [parms]]
+                                         [autorm] [hostmax <hn>]
+                                         [pgm <path> [parms] |
+                                          engine [<lib> [parms]]]
 
              parms: [dn <name>] [group <grp>] [host <hn>] [vo <vo>]
 
@@ -1199,6 +1201,8 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
              allow   only allow destinations that match the specified
                      authentication specification.
              <n>     maximum number of simultaneous transfers.
+             <hn>    maximum number of simultaneous transfers from any one
+                     source host (0 means no limit, the default).
              <num>   the number of TCP streams to use for the copy.
              <auth>  require that the client, destination, or both (i.e. all)
                      use the specified authentication protocol. Additional
@@ -1212,6 +1216,10 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
                      default is to scan both.
              pgm     specifies the transfer command with optional paramaters.
                      It must be the last parameter on the line.
+             engine  copy in-process using the engine in <lib> with optional
+                     parameters instead of running a transfer command. The
+                     default engine is based on XrdCl. It must be the last
+                     parameter on the line.
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1219,9 +1227,9 @@ int XrdOfs::xrole(XrdOucStream &Config, XrdSysError &Eroute)
 int XrdOfs::xtpc(XrdOucStream &Config, XrdSysError &Eroute)
 {
    XrdOfsTPC::iParm Parms;
-   char *val, pgm[1024];
+   char *val, pgm[1024], eng[1024];
    int  reqType;
-   *pgm = 0;
+   *pgm = 0; *eng = 0;
 
    while((val =  Config.GetWord()))
         {if (!strcmp(val, "allow"))
@@ -1246,6 +1254,18 @@ int XrdOfs::xtpc(XrdOucStream &Config, XrdSysError &Eroute)
          if (!strcmp(val, "echo"))  {Parms.xEcho = 1; continue;}
          if (!strcmp(val, "logok")) {Parms.Logok = 1; continue;}
          if (!strcmp(val, "autorm")){Parms.autoRM = 1; continue;}
+         if (!strcmp(val, "engine"))
+            {if (!Config.GetRest(eng, sizeof(eng)))
+                {Eroute.Emsg("Config", "tpc engine line too long"); return 1;}
+             Parms.Eng = eng;
+             break;
+            }
+         if (!strcmp(val, "hostmax"))
+            {if (!(val = Config.GetWord()))
+                {Eroute.Emsg("Config","tpc hostmax value not specified"); return 1;}
+             if (XrdOuca2x::a2i(Eroute,"tpc hostmax",val,&Parms.Hmax,0)) return 1;
+             continue;
+            }
          if (!strcmp(val, "pgm"))
             {if (!Config.GetRest(pgm, sizeof(pgm)))
                 {Eroute.Emsg("Config", "tpc command line too long"); return 1;}
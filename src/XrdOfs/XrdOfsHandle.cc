@@ -34,7 +34,6 @@
 #include <sys/types.h>
 
 #include "XrdOfs/XrdOfsHandle.hh"
-#include "XrdOfs/XrdOfsStats.hh"
 #include "XrdOss/XrdOss.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
@@ -162,15 +161,12 @@ void *XrdOfsHanXpire(void *pp)
 
 extern XrdSysError OfsEroute;
 
-extern XrdOfsStats OfsStats;
-
 /******************************************************************************/
 /*                        S t a t i c   O b j e c t s                         */
 /******************************************************************************/
   
-XrdSysMutex   XrdOfsHandle::myMutex;
-XrdOfsHanTab  XrdOfsHandle::roTable;
-XrdOfsHanTab  XrdOfsHandle::rwTable;
+XrdOfsHandle::hanShard XrdOfsHandle::hanTab[XrdOfsHandle::hanShards];
+XrdSysMutex   XrdOfsHandle::freeMutex;
 XrdOssDF     *XrdOfsHandle::ossDF = (XrdOssDF *)new XrdOfsHanOss;
 XrdOfsHandle *XrdOfsHandle::Free = 0;
 
@@ -184,33 +180,34 @@ XrdOfsHandle *XrdOfsHandle::Free = 0;
 int XrdOfsHandle::Alloc(const char *thePath, int Opts, XrdOfsHandle **Handle)
 {
    XrdOfsHandle *hP;
-   XrdOfsHanTab *theTable = (Opts & opRW ? &rwTable : &roTable);
    XrdOfsHanKey theKey(thePath, (int)strlen(thePath));
+   hanShard     &theShard = ShardLock(theKey.Hash);
+   XrdOfsHanTab *theTable = (Opts & opRW ? &theShard.rwTable
+                                         : &theShard.roTable);
    int          retc;
 
-// Lock the search table and try to find the key. If found, increment the
-// the link count (can only be done with the global lock) then release the
-// lock and try to lock the handle. It can't escape between lock calls because
-// the link count is positive. If we can't lock the handle then it must be the
-// that a long running operation is occuring. Return the handle to its former
+// The shard for this key is now locked, so try to find the key. If found,
+// increment the link count (can only be done with the shard lock) then release
+// the lock and try to lock the handle. It can't escape between lock calls
+// because the link count is positive. If we can't lock the handle then it must
+// be that a long running operation is occuring. Return the handle to its former
 // state and return a delay. Otherwise, return the handle.
 //
-   myMutex.Lock();
    if ((hP = theTable->Find(theKey)) && hP->Path.Links != 0xffff)
-      {hP->Path.Links++; myMutex.UnLock();
+      {hP->Path.Links++; theShard.sMutex.UnLock();
        if (hP->WaitLock()) {*Handle = hP; return 0;}
-       myMutex.Lock(); hP->Path.Links--; myMutex.UnLock();
+       theShard.sMutex.Lock(); hP->Path.Links--; theShard.sMutex.UnLock();
        return nolokDelay;
       }
 
 // Get a new handle
 //
-   if (!(retc = Alloc(theKey, Opts, Handle))) theTable->Add(*Handle);
-   OfsStats.Add(OfsStats.Data.numHandles);
+   if (!(retc = Alloc(theKey, Opts, Handle)))
+      {theTable->Add(*Handle); theShard.numHan++;}
 
 // All done
 //
-   myMutex.UnLock();
+   theShard.sMutex.UnLock();
    return retc;
 }
 
@@ -223,10 +220,8 @@ int XrdOfsHandle::Alloc(XrdOfsHandle **Handle)
     XrdOfsHanKey myKey("dummy", 5);
     int retc;
 
-    myMutex.Lock();
     if (!(retc = Alloc(myKey, 0, Handle))) 
        {(*Handle)->Path.Links = 0; (*Handle)->UnLock();}
-    myMutex.UnLock();
     return retc;
 }
 
@@ -234,16 +229,19 @@ int XrdOfsHandle::Alloc(XrdOfsHandle **Handle)
 /* private                      A l l o c   # 3                               */
 /******************************************************************************/
   
-int XrdOfsHandle::Alloc(XrdOfsHanKey theKey, int Opts, XrdOfsHandle **Handle)
+int XrdOfsHandle::Alloc(const XrdOfsHanKey &theKey, int Opts,
+                        XrdOfsHandle **Handle)
 {
    static const int minAlloc = 4096/sizeof(XrdOfsHandle);
    XrdOfsHandle *hP;
 
 // No handle currently in the table. Get a new one off the free list
 //
+   freeMutex.Lock();
    if (!Free && (hP = new XrdOfsHandle[minAlloc]))
       {int i = minAlloc; while(i--) {hP->Next = Free; Free = hP; hP++;}}
    if ((hP = Free)) Free = hP->Next;
+   freeMutex.UnLock();
 
 // Initialize the new handle, if we have one, and add it to the table
 //
@@ -271,14 +269,14 @@ void XrdOfsHandle::Hide(const char *thePath)
 {
    XrdOfsHandle *hP;
    XrdOfsHanKey theKey(thePath, (int)strlen(thePath));
+   hanShard    &theShard = ShardLock(theKey.Hash);
 
-// Lock the search table and try to find the key in each table. If found,
-// clear the length field to effectively hide the item.
+// The shard for this key is locked, so try to find the key in each table. If
+// found, clear the length field to effectively hide the item.
 //
-   myMutex.Lock();
-   if ((hP = roTable.Find(theKey))) hP->Path.Len = 0;
-   if ((hP = rwTable.Find(theKey))) hP->Path.Len = 0;
-   myMutex.UnLock();
+   if ((hP = theShard.roTable.Find(theKey))) hP->Path.Len = 0;
+   if ((hP = theShard.rwTable.Find(theKey))) hP->Path.Len = 0;
+   theShard.sMutex.UnLock();
 }
 
 /******************************************************************************/
@@ -297,7 +295,11 @@ int XrdOfsHandle::PoscGet(short &Mode, int Done)
        Mode = Posc->Mode;
        if (Done)
           {pP = Posc; Posc = 0;
-           if (pP->xprP) {myMutex.Lock(); Path.Links--; myMutex.UnLock();}
+           if (pP->xprP)
+              {hanShard &theShard = ShardLock();
+               Path.Links--;
+               theShard.sMutex.UnLock();
+              }
            pP->Recycle();
           }
        return pnum;
@@ -378,33 +380,40 @@ const char *XrdOfsHandle::PoscUsr()
 
 int XrdOfsHandle::Retire(int &retc, long long *retsz, char *buff, int blen)
 {
+   hanShard &theShard = ShardLock();
    XrdOssDF *mySSI;
-   int numLeft;
+   int numLeft, doFree = 0;
 
-// Get the global lock as the links field can only be manipulated with it.
+// Get the shard lock as the links field can only be manipulated with it.
 // Decrement the links count and if zero, remove it from the table and
 // place it on the free list. Otherwise, it is still in use.
 //
    retc = 0;
-   myMutex.Lock();
    if (Path.Links == 1)
       {if (buff) strlcpy(buff, Path.Val, blen);
-       numLeft = 0; OfsStats.Dec(OfsStats.Data.numHandles);
-       if ( (isRW ? rwTable.Remove(this) : roTable.Remove(this)) )
-         {Next = Free; Free = this;
+       numLeft = 0;
+       if ( (isRW ? theShard.rwTable.Remove(this)
+                  : theShard.roTable.Remove(this)) )
+         {theShard.numHan--; doFree = 1;
           if (Posc) {Posc->Recycle(); Posc = 0;}
           if (Path.Val) {free((void *)Path.Val); Path.Val = (char *)"";}
           Path.Len = 0;
           if ((mySSI = ssi) && ssi != ossDF)
-             {ssi = ossDF; myMutex.UnLock();
+             {ssi = ossDF; theShard.sMutex.UnLock();
               retc = mySSI->Close(retsz); delete mySSI;
-             } else myMutex.UnLock();
+             } else theShard.sMutex.UnLock();
          } else {
-          myMutex.UnLock();
+          theShard.sMutex.UnLock();
           OfsEroute.Emsg("Retire", "Lost handle to", Path.Val);
         }
-      } else {numLeft = --Path.Links; myMutex.UnLock();}
+      } else {numLeft = --Path.Links; theShard.sMutex.UnLock();}
    UnLock();
+
+// Place the handle on the free list only after we are completely done with it
+// as the free list is no longer protected by the table lock.
+//
+   if (doFree)
+      {freeMutex.Lock(); Next = Free; Free = this; freeMutex.UnLock();}
    return numLeft;
 }
 
@@ -419,14 +428,14 @@ int XrdOfsHandle::Retire(XrdOfsHanCB *cbP, int hTime)
 // The handle can only be held by one reference and only if it's a POSC and
 // defered handling was properly set up.
 //
-   myMutex.Lock();
+   hanShard &theShard = ShardLock();
    if (!Posc || !allOK)
       {OfsEroute.Emsg("Retire", "ignoring deferred retire of", Path.Val);
-       if (Path.Links != 1 || !Posc || !cbP) myMutex.UnLock();
-          else {myMutex.UnLock(); cbP->Retired(this);}
+       if (Path.Links != 1 || !Posc || !cbP) theShard.sMutex.UnLock();
+          else {theShard.sMutex.UnLock(); cbP->Retired(this);}
        return Retire(retc);
       }
-   myMutex.UnLock();
+   theShard.sMutex.UnLock();
 
 // If this object already has an xpr object (happens for bouncing connections)
 // then reuse that object. Otherwise create a new one and put it on the queue.
@@ -478,14 +487,14 @@ do{xP = XrdOfsHanXpr::Get(); hP = xP->Handle;
             hP->UnLock(); delete xP; continue;
            }
 
-// As the handle is locked we can get the global handle lock to prevent
-// additions and removals of handles as we need a stable reference count to
-// effect the callout, if any. Do so only if the reference count is one (for us)
-// and the handle is active. In all cases, drop the global lock.
+// As the handle is locked we can get the shard lock to prevent additions and
+// removals of references as we need a stable reference count to effect the
+// callout, if any. Do so only if the reference count is one (for us) and the
+// handle is active. In all cases, drop the shard lock.
 //
-   myMutex.Lock();
-   if (hP->Path.Links != 1 || !xP->Call) myMutex.UnLock();
-      else {myMutex.UnLock();
+   hanShard &theShard = hP->ShardLock();
+   if (hP->Path.Links != 1 || !xP->Call) theShard.sMutex.UnLock();
+      else {theShard.sMutex.UnLock();
             xP->Call->Retired(hP);
            }
 
@@ -500,6 +509,41 @@ do{xP = XrdOfsHanXpr::Get(); hP = xP->Handle;
    return 0;
 }
 
+/******************************************************************************/
+/* public                     T a b l e S t a t s                             */
+/******************************************************************************/
+
+void XrdOfsHandle::TableStats(int &numHan, int &numWait)
+{
+   int i;
+
+// Sum up the counters across all the shards. We don't lock the shards as an
+// approximate value is good enough for statistical purposes.
+//
+   numHan = numWait = 0;
+   for (i = 0; i < hanShards; i++)
+       {numHan += hanTab[i].numHan; numWait += hanTab[i].numWait;}
+}
+
+/******************************************************************************/
+/* private                     S h a r d L o c k                              */
+/******************************************************************************/
+
+XrdOfsHandle::hanShard &XrdOfsHandle::ShardLock(unsigned int hVal)
+{
+// The shard tables index buckets by the hash modulo their size. Choosing the
+// shard by the low bits as well would leave most of those buckets unused, so
+// use the high bits of the hash instead.
+//
+   hanShard &theShard = hanTab[(hVal >> 26) % hanShards];
+
+// Lock the shard, counting the number of times we had to wait for the lock
+//
+   if (!theShard.sMutex.CondLock())
+      {theShard.sMutex.Lock(); theShard.numWait++;}
+   return theShard;
+}
+
 /******************************************************************************/
 /* public                       W a i t L o c k                               */
 /******************************************************************************/
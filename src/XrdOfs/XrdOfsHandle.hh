@@ -160,6 +160,8 @@ XrdOssDF           &Select(void) {return *ssi;}   // To allow for mt interfaces
 
 static       int    StartXpr(int Init=0);         // Internal use only!
 
+static       void   TableStats(int &numHan, int &numWait);
+
              int    Usage() {return Path.Links;}
 
 inline       void   Lock()   {hMutex.Lock();}
@@ -170,17 +172,37 @@ inline       void   UnLock() {hMutex.UnLock();}
          ~XrdOfsHandle() {int retc; Retire(retc);}
 
 private:
-static int           Alloc(XrdOfsHanKey, int Opts, XrdOfsHandle **Handle);
+
+// The handle table is split into shards by key hash, each with its own lock,
+// so that opens and closes of different files do not serialize. The link
+// count of a handle may only be changed while holding its shard's lock.
+//
+struct hanShard
+      {XrdSysMutex   sMutex;
+       XrdOfsHanTab  roTable;    // File handles open r/o
+       XrdOfsHanTab  rwTable;    // File Handles open r/w
+       int           numHan;     // Number of handles in this shard
+       int           numWait;    // Number of times the lock was contended
+       char          pad[64];    // Keep shards on separate cache lines
+
+       hanShard() : roTable(89, 144), rwTable(89, 144),
+                    numHan(0), numWait(0) {}
+      };
+
+static int           Alloc(const XrdOfsHanKey &theKey, int Opts,
+                           XrdOfsHandle **Handle);
+static hanShard     &ShardLock(unsigned int hVal);
+inline hanShard     &ShardLock() {return ShardLock(Path.Hash);}
        int           WaitLock(void);
 
 static const int     LockTries =   3; // Times to try for a lock
 static const int     LockWait  = 333; // Mills to wait between tries
 static const int     nolokDelay=   3; // Secs to delay client when lock failed
 static const int     nomemDelay=  15; // Secs to delay client when ENOMEM
+static const int     hanShards =  64; // Number of handle table shards
 
-static XrdSysMutex   myMutex;
-static XrdOfsHanTab  roTable;    // File handles open r/o
-static XrdOfsHanTab  rwTable;    // File Handles open r/w
+static hanShard      hanTab[hanShards];
+static XrdSysMutex   freeMutex;
 static XrdOssDF     *ossDF;      // Dummy storage sysem
 static XrdOfsHandle *Free;       // List of free handles
 
@@ -51,6 +51,7 @@
 /******************************************************************************/
 
 XrdOfsPoscq::XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn)
+                        : syncCV(0, "poscq sync")
 {
    eDest = erp;
    ossFS = oss;
@@ -59,6 +60,9 @@ XrdOfsPoscq::XrdOfsPoscq(XrdSysError *erp, XrdOss *oss, const char *fn)
    pocSZ = 0;
    pocIQ = 0;
    SlotList = SlotLust = 0;
+   syncReq = syncDone = 0;
+   syncFails = 0;
+   syncBusy = false;
 }
   
 /******************************************************************************/
@@ -90,9 +94,9 @@ int XrdOfsPoscq::Add(const char *Tident, const char *Lfn)
    pocIQ++;
    myMutex.UnLock();
 
-// Write out the record
+// Write out the record and make it durable. Concurrent additions share fsyncs.
 //
-   if (!reqWrite((void *)&tmpReq, sizeof(tmpReq), fP))
+   if (!reqWrite((void *)&tmpReq, sizeof(tmpReq), fP) || !Sync())
       {eDest->Emsg("Add", Lfn, "not added to the persist queue.");
        myMutex.Lock(); pocIQ--; myMutex.UnLock();
        return -EIO;
@@ -286,8 +290,6 @@ int XrdOfsPoscq::reqWrite(void *Buff, int Bsz, int Offs)
 
    do {rc = pwrite(pocFD, Buff, Bsz, Offs);} while(rc < 0 && errno == EINTR);
 
-   if (rc >= 0 && Bsz > 8) rc = fsync(pocFD);
-
    if (rc < 0) {eDest->Emsg("reqWrite",errno,"write", pocFN); return 0;}
    return 1;
 }
@@ -313,7 +315,7 @@ int XrdOfsPoscq::ReWrite(XrdOfsPoscq::recEnt *rP)
    oldFD = pocFD; pocFD = newFD;
    oldFN = pocFN; pocFN = newFN;
 
-// Rewrite all records if we have any
+// Rewrite all records if we have any and sync them all at once
 //
    while(rP)
         {rP->Offset = Offs;
@@ -321,6 +323,8 @@ int XrdOfsPoscq::ReWrite(XrdOfsPoscq::recEnt *rP)
          Offs += ReqSize;
          rP = rP->Next;
         }
+   if (aOK && fsync(pocFD))
+      {eDest->Emsg("ReWrite",errno,"sync",newFN); aOK = 0;}
 
 // If all went well, rename the file
 //
@@ -336,6 +340,48 @@ int XrdOfsPoscq::ReWrite(XrdOfsPoscq::recEnt *rP)
    return aOK;
 }
 
+/******************************************************************************/
+/*                                  S y n c                                   */
+/******************************************************************************/
+
+int XrdOfsPoscq::Sync()
+{
+   long long myTicket, myFails, lastTicket;
+   int rc;
+
+// Take a ticket. Any write that completed before this point will be covered
+// by the first fsync that starts after we get the ticket. We also note how
+// many fsyncs failed so far; should any fsync fail before ours is done, even
+// one that started before we got the ticket, our write may not be durable.
+//
+   syncCV.Lock();
+   myTicket = ++syncReq;
+   myFails  = syncFails;
+
+// Wait until an fsync covering our ticket has completed. If no one is doing
+// an fsync, we do it for everyone that is waiting. Callers that arrive while
+// an fsync is in progress are all handled by the next one. So, at most two
+// fsyncs are ever waited for and only one runs at any one time.
+//
+   while(syncDone < myTicket)
+        {if (syncBusy) {syncCV.Wait(); continue;}
+         syncBusy = true; lastTicket = syncReq;
+         syncCV.UnLock();
+         do {rc = fsync(pocFD);} while(rc < 0 && errno == EINTR);
+         if (rc < 0) eDest->Emsg("Sync", errno, "sync", pocFN);
+         syncCV.Lock();
+         if (rc < 0) syncFails++;
+         syncDone = lastTicket; syncBusy = false;
+         syncCV.Broadcast();
+        }
+
+// Determine whether all fsyncs that ended since we got our ticket worked
+//
+   rc = (syncFails == myFails);
+   syncCV.UnLock();
+   return rc;
+}
+
 /******************************************************************************/
 /*                             V e r O f f s e t                              */
 /******************************************************************************/
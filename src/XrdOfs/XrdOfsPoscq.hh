@@ -80,6 +80,7 @@ void   FailIni(const char *lfn);
 int    reqRead(void *Buff, int Offs);
 int    reqWrite(void *Buff, int Bsz, int Offs);
 int    ReWrite(recEnt *rP);
+int    Sync();
 int    VerOffset(const char *Lfn, int Offset);
 
 struct FileSlot
@@ -88,6 +89,16 @@ struct FileSlot
       };
 
 XrdSysMutex  myMutex;
+
+// Group commit state. Each Sync() caller takes a ticket; one caller at a time
+// runs fsync() on behalf of all tickets issued before it started.
+//
+XrdSysCondVar syncCV;
+long long    syncReq;    // Last ticket handed out
+long long    syncDone;   // Last ticket covered by a completed fsync
+long long    syncFails;  // Number of failed fsyncs
+bool         syncBusy;   // An fsync is in progress
+
 XrdSysError *eDest;
 XrdOss      *ossFS;
 FileSlot    *SlotList;
@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 
+#include "XrdOfs/XrdOfsHandle.hh"
 #include "XrdOfs/XrdOfsStats.hh"
 
 /******************************************************************************/
@@ -40,12 +41,13 @@ int XrdOfsStats::Report(char *buff, int blen)
     static const char stats1[] = "<stats id=\"ofs\"><role>%s</role>"
            "<opr>%d</opr><opw>%d</opw><opp>%d</opp><ups>%d</ups><han>%d</han>"
            "<rdr>%d</rdr><bxq>%d</bxq><rep>%d</rep><err>%d</err><dly>%d</dly>"
-           "<sok>%d</sok><ser>%d</ser>"
+           "<sok>%d</sok><ser>%d</ser><hwt>%d</hwt>"
            "<tpc><grnt>%d</grnt><deny>%d</deny><err>%d</err><exp>%d</exp></tpc>"
            "</stats>";
-    static const int  statsz = sizeof(stats1) + (12*10) + 64;
+    static const int  statsz = sizeof(stats1) + (18*10) + 64;
 
     StatsData myData;
+    int       numWait;
 
 // If only the size is wanted, return the size
 //
@@ -61,13 +63,17 @@ int XrdOfsStats::Report(char *buff, int blen)
    myData = Data;
    sdMutex.UnLock();
 
+// The handle counts are kept by the handle table itself
+//
+   XrdOfsHandle::TableStats(myData.numHandles, numWait);
+
 // Format the buffer
 //
    return sprintf(buff, stats1, myRole, myData.numOpenR,   myData.numOpenW,
                     myData.numOpenP,    myData.numUnpsist, myData.numHandles,
                     myData.numRedirect, myData.numStarted, myData.numReplies,
                     myData.numErrors,   myData.numDelays,
-                    myData.numSeventOK, myData.numSeventER,
+                    myData.numSeventOK, myData.numSeventER, numWait,
                     myData.numTPCgrant, myData.numTPCdeny,
                     myData.numTPCerrs,  myData.numTPCexpr);
 }
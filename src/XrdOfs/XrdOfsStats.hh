@@ -43,7 +43,7 @@ int         numOpenR;   // Read
 int         numOpenW;   // Write
 int         numOpenP;   // Posc
 int         numUnpsist; // Posc
-int         numHandles;
+int         numHandles; // Filled in from the handle table
 int         numRedirect;
 int         numStarted;
 int         numReplies;
@@ -65,9 +65,12 @@ namespace XrdOfsTPCParms
 {
 char              *XfrProg  = 0;
 char              *cksType  = 0;
+char              *EngLib   = 0;
+char              *EngParms = 0;
 int                LogOK    = 0;
 int                nStrms   = 0;
 int                xfrMax   = 9;
+int                hostMax  = 0;
 int                tpcOK    = 0;
 int                encTPC   = 0;
 int                errMon   =-3;
@@ -343,6 +346,24 @@ void XrdOfsTPC::Init(XrdOfsTPC::iParm &Parms)
        XfrProg = strdup(Parms.Pgm);
       }
 
+// Set the copy engine if specified. The library path is followed by optional
+// parameters. Without a path we use the engine that is based on XrdCl.
+//
+   if (Parms.Eng)
+      {char *sP;
+       if (EngLib) free(EngLib);
+       if (EngParms) {free(EngParms); EngParms = 0;}
+       while(*Parms.Eng == ' ') Parms.Eng++;
+       if (!*Parms.Eng) EngLib = strdup("libXrdOfsTPCCl.so");
+          else {EngLib = strdup(Parms.Eng);
+                if ((sP = index(EngLib, ' ')))
+                   {*sP++ = 0;
+                    while(*sP == ' ') sP++;
+                    if (*sP) EngParms = strdup(sP);
+                   }
+               }
+      }
+
 // Set checksum type if specified
 //
    if (Parms.Ckst)
@@ -357,6 +378,7 @@ void XrdOfsTPC::Init(XrdOfsTPC::iParm &Parms)
    if (Parms.Logok  >= 0) LogOK  = Parms.Logok;
    if (Parms.Strm   >  0) nStrms = Parms.Strm;
    if (Parms.Xmax   >  0) xfrMax = Parms.Xmax;
+   if (Parms.Hmax   >= 0) hostMax= Parms.Hmax;
    if (Parms.Grab   <  0) errMon = Parms.Grab;
    if (Parms.xEcho  >= 0) doEcho = Parms.xEcho != 0;
    if (Parms.autoRM >= 0) autoRM = Parms.autoRM != 0;
@@ -448,9 +470,10 @@ int XrdOfsTPC::Start()
 //
    if (RPList) RPList->Default(1);
 
-// If there is no copy program then we use the default one
+// If there is no copy program then we use the default one (it is not used if
+// an in-process copy engine has been configured).
 //
-   if (!XfrProg)
+   if (!XfrProg && !EngLib)
       {char pgmBuff[256], sBuff[32];
        if (nStrms) sprintf(sBuff, " -S %d", nStrms);
           else *sBuff = 0;
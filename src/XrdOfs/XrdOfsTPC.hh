@@ -74,17 +74,19 @@ virtual void  Del() {}
 
 struct  iParm {char *Pgm;
                char *Ckst;
+               char *Eng;
                int   Dflttl;
                int   Maxttl;
                int   Logok;
                int   Strm;
                int   Xmax;
+               int   Hmax;
                int   Grab;
                int   xEcho;
                int   autoRM;
-                     iParm() : Pgm(0), Ckst(0), Dflttl(-1), Maxttl(-1),
-                               Logok(-1), Strm(-1), Xmax(-1), Grab(0), 
-                               xEcho(-1), autoRM(-1) {}
+                     iParm() : Pgm(0), Ckst(0), Eng(0), Dflttl(-1), Maxttl(-1),
+                               Logok(-1), Strm(-1), Xmax(-1), Hmax(-1),
+                               Grab(0), xEcho(-1), autoRM(-1) {}
               };
 
 static  void  Init(iParm &Parms);
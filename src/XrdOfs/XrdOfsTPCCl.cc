@@ -0,0 +1,170 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O f s T P C C l . c c                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "XProtocol/XProtocol.hh"
+#include "XrdCl/XrdClCopyProcess.hh"
+#include "XrdCl/XrdClDefaultEnv.hh"
+#include "XrdCl/XrdClPropertyList.hh"
+#include "XrdOfs/XrdOfsTPCEngine.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdVersion.hh"
+
+/******************************************************************************/
+/*                         L o c a l   C l a s s e s                          */
+/******************************************************************************/
+
+namespace
+{
+class XrdOfsTPCClMon : public XrdCl::CopyProgressHandler
+{
+public:
+
+void JobProgress(uint16_t jobNum, uint64_t bDone, uint64_t bTotal)
+                {(void)jobNum;
+                 myMon.Progress((long long)bDone, (long long)bTotal);
+                }
+
+bool ShouldCancel(uint16_t jobNum) {(void)jobNum; return myMon.Cancelled();}
+
+     XrdOfsTPCClMon(XrdOfsTPCEngine::Monitor &mon) : myMon(mon) {}
+    ~XrdOfsTPCClMon() {}
+
+private:
+XrdOfsTPCEngine::Monitor &myMon;
+};
+
+class XrdOfsTPCCl : public XrdOfsTPCEngine
+{
+public:
+
+int  Copy(const char *src, const char *dst, const char *cks,
+          int nStrm, Monitor &mon, char *eBuff, int eBlen);
+
+     XrdOfsTPCCl(XrdSysError *eP) : eDest(eP), strmSet(false) {}
+    ~XrdOfsTPCCl() {}
+
+private:
+
+void SetStreams(int nStrm);
+
+XrdSysError *eDest;
+XrdSysMutex  strmMutex;
+bool         strmSet;
+};
+}
+
+/******************************************************************************/
+/*                                  C o p y                                   */
+/******************************************************************************/
+
+int XrdOfsTPCCl::Copy(const char *src, const char *dst, const char *cks,
+                      int nStrm, Monitor &mon, char *eBuff, int eBlen)
+{
+   XrdCl::CopyProcess  copyProc;
+   XrdCl::PropertyList props, results;
+   XrdCl::XRootDStatus st;
+   XrdOfsTPCClMon      clMon(mon);
+
+// Set the number of streams, if so wanted
+//
+   if (nStrm > 1) SetStreams(nStrm);
+
+// Describe the copy. The destination has already been created for us.
+//
+   props.Set("source", src);
+   props.Set("target", dst);
+   props.Set("force",  true);
+
+// Request checksum verification if a checksum was specified
+//
+   if (cks)
+      {std::string cksType(cks), cksVal;
+       std::string::size_type cPos = cksType.find(':');
+       if (cPos != std::string::npos)
+          {cksVal = cksType.substr(cPos+1); cksType.erase(cPos);}
+       props.Set("checkSumMode", "end2end");
+       props.Set("checkSumType", cksType);
+       if (cksVal.size()) props.Set("checkSumPreset", cksVal);
+      }
+
+// Prepare the job and run it in this thread
+//
+   if ((st = copyProc.AddJob(props, &results)).IsOK()
+   &&  (st = copyProc.Prepare()).IsOK()) st = copyProc.Run(&clMon);
+
+// Check how things went
+//
+   if (st.IsOK()) return 0;
+   snprintf(eBuff, eBlen, "%s", st.ToStr().c_str());
+   char *eP = eBuff + strlen(eBuff);
+   while(eP > eBuff && *(eP-1) == '\n') *(--eP) = 0;
+   if (mon.Cancelled()) return ECANCELED;
+   if (st.code == XrdCl::errErrorResponse) return XProtocol::toErrno(st.errNo);
+   return (st.errNo ? st.errNo : EIO);
+}
+
+/******************************************************************************/
+/*                            S e t S t r e a m s                             */
+/******************************************************************************/
+
+void XrdOfsTPCCl::SetStreams(int nStrm)
+{
+   XrdSysMutexHelper strmHelp(strmMutex);
+
+// The number of substreams is a client-wide setting. So, set it only once.
+//
+   if (!strmSet)
+      {XrdCl::DefaultEnv::GetEnv()->PutInt("SubStreamsPerChannel", nStrm);
+       strmSet = true;
+      }
+}
+
+/******************************************************************************/
+/*                    X r d O f s T P C G e t E n g i n e                     */
+/******************************************************************************/
+
+extern "C"
+{
+XrdOfsTPCEngine *XrdOfsTPCGetEngine(XrdSysError *eDest, const char *parms)
+{
+   (void)parms;
+   eDest->Say("Config using in-process XrdCl third party copy engine.");
+   return new XrdOfsTPCCl(eDest);
+}
+}
+
+XrdVERSIONINFO(XrdOfsTPCGetEngine, TPC-XrdCl);
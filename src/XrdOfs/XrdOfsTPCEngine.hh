@@ -0,0 +1,128 @@
+#ifndef __XRDOFSTPCENGINE_HH__
+#define __XRDOFSTPCENGINE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d O f s T P C E n g i n e . h h                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+//------------------------------------------------------------------------------
+//! The XrdOfsTPCEngine class defines the interface to an in-process third
+//! party copy engine. When one is configured (i.e. ofs.tpc engine) each copy
+//! is executed by calling Copy() in a tpc job thread instead of forking the
+//! copy program. This avoids process startup, allows connections to be shared
+//! among copies, and lets the engine report progress as the copy proceeds.
+//------------------------------------------------------------------------------
+
+class XrdSysError;
+
+class XrdOfsTPCEngine
+{
+public:
+
+//------------------------------------------------------------------------------
+//! The Monitor object is supplied by the caller of Copy(). The engine should
+//! periodically report progress and check whether it should abort the copy.
+//------------------------------------------------------------------------------
+
+class Monitor
+{
+public:
+
+//------------------------------------------------------------------------------
+//! Check whether the copy has been cancelled.
+//!
+//! @return true  The copy should be aborted as soon as possible.
+//! @return false Continue with the copy.
+//------------------------------------------------------------------------------
+
+virtual bool Cancelled() = 0;
+
+//------------------------------------------------------------------------------
+//! Report copy progress.
+//!
+//! @param  bDone  Number of bytes copied so far.
+//! @param  bTotal Total number of bytes to copy, if known (zero otherwise).
+//------------------------------------------------------------------------------
+
+virtual void Progress(long long bDone, long long bTotal) = 0;
+
+             Monitor() {}
+virtual     ~Monitor() {}
+};
+
+//------------------------------------------------------------------------------
+//! Copy a file.
+//!
+//! @param  src    The source url. It carries the tpc rendezvous cgi.
+//! @param  dst    The local physical path of the destination file. The file
+//!                has already been created and is to be overwritten.
+//! @param  cks    The checksum to be verified as "<type>[:<value>]" or nil if
+//!                no checksum is to be verified.
+//! @param  nStrm  The number of TCP streams to use (0 -> engine default).
+//! @param  mon    Reference to the monitor for this copy.
+//! @param  eBuff  Buffer to receive an error message should the copy fail.
+//! @param  eBlen  Size of the buffer.
+//!
+//! @return =0     The copy succeeded.
+//! @return !0     The errno value describing why the copy failed.
+//------------------------------------------------------------------------------
+
+virtual int  Copy(const char *src, const char *dst, const char *cks,
+                  int nStrm, Monitor &mon, char *eBuff, int eBlen) = 0;
+
+             XrdOfsTPCEngine() {}
+virtual     ~XrdOfsTPCEngine() {}
+};
+
+/******************************************************************************/
+/*                    X r d O f s T P C G e t E n g i n e                     */
+/******************************************************************************/
+
+//------------------------------------------------------------------------------
+//! Obtain an instance of the copy engine. The engine must be thread safe as a
+//! single instance is used for all concurrent copies.
+//!
+//! @param  eDest  Pointer to the error message object.
+//! @param  parms  Pointer to the parameters specified after the library path
+//!                in the ofs.tpc engine option (may be nil).
+//!
+//! @return Pointer to the engine or nil if it could not be initialized.
+//!
+//! extern "C"
+//! {
+//! XrdOfsTPCEngine *XrdOfsTPCGetEngine(XrdSysError *eDest, const char *parms);
+//! }
+//!
+//! Declare the compilation version number using:
+//!
+//! XrdVERSIONINFO(XrdOfsTPCGetEngine, <name>);
+//------------------------------------------------------------------------------
+
+typedef XrdOfsTPCEngine *(*XrdOfsTPCGetEngine_t)(XrdSysError *, const char *);
+#endif
@@ -57,6 +57,7 @@ XrdOfsTPCJob::XrdOfsTPCJob(const char *Url, const char *Org,
                            const char *Lfn, const char *Pfn,
                            const char *Cks, short lfnLoc[2])
                           : XrdOfsTPC(Url, Org, Lfn, Pfn, Cks), myProg(0),
+                            xfrDone(0), xfrSize(0), xfrBeg(0),
                             Status(isWaiting)
 {  lfnPos[0] = lfnLoc[0]; lfnPos[1] = lfnLoc[1]; }
   
@@ -102,9 +103,10 @@ XrdOfsTPCJob *XrdOfsTPCJob::Done(XrdOfsTPCProg *pgmP, const char *eTxt, int rc)
    XrdSysMutexHelper jobMon(&jobMutex);
    XrdOfsTPCJob *jP;
 
-// Indicate job status
+// Indicate job status and make the program usable for another job
 //
    eCode = rc; Status = isDone;
+   pgmP->Reset();
    if (Info.Key) free(Info.Key);
    Info.Key = (rc ? strdup(eTxt) : 0);
 
@@ -132,6 +134,20 @@ XrdOfsTPCJob *XrdOfsTPCJob::Done(XrdOfsTPCProg *pgmP, const char *eTxt, int rc)
    return jP;
 }
 
+/******************************************************************************/
+/*                              P r o g r e s s                               */
+/******************************************************************************/
+
+void XrdOfsTPCJob::Progress(long long bDone, long long bTotal)
+{
+// This is called frequently by the copy engine so we do not lock anything.
+// The values are only used as a hint so a torn read does no harm.
+//
+   if (!xfrBeg) xfrBeg = time(0);
+   xfrDone = bDone;
+   xfrSize = bTotal;
+}
+
 /******************************************************************************/
 /*                                  S y n c                                   */
 /******************************************************************************/
@@ -146,7 +162,7 @@ int XrdOfsTPCJob::Sync(XrdOucErrInfo *eRR)
 //
    if (Status == isRunning)
       {if (Info.SetCB(eRR)) return SFS_ERROR;
-       eRR->setErrCode(cbWaitTime);
+       eRR->setErrCode(WaitTime(cbWaitTime));
        return SFS_STARTED;
       }
 
@@ -182,3 +198,21 @@ int XrdOfsTPCJob::Sync(XrdOucErrInfo *eRR)
    inQ = 1; eRR->setErrCode(cbWaitTime);
    return SFS_STARTED;
 }
+
+/******************************************************************************/
+/* Private:                     W a i t T i m e                               */
+/******************************************************************************/
+
+int XrdOfsTPCJob::WaitTime(int maxWait)
+{
+   long long bDone = xfrDone, bLeft = xfrSize - bDone, tLeft;
+   time_t tNow = time(0);
+
+// If the copy engine reported progress, estimate how much longer the copy will
+// take. This is only a hint to the client, so we are generous with it.
+//
+   if (!xfrBeg || bDone <= 0 || bLeft <= 0 || tNow <= xfrBeg) return maxWait;
+   tLeft = (tNow - xfrBeg) * bLeft / bDone;
+   tLeft = tLeft * 2 + 30;
+   return (tLeft < maxWait ? static_cast<int>(tLeft) : maxWait);
+}
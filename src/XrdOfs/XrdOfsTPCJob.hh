@@ -30,6 +30,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
   
+#include <time.h>
+
 #include "XrdOfs/XrdOfsTPC.hh"
 #include "XrdSys/XrdSysPthread.hh"
 
@@ -43,6 +45,8 @@ void          Del();
 
 XrdOfsTPCJob *Done(XrdOfsTPCProg *pgmP, const char *eTxt, int rc);
 
+void          Progress(long long bDone, long long bTotal);
+
 int           Sync(XrdOucErrInfo *eRR);
 
               XrdOfsTPCJob(const char *Url, const char *Org,
@@ -52,11 +56,16 @@ int           Sync(XrdOucErrInfo *eRR);
              ~XrdOfsTPCJob() {}
 
 private:
+int           WaitTime(int maxWait);
+
 static XrdSysMutex        jobMutex;
 static XrdOfsTPCJob      *jobQ;
 static XrdOfsTPCJob      *jobLast;
        XrdOfsTPCJob      *Next;
        XrdOfsTPCProg     *myProg;
+       long long          xfrDone;   // Bytes copied so far
+       long long          xfrSize;   // Bytes to copy (0 if not known)
+       time_t             xfrBeg;    // Time progress was first reported
        int                eCode;
 enum   jobStat {isWaiting, isRunning, isDone};
        jobStat            Status;
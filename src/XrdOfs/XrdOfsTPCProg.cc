@@ -28,15 +28,21 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <time.h>
   
+#include "XrdVersion.hh"
 #include "XrdOfs/XrdOfsTPC.hh"
 #include "XrdOfs/XrdOfsTPCJob.hh"
 #include "XrdOfs/XrdOfsTPCProg.hh"
 #include "XrdOfs/XrdOfsTrace.hh"
 #include "XrdOss/XrdOss.hh"
 #include "XrdOuc/XrdOucCallBack.hh"
+#include "XrdOuc/XrdOucPinLoader.hh"
 #include "XrdOuc/XrdOucProg.hh"
 #include "XrdOuc/XrdOucTrace.hh"
 #include "XrdSys/XrdSysError.hh"
@@ -50,11 +56,17 @@ extern XrdSysError  OfsEroute;
 extern XrdOucTrace  OfsTrace;
 extern XrdOss      *XrdOfsOss;
 
+XrdVERSIONINFOREF(XrdOfs);
+
 namespace XrdOfsTPCParms
 {
 extern char        *XfrProg;
 extern char        *cksType;
+extern char        *EngLib;
+extern char        *EngParms;
+extern int          nStrms;
 extern int          xfrMax;
+extern int          hostMax;
 extern int          errMon;
 extern bool         doEcho;
 extern bool         autoRM;
@@ -68,6 +80,13 @@ using namespace XrdOfsTPCParms;
   
 XrdSysMutex        XrdOfsTPCProg::pgmMutex;
 XrdOfsTPCProg     *XrdOfsTPCProg::pgmIdle  = 0;
+XrdSysCondVar      XrdOfsTPCProg::hostCV(0);
+XrdOfsTPCProg::hostSlot *XrdOfsTPCProg::hostList = 0;
+
+namespace
+{
+XrdOfsTPCEngine   *xfrEng = 0;
+}
 
 /******************************************************************************/
 /*                     E x t e r n a l   L i n k a g e s                      */
@@ -87,11 +106,88 @@ void *XrdOfsTPCProgRun(void *pp)
 XrdOfsTPCProg::XrdOfsTPCProg(XrdOfsTPCProg *Prev, int num, int errMon)
              : Prog(&OfsEroute, errMon),
                JobStream(&OfsEroute),
-               Next(Prev), Job(0)
+               Next(Prev), Job(0), lastEcho(0), isCan(false)
              {snprintf(Pname, sizeof(Pname), "TPC job %d: ", num);
               Pname[sizeof(Pname)-1] = 0;
              }
 
+/******************************************************************************/
+/*                                C a n c e l                                 */
+/******************************************************************************/
+
+void XrdOfsTPCProg::Cancel()
+{
+// Indicate the copy is to be cancelled. Kill the copy program if we are using
+// one and wake up anyone waiting for a host slot so they notice this.
+//
+   isCan = true;
+   if (!xfrEng) JobStream.Drain();
+   if (hostMax) {hostCV.Lock(); hostCV.Broadcast(); hostCV.UnLock();}
+}
+
+/******************************************************************************/
+/* Private:                     H o s t D r o p                               */
+/******************************************************************************/
+
+void XrdOfsTPCProg::HostDrop(const char *hName)
+{
+   XrdSysCondVarHelper hostHelp(hostCV);
+   hostSlot *hP = hostList;
+
+// Find the slot and release our hold on it. We keep the slot around as hosts
+// tend to be reused and their number is small.
+//
+   while(hP && strcmp(hP->host, hName)) hP = hP->next;
+   if (hP && hP->active > 0) hP->active--;
+   hostCV.Broadcast();
+}
+
+/******************************************************************************/
+/* Private:                     H o s t H o l d                               */
+/******************************************************************************/
+
+bool XrdOfsTPCProg::HostHold(const char *hName)
+{
+   XrdSysCondVarHelper hostHelp(hostCV);
+   hostSlot *hP = hostList;
+
+// Find the slot for this host, adding one if need be
+//
+   while(hP && strcmp(hP->host, hName)) hP = hP->next;
+   if (!hP)
+      {hP = new hostSlot;
+       hP->next = hostList; hP->host = strdup(hName); hP->active = 0;
+       hostList = hP;
+      }
+
+// Wait until the host has room for another transfer or we are cancelled
+//
+   while(hP->active >= hostMax && !isCan) hostCV.Wait();
+   if (isCan) return false;
+   hP->active++;
+   return true;
+}
+
+/******************************************************************************/
+/* Private:                     H o s t N a m e                               */
+/******************************************************************************/
+
+void XrdOfsTPCProg::HostName(char *hBuff, int hBlen)
+{
+   const char *hP = Job->Info.Key, *eP;
+   int n;
+
+// The source is a url of the form <prot>://[<user>@]<host>[:<port>]/<path>.
+// We use the host and port as the key to limit transfers from a host.
+//
+   if ((eP = strstr(hP, "://"))) hP = eP+3;
+   if (!(eP = index(hP, '/'))) eP = hP + strlen(hP);
+   for (const char *aP = hP; aP < eP; aP++) if (*aP == '@') hP = aP+1;
+   n = eP - hP;
+   if (n >= hBlen) n = hBlen-1;
+   strncpy(hBuff, hP, n); hBuff[n] = 0;
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -100,11 +196,21 @@ int XrdOfsTPCProg::Init()
 {
    int n;
 
-// Allocate copy program objects
+// Load the in-process copy engine if one has been specified
+//
+   if (EngLib)
+      {XrdOucPinLoader myLib(&OfsEroute, &XrdVERSIONINFOVAR(XrdOfs),
+                             "tpc engine", EngLib);
+       XrdOfsTPCGetEngine_t ep;
+       if (!(ep = (XrdOfsTPCGetEngine_t)myLib.Resolve("XrdOfsTPCGetEngine"))
+       ||  !(xfrEng = ep(&OfsEroute, EngParms))) return 0;
+      }
+
+// Allocate copy program objects. Programs are not needed with an engine.
 //
    for (n = 0; n < xfrMax; n++)
        {pgmIdle = new XrdOfsTPCProg(pgmIdle, n, errMon);
-        if (pgmIdle->Prog.Setup(XfrProg, &OfsEroute)) return 0;
+        if (!xfrEng && pgmIdle->Prog.Setup(XfrProg, &OfsEroute)) return 0;
        }
 
 // All done
@@ -113,6 +219,28 @@ int XrdOfsTPCProg::Init()
    return 1;
 }
 
+/******************************************************************************/
+/*                              P r o g r e s s                               */
+/******************************************************************************/
+
+void XrdOfsTPCProg::Progress(long long bDone, long long bTotal)
+{
+   time_t tNow;
+
+// Record the progress in the job so that sync requests can use it
+//
+   Job->Progress(bDone, bTotal);
+
+// Echo the progress about once a minute if so wanted
+//
+   if (doEcho && (tNow = time(0)) - lastEcho >= 60)
+      {char buff[80];
+       lastEcho = tNow;
+       snprintf(buff, sizeof(buff), "%lld of %lld bytes copied", bDone, bTotal);
+       OfsEroute.Say(Pname, buff);
+      }
+}
+
 /******************************************************************************/
 /*                                   R u n                                    */
 /******************************************************************************/
@@ -151,6 +279,7 @@ XrdOfsTPCProg *XrdOfsTPCProg::Start(XrdOfsTPCJob *jP, int &rc)
 //
    if (!(pgmP = pgmIdle)) {rc = 0; return 0;}
    pgmP->Job = jP;
+   pgmP->isCan = false;
 
 // Start a thread to run the job
 //
@@ -170,9 +299,7 @@ XrdOfsTPCProg *XrdOfsTPCProg::Start(XrdOfsTPCJob *jP, int &rc)
   
 int XrdOfsTPCProg::Xeq()
 {
-   EPNAME("Xeq");
-   const char *cksOpt;
-   char *lP, *Colon, *cksVal, *tident = Job->Info.Org;
+   char *cksVal, *tident = Job->Info.Org, hName[256];
    int rc;
 
 // Echo out what we are doing if so desired
@@ -187,20 +314,81 @@ int XrdOfsTPCProg::Xeq()
 // Determine checksum option
 //
    cksVal = (Job->Info.Cks ? Job->Info.Cks : XrdOfsTPCParms::cksType);
-   cksOpt = (cksVal ? "-C" : 0);
+
+// Limit the number of concurrent copies from the same source host if need be
+//
+   if (hostMax)
+      {HostName(hName, sizeof(hName));
+       if (!HostHold(hName))
+          {strcpy(eRec, "Copy cancelled.");
+           return ECANCELED;
+          }
+      }
+
+// Do the copy using the engine or the copy program, as configured
+//
+   *eRec = 0;
+   rc = (xfrEng ? XeqEng(cksVal) : XeqPgm(cksVal));
+   if (hostMax) HostDrop(hName);
+
+// Check if we should generate a message
+//
+   if (rc && !(*eRec)) sprintf(eRec, "Copy failed with return code %d", rc);
+
+// Log failures and optionally remove the file
+//
+   if (rc)
+      {OfsEroute.Emsg("TPC", Job->Info.Org, Job->Info.Lfn, eRec);
+       if (autoRM) XrdOfsOss->Unlink(Job->Info.Dst, XRDOSS_isPFN);
+      }
+
+// All done
+//
+   return rc;
+}
+
+/******************************************************************************/
+/* Private:                       X e q E n g                                 */
+/******************************************************************************/
+
+int XrdOfsTPCProg::XeqEng(const char *cksVal)
+{
+   EPNAME("XeqEng");
+   const char *tident = Job->Info.Org;
+   int rc;
+
+// Run the copy in this thread. The engine reports progress and checks for
+// cancellation via our monitor interface.
+//
+   lastEcho = time(0);
+   rc = xfrEng->Copy(Job->Info.Key, Job->Info.Dst, cksVal, nStrms, *this,
+                     eRec, sizeof(eRec));
+   if (rc < 0) rc = -rc;
+   DEBUG(Pname <<"ended with rc=" <<rc);
+   return rc;
+}
+
+/******************************************************************************/
+/* Private:                       X e q P g m                                 */
+/******************************************************************************/
+
+int XrdOfsTPCProg::XeqPgm(const char *cksVal)
+{
+   EPNAME("XeqPgm");
+   const char *cksOpt = (cksVal ? "-C" : 0), *tident = Job->Info.Org;
+   char *lP, *Colon;
+   int rc;
 
 // Start the job.
 //
    if ((rc = Prog.Run(&JobStream,cksOpt,cksVal,Job->Info.Key,Job->Info.Dst)))
       {strcpy(eRec, "Copy failed; unable to start job.");
-       OfsEroute.Emsg("TPC", Job->Info.Org, Job->Info.Lfn, eRec);
        return rc;
       }
 
 // Now we drain the output looking for an end of run line. This line should
 // be printed as an error message should the copy fail.
 //
-   *eRec = 0;
    while((lP = JobStream.GetLine()))
         {if ((Colon = index(lP, ':')) && *(Colon+1) == ' ')
             {strncpy(eRec, Colon+2, sizeof(eRec)); eRec[sizeof(eRec)-1] = 0;}
@@ -211,19 +399,5 @@ int XrdOfsTPCProg::Xeq()
 //
    if ((rc = Prog.RunDone(JobStream)) < 0) rc = -rc;
    DEBUG(Pname <<"ended with rc=" <<rc);
-
-// Check if we should generate a message
-//
-   if (rc && !(*eRec)) sprintf(eRec, "Copy failed with return code %d", rc);
-
-// Log failures and optionally remove the file
-//
-   if (rc)
-      {OfsEroute.Emsg("TPC", Job->Info.Org, Job->Info.Lfn, eRec);
-       if (autoRM) XrdOfsOss->Unlink(Job->Info.Dst, XRDOSS_isPFN);
-      }
-
-// All done
-//
    return rc;
 }
@@ -30,6 +30,9 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <time.h>
+
+#include "XrdOfs/XrdOfsTPCEngine.hh"
 #include "XrdOuc/XrdOucProg.hh"
 #include "XrdOuc/XrdOucStream.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -37,14 +40,20 @@
 class XrdOfsTPCJob;
 class XrdOucProg;
   
-class XrdOfsTPCProg
+class XrdOfsTPCProg : public XrdOfsTPCEngine::Monitor
 {
 public:
 
-       void      Cancel() {JobStream.Drain();}
+       void      Cancel();
+
+       bool      Cancelled() {return isCan;}
 
 static int       Init();
 
+       void      Progress(long long bDone, long long bTotal);
+
+       void      Reset() {isCan = false;}
+
        void      Run();
 
 static
@@ -57,13 +66,28 @@ XrdOfsTPCProg   *Start(XrdOfsTPCJob *jP, int &rc);
                 ~XrdOfsTPCProg() {}
 private:
 
+struct hostSlot {hostSlot   *next;
+                 char       *host;
+                 int         active;
+                };
+
+       bool      HostHold(const char *hName);
+static void      HostDrop(const char *hName);
+       void      HostName(char *hBuff, int hBlen);
+       int       XeqEng(const char *cksVal);
+       int       XeqPgm(const char *cksVal);
+
 static XrdSysMutex    pgmMutex;
 static XrdOfsTPCProg *pgmIdle;
+static XrdSysCondVar  hostCV;
+static hostSlot      *hostList;
 
        XrdOucProg     Prog;
        XrdOucStream   JobStream;
        XrdOfsTPCProg *Next;
        XrdOfsTPCJob  *Job;
+       time_t         lastEcho;
+       volatile bool  isCan;
        char           Pname[32];
        char           eRec[1024];
 };
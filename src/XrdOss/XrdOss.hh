@@ -124,6 +124,10 @@ virtual int     Fctl(int cmd, int alen, const char *args, char **resp=0)
   return -ENOTSUP;
 }
 
+//! Fctl() command: returns 1 when the data must not be sent with sendfile()
+//! using the descriptor from getFD(), 0 or -ENOTSUP otherwise.
+static const int Fctl_noSendFile = 1;
+
                 XrdOssDF() {fd = -1;}
 virtual        ~XrdOssDF() {}
 
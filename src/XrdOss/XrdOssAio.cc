@@ -44,7 +44,10 @@
 #endif
 
 #include "XrdOss/XrdOssApi.hh"
+#include "XrdOss/XrdOssMioFile.hh"
+#include "XrdOss/XrdOssRdAhead.hh"
 #include "XrdOss/XrdOssTrace.hh"
+#include "XrdOss/XrdOssUring.hh"
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysPlatform.hh"
 #include "XrdSys/XrdSysPthread.hh"
@@ -95,13 +98,24 @@ const int OSS_AIO_WRITE_DONE = SIGRTMAX;
 
 int XrdOssFile::Fsync(XrdSfsAio *aiop)
 {
+   int rc;
 
+// Use io_uring if it has been enabled
+//
+   if (XrdOssUring::Active())
+      {aiop->TIdent = tident;
+       if (!(rc = XrdOssUring::Submit(aiop, fd, XrdOssUring::opFsync)))
+          return 0;
+       if (rc != -EAGAIN) return rc;
+       {int fcnt = AioFailure++;
+        if ((fcnt & 0x3ff) == 1) OssEroute.Emsg("aio", -rc, "fsync via uring");
+       }
+      }
 #ifdef _POSIX_ASYNCHRONOUS_IO
-   int rc;
 
 // Complete the aio request block and do the operation
 //
-   if (XrdOssSys::AioAllOk)
+   else if (XrdOssSys::AioAllOk)
       {aiop->sfsAio.aio_fildes = fd;
        aiop->sfsAio.aio_sigevent.sigev_signo  = OSS_AIO_WRITE_DONE;
        aiop->TIdent = tident;
@@ -147,14 +161,40 @@ int XrdOssFile::Fsync(XrdSfsAio *aiop)
   
 int XrdOssFile::Read(XrdSfsAio *aiop)
 {
+   EPNAME("AioRead");
+   int rc, aioOK = !isUnaligned((void *)aiop->sfsAio.aio_buf,
+                                (off_t)aiop->sfsAio.aio_offset,
+                               (size_t)aiop->sfsAio.aio_nbytes);
+
+// Small memory mapped files are read by copying out of the mapping
+//
+   if (mmFile && mmFile->Copyable()) aioOK = 0;
 
+// Give readahead hints before the request is queued so they can take effect
+//
+   if (raObj) raObj->Advise(fd, (off_t)aiop->sfsAio.aio_offset,
+                                (size_t)aiop->sfsAio.aio_nbytes);
+
+// Use io_uring if it has been enabled. Unaligned direct i/o requests must be
+// done synchronously using a bounce buffer.
+//
+   if (aioOK && XrdOssUring::Active())
+      {aiop->TIdent = tident;
+       TRACE(Debug,  "Read " <<aiop->sfsAio.aio_nbytes <<'@'
+                             <<aiop->sfsAio.aio_offset <<" queued; aiocb="
+                             <<std::hex <<aiop <<std::dec);
+       if (!(rc = XrdOssUring::Submit(aiop, fd, XrdOssUring::opRead)))
+          return 0;
+       if (rc != -EAGAIN) return rc;
+       {int fcnt = AioFailure++;
+        if ((fcnt & 0x3ff) == 1) OssEroute.Emsg("aio", -rc, "read via uring");
+       }
+      }
 #ifdef _POSIX_ASYNCHRONOUS_IO
-   EPNAME("AioRead");
-   int rc;
 
 // Complete the aio request block and do the operation
 //
-   if (XrdOssSys::AioAllOk)
+   else if (aioOK && XrdOssSys::AioAllOk)
       {aiop->sfsAio.aio_fildes = fd;
        aiop->sfsAio.aio_sigevent.sigev_signo  = OSS_AIO_READ_DONE;
        aiop->TIdent = tident;
@@ -205,13 +245,31 @@ int XrdOssFile::Read(XrdSfsAio *aiop)
   
 int XrdOssFile::Write(XrdSfsAio *aiop)
 {
-#ifdef _POSIX_ASYNCHRONOUS_IO
    EPNAME("AioWrite");
-   int rc;
+   int rc, aioOK = !isUnaligned((void *)aiop->sfsAio.aio_buf,
+                                (off_t)aiop->sfsAio.aio_offset,
+                               (size_t)aiop->sfsAio.aio_nbytes);
+
+// Use io_uring if it has been enabled. Unaligned direct i/o requests must be
+// done synchronously using a bounce buffer.
+//
+   if (aioOK && XrdOssUring::Active())
+      {aiop->TIdent = tident;
+       TRACE(Debug, "Write " <<aiop->sfsAio.aio_nbytes <<'@'
+                             <<aiop->sfsAio.aio_offset <<" queued; aiocb="
+                             <<std::hex <<aiop <<std::dec);
+       if (!(rc = XrdOssUring::Submit(aiop, fd, XrdOssUring::opWrite)))
+          return 0;
+       if (rc != -EAGAIN) return rc;
+       {int fcnt = AioFailure++;
+        if ((fcnt & 0x3ff) == 1) OssEroute.Emsg("aio",-rc,"write via uring");
+       }
+      }
+#ifdef _POSIX_ASYNCHRONOUS_IO
 
 // Complete the aio request block and do the operation
 //
-   if (XrdOssSys::AioAllOk)
+   else if (aioOK && XrdOssSys::AioAllOk)
       {aiop->sfsAio.aio_fildes = fd;
        aiop->sfsAio.aio_sigevent.sigev_signo  = OSS_AIO_WRITE_DONE;
        aiop->TIdent = tident;
@@ -253,6 +311,8 @@ int XrdOssFile::Write(XrdSfsAio *aiop)
 /******************************************************************************/
 
 int   XrdOssSys::AioAllOk = 0;
+int   XrdOssSys::AioDepth = 256;
+int   XrdOssSys::AioRings = 0;
   
 #if defined(_POSIX_ASYNCHRONOUS_IO) && !defined(HAVE_SIGWTI)
 // The folowing is for sigwaitinfo() emulation
@@ -274,6 +334,15 @@ extern "C" {extern void XrdOssAioWSH(int, siginfo_t *, void *);}
 
 int XrdOssSys::AioInit()
 {
+// If io_uring was requested, use it. Should that not be possible we revert to
+// using POSIX aio as we would normally do.
+//
+   if (AioRings)
+      {if (XrdOssUring::Init(OssEroute, AioRings, AioDepth)) return 1;
+       OssEroute.Say("Config warning: io_uring unavailable; using POSIX aio.");
+       AioRings = 0;
+      }
+
 #if defined(_POSIX_ASYNCHRONOUS_IO)
    EPNAME("AioInit");
    extern void *XrdOssAioWait(void *carg);
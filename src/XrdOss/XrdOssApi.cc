@@ -37,6 +37,8 @@
 #include <signal.h>
 #include <strings.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -53,6 +55,7 @@
 #include "XrdOss/XrdOssConfig.hh"
 #include "XrdOss/XrdOssError.hh"
 #include "XrdOss/XrdOssMio.hh"
+#include "XrdOss/XrdOssRdAhead.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOucEnv.hh"
 #include "XrdOuc/XrdOucName2Name.hh"
@@ -88,6 +91,16 @@ int       XrdOssSys::runOld  = 0;
 char      XrdOssSys::tryMmap = 0;
 char      XrdOssSys::chkMmap = 0;
 
+// Unaligned direct writes read and rewrite the blocks at either end. Those of
+// a file must not interleave, whichever handle they come through, so they are
+// serialized by a lock chosen by the file's device and inode numbers.
+//
+namespace
+{
+static const int dioLockNum = 64;
+XrdSysMutex      dioLockTab[dioLockNum];
+}
+
 /******************************************************************************/
 /*                XrdOssGetSS (a.k.a. XrdOssGetStorageSystem)                 */
 /******************************************************************************/
@@ -756,9 +769,35 @@ int XrdOssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
           mopts |= OSSMIO_MLOK;
        if (popts & XRDEXP_MMAP  || Info.Attr.Flags & XrdFrcXAttrMem::memMap)
           mopts |= OSSMIO_MMAP;
+       if (!mopts && !(Oflag & (O_WRONLY | O_RDWR)) && (popts & XRDEXP_NOTRW)
+       &&  buf.st_size > 0 && buf.st_size <= XrdOssMio::Small())
+          mopts = OSSMIO_SMAL;
        if (mopts) mmFile = XrdOssMio::Map(local_path, fd, mopts);
       } else mmFile = 0;
 
+// See if data should bypass the page cache. Since requests can be arbitrary,
+// unaligned ones are handled via an aligned bounce buffer. Page alignment
+// satisfies all devices. Should the filesystem not support direct i/o we
+// simply continue to use the page cache.
+//
+   dioAlign = 0;
+#ifdef O_DIRECT
+   if (fd >= 0 && (popts & XRDEXP_DIRECT) && !mmFile && !cxobj)
+      {int fFlags = fcntl(fd, F_GETFL);
+       if (fFlags >= 0 && !fcntl(fd, F_SETFL, fFlags | O_DIRECT))
+          {dioAlign = XrdOssSS->prPSize;
+           dioLock  = (int)(((unsigned long long)buf.st_dev * 31
+                           + (unsigned long long)buf.st_ino) % dioLockNum);
+          }
+      }
+#endif
+
+// Track the access pattern to give the kernel readahead hints. This is of no
+// use when the page cache is bypassed or the file is memory mapped.
+//
+   if (fd >= 0 && !dioAlign && !mmFile && !cxobj && XrdOssRdAhead::Enabled())
+      raObj = new XrdOssRdAhead;
+
 // Return the result of this open
 //
    return (fd < 0 ? fd : XrdOssOK);
@@ -788,10 +827,11 @@ int XrdOssFile::Close(long long *retsz)
        }
     if (close(fd)) return -errno;
     if (mmFile) {XrdOssMio::Recycle(mmFile); mmFile = 0;}
+    if (raObj) {raObj->Report(tident); delete raObj; raObj = 0;}
 #ifdef XRDOSSCX
     if (cxobj) {delete cxobj; cxobj = 0;}
 #endif
-    fd = -1; FSize = -1; cacheP = 0;
+    fd = -1; FSize = -1; cacheP = 0; dioAlign = 0;
     return XrdOssOK;
 }
 
@@ -843,6 +883,12 @@ ssize_t XrdOssFile::Read(void *buff, off_t offset, size_t blen)
 
      if (fd < 0) return (ssize_t)-XRDOSS_E8004;
 
+     if (isUnaligned(buff, offset, blen)) return ReadDIO(buff, offset, blen);
+
+     if (mmFile && mmFile->Copyable()) return mmFile->Read(buff, offset, blen);
+
+     if (raObj) raObj->Advise(fd, offset, blen);
+
 #ifdef XRDOSSCX
      if (cxobj)  
         if (XrdOssSS->DirFlags & XrdOssNOSSDEC) return (ssize_t)-XRDOSS_E8021;
@@ -908,8 +954,17 @@ ssize_t XrdOssFile::ReadV(XrdOucIOVec *readV, int n)
 // Read in the vector and do a pre-advise if we support that
 //
    for (i = 0; i < n; i++)
-       {do {rdsz = pread(fd, readV[i].data, readV[i].size, readV[i].offset);}
-           while(rdsz < 0 && errno == EINTR);
+       {if (mmFile && mmFile->Copyable())
+           {rdsz = mmFile->Read(readV[i].data, readV[i].offset, readV[i].size);
+            if (rdsz < 0) errno = -rdsz;
+           }
+        else if (isUnaligned(readV[i].data, readV[i].offset, readV[i].size))
+           {rdsz = ReadDIO(readV[i].data, readV[i].offset, readV[i].size);
+            if (rdsz < 0) errno = -rdsz;
+           }
+           else do {rdsz = pread(fd, readV[i].data, readV[i].size,
+                                     readV[i].offset);
+                   } while(rdsz < 0 && errno == EINTR);
         if (rdsz < 0 || rdsz != readV[i].size)
            {totBytes =  (rdsz < 0 ? -errno : -ESPIPE); break;}
         totBytes += rdsz;
@@ -959,6 +1014,8 @@ ssize_t XrdOssFile::ReadRaw(void *buff, off_t offset, size_t blen)
 
      if (fd < 0) return (ssize_t)-XRDOSS_E8004;
 
+     if (isUnaligned(buff, offset, blen)) return ReadDIO(buff, offset, blen);
+
 #ifdef XRDOSSCX
      if (cxobj)   retval = cxobj->ReadRaw((char *)buff, blen, offset);
         else 
@@ -993,6 +1050,8 @@ ssize_t XrdOssFile::Write(const void *buff, off_t offset, size_t blen)
      if (XrdOssSS->MaxSize && (long long)(offset+blen) > XrdOssSS->MaxSize)
         return (ssize_t)-XRDOSS_E8007;
 
+     if (isUnaligned(buff, offset, blen)) return WriteDIO(buff, offset, blen);
+
      do { retval = pwrite(fd, buff, blen, offset); }
           while(retval < 0 && errno == EINTR);
 
@@ -1094,6 +1153,27 @@ int XrdOssFile::isCompressed(char *cxidp)
     return cxpgsz;
 }
 
+/******************************************************************************/
+/*                                  F c t l                                   */
+/******************************************************************************/
+
+/*
+  Function: Perform a control operation on the file.
+
+  Input:    cmd       - The operation, only Fctl_noSendFile is supported.
+
+  Output:   For Fctl_noSendFile returns 1 when the file is opened for direct
+            i/o as sendfile() would not honor it, and 0 otherwise. Returns
+            -ENOTSUP for any other operation.
+*/
+int XrdOssFile::Fctl(int cmd, int alen, const char *args, char **resp)
+{
+   (void)alen; (void)args; (void)resp;
+
+   if (cmd == XrdOssDF::Fctl_noSendFile) return (dioAlign ? 1 : 0);
+   return -ENOTSUP;
+}
+
 /******************************************************************************/
 /*                              t r u n c a t e                               */
 /******************************************************************************/
@@ -1208,3 +1288,126 @@ int XrdOssFile::Open_ufs(const char *path, int Oflag, int Mode,
 //
     return myfd;
 }
+
+/******************************************************************************/
+/*                               R e a d D I O                                */
+/******************************************************************************/
+
+/*
+  Function: Read an unaligned extent from a file opened for direct i/o.
+
+  Input:    Same as for Read().
+
+  Output:   Returns the number bytes read upon success and -errno upon failure.
+
+  Notes:    The aligned extent covering the request is read into a bounce
+            buffer and the requested bytes are copied out of it.
+*/
+
+ssize_t XrdOssFile::ReadDIO(void *buff, off_t offset, size_t blen)
+{
+   off_t  begOff = offset & ~(off_t)(dioAlign-1);
+   size_t bsz    = (offset - begOff + blen + dioAlign - 1) & ~(dioAlign-1);
+   size_t skip   = offset - begOff;
+   ssize_t retval;
+   void   *bP;
+
+// Get an aligned bounce buffer
+//
+   if (posix_memalign(&bP, dioAlign, bsz)) return (ssize_t)-ENOMEM;
+
+// Read the aligned extent and copy out what the caller wanted
+//
+   do {retval = pread(fd, bP, bsz, begOff);}
+      while(retval < 0 && errno == EINTR);
+   if (retval < 0) retval = -errno;
+      else {if ((size_t)retval <= skip) retval = 0;
+               else {retval -= skip;
+                     if ((size_t)retval > blen) retval = blen;
+                     memcpy(buff, (char *)bP + skip, retval);
+                    }
+           }
+
+// All done
+//
+   free(bP);
+   return retval;
+}
+
+/******************************************************************************/
+/*                              W r i t e D I O                               */
+/******************************************************************************/
+
+/*
+  Function: Write an unaligned extent to a file opened for direct i/o.
+
+  Input:    Same as for Write().
+
+  Output:   Returns the number of bytes written upon success and -errno o/w.
+
+  Notes:    1) The partial blocks at either end of the extent are read first so
+               that the aligned write does not clobber adjacent data. Unaligned
+               writes to the same file are serialized, across all handles, to
+               keep these read-modify-write cycles from interleaving.
+            2) The aligned write may extend the file past the requested end
+               so the file is truncated back to its proper size.
+*/
+
+ssize_t XrdOssFile::WriteDIO(const void *buff, off_t offset, size_t blen)
+{
+   XrdSysMutexHelper dioHelp(dioLockTab[dioLock]);
+   struct stat Stat;
+   off_t  begOff = offset & ~(off_t)(dioAlign-1);
+   off_t  endOff = offset + blen;
+   size_t bsz    = (endOff - begOff + dioAlign - 1) & ~(dioAlign-1);
+   off_t  tlOff  = begOff + bsz - dioAlign;
+   size_t skip   = offset - begOff;
+   ssize_t retval;
+   char  *bP;
+
+// Get the current file size as we may need to restore it
+//
+   if (fstat(fd, &Stat)) return (ssize_t)-errno;
+
+// Get an aligned bounce buffer
+//
+   if (posix_memalign((void **)&bP, dioAlign, bsz)) return (ssize_t)-ENOMEM;
+   memset(bP, 0, bsz);
+
+// Fill in the leading and trailing partial blocks from the file. Data past the
+// end of file reads as zeroes.
+//
+   if (skip && begOff < Stat.st_size)
+      {do {retval = pread(fd, bP, dioAlign, begOff);}
+          while(retval < 0 && errno == EINTR);
+       if (retval < 0) {retval = -errno; free(bP); return retval;}
+      }
+   if ((endOff & (dioAlign-1)) && (tlOff != begOff || !skip)
+   &&  tlOff < Stat.st_size)
+      {do {retval = pread(fd, bP + (tlOff - begOff), dioAlign, tlOff);}
+          while(retval < 0 && errno == EINTR);
+       if (retval < 0) {retval = -errno; free(bP); return retval;}
+      }
+
+// Merge in the caller's data and write out the aligned extent
+//
+   memcpy(bP + skip, buff, blen);
+   do {retval = pwrite(fd, bP, bsz, begOff);}
+      while(retval < 0 && errno == EINTR);
+   if (retval < 0) retval = -errno;
+      else {retval = (retval > (ssize_t)skip ? retval - skip : 0);
+            if (retval > (ssize_t)blen) retval = blen;
+           }
+   free(bP);
+
+// Trim the file back if the aligned write went past the real end, unless some
+// other write has since extended the file even further.
+//
+   if (retval > 0 && begOff + (off_t)bsz > endOff
+   &&  begOff + (off_t)bsz > Stat.st_size)
+      {off_t newSize = (endOff > Stat.st_size ? endOff : Stat.st_size);
+       if (!fstat(fd, &Stat) && Stat.st_size == begOff + (off_t)bsz
+       &&  ftruncate(fd, newSize)) retval = -errno;
+      }
+   return retval;
+}
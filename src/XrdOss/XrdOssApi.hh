@@ -80,6 +80,7 @@ class oocx_CXFile;
 class XrdSfsAio;
 class XrdOssCache_FS;
 class XrdOssMioFile;
+class XrdOssRdAhead;
   
 class XrdOssFile : public XrdOssDF
 {
@@ -96,6 +97,7 @@ int     Fstat(struct stat *);
 int     Fsync();
 int     Fsync(XrdSfsAio *aiop);
 int     Ftruncate(unsigned long long);
+int     Fctl(int cmd, int alen, const char *args, char **resp=0);
 int     getFD() {return fd;}
 off_t   getMmap(void **addr);
 int     isCompressed(char *cxidp=0);
@@ -110,22 +112,35 @@ int     Write(XrdSfsAio *aiop);
         // Constructor and destructor
         XrdOssFile(const char *tid)
                   {cxobj = 0; rawio = 0; cxpgsz = 0; cxid[0] = '\0';
-                   mmFile = 0; tident = tid;
+                   mmFile = 0; tident = tid; dioAlign = 0; dioLock = 0;
+                   raObj = 0;
                   }
 
 virtual ~XrdOssFile() {if (fd >= 0) Close();}
 
 private:
 int     Open_ufs(const char *, int, int, unsigned long long);
+ssize_t ReadDIO(void *, off_t, size_t);
+ssize_t WriteDIO(const void *, off_t, size_t);
+
+// Direct i/o requires the buffer, offset, and length to be aligned
+//
+bool    isUnaligned(const void *buff, off_t offset, size_t blen)
+                   {return dioAlign && ((long long)((size_t)buff | blen)
+                                        | (long long)offset) & (dioAlign-1);
+                   }
 
 static int      AioFailure;
 oocx_CXFile    *cxobj;
 XrdOssCache_FS *cacheP;
 XrdOssMioFile  *mmFile;
+XrdOssRdAhead  *raObj;      // Access pattern tracker or 0 if none
 const char     *tident;
 long long       FSize;
 int             rawio;
 int             cxpgsz;
+int             dioAlign;   // Direct i/o alignment or 0 if not direct
+int             dioLock;    // Lock serializing unaligned direct writes
 char            cxid[4];
 };
 
@@ -193,6 +208,8 @@ int       Stats(char *bp, int bl);
 
 static int   AioInit();
 static int   AioAllOk;
+static int   AioDepth;          // io_uring queue depth
+static int   AioRings;          // io_uring rings (0 -> use POSIX aio)
 
 static int   runOld;            // Run in backward compatability mode
 
@@ -271,6 +288,10 @@ int               prActive;  //    preread activity count
 short             prDepth;   //    preread depth
 short             prQSize;   //    preread maximum allowed
 
+long long         raMin;     //    readahead initial window
+long long         raMax;     //    readahead maximum window (0 -> off)
+bool              raDrop;    //    readahead drops pages behind the reader
+
 XrdVersionInfo   *myVersion; //    Compilation version set by constructor
    
          XrdOssSys();
@@ -282,7 +303,9 @@ protected:
 long long minalloc;          //    Minimum allocation
 int       ovhalloc;          //    Allocation overage
 int       fuzalloc;          //    Allocation fuzz
+int       ldalloc;           //    Allocation load weight
 int       cscanint;          //    Seconds between cache scans
+int       cscantmo;          //    Seconds to wait for a filesystem scan
 int       xfrspeed;          //    Average transfer speed (bytes/second)
 int       xfrovhd;           //    Minimum seconds to get a file
 int       xfrhold;           //    Second hold limit on failing requests
@@ -335,6 +358,7 @@ void   ConfigStats(XrdSysError &Eroute);
 void   ConfigStats(dev_t Devnum, char *lP);
 int    ConfigXeq(char *, XrdOucStream &, XrdSysError &);
 void   List_Path(const char *, const char *, unsigned long long, XrdSysError &);
+int    xaio(XrdOucStream &Config, XrdSysError &Eroute);
 int    xalloc(XrdOucStream &Config, XrdSysError &Eroute);
 int    xcache(XrdOucStream &Config, XrdSysError &Eroute);
 int    xcachescan(XrdOucStream &Config, XrdSysError &Eroute);
@@ -345,6 +369,7 @@ int    xmemf(XrdOucStream &Config, XrdSysError &Eroute);
 int    xnml(XrdOucStream &Config, XrdSysError &Eroute);
 int    xpath(XrdOucStream &Config, XrdSysError &Eroute);
 int    xprerd(XrdOucStream &Config, XrdSysError &Eroute);
+int    xrdahd(XrdOucStream &Config, XrdSysError &Eroute);
 int    xspace(XrdOucStream &Config, XrdSysError &Eroute, int *isCD=0);
 int    xspaceBuild(char *grp, char *fn, int isxa, XrdSysError &Eroute);
 int    xstg(XrdOucStream &Config, XrdSysError &Eroute);
@@ -35,8 +35,12 @@
 #include <strings.h>
 #include <time.h>
 #include <sys/param.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
 
 #include "XrdOss/XrdOssCache.hh"
 #include "XrdOss/XrdOssOpaque.hh"
@@ -71,9 +75,15 @@ double              XrdOssCache::fuzAlloc= 0.0;
 long long           XrdOssCache::minAlloc= 0;
 int                 XrdOssCache::fsCount = 0;
 int                 XrdOssCache::ovhAlloc= 0;
+int                 XrdOssCache::ldAlloc = 0;
 int                 XrdOssCache::Quotas  = 0;
 int                 XrdOssCache::Usage   = 0;
 
+XrdSysCondVar       XrdOssCache::scanCV(0);
+XrdSysMutex         XrdOssCache::scanMutex;
+int                 XrdOssCache::scanPend= 0;
+int                 XrdOssCache::scanTMO = 30;
+
 /******************************************************************************/
 /*            X r d O s s C a c h e _ F S D a t a   M e t h o d s             */
 /******************************************************************************/
@@ -98,6 +108,16 @@ XrdOssCache_FSData::XrdOssCache_FSData(const char *fsp,
      next = 0;
      stat = 0;
      seen = 0;
+     ioSect = -1;
+     ioTime = 0;
+     ioRate = 0;
+     ioBusy = 0;
+     ioQdep = 0;
+     scnFree= frsz;
+     scnErr = 0;
+     scnBusy= 0;
+     scnDone= 0;
+     scnLate= 0;
 }
   
 /******************************************************************************/
@@ -300,6 +320,8 @@ int XrdOssCache_FS::getSpace(XrdOssCache_Space &Space, XrdOssCache_Group *fsg)
    XrdOssCache::Mutex.Lock();
    seenVal++;
    Space.Usage = fsg->Usage; Space.Quota = fsg->Quota;
+   Space.Allocs = fsg->Allocs; Space.NoSpace = fsg->NoSpace;
+   Space.LoadAvd= fsg->LoadAvd;
    if ((fsp = XrdOssCache::fsfirst)) do
       {if (fsp->fsgroup == fsg && fsp->fsdata->seen != seenVal)
           {fsd = fsp->fsdata; pnum++; fsd->seen = seenVal;
@@ -414,12 +436,11 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
 {
    EPNAME("Alloc");
    static const mode_t theMode = S_IRWXU | S_IRWXG;
-   XrdSysMutexHelper myMutex(&Mutex);
    double diffree;
    XrdOssPath::fnInfo Info;
-   XrdOssCache_FS *fsp, *fspend, *fsp_sel;
+   XrdOssCache_FS *fsp, *fspend, *fsp_sel, *fsp_max;
    XrdOssCache_Group *cgp = 0;
-   long long size, maxfree, curfree;
+   long long size, maxfree, curfree, curwt, maxwt;
    int rc, madeDir, datfd = 0;
 
 // Compute appropriate allocation size
@@ -436,9 +457,15 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
 
 // Find a cache that will fit this allocation request. We start with the next
 // entry past the last one we selected and go full round looking for a
-// compatable entry (enough space and in the right space group).
-//
-   fsp_sel = 0; maxfree = 0;
+// compatable entry (enough space and in the right space group). When load
+// balancing is enabled, the free space is weighted down by how busy the
+// underlying device has recently been so that hot disks get fewer new files.
+// For round-robin, a disk whose weighted space is halved or worse is skipped
+// unless all of them are. We also track what we would have picked by free
+// space alone for statistics.
+//
+   Mutex.Lock();
+   fsp_sel = fsp_max = 0; maxfree = maxwt = 0;
    fsp = cgp->curr->next; fspend = fsp; // End when we hit the start again
    do {
        if (strcmp(aInfo.cgName, fsp->group)
@@ -446,21 +473,37 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
                         ||  strncmp(aInfo.cgPath,fsp->path,aInfo.cgPlen)))) continue;
        curfree = fsp->fsdata->frsz;
        if (size > curfree) continue;
+       curwt = curfree
+             - (curfree/100) * (ldAlloc * fsp->fsdata->ioBusy / 100);
+       if (!fsp_max || curfree > maxfree) {fsp_max = fsp; maxfree = curfree;}
 
-             if (fuzAlloc > 0.999) {fsp_sel = fsp; break;}
+             if (fuzAlloc > 0.999)
+                {if (!ldAlloc || curwt > curfree/2) {fsp_sel = fsp; break;}
+                 if (curwt > maxwt || !fsp_sel) {fsp_sel = fsp; maxwt = curwt;}
+                }
        else  if (!fuzAlloc || !fsp_sel)
-                {if (curfree > maxfree) {fsp_sel = fsp; maxfree = curfree;}}
-       else {diffree = (!(curfree + maxfree) ? 0.0
-                     : static_cast<double>(XRDABS(maxfree - curfree)) /
-                       static_cast<double>(       maxfree + curfree));
-             if (diffree > fuzAlloc) {fsp_sel = fsp; maxfree = curfree;}
+                {if (curwt > maxwt || !fsp_sel) {fsp_sel = fsp; maxwt = curwt;}}
+       else {diffree = (!(curwt + maxwt) ? 0.0
+                     : static_cast<double>(XRDABS(maxwt - curwt)) /
+                       static_cast<double>(       maxwt + curwt));
+             if (diffree > fuzAlloc) {fsp_sel = fsp; maxwt = curwt;}
             }
       } while((fsp = fsp->next) != fspend);
 
 // Check if we can realy fit this file. If so, update current scan pointer
+// and reserve the space (temporarily adjust down the free space) so that we
+// can drop the lock while we create the file.
 //
-   if (!fsp_sel) return -ENOSPC;
+   if (!fsp_sel) {cgp->NoSpace++; Mutex.UnLock(); return -ENOSPC;}
    cgp->curr = fsp_sel;
+   cgp->Allocs++;
+   if (ldAlloc && fsp_sel->fsdata != fsp_max->fsdata
+   &&  fsp_sel->fsdata->ioBusy < fsp_max->fsdata->ioBusy) cgp->LoadAvd++;
+   DEBUG("free=" <<fsp_sel->fsdata->frsz <<'-' <<size <<" busy="
+                 <<fsp_sel->fsdata->ioBusy <<"% path=" <<fsp_sel->fsdata->path);
+   fsp_sel->fsdata->frsz -= size;
+   fsp_sel->fsdata->stat |= XrdOssFSData_REFRESH;
+   Mutex.UnLock();
 
 // Construct the target filename
 //
@@ -472,27 +515,31 @@ int XrdOssCache::Alloc(XrdOssCache::allocInfo &aInfo)
 
 // Verify that target name was constructed
 //
-   if (!(*aInfo.cgPFbf)) return -ENAMETOOLONG;
+   if (!(*aInfo.cgPFbf)) {rc = -ENAMETOOLONG; datfd = -1;}
 
 // Simply open the file in the local filesystem, creating it if need be.
 //
-   if (aInfo.aMode)
+   else if (aInfo.aMode)
       {madeDir = 0;
        do {do {datfd = open(aInfo.cgPFbf,O_CREAT|O_TRUNC|O_WRONLY,aInfo.aMode);}
                while(datfd < 0 && errno == EINTR);
            if (datfd >= 0 || errno != ENOENT || madeDir) break;
            *Info.Slash='\0'; rc=mkdir(aInfo.cgPFbf,theMode); *Info.Slash='/';
+           if (rc && errno == EEXIST) rc = 0;  // Someone else just made it
            madeDir = 1;
           } while(!rc);
-       if (datfd < 0) return (errno ? -errno : -ENOSYS);
+       if (datfd < 0) rc = (errno ? -errno : -ENOSYS);
       }
 
-// All done (temporarily adjust down the free space)x
+// If we failed, return the space we reserved
+//
+   if (datfd < 0)
+      {Mutex.Lock(); fsp_sel->fsdata->frsz += size; Mutex.UnLock();
+       return rc;
+      }
+
+// All done
 //
-   DEBUG("free=" <<fsp_sel->fsdata->frsz <<'-' <<size <<" path=" 
-                 <<fsp_sel->fsdata->path);
-   fsp_sel->fsdata->frsz -= size;
-   fsp_sel->fsdata->stat |= XrdOssFSData_REFRESH;
    aInfo.cgFSp  = fsp_sel;
    return datfd;
 }
@@ -558,13 +605,15 @@ int XrdOssCache::Init(const char *UPath, const char *Qfile, int isSOL)
 
 /******************************************************************************/
 
-int XrdOssCache::Init(long long aMin, int ovhd, int aFuzz)
+int XrdOssCache::Init(long long aMin, int ovhd, int aFuzz, int aLoad, int sTMO)
 {
 // Set values
 //
    minAlloc = aMin;
    ovhAlloc = ovhd;
    fuzAlloc = static_cast<double>(aFuzz)/100.0;
+   ldAlloc  = aLoad;
+   scanTMO  = sTMO;
    return 0;
 }
 
@@ -592,6 +641,98 @@ void XrdOssCache::List(const char *lname, XrdSysError &Eroute)
         } while(fsp != fsfirst);
 }
  
+/******************************************************************************/
+/*                                  L o a d                                   */
+/******************************************************************************/
+
+void *XrdOssCache::Load(int ldint)
+{
+   EPNAME("CacheLoad")
+   XrdOssCache_FSData *fsdp;
+   const struct timespec naptime = {ldint, 0};
+   struct timeval tNow, tLast;
+   long long sect, tbusy, msecs, rate;
+   int busy, qdep;
+
+// Take an initial sample so that the first interval has a base
+//
+   gettimeofday(&tLast, 0);
+   for (fsdp = fsdata; fsdp; fsdp = fsdp->next)
+       {if (LoadRead(fsdp, sect, tbusy, qdep))
+           {Mutex.Lock();
+            fsdp->ioSect = sect; fsdp->ioTime = tbusy; fsdp->ioQdep = qdep;
+            Mutex.UnLock();
+           } else {DEBUG("No i/o statistics for " <<fsdp->path);}
+       }
+
+// Periodically sample each device and compute how busy it was
+//
+   while(1)
+        {nanosleep(&naptime, 0);
+         gettimeofday(&tNow, 0);
+         msecs = (tNow.tv_sec  - tLast.tv_sec)  * 1000
+               + (tNow.tv_usec - tLast.tv_usec) / 1000;
+         tLast = tNow;
+         if (msecs <= 0) continue;
+         for (fsdp = fsdata; fsdp; fsdp = fsdp->next)
+             {if (fsdp->ioSect < 0 || !LoadRead(fsdp, sect, tbusy, qdep))
+                 continue;
+              busy = static_cast<int>((tbusy - fsdp->ioTime) * 100 / msecs);
+              if (busy < 0) busy = 0;
+                 else if (busy > 100) busy = 100;
+              rate = (sect - fsdp->ioSect) * 512 * 1000 / msecs;
+              Mutex.Lock();
+              fsdp->ioSect = sect; fsdp->ioTime = tbusy;
+              fsdp->ioRate = (rate < 0 ? 0 : rate);
+              fsdp->ioBusy = busy; fsdp->ioQdep = qdep;
+              Mutex.UnLock();
+              DEBUG("busy=" <<busy <<"% rate=" <<rate <<" qdep=" <<qdep
+                           <<" path=" <<fsdp->path);
+             }
+        }
+
+// Keep the compiler happy
+//
+   return (void *)0;
+}
+
+/******************************************************************************/
+/*                              L o a d R e a d                               */
+/******************************************************************************/
+
+int XrdOssCache::LoadRead(XrdOssCache_FSData *fsdp, long long &sect,
+                          long long &tbusy, int &qdep)
+{
+#ifdef __linux__
+   unsigned long long rdsect, wrsect, ioticks, dummy;
+   unsigned int inflight;
+   char fname[64];
+   FILE *fp;
+   int n;
+
+// The block layer keeps cumulative statistics for each device and partition.
+// See the kernel's Documentation/block/stat for the meaning of the fields.
+//
+   snprintf(fname, sizeof(fname), "/sys/dev/block/%u:%u/stat",
+            major(fsdp->fsid), minor(fsdp->fsid));
+   if (!(fp = fopen(fname, "r"))) return 0;
+   n = fscanf(fp, "%llu %llu %llu %llu %llu %llu %llu %llu %u %llu",
+              &dummy, &dummy, &rdsect, &dummy, &dummy, &dummy, &wrsect,
+              &dummy, &inflight, &ioticks);
+   fclose(fp);
+   if (n != 10) return 0;
+
+// Return the values
+//
+   sect  = static_cast<long long>(rdsect + wrsect);
+   tbusy = static_cast<long long>(ioticks);
+   qdep  = static_cast<int>(inflight);
+   return 1;
+#else
+   return 0;
+#endif
+}
+
 /******************************************************************************/
 /*                                 P a r s e                                  */
 /******************************************************************************/
@@ -631,7 +772,8 @@ void *XrdOssCache::Scan(int cscanint)
    XrdOssCache_FSData *fsdp;
    XrdOssCache_Group  *fsgp;
    const struct timespec naptime = {cscanint, 0};
-   long long frsz, llT; // llT is a dummy temporary
+   pthread_t tid;
+   time_t tNow, tEnd;
    int retc, dbgMsg, dbgNoMsg, dbgDoMsg;
 
 // Try to prevent floodingthe log with scan messages
@@ -647,42 +789,81 @@ void *XrdOssCache::Scan(int cscanint)
          dbgDoMsg = !dbgNoMsg--;
          if (dbgDoMsg) dbgNoMsg = dbgMsg;
 
-        // Get the cache context lock
+        // Only one scan may be in progress at any one time
+        //
+           scanMutex.Lock();
+
+        // Start a statfs() for each filesystem, skipping those that have been
+        // recently adjusted to avoid fs statstics latency problems. Each one
+        // runs in its own thread so that a slow or hung filesystem neither
+        // delays the others nor holds the cache lock. A filesystem whose
+        // previous statfs() has not yet returned is skipped altogether.
         //
            Mutex.Lock();
+           scanCV.Lock();
+           fsdp = fsdata;
+           while(fsdp)
+                {if (!fsdp->scnBusy
+                 && ((fsdp->stat & XrdOssFSData_REFRESH)
+                 || !(fsdp->stat & XrdOssFSData_ADJUSTED) || cscanint <= 0))
+                    {fsdp->scnBusy = 1;
+                     if ((retc = XrdSysThread::Run(&tid, XrdOssCache::ScanFS,
+                                            (void *)fsdp, 0, "cache statfs")))
+                        {OssEroute.Emsg("CacheScan", retc, "create statfs "
+                                        "thread for", fsdp->path);
+                         fsdp->scnBusy = 0;
+                        } else scanPend++;
+                    } else if (!fsdp->scnBusy)
+                              fsdp->stat |= XrdOssFSData_REFRESH;
+                 fsdp = fsdp->next;
+                }
+           Mutex.UnLock();
 
-        // Scan through all filesystems skip filesystem that have been
-        // recently adjusted to avoid fs statstics latency problems.
+        // Wait for all of the statfs() calls to complete or time out
+        //
+           tEnd = time(0) + scanTMO;
+           while(scanPend > 0 && (tNow = time(0)) < tEnd)
+                scanCV.Wait(tEnd - tNow);
+           scanCV.UnLock();
+
+        // Update each filesystem with what was found and recompute the totals.
+        // A statfs() that completed after timing out in a prior scan is used
+        // now as it is no staler than it would have been had it been on time.
         //
+           Mutex.Lock();
+           scanCV.Lock();
            fsSize =  0;
            fsTotFr=  0;
            fsFree =  0;
            fsdp = fsdata;
            while(fsdp)
-                {retc = 0;
-                 if ((fsdp->stat & XrdOssFSData_REFRESH)
-                 || !(fsdp->stat & XrdOssFSData_ADJUSTED) || cscanint <= 0)
-                     {frsz = XrdOssCache_FS::freeSpace(llT,fsdp->path);
-                      if (frsz < 0) OssEroute.Emsg("CacheScan", errno ,
-                                    "state file system ",(char *)fsdp->path);
-                         else {fsdp->frsz = frsz;
-                               fsdp->stat &= ~(XrdOssFSData_REFRESH |
-                                               XrdOssFSData_ADJUSTED);
-                               if (dbgDoMsg)
-                                  {DEBUG("New free=" <<fsdp->frsz <<" path=" <<fsdp->path);}
-                               }
-                     } else fsdp->stat |= XrdOssFSData_REFRESH;
-                 if (!retc)
-                    {if (fsdp->frsz > fsFree)
-                        {fsFree = fsdp->frsz; fsSize = fsdp->size;}
-                     fsTotFr += fsdp->frsz;
-                    }
+                {if (fsdp->scnDone)
+                    {fsdp->scnDone = 0;
+                     if (fsdp->scnErr) OssEroute.Emsg("CacheScan",fsdp->scnErr,
+                                       "state file system ",fsdp->path);
+                        else {fsdp->frsz = fsdp->scnFree;
+                              fsdp->stat &= ~(XrdOssFSData_REFRESH |
+                                              XrdOssFSData_ADJUSTED);
+                              if (dbgDoMsg)
+                                 {DEBUG("New free=" <<fsdp->frsz
+                                        <<" path=" <<fsdp->path);}
+                             }
+                    } else if (fsdp->scnBusy && !fsdp->scnLate)
+                              {fsdp->scnLate = 1; scanPend--;
+                               OssEroute.Emsg("CacheScan", "statfs timed out "
+                                              "for", fsdp->path);
+                              }
+                 if (fsdp->frsz > fsFree)
+                    {fsFree = fsdp->frsz; fsSize = fsdp->size;}
+                 fsTotFr += fsdp->frsz;
                  fsdp = fsdp->next;
                 }
+           scanCV.UnLock();
 
         // Unlock the cache and if we have quotas check them out
         //
            Mutex.UnLock();
+           scanMutex.UnLock();
            if (cscanint <= 0) return (void *)0;
            if (Quotas) XrdOssSpace::Quotas();
 
@@ -702,3 +883,32 @@ void *XrdOssCache::Scan(int cscanint)
 //
    return (void *)0;
 }
+
+/******************************************************************************/
+/*                                S c a n F S                                 */
+/******************************************************************************/
+
+void *XrdOssCache::ScanFS(void *carg)
+{
+   XrdOssCache_FSData *fsdp = (XrdOssCache_FSData *)carg;
+   long long frsz, llT; // llT is a dummy temporary
+   int rc;
+
+// Get the free space, this may take a long time for remote filesystems. The
+// path is never changed or freed so we need not hold any lock here.
+//
+   frsz = XrdOssCache_FS::freeSpace(llT, fsdp->path);
+   rc   = (frsz < 0 ? (errno ? errno : EIO) : 0);
+
+// Post the result. If the scanner gave up on us it no longer counts us.
+//
+   scanCV.Lock();
+   fsdp->scnFree = frsz;
+   fsdp->scnErr  = rc;
+   fsdp->scnDone = 1;
+   fsdp->scnBusy = 0;
+   if (fsdp->scnLate) fsdp->scnLate = 0;
+      else if (!(--scanPend)) scanCV.Signal();
+   scanCV.UnLock();
+   return (void *)0;
+}
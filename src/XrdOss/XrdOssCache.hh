@@ -86,9 +86,13 @@ long long          Inodes;
 long long          Inleft;
 long long          Usage;
 long long          Quota;
+long long          Allocs;    // Number of files placed in the space
+long long          NoSpace;   // Number of placements failed for lack of space
+long long          LoadAvd;   // Number of placements that avoided a busy disk
 
      XrdOssCache_Space() : Total(0), Free(0), Maxfree(0), Largest(0),
-                           Inodes(0), Inleft(0), Usage(-1), Quota(-1) {}
+                           Inodes(0), Inleft(0), Usage(-1), Quota(-1),
+                           Allocs(0), NoSpace(0), LoadAvd(0) {}
     ~XrdOssCache_Space() {}
 };
   
@@ -115,6 +119,22 @@ time_t              updt;
 int                 stat;
 unsigned int        seen;
 
+// The following are maintained by the load sampler (see XrdOssCache::Load)
+//
+long long           ioSect;   // Sectors read and written at last sample
+long long           ioTime;   // Milliseconds device was busy at last sample
+long long           ioRate;   // Bytes per second read and written
+int                 ioBusy;   // Percentage of time device was busy (0-100)
+int                 ioQdep;   // Requests in progress at last sample
+
+// The following are maintained by the scanner (see XrdOssCache::Scan)
+//
+long long           scnFree;  // Free space found by the last statfs()
+int                 scnErr;   // errno from the last statfs(), if it failed
+char                scnBusy;  // A statfs() is in progress
+char                scnDone;  // A statfs() completed and is not yet used
+char                scnLate;  // The statfs() in progress timed out
+
        XrdOssCache_FSData(const char *, STATFS_t &, dev_t);
       ~XrdOssCache_FSData() {if (path) free((void *)path);}
 };
@@ -170,6 +190,9 @@ char              *group;
 XrdOssCache_FS    *curr;
 long long          Usage;
 long long          Quota;
+long long          Allocs;
+long long          NoSpace;
+long long          LoadAvd;
 int                GRPid;
 static long long   PubQuota;
 
@@ -177,7 +200,8 @@ static XrdOssCache_Group *fsgroups;
 
        XrdOssCache_Group(const char *grp, XrdOssCache_FS *fsp=0) 
                         : next(0), group(strdup(grp)), curr(fsp), Usage(0),
-                          Quota(-1), GRPid(-1) {}
+                          Quota(-1), Allocs(0), NoSpace(0), LoadAvd(0),
+                          GRPid(-1) {}
       ~XrdOssCache_Group() {if (group) free((void *)group);}
 };
   
@@ -219,10 +243,13 @@ static XrdOssCache_FS *Find(const char *Path, int lklen=0);
 
 static int             Init(const char *UDir, const char *Qfile, int isSOL);
 
-static int             Init(long long aMin, int ovhd, int aFuzz);
+static int             Init(long long aMin, int ovhd, int aFuzz, int aLoad=0,
+                            int sTMO=30);
 
 static void            List(const char *lname, XrdSysError &Eroute);
 
+static void           *Load(int ldint);
+
 static char           *Parse(const char *token, char *cbuff, int cblen);
 
 static void           *Scan(int cscanint);
@@ -244,9 +271,20 @@ static int                 fsCount;  // Number of file systems
 
 private:
 
+static int                 LoadRead(XrdOssCache_FSData *fsdp, long long &sect,
+                                    long long &tbusy, int &qdep);
+
+static void               *ScanFS(void *carg);
+
+static XrdSysCondVar       scanCV;   // Protects the scn* fields in FSData
+static XrdSysMutex         scanMutex;// Serializes scans
+static int                 scanPend; // Number of statfs() calls outstanding
+static int                 scanTMO;  // Seconds to wait for a statfs()
+
 static long long           minAlloc;
 static double              fuzAlloc;
 static int                 ovhAlloc;
+static int                 ldAlloc;
 static int                 Quotas;
 static int                 Usage;
 };
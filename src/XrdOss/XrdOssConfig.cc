@@ -50,6 +50,7 @@
 #include "XrdOss/XrdOssError.hh"
 #include "XrdOss/XrdOssMio.hh"
 #include "XrdOss/XrdOssOpaque.hh"
+#include "XrdOss/XrdOssRdAhead.hh"
 #include "XrdOss/XrdOssSpace.hh"
 #include "XrdOss/XrdOssTrace.hh"
 #include "XrdOuc/XrdOuca2x.hh"
@@ -142,6 +143,8 @@ void *XrdOssxfr(void *carg)       {return XrdOssSS->Stage_In(carg);}
 
 void *XrdOssCacheScan(void *carg) {return XrdOssCache::Scan(*((int *)carg));}
 
+void *XrdOssCacheLoad(void *carg) {return XrdOssCache::Load(*((int *)carg));}
+
 /******************************************************************************/
 /*                           C o n s t r u c t o r                            */
 /******************************************************************************/
@@ -180,12 +183,14 @@ XrdOssSys::XrdOssSys()
    LocalRoot     = 0;
    RemoteRoot    = 0;
    cscanint      = 600;
+   cscantmo      = 30;
    FDFence       = -1;
    FDLimit       = -1;
    MaxSize       = 0;
    minalloc      = 0;
    ovhalloc      = 0;
    fuzalloc      = 0;
+   ldalloc       = 0;
    xfrspeed      = 9*1024*1024;
    xfrovhd       = 30;
    xfrhold       =  3*60*60;
@@ -212,6 +217,9 @@ XrdOssSys::XrdOssSys()
    prActive      = 0;
    prDepth       = 0;
    prQSize       = 0;
+   raMin         = 0;
+   raMax         = 0;
+   raDrop        = false;
    STT_Lib       = 0;
    STT_Parms     = 0;
    STT_Func      = 0;
@@ -282,6 +290,10 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
 //
    NoGo = ConfigProc(Eroute);
 
+// Enable access pattern driven readahead if so wanted
+//
+   if (!NoGo && raMax) XrdOssRdAhead::Init(raMin, raMax, raDrop);
+
 // Configure dependent plugins
 //
    if (!NoGo)
@@ -295,7 +307,8 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
    Solitary = ((val = getenv("XRDREDIRECT")) && !strcmp(val, "Q"));
    if (Solitary) Eroute.Say("++++++ Configuring standalone mode . . .");
    NoGo |= XrdOssCache::Init(UDir, QFile, Solitary)
-          |XrdOssCache::Init(minalloc, ovhalloc, fuzalloc);
+          |XrdOssCache::Init(minalloc, ovhalloc, fuzalloc, ldalloc,
+                             cscantmo);
 
 // Configure the MSS interface including staging
 //
@@ -337,6 +350,17 @@ int XrdOssSys::Configure(const char *configfn, XrdSysError &Eroute,
           Eroute.Emsg("Config", retc, "create cache scan thread");
       }
 
+// Start the device load sampler if placement is to take load into account
+//
+   if (!NoGo && ldalloc)
+      {static int ldint = 5;
+       if ((retc = XrdSysThread::Run(&tid, XrdOssCacheLoad,
+                                    (void *)&ldint, 0, "cache load")))
+          {Eroute.Emsg("Config", retc, "create cache load thread");
+           NoGo = 1;
+          }
+      }
+
 // Display the final config if we can continue
 //
    if (!NoGo) Config_Display(Eroute);
@@ -386,8 +410,8 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
         else cloc = ConfigFN;
 
      snprintf(buff, sizeof(buff), "Config effective %s oss configuration:\n"
-                                  "       oss.alloc        %lld %d %d\n"
-                                  "       oss.cachescan    %d\n"
+                                  "       oss.alloc        %lld %d %d load %d\n"
+                                  "       oss.cachescan    %d timeout %d\n"
                                   "       oss.fdlimit      %d %d\n"
                                   "       oss.maxsize      %lld\n"
                                   "%s%s%s"
@@ -400,8 +424,8 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
                                   "       oss.trace        %x\n"
                                   "       oss.xfr          %d deny %d keep %d",
              cloc,
-             minalloc, ovhalloc, fuzalloc,
-             cscanint,
+             minalloc, ovhalloc, fuzalloc, ldalloc,
+             cscanint, cscantmo,
              FDFence, FDLimit, MaxSize,
              XrdOssConfig_Val(N2N_Lib,    namelib),
              XrdOssConfig_Val(LocalRoot,  localroot),
@@ -416,6 +440,12 @@ void XrdOssSys::Config_Display(XrdSysError &Eroute)
 
      Eroute.Say(buff);
 
+     if (AioRings)
+        {snprintf(buff, sizeof(buff), "       oss.aio          uring rings %d "
+                                      "depth %d", AioRings, AioDepth);
+         Eroute.Say(buff);
+        }
+
      XrdOssMio::Display(Eroute);
 
      XrdOssCache::List("       oss.", Eroute);
@@ -487,9 +517,10 @@ void XrdOssSys::ConfigMio(XrdSysError &Eroute)
       }
 #endif
 
-// If no memory flags are set, turn off memory mapped files
+// If no memory flags are set and small files are not automatically mapped,
+// turn off memory mapped files
 //
-   if (!(flags & XRDEXP_MEMAP) || setoff)
+   if ((!(flags & XRDEXP_MEMAP) && !XrdOssMio::Small()) || setoff)
      {XrdOssMio::Set(0, 0, 0);
       tryMmap = 0; chkMmap = 0;
      }
@@ -943,6 +974,7 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
     int nosubs;
     XrdOucEnv *myEnv = 0;
 
+   TS_Xeq("aio",           xaio);
    TS_Xeq("alloc",         xalloc);
    TS_Xeq("cache",         xcache);
    TS_Xeq("cachescan",     xcachescan);
@@ -953,6 +985,7 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
    TS_Xeq("namelib",       xnml);
    TS_Xeq("path",          xpath);
    TS_Xeq("preread",       xprerd);
+   TS_Xeq("readahead",     xrdahd);
    TS_Xeq("space",         xspace);
    TS_Xeq("stagecmd",      xstg);
    TS_Xeq("statlib",       xstl);
@@ -1012,6 +1045,59 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
    return 0;
 }
 
+/******************************************************************************/
+/*                                  x a i o                                   */
+/******************************************************************************/
+
+/* Function: xaio
+
+   Purpose:  To parse the directive: aio {posix | uring} [rings <n>] [depth <n>]
+
+             posix       use POSIX aio for asynchronous requests (default).
+             uring       use io_uring for asynchronous requests.
+             rings <n>   number of io_urings to use, each with its own
+                         completion thread (default 1).
+             depth <n>   number of requests each ring can queue (default 256).
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xaio(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    char *val;
+    int depth = 256, rings = 1, isUring = 0;
+
+    if (!(val = Config.GetWord()))
+       {Eroute.Emsg("Config", "aio type not specified"); return 1;}
+         if (!strcmp(val, "uring")) isUring = 1;
+    else if ( strcmp(val, "posix"))
+            {Eroute.Emsg("Config", "invalid aio type -", val); return 1;}
+
+    while((val = Config.GetWord()))
+         {     if (!strcmp(val, "depth"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config", "aio depth not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2i(Eroute,"aio depth",val,&depth,1,32768))
+                      return 1;
+                  }
+          else if (!strcmp(val, "rings"))
+                  {if (!(val = Config.GetWord()))
+                      {Eroute.Emsg("Config", "aio rings not specified");
+                       return 1;
+                      }
+                   if (XrdOuca2x::a2i(Eroute, "aio rings", val, &rings, 1, 64))
+                      return 1;
+                  }
+          else {Eroute.Emsg("Config", "invalid aio option -", val); return 1;}
+         }
+
+    AioRings = (isUring ? rings : 0);
+    AioDepth = depth;
+    return 0;
+}
+
 /******************************************************************************/
 /*                                x a l l o c                                 */
 /******************************************************************************/
@@ -1019,6 +1105,7 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
 /* Function: aalloc
 
    Purpose:  To parse the directive: alloc <min> [<headroom> [<fuzz>]]
+                                               [load <pct>]
 
              <min>       minimum amount of free space needed in a partition.
                          (asterisk uses default).
@@ -1028,6 +1115,10 @@ int XrdOssSys::ConfigXeq(char *var, XrdOucStream &Config, XrdSysError &Eroute)
                          quantities that may be ignored when selecting a cache
                            0 - reduces to finding the largest free space
                          100 - reduces to simple round-robin allocation
+             load        weight given to how busy a disk has recently been.
+                         The free space of a partition is reduced by <pct>
+                         percent of the disk's busy percentage when selecting
+                         (0 - busy time is ignored, the default).
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1038,25 +1129,36 @@ int XrdOssSys::xalloc(XrdOucStream &Config, XrdSysError &Eroute)
     long long mina = 0;
     int       fuzz = 0;
     int       hdrm = 0;
+    int       load = 0;
 
     if (!(val = Config.GetWord()))
        {Eroute.Emsg("Config", "alloc minfree not specified"); return 1;}
     if (strcmp(val, "*") &&
         XrdOuca2x::a2sz(Eroute, "alloc minfree", val, &mina, 0)) return 1;
 
-    if ((val = Config.GetWord()))
+    if ((val = Config.GetWord()) && strcmp(val, "load"))
        {if (strcmp(val, "*") &&
             XrdOuca2x::a2i(Eroute,"alloc headroom",val,&hdrm,0,100)) return 1;
 
-        if ((val = Config.GetWord()))
+        if ((val = Config.GetWord()) && strcmp(val, "load"))
            {if (strcmp(val, "*") &&
             XrdOuca2x::a2i(Eroute, "alloc fuzz", val, &fuzz, 0, 100)) return 1;
+            val = Config.GetWord();
            }
        }
 
+    if (val)
+       {if (strcmp(val, "load"))
+           {Eroute.Emsg("Config", "invalid alloc option -", val); return 1;}
+        if (!(val = Config.GetWord()))
+           {Eroute.Emsg("Config", "alloc load value not specified"); return 1;}
+        if (XrdOuca2x::a2i(Eroute, "alloc load", val, &load, 0, 100)) return 1;
+       }
+
     minalloc = mina;
     ovhalloc = hdrm;
     fuzalloc = fuzz;
+    ldalloc  = load;
     return 0;
 }
 
@@ -1094,20 +1196,36 @@ int XrdOssSys::xcache(XrdOucStream &Config, XrdSysError &Eroute)
 
 /* Function: xcachescan
 
-   Purpose:  To parse the directive: cachescan <num>
+   Purpose:  To parse the directive: cachescan <num> [timeout <sec>]
 
              <num>     number of seconds between cache scans.
+             <sec>     number of seconds to wait for a filesystem to report
+                       its free space before using its last known value. The
+                       default is 30 seconds.
 
    Output: 0 upon success or !0 upon failure.
 */
 int XrdOssSys::xcachescan(XrdOucStream &Config, XrdSysError &Eroute)
-{   int cscan = 0;
+{   int cscan = 0, ctmo = cscantmo;
     char *val;
 
     if (!(val = Config.GetWord()))
        {Eroute.Emsg("Config", "cachescan not specified"); return 1;}
     if (XrdOuca2x::a2tm(Eroute, "cachescan", val, &cscan, 30)) return 1;
+
+    if ((val = Config.GetWord()))
+       {if (strcmp(val, "timeout"))
+           {Eroute.Emsg("Config", "invalid cachescan option -", val); return 1;}
+        if (!(val = Config.GetWord()))
+           {Eroute.Emsg("Config", "cachescan timeout not specified");
+            return 1;
+           }
+        if (XrdOuca2x::a2tm(Eroute, "cachescan timeout", val, &ctmo, 1))
+           return 1;
+       }
+
     cscanint = cscan;
+    cscantmo = ctmo;
     return 0;
 }
 
@@ -1188,7 +1306,7 @@ int XrdOssSys::xmaxsz(XrdOucStream &Config, XrdSysError &Eroute)
   
 /* Function: xmemf
 
-   Purpose:  Parse the directive: memfile [off] [max <msz>]
+   Purpose:  Parse the directive: memfile [off] [max <msz>] [small <ssz>]
                                           [check xattr] [preload]
 
              check      Applies memory mapping options based on file's xattrs.
@@ -1199,6 +1317,10 @@ int XrdOssSys::xmaxsz(XrdOucStream &Config, XrdSysError &Eroute)
              on         Enables memory mapping
              preload    Preloads the file after every opn reference.
              <msz>      Maximum amount of memory to use (can be n% or real mem).
+             <ssz>      Files of at most this size opened read/only in a
+                        read/only path are memory mapped whatever their path
+                        options, as long as memory is available. The default
+                        is 0 (i.e. no automatic mapping), the maximum 16m.
 
    Output: 0 upon success or !0 upon failure.
 */
@@ -1207,7 +1329,7 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
 {
     char *val;
     int i, j, V_check=-1, V_preld = -1, V_on=-1;
-    long long V_max = 0;
+    long long V_max = 0, V_small = -1;
 
     static struct mmapopts {const char *opname; int otyp;
                             const char *opmsg;} mmopts[] =
@@ -1215,7 +1337,8 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
         {"off",        0, ""},
         {"preload",    1, "memfile preload"},
         {"check",      2, "memfile check"},
-        {"max",        3, "memfile max"}};
+        {"max",        3, "memfile max"},
+        {"small",      4, "memfile small"}};
     int numopts = sizeof(mmopts)/sizeof(struct mmapopts);
 
     if (!(val = Config.GetWord()))
@@ -1253,6 +1376,10 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
                                                 mmopts[i].opmsg, val, &V_max,
                                                 10*1024*1024)) return 1;
                                   break;
+                          case 4: if (XrdOuca2x::a2sz(Eroute, mmopts[i].opmsg,
+                                                val, &V_small, 0,
+                                                16*1024*1024)) return 1;
+                                  break;
                           default: V_on = 0; break;
                          }
                   val = Config.GetWord();
@@ -1262,7 +1389,7 @@ int XrdOssSys::xmemf(XrdOucStream &Config, XrdSysError &Eroute)
 // Set the values
 //
    XrdOssMio::Set(V_on, V_preld, V_check);
-   XrdOssMio::Set(V_max);
+   XrdOssMio::Set(V_max, V_small);
    return 0;
 }
 
@@ -1407,6 +1534,77 @@ int XrdOssSys::xprerd(XrdOucStream &Config, XrdSysError &Eroute)
       return 0;
 }
   
+/******************************************************************************/
+/*                                x r d a h d                                 */
+/******************************************************************************/
+
+/* Function: xrdahd
+
+   Purpose:  To parse the directive: readahead {off | on} [min <sz>] [max <sz>]
+                                               [dropbehind]
+
+             off      does not track access patterns, the default.
+             on       tracks the access pattern of each file and issues
+                      readahead hints ahead of sequential and strided readers
+                      and turns off kernel readahead for random readers.
+             <sz>     the initial (min) and maximum (max) readahead window for
+                      sequential reads. The window doubles each time the reader
+                      catches up. The defaults are 128k and 4m, respectively.
+                      The max also limits how far ahead strided reads are
+                      prefetched.
+             dropbehind
+                      drops pages already read by a sequential reader from the
+                      page cache, keeping a maximum window's worth.
+
+   Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdOssSys::xrdahd(XrdOucStream &Config, XrdSysError &Eroute)
+{
+    static const long long m1G = 1073741824LL;
+    char *val;
+    long long rmin = 131072, rmax = 4194304;
+    bool isOn, rdrop = false;
+
+      if (!(val = Config.GetWord()))
+         {Eroute.Emsg("Config", "readahead option not specified"); return 1;}
+
+           if (!strcmp(val, "on"))  isOn = true;
+      else if (!strcmp(val, "off")) isOn = false;
+      else {Eroute.Emsg("Config","invalid readahead option -",val); return 1;}
+
+      while((val = Config.GetWord()))
+           {     if (!strcmp(val, "min"))
+                    {if (!(val = Config.GetWord()))
+                        {Eroute.Emsg("Config","readahead min not specified");
+                         return 1;
+                        }
+                     if (XrdOuca2x::a2sz(Eroute,"readahead min",val,&rmin,
+                                         prPSize,m1G)) return 1;
+                    }
+            else if (!strcmp(val, "max"))
+                    {if (!(val = Config.GetWord()))
+                        {Eroute.Emsg("Config","readahead max not specified");
+                         return 1;
+                        }
+                     if (XrdOuca2x::a2sz(Eroute,"readahead max",val,&rmax,
+                                         prPSize,m1G)) return 1;
+                    }
+            else if (!strcmp(val, "dropbehind")) rdrop = true;
+            else {Eroute.Emsg("Config","invalid readahead option -",val);
+                  return 1;
+                 }
+         }
+
+      if (rmax < rmin)
+         {Eroute.Emsg("Config","readahead max must be >= min"); return 1;}
+
+      raMin  = rmin;
+      raMax  = (isOn ? rmax : 0);
+      raDrop = rdrop;
+      return 0;
+}
+
 /******************************************************************************/
 /*                                x s p a c e                                 */
 /******************************************************************************/
@@ -1850,8 +2048,8 @@ void XrdOssSys::List_Path(const char *pfx, const char *pname,
      if (flags & XRDEXP_FORCERO) rwmode = (char *)" forcero";
         else if (flags & XRDEXP_READONLY) rwmode = (char *)" r/o ";
                 else rwmode = (char *)" r/w ";
-                                 //   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5
-     snprintf(buff, sizeof(buff), "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
+                                 //   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6
+     snprintf(buff, sizeof(buff), "%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
               pfx, pname,                                           // 0
               rwmode,                                               // 1
               (flags & XRDEXP_INPLACE  ? " inplace" : ""),          // 2
@@ -1868,7 +2066,8 @@ void XrdOssSys::List_Path(const char *pfx, const char *pname,
               (flags & XRDEXP_RCREATE  ? " rcreate" : " norcreate"),// 11
               (flags & XRDEXP_PURGE    ? " purge"   : " nopurge"),  // 12
               (flags & XRDEXP_STAGE    ? " stage"   : " nostage"),  // 13
-              (flags & XRDEXP_NOXATTR  ? " noxattr" : " xattr")     // 14
+              (flags & XRDEXP_NOXATTR  ? " noxattr" : " xattr"),    // 14
+              (flags & XRDEXP_DIRECT   ? " direct"  : "")           // 15
               );
      Eroute.Say(buff); 
 }
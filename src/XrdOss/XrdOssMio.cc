@@ -67,6 +67,7 @@ long long      XrdOssMio::MM_pages    = (long long)sysconf(_SC_PHYS_PAGES);
 #endif
 long long      XrdOssMio::MM_max      = MM_pagsz*MM_pages/2;
 long long      XrdOssMio::MM_inuse    = 0;
+long long      XrdOssMio::MM_small    = 0;
 
 extern XrdSysError OssEroute;
 
@@ -79,10 +80,11 @@ extern XrdOucTrace OssTrace;
 void XrdOssMio::Display(XrdSysError &Eroute)
 {
      char buff[1080];
-     snprintf(buff, sizeof(buff), "       oss.memfile %s%s%s max %lld",
+     snprintf(buff, sizeof(buff),
+             "       oss.memfile %s%s%s max %lld small %lld",
              (MM_on      ? ""            : "off "),
-             (MM_preld   ? "preload"     : ""),
-             (MM_chk     ? "check xattr" : ""), MM_max);
+             (MM_preld   ? "preload "    : ""),
+             (MM_chk     ? "check xattr" : ""), MM_max, MM_small);
      Eroute.Say(buff);
 }
 
@@ -118,31 +120,49 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
 //
    mapMutex.Lock(&MM_Mutex);
 
-// Check if we already have this mapping
+// Check if we already have this mapping. The mapping is only good if the file
+// has not changed since it was mapped. A stale mapping that is not in use is
+// discarded, otherwise the file is simply not memory mapped this time around.
 //
    if ((mp = MM_Hash.Find(hashname)))
-      {DEBUG("Reusing mmap; usecnt=" <<mp->inUse <<" path=" <<path);
-       if (!(mp->Status & OSSMIO_MPRM) && !mp->inUse) Reclaim(mp);
-       mp->inUse++;
-       return mp;
+      {if (mp->Size == statb.st_size && mp->Mtime == statb.st_mtime)
+          {DEBUG("Reusing mmap; usecnt=" <<mp->inUse <<" path=" <<path);
+           if (!(mp->Status & OSSMIO_MPRM) && !mp->inUse) Reclaim(mp);
+           mp->inUse++;
+           return mp;
+          }
+       if (mp->inUse || (mp->Status & OSSMIO_MPRM))
+          {DEBUG("Stale mmap in use; usecnt=" <<mp->inUse <<" path=" <<path);
+           return 0;
+          }
+       DEBUG("Discarding stale mmap for " <<path);
+       Reclaim(mp);
+       MM_inuse -= mp->Size;
+       MM_Hash.Del(mp->HashName);  // This will delete the object
       }
 
-// Check if memory will be over committed
+// Check if memory will be over committed. Small files are mapped on a best
+// effort basis so we don't complain when they cannot be accomodated.
 //
    if (MM_inuse + statb.st_size > MM_max)
       {if (!Reclaim(statb.st_size))
-          {OssEroute.Emsg("Mio", "Unable to reclaim enough storage to mmap",path);
+          {if (opts & OSSMIO_SMAL)
+              {DEBUG("Unable to reclaim enough storage to mmap " <<path);}
+              else OssEroute.Emsg("Mio", "Unable to reclaim enough storage "
+                                         "to mmap", path);
            return 0;
           }
       }
-   MM_inuse += statb.st_size;
 
-// Memory map the file
+// Memory map the file. Small files are brought in by asynchronous readahead
+// as we must not wait for the i/o while holding the lock.
 //
    if ((thefile = mmap(0,statb.st_size,PROT_READ,MAP_PRIVATE,fd,0))==MAP_FAILED)
       {OssEroute.Emsg("Mio", errno, "mmap file", path);
        return 0;
       } else {DEBUG("mmap " <<statb.st_size <<" bytes for " <<path);}
+   MM_inuse += statb.st_size;
+   if (opts & OSSMIO_SMAL) madvise(thefile, statb.st_size, MADV_WILLNEED);
 
 // Lock the file, if need be. Turn off locking if we don't have privs
 //
@@ -165,6 +185,7 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
    if (!(mp = new XrdOssMioFile(hashname)))
       {OssEroute.Emsg("Mio", "Unable to allocate mmap file object for", path);
        munmap((char *)thefile, statb.st_size);
+       MM_inuse -= statb.st_size;
        return 0;
       }
 
@@ -174,14 +195,16 @@ XrdOssMioFile *XrdOssMio::Map(char *path, int fd, int opts)
    mp->Size   = statb.st_size;
    mp->Dev    = statb.st_dev;
    mp->Ino    = statb.st_ino;
+   mp->Mtime  = statb.st_mtime;
    mp->Status = opts;
+   mp->isSmall= (opts & OSSMIO_SMAL) != 0;
 
 // Add the mapping to our hash table
 //
    if (MM_Hash.Add(hashname, mp))
       {OssEroute.Emsg("Mio", "Hash add failed for", path);
-       munmap((char *)thefile, statb.st_size);
-       delete mp;
+       MM_inuse -= statb.st_size;
+       delete mp;  // This will unmap the file
        return 0;
       }
 
@@ -321,10 +344,11 @@ void XrdOssMio::Set(int V_on, int V_preld,  int V_check)
    if (V_check   >= 0) MM_chk     = (char)V_check;
 }
 
-void XrdOssMio::Set(long long V_max)
+void XrdOssMio::Set(long long V_max, long long V_small)
 {
    if (V_max > 0) MM_max = V_max;
       else if (V_max < 0) MM_max = MM_pagsz*MM_pages*(-V_max)/100;
+   if (V_small >= 0) MM_small = V_small;
 }
  
 /******************************************************************************/
@@ -40,6 +40,7 @@
 #define OSSMIO_MLOK 0x0001
 #define OSSMIO_MMAP 0x0002
 #define OSSMIO_MPRM 0x0004
+#define OSSMIO_SMAL 0x0008
   
 class XrdOssMio
 {
@@ -58,7 +59,9 @@ static void           Recycle(XrdOssMioFile *mp);
 
 static void           Set(int V_off, int V_preld, int V_check);
 
-static void           Set(long long V_max);
+static void           Set(long long V_max, long long V_small=-1);
+
+static long long      Small()  {return MM_small;}
 
 private:
 static int  Reclaim(off_t amount);
@@ -79,5 +82,6 @@ static long long  MM_max;
 static long long  MM_pagsz;
 static long long  MM_pages;
 static long long  MM_inuse;
+static long long  MM_small;
 };
 #endif
@@ -30,6 +30,8 @@
 /* specific prior written permission of the institution or contributor.       */
 /******************************************************************************/
 
+#include <errno.h>
+#include <string.h>
 #include <time.h>
 #include <sys/types.h>
   
@@ -40,9 +42,25 @@ friend class XrdOssMio;
 
 off_t Export(void **Addr) {*Addr = Base; return Size;}
 
+// Mappings made because the file is small are read by copying out of them.
+// Others are only exported; reads use pread() so that a file truncated
+// behind our back yields an error rather than a SIGBUS.
+//
+bool    Copyable() {return isSmall;}
+
+// Read from the mapping as pread() would from the file when it was mapped
+//
+ssize_t Read(void *buff, off_t offset, size_t blen)
+            {if (offset < 0) return -EINVAL;
+             if (offset >= Size) return 0;
+             if ((off_t)blen > Size - offset) blen = Size - offset;
+             memcpy(buff, (char *)Base + offset, blen);
+             return (ssize_t)blen;
+            }
+
        XrdOssMioFile(char *hname)
                     {strcpy(HashName, hname); 
-                     inUse = 1; Next = 0; Size = 0;
+                     inUse = 1; Next = 0; Size = 0; isSmall = false;
                     }
       ~XrdOssMioFile();
 
@@ -51,8 +69,10 @@ private:
 XrdOssMioFile *Next;
 dev_t          Dev;
 ino_t          Ino;
+time_t         Mtime;
 int            Status;
 int            inUse;
+bool           isSmall;
 void          *Base;
 off_t          Size;
 char           HashName[64];
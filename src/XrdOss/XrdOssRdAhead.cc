@@ -0,0 +1,210 @@
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d O s s R d A h e a d . c c                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "XrdOss/XrdOssRdAhead.hh"
+#include "XrdOss/XrdOssTrace.hh"
+
+/******************************************************************************/
+/*                        G l o b a l   O b j e c t s                         */
+/******************************************************************************/
+
+extern XrdOucTrace  OssTrace;
+
+long long XrdOssRdAhead::raMin  = 0;
+long long XrdOssRdAhead::raMax  = 0;
+long long XrdOssRdAhead::pgMask = ~4095LL;
+bool      XrdOssRdAhead::raDrop = false;
+
+/******************************************************************************/
+/*                                A d v i s e                                 */
+/******************************************************************************/
+
+void XrdOssRdAhead::Advise(int fd, off_t offset, size_t blen)
+{
+#if defined(__linux__)
+   Stream *sP;
+   long long aBeg, aEnd, theEnd = offset + blen;
+   int depth;
+
+// Tracking is best effort, never make a reader wait for it. A zero length
+// read tells us nothing about the access pattern.
+//
+   if (!blen || !raMutex.CondLock()) return;
+   useTick++;
+
+// Classify this read. A read that continues one of the sequential streams is
+// sequential. Failing that, a read that is a constant forward distance from
+// the previous one that skips data is strided. Anything else is random and
+// starts a new stream that may turn out to be sequential. It takes several
+// random reads in a row to turn off kernel readahead since every sequential
+// reader starts with a seek.
+//
+   if ((sP = Match(offset, theEnd)))
+      {nSeq++; misses = 0; strRun = 0;
+       if (noRdAhead) SetRandom(fd, false);
+       if (theEnd > sP->nextOff) sP->nextOff = theEnd;
+       sP->runLen++;
+      }
+   else if (lastOff >= 0 && offset - lastOff == stride
+        &&  stride > (long long)blen)
+      {nStr++; misses = 0;
+       if (noRdAhead) SetRandom(fd, false);
+       if (!strRun++) strEnd = 0;
+      }
+   else {if (lastOff >= 0) nRnd++;
+         strRun = 0;
+         if (numStrm < maxStreams) sP = &strm[numStrm++];
+            else {sP = &strm[0];
+                  for (int i = 1; i < maxStreams; i++)
+                      if (strm[i].lastUse < sP->lastUse) sP = &strm[i];
+                 }
+         sP->nextOff = sP->advEnd = theEnd;
+         sP->dropEnd = offset & pgMask;
+         sP->window  = raMin;
+         sP->runLen  = 0;
+         sP->lastUse = useTick;
+         sP = 0;
+         if (++misses >= 2*maxStreams && !noRdAhead) SetRandom(fd, true);
+        }
+   stride  = (lastOff >= 0 ? offset - lastOff : 0);
+   lastOff = offset;
+
+// For sequential reads keep the window ahead of the reader, doubling it each
+// time less than a quarter of the window is left advised ahead of the reader.
+//
+   if (sP && sP->advEnd - sP->nextOff <= sP->window/4)
+      {aBeg = (sP->advEnd > sP->nextOff ? sP->advEnd : sP->nextOff) & pgMask;
+       aEnd = sP->nextOff + sP->window;
+       if (aEnd > aBeg)
+          {posix_fadvise(fd, aBeg, aEnd - aBeg, POSIX_FADV_WILLNEED);
+           nAdv += aEnd - aBeg; sP->advEnd = aEnd;
+          }
+       if ((sP->window *= 2) > raMax) sP->window = raMax;
+      }
+
+// Drop what a sequential reader has left behind, keeping enough to cover any
+// requests that are still outstanding.
+//
+   if (sP && raDrop && sP->nextOff - sP->dropEnd > 3*raMax)
+      {aEnd = (sP->nextOff - 2*raMax) & pgMask;
+       posix_fadvise(fd, sP->dropEnd, aEnd - sP->dropEnd, POSIX_FADV_DONTNEED);
+       nDrop += aEnd - sP->dropEnd; sP->dropEnd = aEnd;
+      }
+
+// For strided reads prefetch the next few strides not yet advised
+//
+   if (strRun >= 2)
+      {if ((depth = raMax / blen) > 8) depth = 8;
+          else if (depth < 1) depth = 1;
+       aBeg = offset + stride;
+       if (strEnd > aBeg) aBeg = strEnd;
+       aEnd = offset + stride * depth;
+       while(aBeg <= aEnd)
+            {posix_fadvise(fd, aBeg & pgMask, blen + (aBeg & ~pgMask),
+                           POSIX_FADV_WILLNEED);
+             nAdv += blen; aBeg += stride;
+            }
+       strEnd = aBeg;
+      }
+
+// All done
+//
+   raMutex.UnLock();
+#endif
+}
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+
+void XrdOssRdAhead::Init(long long rMin, long long rMax, bool rDrop)
+{
+   long long pgSize = (long long)sysconf(_SC_PAGESIZE);
+
+   if (pgSize > 0) pgMask = ~(pgSize-1);
+   raMin  = rMin;
+   raMax  = (rMax < rMin ? rMin : rMax);
+   raDrop = rDrop;
+}
+
+/******************************************************************************/
+/*                                R e p o r t                                 */
+/******************************************************************************/
+
+void XrdOssRdAhead::Report(const char *tident)
+{
+   EPNAME("RdAhead");
+
+   TRACE(Debug, "seq=" <<nSeq <<" stride=" <<nStr <<" random=" <<nRnd
+                <<" advised=" <<nAdv <<" dropped=" <<nDrop);
+}
+
+/******************************************************************************/
+/*                       P r i v a t e   M e t h o d s                        */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 M a t c h                                  */
+/******************************************************************************/
+
+XrdOssRdAhead::Stream *XrdOssRdAhead::Match(off_t offset, long long theEnd)
+{
+   Stream *sP;
+
+// A stream matches when the read starts where it left off. Once a stream is
+// established, reads within a maximum window of its position also match as
+// asynchronous requests complete out of order.
+//
+   for (int i = 0; i < numStrm; i++)
+       {sP = &strm[i];
+        if (offset == sP->nextOff
+        || (sP->runLen && offset <  sP->nextOff + raMax
+                       && theEnd >  sP->nextOff - raMax))
+           {sP->lastUse = useTick;
+            return sP;
+           }
+       }
+   return 0;
+}
+
+/******************************************************************************/
+/*                             S e t R a n d o m                              */
+/******************************************************************************/
+
+void XrdOssRdAhead::SetRandom(int fd, bool isRandom)
+{
+#if defined(__linux__)
+   posix_fadvise(fd, 0, 0, (isRandom ? POSIX_FADV_RANDOM : POSIX_FADV_NORMAL));
+#endif
+   noRdAhead = isRandom;
+}
@@ -0,0 +1,103 @@
+#ifndef __XRDOSSRDAHEAD_HH__
+#define __XRDOSSRDAHEAD_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                      X r d O s s R d A h e a d . h h                       */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <sys/types.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+// XrdOssRdAhead tracks the access pattern of reads against a single file and
+// gives the kernel hints accordingly. Up to maxStreams concurrent sequential
+// readers are followed, each getting a readahead window that doubles up to a
+// maximum each time the reader catches up with it. Reads separated by a
+// constant stride get the next few strides prefetched. When reads fit no
+// pattern for a while kernel readahead is turned off for the file. Optionally,
+// pages behind a sequential reader are dropped from the page cache as they
+// will not be reread. The tracker is a hint generator only; when it cannot
+// immediately get its lock the read simply goes unobserved.
+//
+class XrdOssRdAhead
+{
+public:
+
+void        Advise(int fd, off_t offset, size_t blen);
+
+static bool Enabled() {return raMax > 0;}
+
+static void Init(long long rMin, long long rMax, bool rDrop);
+
+void        Report(const char *tident);
+
+            XrdOssRdAhead() : lastOff(-1), stride(0), strEnd(0), nAdv(0),
+                              nDrop(0), nSeq(0), nStr(0), nRnd(0), strRun(0),
+                              misses(0), numStrm(0), useTick(0),
+                              noRdAhead(false) {}
+           ~XrdOssRdAhead() {}
+
+private:
+
+struct Stream
+      {long long nextOff;  // Offset one past the furthest read
+       long long advEnd;   // Offset one past the end of what was advised
+       long long dropEnd;  // Offset up to which pages have been dropped
+       long long window;   // Current readahead window
+       int       runLen;   // Reads that followed on
+       int       lastUse;  // Value of useTick when last matched
+      };
+
+static const int maxStreams = 4;
+
+Stream     *Match(off_t offset, long long theEnd);
+void        SetRandom(int fd, bool isRandom);
+
+XrdSysMutex raMutex;
+Stream      strm[maxStreams];
+long long   lastOff;   // Offset of the last read
+long long   stride;    // Distance between the starts of the last two reads
+long long   strEnd;    // Offset of the next stride not yet advised
+long long   nAdv;      // Bytes advised
+long long   nDrop;     // Bytes dropped
+int         nSeq;      // Reads classified as sequential
+int         nStr;      // Reads classified as strided
+int         nRnd;      // Reads classified as random
+int         strRun;    // Consecutive reads with the same stride
+int         misses;    // Consecutive reads matching no pattern
+int         numStrm;   // Number of streams in strm[]
+int         useTick;   // Incremented on each read
+bool        noRdAhead; // Kernel readahead has been turned off
+
+static long long raMin;
+static long long raMax;
+static long long pgMask;
+static bool      raDrop;
+};
+#endif
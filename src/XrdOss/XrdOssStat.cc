@@ -453,13 +453,14 @@ int XrdOssSys::getStats(char *buff, int blen)
    static const char stag1[] = "<space>%d";
    static const char stag2[] = "<stats id=\"%d\"><name>%s</name>"
                 "<tot>%lld</tot><free>%lld</free><maxf>%lld</maxf>"
-                "<fsn>%d</fsn><usg>%lld</usg>";
+                "<fsn>%d</fsn><usg>%lld</usg>"
+                "<alc>%lld</alc><nsp>%lld</nsp><lda>%lld</lda>";
    static const char stagq[] = "<qta>%lld</qta>";
    static const char stags[] = "</stats>";
    static const char stag3[] = "</space>";
 
    static const int stag1sz = sizeof(stag1);
-   static const int stag2sz = sizeof(stag2) + XrdOssSpace::maxSNlen + (16*5);
+   static const int stag2sz = sizeof(stag2) + XrdOssSpace::maxSNlen + (16*8);
    static const int stagqsz = sizeof(stagq) + 16;
    static const int stagssz = sizeof(stags);
    static const int stag3sz = sizeof(stag3);
@@ -516,7 +517,8 @@ int XrdOssSys::getStats(char *buff, int blen)
    while(fsg && blen > 0)
         {n = XrdOssCache_FS::getSpace(CSpace, fsg);
          flen = snprintf(bp, blen, stag2, spNum, fsg->group, CSpace.Total>>10,
-                CSpace.Free>>10, CSpace.Maxfree>>10, n, CSpace.Usage>>10);
+                CSpace.Free>>10, CSpace.Maxfree>>10, n, CSpace.Usage>>10,
+                CSpace.Allocs, CSpace.NoSpace, CSpace.LoadAvd);
          bp += flen; blen -= flen; spNum++;
          if (CSpace.Quota >= 0 && blen > stagqsz)
             {flen = sprintf(bp, stagq, CSpace.Quota); bp += flen; blen -= flen;}
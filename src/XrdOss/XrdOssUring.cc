@@ -0,0 +1,400 @@
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . c c                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#ifdef HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "XrdOss/XrdOssUring.hh"
+#include "XrdOss/XrdOssTrace.hh"
+#include "XrdOuc/XrdOucTrace.hh"
+#include "XrdSfs/XrdSfsAio.hh"
+#include "XrdSys/XrdSysError.hh"
+#include "XrdSys/XrdSysPthread.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                               G l o b a l s                                */
+/******************************************************************************/
+
+extern XrdOucTrace OssTrace;
+
+extern XrdSysError OssEroute;
+
+/******************************************************************************/
+/*                        S t a t i c   M e m b e r s                         */
+/******************************************************************************/
+
+XrdOssUring::Ring *XrdOssUring::Rings    = 0;
+int                XrdOssUring::numRings = 0;
+
+#ifdef HAVE_IO_URING
+/******************************************************************************/
+/*                     L o c a l   D e f i n i t i o n s                      */
+/******************************************************************************/
+
+namespace
+{
+// We use the raw system calls as liburing is not generally available. The
+// barriers order our accesses to the ring indices shared with the kernel.
+//
+inline int uSetup(unsigned entries, struct io_uring_params *p)
+           {return (int)syscall(__NR_io_uring_setup, entries, p);}
+
+inline int uEnter(int fd, unsigned toSubmit, unsigned minComp, unsigned flags)
+           {return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComp,
+                                flags, (void *)0, (size_t)0);
+           }
+
+inline int uRegister(int fd, unsigned opc, void *arg, unsigned nargs)
+           {return (int)syscall(__NR_io_uring_register, fd, opc, arg, nargs);}
+
+inline unsigned  uLoad(volatile unsigned *p)
+                      {unsigned v = *p; __sync_synchronize(); return v;}
+
+inline void      uStore(volatile unsigned *p, unsigned v)
+                       {__sync_synchronize(); *p = v;}
+
+// The operation type is kept in the low order bits of the user data as the
+// address of an XrdSfsAio object is always suitably aligned.
+//
+static const unsigned long long opMask = 0x03ULL;
+}
+
+/******************************************************************************/
+/*                     X r d O s s U r i n g : : R i n g                      */
+/******************************************************************************/
+
+struct XrdOssUring::Ring
+{
+XrdSysMutex          sqMutex;     // Serializes the submission queue
+int                  ringFD;
+int                  inFlight;    // Requests not yet reaped
+int                  toSubmit;    // Requests queued but not yet submitted
+bool                 Flushing;    // A thread is submitting on our behalf
+unsigned             sqEntries;
+unsigned             cqEntries;
+volatile unsigned   *sqHead;
+volatile unsigned   *sqTail;
+volatile unsigned   *sqArray;
+unsigned             sqMask;
+volatile unsigned   *cqHead;
+volatile unsigned   *cqTail;
+unsigned             cqMask;
+struct io_uring_sqe *sqes;
+struct io_uring_cqe *cqes;
+
+void                 Flush();
+bool                 Setup(XrdSysError &Eroute, int depth);
+void                 Reap();
+
+                     Ring() : ringFD(-1), inFlight(0), toSubmit(0),
+                              Flushing(false) {}
+};
+
+/******************************************************************************/
+/*                                 F l u s h                                  */
+/******************************************************************************/
+
+// Must be called with sqMutex held and Flushing false. Queued entries are
+// submitted in batches; other threads may keep adding entries while we are in
+// the kernel and these are picked up on the next iteration.
+//
+void XrdOssUring::Ring::Flush()
+{
+   int n, rc, delay = 1;
+
+   Flushing = true;
+   while((n = toSubmit))
+        {sqMutex.UnLock();
+         rc = uEnter(ringFD, n, 0, 0);
+         sqMutex.Lock();
+         if (rc > 0) {toSubmit -= rc; delay = 1; continue;}
+         if (rc < 0 && errno == EINTR) continue;
+
+      // The kernel could not accept anything right now. If requests are in
+      // the kernel the completion thread tries again when one of them ends.
+      // Otherwise nothing would ever wake it up, so back off and resubmit.
+      //
+         if (rc <= 0 && (rc == 0 || errno == EAGAIN || errno == EBUSY))
+            {if (inFlight > toSubmit) break;
+             sqMutex.UnLock();
+             XrdSysTimer::Wait(delay);
+             sqMutex.Lock();
+             if (delay < 64) delay <<= 1;
+             continue;
+            }
+
+      // The submit failed. The entries stay queued and the next submitter or
+      // the completion thread will try again.
+      //
+         OssEroute.Emsg("Uring", errno, "submit aio requests");
+         break;
+        }
+   Flushing = false;
+}
+
+/******************************************************************************/
+/*                                  R e a p                                   */
+/******************************************************************************/
+
+void XrdOssUring::Ring::Reap()
+{
+   EPNAME("UringReap");
+   XrdSfsAio *aiop;
+   unsigned long long uData;
+   unsigned head, tail;
+   int n, rc;
+
+// Wait for completions and hand each one back to its requestor
+//
+   while(1)
+        {rc = uEnter(ringFD, 0, 1, IORING_ENTER_GETEVENTS);
+         if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {OssEroute.Emsg("Uring", errno, "wait for aio completions");
+             sleep(1);
+            }
+
+         head = *cqHead; tail = uLoad(cqTail); n = 0;
+         while(head != tail)
+              {struct io_uring_cqe *cqe = &cqes[head & cqMask];
+               uData = cqe->user_data;
+               aiop  = (XrdSfsAio *)(uData & ~opMask);
+               aiop->Result = cqe->res;
+               uStore(cqHead, ++head);
+               n++;
+               DEBUG("op " <<(uData & opMask) <<" ended; rc=" <<aiop->Result
+                     <<" aiocb=" <<std::hex <<aiop <<std::dec);
+               if ((uData & opMask) == opRead) aiop->doneRead();
+                  else aiop->doneWrite();
+              }
+
+      // Account for what we reaped and push out anything left queued
+      //
+         if (n || toSubmit)
+            {sqMutex.Lock();
+             inFlight -= n;
+             if (toSubmit && !Flushing) Flush();
+             sqMutex.UnLock();
+            }
+        }
+}
+
+/******************************************************************************/
+/*                                 S e t u p                                  */
+/******************************************************************************/
+
+bool XrdOssUring::Ring::Setup(XrdSysError &Eroute, int depth)
+{
+   struct io_uring_params parms;
+   struct io_uring_probe *probe;
+   size_t sqLen, cqLen, pbLen;
+   char *sqMap, *cqMap;
+   bool isOK;
+
+// Create the ring
+//
+   memset(&parms, 0, sizeof(parms));
+   if ((ringFD = uSetup(depth, &parms)) < 0)
+      {Eroute.Emsg("Uring", errno, "create io_uring"); return false;}
+
+// Make sure the kernel knows about all of the operations we need
+//
+   pbLen = sizeof(*probe) + 256*sizeof(struct io_uring_probe_op);
+   probe = (struct io_uring_probe *)calloc(1, pbLen);
+   isOK  = uRegister(ringFD, IORING_REGISTER_PROBE, probe, 256) >= 0
+        && probe->last_op >= IORING_OP_WRITE
+        && probe->ops[IORING_OP_READ ].flags & IO_URING_OP_SUPPORTED
+        && probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED
+        && probe->ops[IORING_OP_FSYNC].flags & IO_URING_OP_SUPPORTED;
+   free(probe);
+   if (!isOK)
+      {Eroute.Emsg("Uring", "io_uring does not support read/write operations");
+       close(ringFD); ringFD = -1;
+       return false;
+      }
+
+// Map the submission and completion rings. Newer kernels allow both to be
+// mapped using a single mapping.
+//
+   sqLen = parms.sq_off.array + parms.sq_entries * sizeof(unsigned);
+   cqLen = parms.cq_off.cqes  + parms.cq_entries * sizeof(struct io_uring_cqe);
+   if (parms.features & IORING_FEAT_SINGLE_MMAP)
+      {if (cqLen > sqLen) sqLen = cqLen;
+       cqLen = sqLen;
+      }
+
+   sqMap = (char *)mmap(0, sqLen, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                        ringFD, IORING_OFF_SQ_RING);
+   if (sqMap == MAP_FAILED) cqMap = (char *)MAP_FAILED;
+      else if (parms.features & IORING_FEAT_SINGLE_MMAP) cqMap = sqMap;
+              else cqMap = (char *)mmap(0, cqLen, PROT_READ|PROT_WRITE,
+                                        MAP_SHARED|MAP_POPULATE,
+                                        ringFD, IORING_OFF_CQ_RING);
+   if (cqMap != MAP_FAILED)
+      sqes = (struct io_uring_sqe *)mmap(0,
+                    parms.sq_entries * sizeof(struct io_uring_sqe),
+                    PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                    ringFD, IORING_OFF_SQES);
+   if (cqMap == MAP_FAILED || sqes == MAP_FAILED)
+      {Eroute.Emsg("Uring", errno, "map io_uring");
+       if (cqMap != MAP_FAILED && cqMap != sqMap) munmap(cqMap, cqLen);
+       if (sqMap != MAP_FAILED) munmap(sqMap, sqLen);
+       close(ringFD); ringFD = -1;
+       return false;
+      }
+
+// Locate the ring indices
+//
+   sqEntries = parms.sq_entries;
+   sqHead    = (volatile unsigned *)(sqMap + parms.sq_off.head);
+   sqTail    = (volatile unsigned *)(sqMap + parms.sq_off.tail);
+   sqArray   = (volatile unsigned *)(sqMap + parms.sq_off.array);
+   sqMask    = *(unsigned *)(sqMap + parms.sq_off.ring_mask);
+   cqEntries = parms.cq_entries;
+   cqHead    = (volatile unsigned *)(cqMap + parms.cq_off.head);
+   cqTail    = (volatile unsigned *)(cqMap + parms.cq_off.tail);
+   cqMask    = *(unsigned *)(cqMap + parms.cq_off.ring_mask);
+   cqes      = (struct io_uring_cqe *)(cqMap + parms.cq_off.cqes);
+   return true;
+}
+
+/******************************************************************************/
+/*                        X r d O s s U r i n g R e a p                       */
+/******************************************************************************/
+
+void *XrdOssUringReap(void *carg)
+{
+   XrdOssUring::Ring *rP = (XrdOssUring::Ring *)carg;
+
+   rP->Reap();
+   return (void *)0;
+}
+#endif
+
+/******************************************************************************/
+/*                                  I n i t                                   */
+/******************************************************************************/
+
+bool XrdOssUring::Init(XrdSysError &Eroute, int rings, int depth)
+{
+#ifdef HAVE_IO_URING
+   EPNAME("UringInit");
+   pthread_t tid;
+   int i, retc;
+
+// Create the rings and start a completion thread for each one. Should we
+// fail part way through we simply use the rings we already have.
+//
+   Rings = new Ring[rings];
+   for (i = 0; i < rings; i++)
+       {if (!Rings[i].Setup(Eroute, depth)) break;
+        if ((retc = XrdSysThread::Run(&tid, XrdOssUringReap, &Rings[i],
+                                      0, "io_uring reaper")))
+           {Eroute.Emsg("Uring", retc, "create io_uring completion thread");
+            break;
+           }
+        DEBUG("started io_uring " <<i <<" depth " <<Rings[i].sqEntries);
+       }
+
+// Enable io_uring only if we have at least one usable ring
+//
+   if (!i) return false;
+   if (i < rings)
+      Eroute.Say("Config warning: fewer io_urings created than requested.");
+   numRings = i;
+   return true;
+#else
+   Eroute.Emsg("Uring", "io_uring is not supported on this platform.");
+   return false;
+#endif
+}
+
+/******************************************************************************/
+/*                                S u b m i t                                 */
+/******************************************************************************/
+
+int XrdOssUring::Submit(XrdSfsAio *aiop, int fd, opType opc)
+{
+#ifdef HAVE_IO_URING
+   static const unsigned char ioOp[] = {IORING_OP_FSYNC, IORING_OP_READ,
+                                        IORING_OP_WRITE};
+   Ring *rP = &Rings[fd % numRings];
+   struct io_uring_sqe *sqe;
+   unsigned tail, idx;
+
+// Make sure we have room in both queues; otherwise the caller must do this
+// synchronously. Requests for the same file always go to the same ring.
+//
+   rP->sqMutex.Lock();
+   tail = *rP->sqTail;
+   if (rP->inFlight >= (int)rP->cqEntries
+   ||  tail - uLoad(rP->sqHead) >= rP->sqEntries)
+      {rP->sqMutex.UnLock();
+       return -EAGAIN;
+      }
+
+// Fill out the submission entry
+//
+   idx = tail & rP->sqMask;
+   sqe = &rP->sqes[idx];
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode    = ioOp[opc];
+   sqe->fd        = fd;
+   if (opc != opFsync)
+      {sqe->addr  = (unsigned long long)(unsigned long)aiop->sfsAio.aio_buf;
+       sqe->len   = (unsigned)aiop->sfsAio.aio_nbytes;
+       sqe->off   = (unsigned long long)aiop->sfsAio.aio_offset;
+      }
+   sqe->user_data = (unsigned long long)(unsigned long)aiop | opc;
+   rP->sqArray[idx] = idx;
+   uStore(rP->sqTail, tail+1);
+   rP->inFlight++;
+   rP->toSubmit++;
+
+// Submit unless someone else is already doing so, in which case they will
+// pick up our entry as part of their batch.
+//
+   if (!rP->Flushing) rP->Flush();
+   rP->sqMutex.UnLock();
+   return 0;
+#else
+   return -ENOTSUP;
+#endif
+}
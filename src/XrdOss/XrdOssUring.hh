@@ -0,0 +1,67 @@
+#ifndef __XRDOSSURING_H__
+#define __XRDOSSURING_H__
+/******************************************************************************/
+/*                                                                            */
+/*                        X r d O s s U r i n g . h h                         */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+class XrdSfsAio;
+class XrdSysError;
+
+// XrdOssUring is an alternative to POSIX aio for XrdOssFile that uses the
+// Linux io_uring interface. Requests are spread over one or more rings, each
+// served by its own completion thread that invokes doneRead()/doneWrite() on
+// the original XrdSfsAio object. Submissions are batched: concurrent callers
+// append to the submission queue and a single caller enters the kernel on
+// behalf of all of them. When io_uring is not available Init() fails and the
+// caller should fall back to POSIX aio.
+//
+class XrdOssUring
+{
+public:
+
+enum opType {opFsync = 0, opRead = 1, opWrite = 2};
+
+static bool  Active() {return numRings > 0;}
+
+static bool  Init(XrdSysError &Eroute, int rings, int depth);
+
+// Submit an aio request for the file descriptor. Returns 0 when queued and
+// -errno otherwise. -EAGAIN indicates the ring is full and the request should
+// be executed synchronously.
+//
+static int   Submit(XrdSfsAio *aiop, int fd, opType opc);
+
+struct Ring;
+
+private:
+
+static Ring *Rings;
+static int   numRings;
+};
+#endif
@@ -34,10 +34,34 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include "XrdOuc/XrdOucCacheData.hh"
 #include "XrdSys/XrdSysHeaders.hh"
 
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+long long usNow()
+{
+   struct timeval tNow;
+
+   gettimeofday(&tNow, 0);
+   return static_cast<long long>(tNow.tv_sec)*1000000 + tNow.tv_usec;
+}
+
+// Objects in a strided stream (e.g. ROOT baskets) rarely have identical sizes
+// so we allow the stride to vary by an eighth.
+//
+long long Slack(long long Stride)
+{
+   return (Stride < 0 ? -Stride : Stride) >> 3;
+}
+}
+
 /******************************************************************************/
 /*                        X r d O u c C a c h e Z I O                         */
 /******************************************************************************/
@@ -84,9 +108,11 @@ XrdOucCacheData::XrdOucCacheData(XrdOucCacheReal *cP, XrdOucCacheIO *ioP,
 // Initialize the pre-read area
 //
    memset(prRR,  -1, sizeof(prRR) );
+   memset(prRO,  -1, sizeof(prRO) );
    memset(prBeg, -1, sizeof(prBeg));
    memset(prEnd, -1, sizeof(prEnd));
    memset(prOpt,  0, sizeof(prOpt));
+   memset(prStr,  0, sizeof(prStr));
 
    prNSS      =-1;
    prRRNow    = 0;
@@ -98,6 +124,9 @@ XrdOucCacheData::XrdOucCacheData(XrdOucCacheReal *cP, XrdOucCacheIO *ioP,
    prAuto     = (prOK ? setAPR(Apr, Cache->aprDefault, SegSize) : 0);
    prPerf     = 0;
    prCalc     = Apr.prRecalc;
+   prSClock   = 0;
+   prWaste    = 0;
+   prFetch    = 0;
 
 // Establish serialization options
 //
@@ -153,14 +182,15 @@ XrdOucCacheIO *XrdOucCacheData::Detach()
            snprintf(sBuff, sizeof(sBuff),
                           "Cache: Stats: %lld Read; %lld Get; %lld Pass; "
                           "%lld Write; %lld Put; %d Hits; %d Miss; "
-                          "%lld pead; %d HitsPR; %d MissPR; Path %s\n",
+                          "%lld pead; %d HitsPR; %d MissPR; %d WastePR; "
+                          "Path %s\n",
                           Statistics.BytesRead, Statistics.BytesGet,
                           Statistics.BytesPass, Statistics.BytesWrite,
                           Statistics.BytesPut,
                           Statistics.Hits,      Statistics.Miss,
                           Statistics.BytesPead,
                           Statistics.HitsPR,    Statistics.MissPR,
-                          ioObj->Path());
+                          prWaste,              ioObj->Path());
            cerr <<sBuff;
           }
        if (isADB) {delete ioObj; RetVal = 0;}
@@ -176,8 +206,8 @@ XrdOucCacheIO *XrdOucCacheData::Detach()
 void XrdOucCacheData::Preread()
 {
    MrSw EnforceMrSw(pPLock, pPLopt);
-   long long segBeg, segEnd;
-   int       oVal, pVal = 0, rLen, noIO, bPead = 0, prPages = 0;
+   long long segBeg, segEnd, tBeg;
+   int       oVal, pVal = 0, rLen, noIO, bPead = 0, prPages = 0, pPages;
    char *cBuff;
 
 // Check if we are stopping, if so, ignore this request
@@ -205,6 +235,7 @@ do{if ((oVal = prOpt[prNext]))
        oVal = (oVal == prSUSE ? XrdOucCacheSlot::isSUSE : 0)
             | XrdOucCacheSlot::isNew;
        segBeg |= VNum; segEnd |= VNum;
+       pPages = prPages; tBeg = usNow();
        do {if ((cBuff = Cache->Get(ioObj, segBeg, rLen, noIO)))
               {if (noIO)  pVal = 0;
                   else   {pVal = oVal; bPead += rLen; prPages++;}
@@ -219,6 +250,13 @@ do{if ((oVal = prOpt[prNext]))
            Statistics.UnLock();
           }
        DMutex.Lock();
+
+// Track how long it takes to fetch a segment, this sizes the preread window
+//
+       if ((pPages = prPages - pPages))
+          {int tSeg = static_cast<int>((usNow() - tBeg) / pPages);
+           prFetch = (prFetch ? (prFetch*3 + tSeg)/4 : tSeg);
+          }
       }
    } while(oVal);
 
@@ -270,6 +308,137 @@ void XrdOucCacheData::Preread(aprParms &Parms)
       }
 }
 
+/******************************************************************************/
+/*                               P r e d i c t                                */
+/******************************************************************************/
+
+// Match a read against the known streams or, failing that, discover a new
+// stream from the recent read history. Then preread what the stream is
+// expected to read next. Returns false if the read is not part of a stream.
+//
+bool XrdOucCacheData::Predict(long long Offs, int rLen)
+{
+   XrdSysMutexHelper Monitor(&DMutex);
+   prStream *sP = 0;
+   long long pBeg, pEnd, Dist, Diff, Need, segMax, tNow = usNow();
+   long long segBeg = Offs >> SegShft, segEnd = (Offs + rLen - 1) >> SegShft;
+   int i, j, Depth;
+
+// Check if this read continues a known stream. If so, update the deviation
+// from the stride and the time between reads.
+//
+   for (i = 0; i < prSMax; i++)
+       {if (!prStr[i].Stride) continue;
+        Diff = Offs - (prStr[i].Last + prStr[i].Stride);
+        if (Diff < 0) Diff = -Diff;
+        if (Diff <= Slack(prStr[i].Stride)) {sP = &prStr[i]; break;}
+       }
+   if (sP)
+      {sP->Jitter -= sP->Jitter/4;
+       if (Diff > sP->Jitter) sP->Jitter = Diff;
+       Need = tNow - sP->rTime;
+       if (Need > 0x7fffffff) Need = 0x7fffffff;
+       sP->Gap = (sP->Gap ? (sP->Gap*3 + static_cast<int>(Need))/4
+                          : static_cast<int>(Need));
+      }
+
+// Otherwise, see if this read and two recent ones are equally spaced. If so,
+// we have a new stream and it replaces the stream least recently used.
+//
+   if (!sP)
+      for (i = 0; i < prRRMax && !sP; i++)
+          {if (prRO[i] < 0 || !(Dist = Offs - prRO[i])) continue;
+           for (j = 0; j < prRRMax; j++)
+               {if (j == i || prRO[j] < 0) continue;
+                Diff = (prRO[i] - prRO[j]) - Dist;
+                if (Diff < 0) Diff = -Diff;
+                if (Diff <= Slack(Dist)) break;
+               }
+           if (j < prRRMax)
+              {sP = &prStr[0];
+               for (j = 1; j < prSMax; j++)
+                   if (prStr[j].Used < sP->Used) sP = &prStr[j];
+               sP->Stride = Dist;
+               sP->Jitter = Diff;
+               sP->Front  = (Dist > 0 ? segEnd : segBeg);
+               sP->Gap    = 0;
+               if (Debug) cerr <<"prS: stride " <<Dist <<'@' <<Offs <<' '
+                               <<ioObj->Path() <<endl;
+              }
+          }
+
+// Record this read in the history of recent reads
+//
+   prRR[prRRNow] = segBeg;
+   prRO[prRRNow] = Offs;
+   prRRNow = (prRRNow+1)%prRRMax;
+   if (!sP) return false;
+   sP->Last  = Offs;
+   sP->rLen  = rLen;
+   sP->rTime = tNow;
+   sP->Used  = ++prSClock;
+
+// Determine how many reads ahead we should preread. We want enough to cover
+// the time it takes to fetch what a read needs given how often reads arrive.
+//
+   Depth = 1;
+   if (sP->Gap > 0 && prFetch > 0)
+      {Need = static_cast<long long>(prFetch) * (segEnd - segBeg + 1);
+       Need = Need / sP->Gap + 1;
+       Depth = (Need > prDMax ? prDMax : static_cast<int>(Need));
+      }
+
+// Never preread past the end of the file
+//
+   if ((Need = ioObj->FSize()) <= 0) return true;
+   segMax = (Need - 1) >> SegShft;
+
+// Reads that are at most a segment apart are preread as a single run of
+// segments in the direction of the stream. Otherwise we preread each of the
+// expected reads widened by the recent deviation from the stride.
+//
+   Dist = (sP->Stride < 0 ? -sP->Stride : sP->Stride);
+   if (Dist <= rLen + SegSize)
+      {Need = (Depth * (Dist + SegSize - 1)) >> SegShft;
+       if (Need < Apr.minPages) Need = Apr.minPages;
+       if (sP->Stride > 0)
+          {pBeg = (sP->Front > segEnd ? sP->Front : segEnd) + 1;
+           pEnd = segEnd + Need;
+           if (pEnd > segMax) pEnd = segMax;
+           if (pBeg <= pEnd)
+              {QueueSegs(pBeg, pEnd, prLRU, 1); sP->Front = pEnd;}
+          } else {
+           pBeg = segBeg - Need;
+           pEnd = (sP->Front < segBeg ? sP->Front : segBeg) - 1;
+           if (pBeg < 0) pBeg = 0;
+           if (pEnd > segMax) pEnd = segMax;
+           if (pBeg <= pEnd)
+              {QueueSegs(pBeg, pEnd, prLRU, 1); sP->Front = pBeg;}
+          }
+       return true;
+      }
+
+   for (i = 1; i <= Depth; i++)
+       {pBeg = Offs + i*sP->Stride - sP->Jitter;
+        pEnd = Offs + i*sP->Stride + sP->Jitter + rLen - 1;
+        if (pEnd < 0) break;
+        pBeg = (pBeg < 0 ? 0 : pBeg >> SegShft);
+        pEnd = pEnd >> SegShft;
+        if (pEnd > segMax) pEnd = segMax;
+        if (sP->Stride > 0)
+           {if (pEnd <= sP->Front) continue;
+            if (pBeg <= sP->Front) pBeg = sP->Front + 1;
+           } else {
+            if (pBeg >= sP->Front) continue;
+            if (pEnd >= sP->Front) pEnd = sP->Front - 1;
+           }
+        if (pBeg > pEnd) break;
+        QueueSegs(pBeg, pEnd, prLRU, 1);
+        sP->Front = (sP->Stride > 0 ? pEnd : pBeg);
+       }
+   return true;
+}
+
 /******************************************************************************/
 /*                               Q u e u e P R                                */
 /******************************************************************************/
@@ -277,7 +446,7 @@ void XrdOucCacheData::Preread(aprParms &Parms)
 void XrdOucCacheData::QueuePR(long long segBeg, int rLen, int prHow, int isAuto)
 {
    XrdSysMutexHelper Monitor(&DMutex);
-   long long segCnt, segEnd;
+   long long segCnt;
    int i;
 
 // Scuttle everything if we are stopping
@@ -297,9 +466,25 @@ void XrdOucCacheData::QueuePR(long long segBeg, int rLen, int prHow, int isAuto)
        if (!segCnt) return;
       }
 
-// Compute last segment to read
+// Queue the segments
 //
-   segEnd = segBeg + segCnt - 1;
+   QueueSegs(segBeg, segBeg + segCnt - 1, prHow, isAuto);
+}
+
+/******************************************************************************/
+/*                             Q u e u e S e g s                              */
+/******************************************************************************/
+
+// The caller must hold DMutex.
+//
+void XrdOucCacheData::QueueSegs(long long segBeg, long long segEnd, int prHow,
+                                int isAuto)
+{
+   int i;
+
+// Scuttle everything if we are stopping
+//
+   if (prStop) return;
 
 // Run through the preread queue and check if we have this block scheduled or
 // we completed the block in the recent past. We do not catch overlapping
@@ -308,7 +493,8 @@ void XrdOucCacheData::QueuePR(long long segBeg, int rLen, int prHow, int isAuto)
    for (i = 0; i < prMax; i++)
        if (segBeg == prBeg[i] || (segBeg >  prBeg[i] && segEnd <= prEnd[i]))
           {if (prHow == prSKIP)
-              {if (Debug) cerr <<"pDQ: " <<rLen <<'@' <<(segBeg*SegSize) <<endl;
+              {if (Debug) cerr <<"pDQ: " <<(segEnd-segBeg+1)*SegSize <<'@'
+                               <<(segBeg*SegSize) <<endl;
                prOpt[i] = prSKIP;
               }
            return;
@@ -347,7 +533,8 @@ void XrdOucCacheData::QueuePR(long long segBeg, int rLen, int prHow, int isAuto)
 
 // If nothing pending then activate a preread
 //
-   if (Debug) cerr <<"prQ: add " <<rLen <<'@' <<(segBeg*SegSize) <<endl;
+   if (Debug) cerr <<"prQ: add " <<(segEnd-segBeg+1)*SegSize <<'@'
+                   <<(segBeg*SegSize) <<endl;
    if (!prActive) {prActive = prWait; Cache->PreRead(&prReq);}
 }
   
@@ -360,7 +547,7 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
    MrSw EnforceMrSw(rPLock, rPLopt);
    XrdOucCacheStats Now;
    char *cBuff, *Dest = Buff;
-   long long segOff, segNum = (Offs >> SegShft);
+   long long segOff, segNum = (Offs >> SegShft), rOffs = Offs;
    int noIO, rAmt, rGot, doPR = prAuto, rLeft = rLen;
 
 // Verify read length and offset
@@ -385,17 +572,13 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
 
 // We check now whether or not we will try to do a preread later. This is
 // advisory at this point so we don't need to obtain any locks to do this.
+// Reads of a recently read segment are only used for stream detection.
+// The read is added to the history of recent reads when we do the preread.
 //
    if (doPR)
       {if (rLen >= Apr.Trigger) doPR = 0;
           else for (noIO = 0; noIO < prRRMax; noIO++)
-                   if (prRR[noIO] == segNum) {doPR = 0; break;}
-       if (doPR)
-          {DMutex.Lock();
-           prRR[prRRNow] = segNum;
-           prRRNow = (prRRNow+1)%prRRMax;
-           DMutex.UnLock();
-          }
+                   if (prRR[noIO] == segNum) {doPR = -1; break;}
       }
    if (Debug > 1) cerr <<"Rdr: " <<rLen <<'@' <<Offs <<" pr=" <<doPR <<endl;
 
@@ -425,11 +608,13 @@ int XrdOucCacheData::Read(char *Buff, long long Offs, int rLen)
 //
    Statistics.Add(Now);
 
-// See if a preread needs to be done. We will only do this if no errors occured
+// See if a preread needs to be done. We will only do this if no errors occured.
+// Reads that are part of a stream are preread according to the stream,
+// otherwise we simply preread the segments following this read.
 //
    if (doPR && cBuff)
       {EnforceMrSw.UnLock();
-       QueuePR(segNum, rLen, prLRU, 1);
+       if (!Predict(rOffs, rLen) && doPR > 0) QueuePR(segNum, rLen, prLRU, 1);
       }
 
 // All done, if we ended fine, return amount read. If there is no page buffer
@@ -69,6 +69,9 @@ int            Sync() {return 0;} // We only support write-through for now
 
 int            Trunc(long long Offset);
 
+void           Wasted(int pages)  // Preread pages dropped before being used
+                     {Statistics.Lock(); prWaste += pages; Statistics.UnLock();}
+
 int            Write(char  *Buffer, long long  Offset,  int  Length);
 
                XrdOucCacheData(XrdOucCacheReal *cP, XrdOucCacheIO *ioP,
@@ -76,7 +79,10 @@ int            Write(char  *Buffer, long long  Offset,  int  Length);
 
 private:
               ~XrdOucCacheData() {}
+bool           Predict(long long Offs, int rLen);
 void           QueuePR(long long SegOffs, int rLen, int prHow, int isAuto=0);
+void           QueueSegs(long long segBeg, long long segEnd, int prHow,
+                         int isAuto);
 int            Read (XrdOucCacheStats &Now,
                       char *Buffer, long long Offs, int Length);
 
@@ -128,11 +134,12 @@ XrdSysSemaphore *prStop;
 
 long long        prNSS;          // Next Sequential Segment for maxi prereads
 
-static const int prRRMax= 5;
+static const int prRRMax= 8;
 long long        prRR[prRRMax];  // Recent reads
+long long        prRO[prRRMax];  // Recent read offsets (parallels prRR)
 int              prRRNow;        // Pointer to next entry to use
 
-static const int prMax  = 8;
+static const int prMax  = 16;
 static const int prRun  = 1;     // Status in prActive (running)
 static const int prWait = 2;     // Status in prActive (waiting)
 
@@ -151,5 +158,30 @@ char             prOpt[prMax];
 char             prOK;
 char             prActive;
 char             prAuto;
+
+// Stream detection for automatic prereads. A stream is a sequence of reads
+// whose offsets are roughly a constant number of bytes (the stride) apart.
+// The stride may be negative and up to prSMax streams may be interleaved.
+// How far ahead a stream is preread depends on how long it takes to fetch a
+// segment relative to how quickly the stream is being read.
+//
+struct prStream
+      {long long    Last;    // Offset of the last read in the stream
+       long long    Stride;  // Bytes between reads (0 -> entry unused)
+       long long    Jitter;  // Recent deviation from the stride in bytes
+       long long    Front;   // Furthest segment queued for preread
+       long long    rTime;   // Time of the last read in microseconds
+       int          rLen;    // Length of the last read
+       int          Gap;     // Average microseconds between reads
+       unsigned int Used;    // Value of prSClock when last used
+      };
+
+static const int prSMax = 4;     // Maximum number of streams tracked
+static const int prDMax = 8;     // Maximum number of reads preread ahead
+
+prStream         prStr[prSMax];
+unsigned int     prSClock;
+int              prFetch;        // Average microseconds to fetch a segment
+int              prWaste;        // Preread pages dropped before being used
 };
 #endif
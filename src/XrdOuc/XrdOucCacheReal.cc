@@ -248,7 +248,7 @@ int XrdOucCacheReal::Detach(XrdOucCacheIO *ioP)
 {
    XrdSysMutexHelper Monitor(CMutex);
    XrdOucCacheSlot  *sP, *oP;
-   int sNum, Fnum, Free = 0, Faults = 0;
+   int sNum, Fnum, Free = 0, Faults = 0, Waste = 0;
 
 // Now we delete this CacheIO from the cache set and see if its still ref'd.
 //
@@ -262,7 +262,8 @@ int XrdOucCacheReal::Detach(XrdOucCacheIO *ioP)
         {sP = &Slots[oP->Own.Next];
          sP->Owner(Slots);
          if (sP->Contents < 0 || sP->Status.LRU.Next < 0) Faults++;
-            else {sP->Hide(Slots, Slash, sP->Contents%HNum);
+            else {if (sP->Count & XrdOucCacheSlot::isNew) Waste++;
+                  sP->Hide(Slots, Slash, sP->Contents%HNum);
                   sP->Pull(Slots);
                   sP->unRef(Slots);
                   Free++;
@@ -273,6 +274,7 @@ int XrdOucCacheReal::Detach(XrdOucCacheIO *ioP)
 //
    Attached--;
    if (AZero && Attached <= 0) AZero->Post();
+   if (Waste) prWaste(Fnum, Waste);
 
 // Issue debugging message
 //
@@ -350,7 +352,11 @@ char *XrdOucCacheReal::Get(XrdOucCacheIO *ioP, long long lAddr,
 //
    sP = &Slots[Slot];
    if (sP->Contents >= 0)
-      {if (sP->Own.Next != Slot) sP->Owner(Slots);
+      {if (sP->Own.Next != Slot)
+          {if (sP->Count & XrdOucCacheSlot::isNew)
+              prWaste((sP->Contents >> Shift) + SegCnt, 1);
+           sP->Owner(Slots);
+          }
        sP->Hide(Slots, Slash, sP->Contents%HNum);
       }
 
@@ -498,6 +504,20 @@ void XrdOucCacheReal::PreRead(XrdOucCacheReal::prTask *prReq)
    prMutex.UnLock();
 }
 
+/******************************************************************************/
+/*                               p r W a s t e                                */
+/******************************************************************************/
+
+// Charge preread pages that were dropped without ever being referenced to the
+// file that asked for them. The cache lock must be held.
+//
+void XrdOucCacheReal::prWaste(int Fnum, int pages)
+{
+   XrdOucCacheData *dP = Slots[Fnum].Status.Data;
+
+   if (dP) dP->Wasted(pages);
+}
+
 /******************************************************************************/
 /*                                   R e f                                    */
 /******************************************************************************/
@@ -129,6 +129,7 @@ struct prTask
        XrdOucCacheData *Data;
       };
 void             PreRead(XrdOucCacheReal::prTask *prReq);
+void             prWaste(int Fnum, int pages);
 prTask          *prFirst;
 prTask          *prLast;
 XrdSysMutex      prMutex;
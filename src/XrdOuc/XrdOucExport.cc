@@ -38,7 +38,7 @@
   
 /* Function: ParseDefs
 
-   Purpose:  Parse: defaults [[no]check] [[no]dread]
+   Purpose:  Parse: defaults [[no]check] [[no]direct] [[no]dread]
 
                              [[no]filter] [forcero]
 
@@ -91,6 +91,8 @@ unsigned long long XrdOucExport::ParseDefs(XrdOucStream      &Config,
         {"nostage",       XRDEXP_STAGE,   0,              XRDEXP_STAGE_X},
         {"stage",         0,              XRDEXP_STAGE,   XRDEXP_STAGE_X},
         {"stage+",        0,              XRDEXP_STAGEMM, XRDEXP_STAGE_X},
+        {"direct",        0,              XRDEXP_DIRECT,  XRDEXP_DIRECT_X},
+        {"nodirect",      XRDEXP_DIRECT,  0,              XRDEXP_DIRECT_X},
         {"dread",         XRDEXP_NODREAD, 0,              XRDEXP_DREAD_X},
         {"nodread",       0,              XRDEXP_NODREAD, XRDEXP_DREAD_X},
         {"check",         XRDEXP_NOCHECK, 0,              XRDEXP_CHECK_X},
@@ -141,6 +143,7 @@ unsigned long long XrdOucExport::ParseDefs(XrdOucStream      &Config,
              <path>    the path prefix that applies
              <options> a blank separated list of options:
                        [no]check    - [don't] check if new file exists in MSS
+                       [no]direct   - [don't] bypass the page cache for data
                        [no]dread    - [don't] read actual directory contents
                            forcero  - force r/w opens to r/o opens
                            inplace  - do not use extended cache for creation
@@ -189,6 +192,11 @@ XrdOucPList *XrdOucExport::ParsePath(XrdOucStream &Config, XrdSysError &Eroute,
        rpval |= XRDEXP_FORCERO;
       }
    if (rpval & (XRDEXP_MLOK | XRDEXP_MKEEP)) rpval |= XRDEXP_MMAP;
+   if ((rpval & XRDEXP_DIRECT) && (rpval & XRDEXP_MEMAP))
+      {Eroute.Emsg("config", "warning, file memory mapping disabled direct "
+                             "i/o for path", path);
+       rpval &= ~XRDEXP_DIRECT;
+      }
 
 // Update the export list. If this path is being modified, turn off all bits
 // in the old path specified in the new path and then set the new bits.
@@ -67,7 +67,8 @@
 #define XRDEXP_INPLACE_X  0x0001000000000000LL
 #define XRDEXP_MWMODE     0x0000000000020000LL
 #define XRDEXP_MWMODE_X   0x0002000000000000LL
-//                        0x0004000000040000LL
+#define XRDEXP_DIRECT     0x0000000000040000LL
+#define XRDEXP_DIRECT_X   0x0004000000000000LL
 #define XRDEXP_LOCAL      0x0000000000080000LL
 #define XRDEXP_LOCAL_X    0x0008000000000000LL
 #define XRDEXP_GLBLRO     0x0000000000100000LL
@@ -9,6 +9,7 @@ set( LIB_XRD_PSS        XrdPss-${PLUGIN_VERSION} )
 set( LIB_XRD_GPFS       XrdOssSIgpfsT-${PLUGIN_VERSION} )
 set( LIB_XRD_ZCRC32     XrdCksCalczcrc32-${PLUGIN_VERSION} )
 set( LIB_XRD_THROTTLE   XrdThrottle-${PLUGIN_VERSION} )
+set( LIB_XRD_TPCCL      XrdOfsTPCCl-${PLUGIN_VERSION} )
 
 #-------------------------------------------------------------------------------
 # Shared library version
@@ -22,6 +23,8 @@ add_library(
   MODULE
   XrdPss/XrdPssAio.cc
   XrdPss/XrdPssAioCB.cc      XrdPss/XrdPssAioCB.hh
+  XrdPss/XrdPssMeta.cc       XrdPss/XrdPssMeta.hh
+  XrdPss/XrdPssPool.cc       XrdPss/XrdPssPool.hh
   XrdPss/XrdPss.cc           XrdPss/XrdPss.hh
   XrdPss/XrdPssCks.cc        XrdPss/XrdPssCks.hh
   XrdPss/XrdPssConfig.cc )
@@ -127,6 +130,31 @@ set_target_properties(
   INTERFACE_LINK_LIBRARIES ""
   LINK_INTERFACE_LIBRARIES "" )
 
+#-------------------------------------------------------------------------------
+# The in-process third party copy engine
+#-------------------------------------------------------------------------------
+if( ENABLE_XRDCL )
+  add_library(
+    ${LIB_XRD_TPCCL}
+    MODULE
+    XrdOfs/XrdOfsTPCCl.cc )
+
+  target_link_libraries(
+    ${LIB_XRD_TPCCL}
+    XrdCl
+    XrdUtils )
+
+  set_target_properties(
+    ${LIB_XRD_TPCCL}
+    PROPERTIES
+    INTERFACE_LINK_LIBRARIES ""
+    LINK_INTERFACE_LIBRARIES "" )
+
+  install(
+    TARGETS ${LIB_XRD_TPCCL}
+    LIBRARY DESTINATION ${CMAKE_INSTALL_LIBDIR} )
+endif()
+
 #-------------------------------------------------------------------------------
 # Install
 #-------------------------------------------------------------------------------
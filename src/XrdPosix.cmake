@@ -21,10 +21,13 @@ add_library(
   XrdPosix/XrdPosixDir.cc          XrdPosix/XrdPosixDir.hh
   XrdPosix/XrdPosixFile.cc         XrdPosix/XrdPosixFile.hh
   XrdPosix/XrdPosixFileRH.cc       XrdPosix/XrdPosixFileRH.hh
+  XrdPosix/XrdPosixIOQueue.cc      XrdPosix/XrdPosixIOQueue.hh
   XrdPosix/XrdPosixMap.cc          XrdPosix/XrdPosixMap.hh
+  XrdPosix/XrdPosixMeta.cc         XrdPosix/XrdPosixMeta.hh
   XrdPosix/XrdPosixObject.cc       XrdPosix/XrdPosixObject.hh
                                    XrdPosix/XrdPosixObjGuard.hh
   XrdPosix/XrdPosixPrepIO.cc       XrdPosix/XrdPosixPrepIO.hh
+  XrdPosix/XrdPosixShmCache.cc     XrdPosix/XrdPosixShmCache.hh
   XrdPosix/XrdPosixXrootd.cc       XrdPosix/XrdPosixXrootd.hh
   XrdPosix/XrdPosixXrootdPath.cc   XrdPosix/XrdPosixXrootdPath.hh
                                    XrdPosix/XrdPosixOsDep.hh    )
@@ -33,7 +36,8 @@ target_link_libraries(
   XrdPosix
   XrdCl
   XrdUtils
-  pthread )
+  pthread
+  ${EXTRA_LIBS} )
 
 set_target_properties(
   XrdPosix
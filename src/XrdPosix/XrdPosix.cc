@@ -686,6 +686,23 @@ long long XrdPosix_Pread(int fildes, void *buf, unsigned long long nbyte,
 }
 }
 
+/******************************************************************************/
+/*                       X r d P o s i x _ P r e a d v                        */
+/******************************************************************************/
+  
+extern "C"
+{
+long long XrdPosix_Preadv(int fildes, const struct iovec *iov, int iovcnt,
+                          long long offset)
+{
+
+// Return the results of the read
+//
+   return (Xroot.myFD(fildes) ? Xroot.Preadv  (fildes, iov, iovcnt, offset)
+                              : Xunix.Preadv64(fildes, iov, iovcnt, offset));
+}
+}
+
 /******************************************************************************/
 /*                       X r d P o s i x _ P w r i t e                        */
 /******************************************************************************/
@@ -703,6 +720,23 @@ long long XrdPosix_Pwrite(int fildes, const void *buf, unsigned long long nbyte,
 }
 }
 
+/******************************************************************************/
+/*                      X r d P o s i x _ P w r i t e v                       */
+/******************************************************************************/
+  
+extern "C"
+{
+long long XrdPosix_Pwritev(int fildes, const struct iovec *iov, int iovcnt,
+                           long long offset)
+{
+
+// Return the results of the write
+//
+   return (Xroot.myFD(fildes) ? Xroot.Pwritev  (fildes, iov, iovcnt, offset)
+                              : Xunix.Pwritev64(fildes, iov, iovcnt, offset));
+}
+}
+
 /******************************************************************************/
 /*                         X r d P o s i x _ R e a d                          */
 /******************************************************************************/
@@ -152,6 +152,9 @@ extern long       XrdPosix_Pathconf(const char *path, int name);
 extern long long  XrdPosix_Pread(int fildes, void *buf, unsigned long long nbyte,
                                  long long offset);
 
+extern long long  XrdPosix_Preadv(int fildes, const struct iovec *iov,
+                                  int iovcnt, long long offset);
+
 extern long long  XrdPosix_Read(int fildes, void *buf, unsigned long long nbyte);
   
 extern long long  XrdPosix_Readv(int fildes, const struct iovec *iov, int iovcnt);
@@ -181,6 +184,9 @@ extern int        XrdPosix_Statvfs(const char *path, struct statvfs *buf);
 extern long long  XrdPosix_Pwrite(int fildes, const void *buf, 
                                   unsigned long long nbyte, long long offset);
 
+extern long long  XrdPosix_Pwritev(int fildes, const struct iovec *iov,
+                                   int iovcnt, long long offset);
+
 extern long       XrdPosix_Telldir(DIR *dirp);
 
 extern int        XrdPosix_Truncate(const char *path, long long offset);
@@ -101,6 +101,8 @@ static void          DelayedDestroy(XrdPosixFile *fp);
 
        void          isOpen();
 
+       bool          isUpdate() {return (cOpt & XrdOucCache::optRW) != 0;}
+
        void          updLock()   {updMutex.Lock();}
 
        void          updUnLock() {updMutex.UnLock();}
@@ -0,0 +1,212 @@
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d P o s i x I O Q u e u e . c c                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+
+#include "XrdOuc/XrdOucIOVec.hh"
+#include "XrdPosix/XrdPosixIOQueue.hh"
+#include "XrdPosix/XrdPosixXrootd.hh"
+
+/******************************************************************************/
+/*                 X r d P o s i x I O Q u e u e : : i o C B                  */
+/******************************************************************************/
+
+class XrdPosixIOQueue::ioCB : public XrdPosixCallBackIO
+{
+public:
+
+void             Complete(ssize_t Result)
+                         {result = Result;
+                          errNum = (Result < 0 ? errno : 0);
+                          queue->Done(this);
+                         }
+
+XrdPosixIOQueue *queue;
+ioCB            *next;
+void            *usrData;
+ssize_t          result;
+int              errNum;
+
+                 ioCB() : queue(0), next(0), usrData(0), result(0), errNum(0) {}
+                ~ioCB() {}
+};
+  
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPosixIOQueue::XrdPosixIOQueue(int depth)
+                : qCV(0, "XrdPosixIOQueue"), doneFirst(0), doneLast(0),
+                  numDone(0), numBusy(0), numRun(0)
+{
+   int i;
+
+// Allocate the callback objects, one per possible request
+//
+   qDepth = (depth > 0 ? depth : 1);
+   cbVec  = new ioCB[qDepth];
+   for (i = 0; i < qDepth; i++)
+       {cbVec[i].queue = this;
+        cbVec[i].next  = (i+1 < qDepth ? &cbVec[i+1] : 0);
+       }
+   freeCB = cbVec;
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+  
+XrdPosixIOQueue::~XrdPosixIOQueue()
+{
+
+// We cannot delete the callback objects while requests are still in flight
+//
+   qCV.Lock();
+   while(numRun) qCV.Wait();
+   qCV.UnLock();
+   delete [] cbVec;
+}
+
+/******************************************************************************/
+/*                                  D o n e                                   */
+/******************************************************************************/
+  
+void XrdPosixIOQueue::Done(ioCB *cbP)
+{
+
+// Place the completed request at the end of the done queue and wake up anyone
+// waiting for completions.
+//
+   qCV.Lock();
+   cbP->next = 0;
+   if (doneLast) doneLast->next = cbP;
+      else       doneFirst      = cbP;
+   doneLast = cbP;
+   numDone++; numRun--;
+   qCV.Broadcast();
+   qCV.UnLock();
+}
+
+/******************************************************************************/
+/*                               P e n d i n g                                */
+/******************************************************************************/
+  
+int XrdPosixIOQueue::Pending()
+{
+   int n;
+
+   qCV.Lock(); n = numBusy; qCV.UnLock();
+   return n;
+}
+
+/******************************************************************************/
+/*                                  R e a p                                   */
+/******************************************************************************/
+  
+int XrdPosixIOQueue::Reap(XrdPosixIOEvent *evVec, int minEv, int maxEv, int tmo)
+{
+   ioCB *cbP;
+   int n = 0;
+
+// Wait for the minimum number of completions. We can't wait for more than
+// could possibly complete.
+//
+   qCV.Lock();
+   if (minEv > maxEv) minEv = maxEv;
+   while(numDone < minEv && numDone < numBusy)
+        {if (tmo < 0) qCV.Wait();
+            else if (qCV.WaitMS(tmo)) break;
+        }
+
+// Return as many completions as we can
+//
+   while(n < maxEv && (cbP = doneFirst))
+        {if (!(doneFirst = cbP->next)) doneLast = 0;
+         evVec[n].usrData = cbP->usrData;
+         evVec[n].result  = cbP->result;
+         evVec[n].errNum  = cbP->errNum;
+         cbP->next = freeCB; freeCB = cbP;
+         numDone--; numBusy--; n++;
+        }
+   qCV.UnLock();
+   return n;
+}
+
+/******************************************************************************/
+/*                                S u b m i t                                 */
+/******************************************************************************/
+  
+int XrdPosixIOQueue::Submit(XrdPosixIOReq *rqVec, int numRq)
+{
+   XrdPosixIOReq *rqP;
+   ioCB *cbP;
+   int n;
+
+// Start each request. We must not hold the queue lock while doing so as the
+// callback may be invoked on this thread when the request fails right away.
+//
+   for (n = 0; n < numRq; n++)
+       {qCV.Lock();
+        if (!(cbP = freeCB)) {qCV.UnLock(); break;}
+        freeCB = cbP->next;
+        numBusy++; numRun++;
+        qCV.UnLock();
+
+        rqP = &rqVec[n];
+        cbP->usrData = rqP->usrData;
+        switch(rqP->opCode)
+              {case opRead:
+                    XrdPosixXrootd::Pread(rqP->fildes, rqP->buff, rqP->nbyte,
+                                          rqP->offset, cbP);
+                    break;
+               case opWrite:
+                    XrdPosixXrootd::Pwrite(rqP->fildes, rqP->buff, rqP->nbyte,
+                                           rqP->offset, cbP);
+                    break;
+               case opReadV:
+                    XrdPosixXrootd::VRead(rqP->fildes,
+                                          (const XrdOucIOVec *)rqP->buff,
+                                          (int)rqP->nbyte, cbP);
+                    break;
+               case opSync:
+                    XrdPosixXrootd::Fsync(rqP->fildes, cbP);
+                    break;
+               default:
+                    errno = EINVAL;
+                    cbP->Complete(-1);
+                    break;
+              }
+       }
+
+// Indicate what happened
+//
+   if (!n && numRq > 0) {errno = EAGAIN; return -1;}
+   return n;
+}
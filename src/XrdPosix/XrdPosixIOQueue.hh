@@ -0,0 +1,146 @@
+#ifndef __POSIX_IOQUEUE_HH__
+#define __POSIX_IOQUEUE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                    X r d P o s i x I O Q u e u e . h h                     */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <sys/types.h>
+
+#include "XrdPosix/XrdPosixCallBack.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+//-----------------------------------------------------------------------------
+//! Describes one request submitted to an XrdPosixIOQueue.
+//-----------------------------------------------------------------------------
+
+struct XrdPosixIOReq
+{
+int       fildes;   //!< File descriptor returned by XrdPosixXrootd::Open()
+int       opCode;   //!< One of the XrdPosixIOQueue::opXXXX request codes
+void     *buff;     //!< Data buffer or, for opReadV, an XrdOucIOVec vector
+size_t    nbyte;    //!< Bytes to read or write or, for opReadV, vector size
+off_t     offset;   //!< File offset (not used for opReadV and opSync)
+void     *usrData;  //!< Handed back unchanged in the completion event
+};
+
+//-----------------------------------------------------------------------------
+//! Describes the completion of a request reaped from an XrdPosixIOQueue.
+//-----------------------------------------------------------------------------
+
+struct XrdPosixIOEvent
+{
+void     *usrData;  //!< The usrData of the completed request
+ssize_t   result;   //!< What the synchronous call would have returned
+int       errNum;   //!< The errno value when result is negative, else 0
+};
+
+//-----------------------------------------------------------------------------
+//! @brief A completion queue for asynchronous I/O on XrdPosix files.
+//!
+//! This class allows many requests to be started with one call and their
+//! completions to be collected in bulk later on, much like io_submit() and
+//! io_getevents(). This allows an application to keep many requests in
+//! flight without having to supply a callback object for each one. A queue
+//! has a fixed depth which limits the number of requests that have been
+//! submitted but whose completion has not yet been reaped. A queue may be
+//! used by any number of threads.
+//-----------------------------------------------------------------------------
+
+class XrdPosixIOQueue
+{
+public:
+
+static const int opRead  = 0;
+static const int opWrite = 1;
+static const int opReadV = 2;
+static const int opSync  = 3;
+
+//-----------------------------------------------------------------------------
+//! Return the number of requests that have been submitted but not reaped.
+//-----------------------------------------------------------------------------
+
+int  Pending();
+
+//-----------------------------------------------------------------------------
+//! Reap completed requests.
+//!
+//! @param  evVec  pointer to a vector to receive the completion events.
+//! @param  minEv  the minimum number of events to wait for.
+//! @param  maxEv  the maximum number of events to return.
+//! @param  tmo    maximum number of milliseconds to wait for minEv events.
+//!                A negative value waits forever.
+//!
+//! @return The number of events placed in evVec. This may be less than minEv
+//!         if the timeout expired or fewer requests were pending.
+//-----------------------------------------------------------------------------
+
+int  Reap(XrdPosixIOEvent *evVec, int minEv, int maxEv, int tmo=-1);
+
+//-----------------------------------------------------------------------------
+//! Submit requests.
+//!
+//! @param  rqVec  pointer to the vector of requests.
+//! @param  numRq  the number of requests in rqVec.
+//!
+//! @return The number of requests that were started. This is less than numRq
+//!         when the queue is full. If no request could be started, -1 is
+//!         returned and errno is set to EAGAIN. Requests that fail right away
+//!         are started and report their failure via a completion event.
+//-----------------------------------------------------------------------------
+
+int  Submit(XrdPosixIOReq *rqVec, int numRq);
+
+//-----------------------------------------------------------------------------
+//! Constructor and destructor. The destructor waits for all in-flight
+//! requests to complete; completions that were not reaped are discarded.
+//!
+//! @param  depth  the maximum number of requests not yet reaped.
+//-----------------------------------------------------------------------------
+
+     XrdPosixIOQueue(int depth=256);
+    ~XrdPosixIOQueue();
+
+private:
+
+class ioCB;
+friend class ioCB;
+
+void          Done(ioCB *cbP);
+
+XrdSysCondVar qCV;
+ioCB         *cbVec;
+ioCB         *freeCB;
+ioCB         *doneFirst;
+ioCB         *doneLast;
+int           numDone;  // Completed and not yet reaped
+int           numBusy;  // Submitted and not yet reaped
+int           numRun;   // Submitted and not yet completed
+int           qDepth;
+};
+#endif
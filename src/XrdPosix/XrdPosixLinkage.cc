@@ -146,10 +146,14 @@ XrdPosixLinkage Xunix;
                          {return (Retv_Pread)Xunix.Load_Error("pread");}
       Retv_Pread64     Xrd_U_Pread64(Args_Pread64)
                          {return (Retv_Pread64)Xunix.Load_Error("pread");}
+      Retv_Preadv64    Xrd_U_Preadv64(Args_Preadv64)
+                         {return (Retv_Preadv64)Xunix.Load_Error("preadv");}
       Retv_Pwrite      Xrd_U_Pwrite(Args_Pwrite) 
                          {return (Retv_Pwrite)Xunix.Load_Error("pwrite");}
       Retv_Pwrite64    Xrd_U_Pwrite64(Args_Pwrite64)
                          {return (Retv_Pwrite64)Xunix.Load_Error("pwrite");}
+      Retv_Pwritev64   Xrd_U_Pwritev64(Args_Pwritev64)
+                         {return (Retv_Pwritev64)Xunix.Load_Error("pwritev");}
       Retv_Read        Xrd_U_Read(Args_Read) 
                          {return (Retv_Read)Xunix.Load_Error("read");}
       Retv_Readv       Xrd_U_Readv(Args_Readv) 
@@ -241,8 +245,10 @@ int XrdPosixLinkage::Resolve()
   LOOKUP_UNIX(Pathconf)
   LOOKUP_UNIX(Pread)
   LOOKUP_UNIX(Pread64)
+  LOOKUP_UNIX(Preadv64)
   LOOKUP_UNIX(Pwrite)
   LOOKUP_UNIX(Pwrite64)
+  LOOKUP_UNIX(Pwritev64)
   LOOKUP_UNIX(Read)
   LOOKUP_UNIX(Readv)
   LOOKUP_UNIX(Readdir)
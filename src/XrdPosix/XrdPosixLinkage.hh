@@ -232,6 +232,10 @@
 #define Retv_Pread64 ssize_t
 #define Args_Pread64 int, void *, size_t, off64_t
 
+#define Symb_Preadv64 UNIX_PFX "preadv64"
+#define Retv_Preadv64 ssize_t
+#define Args_Preadv64 int, const struct iovec *, int, off64_t
+
 #define Symb_Pwrite UNIX_PFX "pwrite"
 #define Retv_Pwrite ssize_t
 #define Args_Pwrite int, const void *, size_t, off_t
@@ -240,6 +244,10 @@
 #define Retv_Pwrite64 ssize_t
 #define Args_Pwrite64 int, const void *, size_t, off64_t
 
+#define Symb_Pwritev64 UNIX_PFX "pwritev64"
+#define Retv_Pwritev64 ssize_t
+#define Args_Pwritev64 int, const struct iovec *, int, off64_t
+
 #define Symb_Read UNIX_PFX "read"
 #define Retv_Read ssize_t
 #define Args_Read int, void *, size_t
@@ -387,8 +395,10 @@ class XrdPosixLinkage
       Retv_Pathconf    (*Pathconf)(Args_Pathconf);
       Retv_Pread       (*Pread)(Args_Pread);
       Retv_Pread64     (*Pread64)(Args_Pread64);
+      Retv_Preadv64    (*Preadv64)(Args_Preadv64);
       Retv_Pwrite      (*Pwrite)(Args_Pwrite);
       Retv_Pwrite64    (*Pwrite64)(Args_Pwrite64);
+      Retv_Pwritev64   (*Pwritev64)(Args_Pwritev64);
       Retv_Read        (*Read)(Args_Read);
       Retv_Readv       (*Readv)(Args_Readv);
       Retv_Readdir     (*Readdir)(Args_Readdir);
@@ -0,0 +1,261 @@
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d P o s i x M e t a . c c                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "XrdCl/XrdClURL.hh"
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdPosix/XrdPosixMeta.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+namespace
+{
+int getVal(XrdOucEnv &theEnv, const char *vName, int dflt)
+{
+   char *eP, *tP;
+   long  val;
+
+   if (!(tP = theEnv.Get(vName)) || !(*tP)) return dflt;
+   errno = 0;
+   val = strtol(tP, &eP, 10);
+   if (errno || *eP || val < 0 || val > 0x7fffffff)
+      {cerr <<"XrdPosix: 'XRDPOSIX_MCACHE=" <<vName <<'=' <<tP
+            <<"' is invalid." <<endl;
+       return dflt;
+      }
+   return static_cast<int>(val);
+}
+};
+  
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPosixMeta::XrdPosixMeta(int pTTL, int nTTL, int lTTL, int maxEnt)
+             : posTTL(pTTL), negTTL(nTTL), locTTL(lTTL)
+{
+   maxPerShard = maxEnt / numShards;
+   if (maxPerShard < 16) maxPerShard = 16;
+}
+
+/******************************************************************************/
+/*                                A d d L o c                                 */
+/******************************************************************************/
+  
+void XrdPosixMeta::AddLoc(const char *path, const char *loc)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+
+   if (locTTL <= 0 || !loc || !(*loc)) return;
+   if ((eP = Get(sh, key)))
+      {eP->Loc  = loc;
+       eP->lExp = time(0) + locTTL;
+      }
+}
+
+/******************************************************************************/
+/*                               A d d S t a t                                */
+/******************************************************************************/
+  
+void XrdPosixMeta::AddStat(const char *path, struct stat *sbuf, int rc)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+   int ttl = (rc ? negTTL : posTTL);
+
+// Only successful results and non-existence are worth remembering
+//
+   if (ttl <= 0 || (rc && rc != ENOENT)) return;
+   if ((eP = Get(sh, key)))
+      {eP->rc   = rc;
+       eP->sExp = time(0) + ttl;
+       if (!rc) eP->sBuf = *sbuf;
+      }
+}
+
+/******************************************************************************/
+/*                                C r e a t e                                 */
+/******************************************************************************/
+  
+XrdPosixMeta *XrdPosixMeta::Create(const char *eData)
+{
+   XrdOucEnv theEnv(eData);
+   int pTTL, nTTL, lTTL, maxEnt;
+
+// Get all of the values, any errors simply result in the default
+//
+   pTTL   = getVal(theEnv, "ttl",    10);
+   nTTL   = getVal(theEnv, "nttl",    5);
+   lTTL   = getVal(theEnv, "lttl",  300);
+   maxEnt = getVal(theEnv, "maxent", 65536);
+
+// If nothing is to be cached then there is no cache
+//
+   if ((!pTTL && !nTTL && !lTTL) || !maxEnt) return 0;
+   return new XrdPosixMeta(pTTL, nTTL, lTTL, maxEnt);
+}
+
+/******************************************************************************/
+/*                               D r o p L o c                                */
+/******************************************************************************/
+  
+void XrdPosixMeta::DropLoc(const char *path)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   EntMap::iterator it = sh.Ents.find(key);
+
+   if (it != sh.Ents.end()) {it->second.Loc.clear(); it->second.lExp = 0;}
+}
+
+/******************************************************************************/
+/*                               F i n d L o c                                */
+/******************************************************************************/
+  
+bool XrdPosixMeta::FindLoc(const char *path, std::string &loc)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   EntMap::iterator it = sh.Ents.find(key);
+
+   if (it == sh.Ents.end() || it->second.lExp <= time(0)) return false;
+   loc = it->second.Loc;
+   return true;
+}
+
+/******************************************************************************/
+/*                              F i n d S t a t                               */
+/******************************************************************************/
+  
+bool XrdPosixMeta::FindStat(const char *path, struct stat &sbuf, int &rc)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   EntMap::iterator it = sh.Ents.find(key);
+
+   if (it == sh.Ents.end() || it->second.sExp <= time(0)) return false;
+   if (!(rc = it->second.rc)) sbuf = it->second.sBuf;
+   return true;
+}
+
+/******************************************************************************/
+/*                                   G e t                                    */
+/******************************************************************************/
+
+// Return the entry for key, adding it if need be. Must be called with the
+// shard locked.
+//
+XrdPosixMeta::Entry *XrdPosixMeta::Get(Shard &sh, const std::string &key)
+{
+   EntMap::iterator it = sh.Ents.find(key);
+   Entry *eP;
+
+// If we have the entry, make it the most recently used one
+//
+   if (it != sh.Ents.end())
+      {sh.LRU.splice(sh.LRU.end(), sh.LRU, it->second.lruP);
+       return &(it->second);
+      }
+
+// Make room if need be by dropping the least recently used entry
+//
+   if ((int)sh.Ents.size() >= maxPerShard && !sh.LRU.empty())
+      {sh.Ents.erase(sh.LRU.front());
+       sh.LRU.pop_front();
+      }
+
+// Add a new empty entry
+//
+   eP = &sh.Ents[key];
+   eP->sExp = eP->lExp = 0;
+   eP->rc   = 0;
+   eP->lruP = sh.LRU.insert(sh.LRU.end(), key);
+   return eP;
+}
+
+/******************************************************************************/
+/*                            I n v a l i d a t e                             */
+/******************************************************************************/
+  
+void XrdPosixMeta::Invalidate(const char *path)
+{
+   std::string key = MakeKey(path);
+   Shard &sh = ShardOf(key);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   EntMap::iterator it = sh.Ents.find(key);
+
+   if (it != sh.Ents.end())
+      {sh.LRU.erase(it->second.lruP);
+       sh.Ents.erase(it);
+      }
+}
+
+/******************************************************************************/
+/*                               M a k e K e y                                */
+/******************************************************************************/
+
+// The key is the url without any cgi so that the same file accessed with
+// different (e.g. security) cgi maps to the same entry.
+//
+std::string XrdPosixMeta::MakeKey(const char *path)
+{
+   XrdCl::URL url(path);
+   const char *qP;
+
+   if (url.IsValid()) return url.GetHostId() + url.GetPath();
+   if ((qP = strchr(path, '?'))) return std::string(path, qP - path);
+   return std::string(path);
+}
+
+/******************************************************************************/
+/*                               S h a r d O f                                */
+/******************************************************************************/
+  
+XrdPosixMeta::Shard &XrdPosixMeta::ShardOf(const std::string &key)
+{
+   unsigned int hval = 2166136261U;
+   int i, n = key.size();
+
+   for (i = 0; i < n; i++) hval = (hval ^ (unsigned char)key[i]) * 16777619U;
+   return shards[hval % numShards];
+}
@@ -0,0 +1,118 @@
+#ifndef __POSIX_META_HH__
+#define __POSIX_META_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                       X r d P o s i x M e t a . h h                        */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <list>
+#include <map>
+#include <string>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "XrdSys/XrdSysPthread.hh"
+
+/******************************************************************************/
+/*                    C l a s s   X r d P o s i x M e t a                     */
+/******************************************************************************/
+
+// The metadata cache avoids repeated round trips for applications that stat
+// the same paths over and over (typically via the preload library). It holds
+// stat results for a positive ttl and ENOENT for a negative ttl. It also holds
+// the data server a file was last opened on so that the next read-only open
+// can go there directly, bypassing the redirector. Entries are keyed by the
+// url without cgi and spread over shards, each with its own lock. The cache is
+// only enabled via the XRDPOSIX_MCACHE envar whose value is a cgi string:
+
+// ttl=n    - seconds successful stat results are kept (default 10).
+// nttl=n   - seconds ENOENT results are kept (default 5).
+// lttl=n   - seconds data server locations are kept, 0 disables (default 300).
+// maxent=n - maximum number of entries (default 65536).
+
+class XrdPosixMeta
+{
+public:
+
+// Stat lookups return true if the path is cached, rc is 0 or an errno value.
+//
+bool  FindStat(const char *path, struct stat &sbuf, int &rc);
+
+void  AddStat (const char *path, struct stat *sbuf, int rc);
+
+// Location lookups return true and set loc to "host:port" if known.
+//
+bool  FindLoc (const char *path, std::string &loc);
+
+void  AddLoc  (const char *path, const char *loc);
+
+void  DropLoc (const char *path);
+
+// Drop whatever is known about path, used when it is being modified.
+//
+void  Invalidate(const char *path);
+
+// Return a cache configured by the passed cgi string or nil if disabled.
+//
+static XrdPosixMeta *Create(const char *eData);
+
+      XrdPosixMeta(int pTTL, int nTTL, int lTTL, int maxEnt);
+     ~XrdPosixMeta() {}
+
+private:
+
+struct Entry
+      {time_t                           sExp;   // Stat info valid until
+       time_t                           lExp;   // Location valid until
+       int                              rc;
+       struct stat                      sBuf;
+       std::string                      Loc;
+       std::list<std::string>::iterator lruP;
+      };
+
+typedef std::map<std::string, Entry> EntMap;
+
+struct Shard
+      {XrdSysMutex            Mutex;
+       EntMap                 Ents;
+       std::list<std::string> LRU;
+      };
+
+static const int numShards = 16;
+
+Entry       *Get(Shard &sh, const std::string &key);
+std::string  MakeKey(const char *path);
+Shard       &ShardOf(const std::string &key);
+
+Shard        shards[numShards];
+int          maxPerShard;
+int          posTTL;
+int          negTTL;
+int          locTTL;
+};
+#endif
@@ -30,6 +30,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
 
@@ -42,7 +43,9 @@
 /******************************************************************************/
 
 XrdSysMutex      XrdPosixObject::fdMutex;
-XrdPosixObject **XrdPosixObject::myFiles  =  0;
+XrdSysMutex      XrdPosixObject::slotMutex;
+XrdPosixObject::fdSlot
+                *XrdPosixObject::myFiles  =  0;
 int              XrdPosixObject::highFD   = -1;
 int              XrdPosixObject::lastFD   = -1;
 int              XrdPosixObject::baseFD   =  0;
@@ -64,23 +67,26 @@ bool XrdPosixObject::AssignFD(bool isStream)
 //
    if (baseFD)
       { if (isStream) return 0;
-        for (fd = freeFD; fd < posxFD && myFiles[fd]; fd++) {}
+        for (fd = freeFD; fd < posxFD && myFiles[fd].objP; fd++) {}
         if (fd >= posxFD) return 0;
         freeFD = fd+1;
       } else {
         do{if ((fd = dup(devNull)) < 0) return false;
            if (fd >= lastFD || (isStream && fd > 255))
               {close(fd); return 0;}
-           if (!myFiles[fd]) break;
+           if (!myFiles[fd].objP) break;
            cerr <<"XrdPosix: FD " <<fd <<" closed outside of XrdPosix!" <<endl;
           } while(1);
       }
 
-// Enter object in out vector of objects and assign it the FD
+// Enter object in out vector of objects and assign it the FD. The fd number
+// must be set before the object becomes visible to lock-free lookups.
 //
-   myFiles[fd] = this;
-   if (fd > highFD) highFD = fd;
    fdNum  = fd + baseFD;
+   AtomicBeg(slotMutex);
+   AtomicCAS(myFiles[fd].objP, (XrdPosixObject *)0, this);
+   AtomicEnd(slotMutex);
+   if (fd > highFD) highFD = fd;
 
 // All done.
 //
@@ -102,12 +108,19 @@ XrdPosixDir *XrdPosixObject::Dir(int fd, bool glk)
 //
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixDir *)0;}
+   fdSlot &slot = myFiles[fd - baseFD];
 
-// Obtain the file object, if any
+// Obtain the file object, if any. Only callers that want to destroy the object
+// need the global lock, everyone else finds the object without it.
 //
-   fdMutex.Lock();
-   if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&dP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+   if (glk)
+      {fdMutex.Lock();
+       if (!(oP = slot.objP) || !(oP->Who(&dP)))
+          {fdMutex.UnLock(); errno = EBADF; return (XrdPosixDir *)0;}
+      } else {
+       if (!(oP = Find(slot)) || !(oP->Who(&dP)))
+          {UnFind(slot); errno = EBADF; return (XrdPosixDir *)0;}
+      }
 
 // Attempt to lock the object in the appropriate mode. If we fail, then we need
 // to retry this after dropping the global lock. We pause a bit to let the
@@ -117,18 +130,26 @@ do{if (fd >= lastFD || fd < baseFD)
    if (glk) haveLock = oP->objMutex.CondWriteLock();
       else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
+      {if (glk) fdMutex.UnLock();
+          else  UnFind(slot);
        waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held, this is a call to destroy the object. The
+// object stays write locked until it has been removed from the table so that
+// lock-free lookups cannot latch onto it. Otherwise, make sure the object was
+// not removed while we were locking it.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+   if (!glk)
+      {if (slot.objP != oP)
+          {oP->UnLock(); UnFind(slot);
+           errno = EBADF; return (XrdPosixDir *)0;
+          }
+       UnFind(slot);
+      }
    return dP;
   } while(1);
 
@@ -153,12 +174,19 @@ XrdPosixFile *XrdPosixObject::File(int fd, bool glk)
 //
 do{if (fd >= lastFD || fd < baseFD)
       {errno = EBADF; return (XrdPosixFile *)0;}
+   fdSlot &slot = myFiles[fd - baseFD];
 
-// Obtain the file object, if any
+// Obtain the file object, if any. Only callers that want to destroy the object
+// need the global lock, everyone else finds the object without it.
 //
-   fdMutex.Lock();
-   if (!(oP = myFiles[fd - baseFD]) || !(oP->Who(&fP)))
-      {fdMutex.UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+   if (glk)
+      {fdMutex.Lock();
+       if (!(oP = slot.objP) || !(oP->Who(&fP)))
+          {fdMutex.UnLock(); errno = EBADF; return (XrdPosixFile *)0;}
+      } else {
+       if (!(oP = Find(slot)) || !(oP->Who(&fP)))
+          {UnFind(slot); errno = EBADF; return (XrdPosixFile *)0;}
+      }
 
 // Attempt to lock the object in the appropriate mode. If we fail, then we need
 // to retry this after dropping the global lock. We pause a bit to let the
@@ -168,18 +196,26 @@ do{if (fd >= lastFD || fd < baseFD)
    if (glk) haveLock = oP->objMutex.CondWriteLock();
       else  haveLock = oP->objMutex.CondReadLock();
    if (!haveLock)
-      {fdMutex.UnLock();
+      {if (glk) fdMutex.UnLock();
+          else  UnFind(slot);
        waitCount++;
        if (waitCount > 120) break;
        XrdSysTimer::Wait(500); // We wait 500 milliseconds
        continue;
       }
 
-// If the global lock is to be held, then release the object lock as this
-// is a call to destroy the object and there is no need for the local lock.
+// If the global lock is to be held, this is a call to destroy the object. The
+// object stays write locked until it has been removed from the table so that
+// lock-free lookups cannot latch onto it. Otherwise, make sure the object was
+// not removed while we were locking it.
 //
-   if (glk) oP->UnLock();
-      else  fdMutex.UnLock();
+   if (!glk)
+      {if (slot.objP != oP)
+          {oP->UnLock(); UnFind(slot);
+           errno = EBADF; return (XrdPosixFile *)0;
+          }
+       UnFind(slot);
+      }
    return fP;
   } while(1);
 
@@ -189,6 +225,24 @@ do{if (fd >= lastFD || fd < baseFD)
    return (XrdPosixFile *)0;
 }
 
+/******************************************************************************/
+/*                                  F i n d                                   */
+/******************************************************************************/
+
+// Register as a user of the slot and return the object in it, if any. The
+// caller must call UnFind() when it no longer needs the slot to be stable.
+//
+XrdPosixObject *XrdPosixObject::Find(fdSlot &slot)
+{
+   XrdPosixObject *oP;
+
+   AtomicBeg(slotMutex);
+   AtomicInc(slot.inUse);
+   oP = slot.objP;
+   AtomicEnd(slotMutex);
+   return oP;
+}
+
 /******************************************************************************/
 /*                                  I n i t                                   */
 /******************************************************************************/
@@ -225,11 +279,11 @@ int XrdPosixObject::Init(int fdnum)
 //
    if (fdnum < 0) {posxFD = fdnum = -fdnum; baseFD = limfd;}
       else         fdnum = limfd;
-   isize = fdnum * sizeof(XrdPosixFile *);
+   isize = fdnum * sizeof(fdSlot);
 
 // Allocate the table for fd-type pointers
 //
-   if (!(myFiles = (XrdPosixObject **)malloc(isize))) lastFD = -1;
+   if (!(myFiles = (fdSlot *)malloc(isize))) lastFD = -1;
       else {memset((void *)myFiles, 0, isize); lastFD = fdnum+baseFD;}
 
 // All done
@@ -247,14 +301,15 @@ void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
 //
    if (needlk) fdMutex.Lock();
 
-// Remove the object from the table
+// Remove the object from the table and wait until no lookup can still be
+// referring to it. Only then can the fd be reused.
 //
    if (baseFD)
       {int myFD = oP->fdNum - baseFD;
        if (myFD < freeFD) freeFD = myFD;
-       myFiles[myFD] = 0;
+       Quiesce(myFiles[myFD], oP);
       } else {
-       myFiles[oP->fdNum] = 0;
+       Quiesce(myFiles[oP->fdNum], oP);
        close(oP->fdNum);
       }
 
@@ -264,6 +319,27 @@ void XrdPosixObject::Release(XrdPosixObject *oP, bool needlk)
    fdMutex.UnLock();
 }
 
+/******************************************************************************/
+/*                               Q u i e s c e                                */
+/******************************************************************************/
+
+// Must be called with the global lock held.
+//
+void XrdPosixObject::Quiesce(fdSlot &slot, XrdPosixObject *oP)
+{
+   int users;
+
+   AtomicBeg(slotMutex);
+   AtomicCAS(slot.objP, oP, (XrdPosixObject *)0);
+   AtomicEnd(slotMutex);
+
+   do {AtomicBeg(slotMutex);
+       users = AtomicGet(slot.inUse);
+       AtomicEnd(slotMutex);
+       if (users) sched_yield();
+      } while(users);
+}
+
 /******************************************************************************/
 /*                            R e l e a s e D i r                             */
 /******************************************************************************/
@@ -279,6 +355,7 @@ XrdPosixDir *XrdPosixObject::ReleaseDir(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)dP, false);
+   ((XrdPosixObject *)dP)->UnLock();
    return dP;
 }
 
@@ -297,6 +374,7 @@ XrdPosixFile *XrdPosixObject::ReleaseFile(int fd)
 // Release it and return the underlying object
 //
    Release((XrdPosixObject *)fP, false);
+   ((XrdPosixObject *)fP)->UnLock();
    return fP;
 }
   
@@ -314,8 +392,8 @@ void XrdPosixObject::Shutdown()
    fdMutex.Lock();
    if (myFiles)
       {for (i = 0; i <= highFD; i++) 
-           if ((oP = myFiles[i]))
-              {myFiles[i] = 0;
+           if ((oP = myFiles[i].objP))
+              {Quiesce(myFiles[i], oP);
                if (oP->fdNum >= 0) close(oP->fdNum);
                oP->fdNum = -1;
                delete oP;
@@ -324,3 +402,14 @@ void XrdPosixObject::Shutdown()
       }
    fdMutex.UnLock();
 }
+  
+/******************************************************************************/
+/*                                U n F i n d                                 */
+/******************************************************************************/
+
+void XrdPosixObject::UnFind(fdSlot &slot)
+{
+   AtomicBeg(slotMutex);
+   AtomicDec(slot.inUse);
+   AtomicEnd(slotMutex);
+}
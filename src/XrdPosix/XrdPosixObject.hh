@@ -81,7 +81,7 @@ static  void          Shutdown();
 
 static  bool          Valid(int fd)
                            {return fd >= baseFD && fd <= (highFD+baseFD)
-                                   && myFiles && myFiles[fd-baseFD];}
+                                   && myFiles && myFiles[fd-baseFD].objP;}
 
 virtual bool          Who(XrdPosixDir  **dirP)  {return false;}
 
@@ -98,8 +98,23 @@ protected:
 
 private:
 
+// Each fd slot counts the threads that are looking up the object in it. Such
+// lookups do not take the global lock. Whoever removes an object from a slot
+// (always under the global lock) waits for the count to drop to zero, after
+// which no one can still be holding a stale pointer to the object.
+//
+struct fdSlot
+      {XrdPosixObject *volatile objP;
+       int                      inUse;
+      };
+
+static XrdPosixObject  *Find(fdSlot &slot);
+static void             Quiesce(fdSlot &slot, XrdPosixObject *oP);
+static void             UnFind(fdSlot &slot);
+
 static XrdSysMutex      fdMutex;
-static XrdPosixObject **myFiles;
+static XrdSysMutex      slotMutex; // Only used without atomics
+static fdSlot          *myFiles;
 static int              lastFD;
 static int              highFD;
 static int              baseFD;
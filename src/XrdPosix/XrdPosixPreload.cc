@@ -519,6 +519,22 @@ ssize_t pread64(int fildes, void *buf, size_t nbyte, off_t offset)
 }
 }
 
+/******************************************************************************/
+/*                                p r e a d v                                 */
+/******************************************************************************/
+  
+#if defined(__linux__)
+extern "C"
+{
+ssize_t preadv64(int fildes, const struct iovec *iov, int iovcnt, off_t offset)
+{
+   static int Init = Xunix.Init(&Init);
+
+   return XrdPosix_Preadv(fildes, iov, iovcnt, offset);
+}
+}
+#endif
+
 /******************************************************************************/
 /*                                p w r i t e                                 */
 /******************************************************************************/
@@ -533,6 +549,22 @@ ssize_t pwrite64(int fildes, const void *buf, size_t nbyte, off_t offset)
 }
 }
 
+/******************************************************************************/
+/*                               p w r i t e v                                */
+/******************************************************************************/
+  
+#if defined(__linux__)
+extern "C"
+{
+ssize_t pwritev64(int fildes, const struct iovec *iov, int iovcnt, off_t offset)
+{
+   static int Init = Xunix.Init(&Init);
+
+   return XrdPosix_Pwritev(fildes, iov, iovcnt, offset);
+}
+}
+#endif
+
 /******************************************************************************/
 /*                                  r e a d                                   */
 /******************************************************************************/
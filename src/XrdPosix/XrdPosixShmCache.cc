@@ -0,0 +1,667 @@
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d P o s i x S h m C a c h e . c c                    */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "XrdOuc/XrdOucEnv.hh"
+#include "XrdPosix/XrdPosixShmCache.hh"
+#include "XrdSys/XrdSysAtomics.hh"
+#include "XrdSys/XrdSysHeaders.hh"
+#include "XrdSys/XrdSysTimer.hh"
+
+/******************************************************************************/
+/*                       L o c a l   D e f i n e s                            */
+/******************************************************************************/
+
+namespace
+{
+const int shmMagic   = 0x78707363;   // "xpsc"
+const int shmVersion = 1;
+const int shmHdrSize = 4096;         // Slots start at this offset
+const int shmSetSize = 8;            // Slots per set
+const int shmMaxRun  = 16;           // Maximum pages fetched after a miss
+
+/******************************************************************************/
+/*                       L o c a l   F u n c t i o n s                        */
+/******************************************************************************/
+
+long long getVal(XrdOucEnv &theEnv, const char *vName, long long dflt)
+{
+   char *eP, *tP;
+   long long val;
+
+   if (!(tP = theEnv.Get(vName)) || !(*tP)) return dflt;
+   errno = 0;
+   val = strtoll(tP, &eP, 10);
+   if (!errno && val > 0)
+      switch(*eP)
+            {case 'k': case 'K': val <<= 10; eP++; break;
+             case 'm': case 'M': val <<= 20; eP++; break;
+             case 'g': case 'G': val <<= 30; eP++; break;
+             default: break;
+            }
+   if (errno || *eP || val <= 0)
+      {cerr <<"XrdPosix: 'XRDPOSIX_SHMCACHE=" <<vName <<'=' <<tP
+            <<"' is invalid." <<endl;
+       return dflt;
+      }
+   return val;
+}
+
+/******************************************************************************/
+
+// A file is identified by its url (sans cgi), modification time, size, and
+// inode number so that a file that was replaced is not served from stale
+// pages, even when it was replaced within the same second. The inode number
+// is the file id reported by the server and changes when a file is recreated.
+// A key of zero is reserved to mark an empty slot.
+//
+long long MakeKey(const char *path, struct stat &sBuf)
+{
+   unsigned long long hash = 0xcbf29ce484222325ULL;
+#if defined(__APPLE__)
+   unsigned long long mNsec = (unsigned long long)sBuf.st_mtimespec.tv_nsec;
+#else
+   unsigned long long mNsec = (unsigned long long)sBuf.st_mtim.tv_nsec;
+#endif
+   unsigned long long vals[4] = {(unsigned long long)sBuf.st_mtime, mNsec,
+                                 (unsigned long long)sBuf.st_size,
+                                 (unsigned long long)sBuf.st_ino};
+
+   while(*path && *path != '?')
+        {hash ^= (unsigned char)*path++; hash *= 0x100000001b3ULL;}
+   for (int i = 0; i < 4; i++)
+       {hash ^= vals[i]; hash *= 0x100000001b3ULL;}
+   return static_cast<long long>(hash | 1);
+}
+}
+
+/******************************************************************************/
+/*             C l a s s   X r d P o s i x S h m C a c h e I O                */
+/******************************************************************************/
+
+class XrdPosixShmCacheIO : public XrdOucCacheIO2
+{
+public:
+
+XrdOucCacheIO2 *Base()   {return ioP;}
+
+XrdOucCacheIO2 *Detach() {XrdOucCacheIO2 *theIO = ioP;
+                          shmCache->Stats.Add(Statistics);
+                          delete this;
+                          return theIO;
+                         }
+
+long long       FSize() {return ioP->FSize();}
+
+int             Fstat(struct stat &buf) {return ioP->Fstat(buf);}
+
+const char     *Location() {return ioP->Location();}
+
+const char     *Path()  {return ioP->Path();}
+
+using           XrdOucCacheIO2::Read;
+
+int             Read (char *buff, long long offs, int rlen);
+
+void            Read (XrdOucCacheIOCB &iocb, char *buff, long long offs,
+                      int rlen);
+
+using           XrdOucCacheIO2::ReadV;
+
+int             ReadV(const XrdOucIOVec *readV, int n);
+
+void            ReadV(XrdOucCacheIOCB &iocb, const XrdOucIOVec *readV, int n);
+
+using           XrdOucCacheIO2::Sync;
+
+int             Sync() {return ioP->Sync();}
+
+void            Sync(XrdOucCacheIOCB &iocb) {ioP->Sync(iocb);}
+
+int             Trunc(long long offs) {return ioP->Trunc(offs);}
+
+void            Update(XrdOucCacheIO2 &iocp) {ioP = &iocp;}
+
+using           XrdOucCacheIO2::Write;
+
+int             Write(char *buff, long long offs, int wlen)
+                     {return ioP->Write(buff, offs, wlen);}
+
+void            Write(XrdOucCacheIOCB &iocb, char *buff, long long offs,
+                      int wlen) {ioP->Write(iocb, buff, offs, wlen);}
+
+                XrdPosixShmCacheIO(XrdPosixShmCache *cP, XrdOucCacheIO2 *iP,
+                                   long long fKey)
+                                  : shmCache(cP), ioP(iP), fileKey(fKey),
+                                    pageSize(cP->PageSize()) {}
+
+               ~XrdPosixShmCacheIO() {}
+
+private:
+int             Cached(char *buff, long long offs, int rlen);
+int             Fetch(long long pNum, char *buff, int pOff, int rlen,
+                      long long fSize);
+void            Insert(const char *buff, long long offs, int blen,
+                       long long fSize);
+
+XrdPosixShmCache *shmCache;
+XrdOucCacheIO2   *ioP;
+long long         fileKey;
+int               pageSize;
+};
+
+/******************************************************************************/
+/*                                C a c h e d                                 */
+/******************************************************************************/
+
+// Copy the data from the cache if every page in the range is present. Return
+// the number of bytes copied or -1 if any page is missing.
+//
+int XrdPosixShmCacheIO::Cached(char *buff, long long offs, int rlen)
+{
+   long long fSize = ioP->FSize();
+   int bLen, pOff, totLen = 0;
+
+   if (offs < 0 || fSize < 0) return -1;
+   if (offs >= fSize || rlen <= 0) return 0;
+   if (offs + rlen > fSize) rlen = fSize - offs;
+
+   while(rlen > 0)
+        {pOff = offs % pageSize;
+         bLen = pageSize - pOff;
+         if (bLen > rlen) bLen = rlen;
+         if (shmCache->Find(fileKey, offs/pageSize, buff, pOff, bLen) != bLen)
+            return -1;
+         buff += bLen; offs += bLen; rlen -= bLen; totLen += bLen;
+        }
+   return totLen;
+}
+
+/******************************************************************************/
+/*                                 F e t c h                                  */
+/******************************************************************************/
+
+// Read a run of pages starting at page pNum, add them to the cache, and copy
+// the requested portion into the caller's buffer. When the run starts at the
+// requested offset and fits in the caller's buffer we read into it directly.
+//
+int XrdPosixShmCacheIO::Fetch(long long pNum, char *buff, int pOff, int rlen,
+                              long long fSize)
+{
+   long long pOffs = pNum * pageSize, runEnd;
+   long long nPages = (pOff + (long long)rlen + pageSize - 1) / pageSize;
+   char *rBuff;
+   int runLen, n;
+
+// Calculate the extent of the run
+//
+   if (nPages > shmMaxRun) nPages = shmMaxRun;
+   runEnd = pOffs + nPages * pageSize;
+   if (runEnd > fSize) runEnd = fSize;
+   runLen = static_cast<int>(runEnd - pOffs);
+
+// Get a buffer and read the pages
+//
+   if (!pOff && runLen <= rlen) rBuff = buff;
+      else if (!(rBuff = (char *)malloc(runLen))) return -ENOMEM;
+   if ((n = ioP->Read(rBuff, pOffs, runLen)) > 0)
+      Insert(rBuff, pOffs, n, fSize);
+
+// Copy out whatever portion the caller wanted
+//
+   if (rBuff != buff)
+      {if (n > 0)
+          {n -= pOff;
+           if (n < 0) n = 0;
+              else {if (n > rlen) n = rlen;
+                    memcpy(buff, rBuff + pOff, n);
+                   }
+          }
+       free(rBuff);
+      }
+   return n;
+}
+
+/******************************************************************************/
+/*                                I n s e r t                                 */
+/******************************************************************************/
+
+// Add each page wholly contained in the buffer to the cache. A partial page
+// is added only when it is the last page of the file.
+//
+void XrdPosixShmCacheIO::Insert(const char *buff, long long offs, int blen,
+                                long long fSize)
+{
+   long long pNum;
+   int pLen, skip = (offs % pageSize ? pageSize - offs % pageSize : 0);
+
+   buff += skip; offs += skip; blen -= skip;
+   while(blen > 0)
+        {pNum = offs / pageSize;
+         pLen = (blen < pageSize ? blen : pageSize);
+         if (pLen != pageSize && offs + pLen != fSize) break;
+         shmCache->Insert(fileKey, pNum, buff, pLen);
+         buff += pLen; offs += pLen; blen -= pLen;
+        }
+}
+
+/******************************************************************************/
+/*                                  R e a d                                   */
+/******************************************************************************/
+
+int XrdPosixShmCacheIO::Read(char *buff, long long offs, int rlen)
+{
+   long long fSize = ioP->FSize();
+   int bLen, pOff, n, hits = 0, miss = 0, totLen = 0;
+
+// Trim the request to the size of the file
+//
+   if (fSize < 0) return static_cast<int>(fSize);
+   if (offs < 0 || rlen < 0) return -EINVAL;
+   if (offs >= fSize || !rlen) return 0;
+   if (offs + rlen > fSize) rlen = fSize - offs;
+
+// Walk through the pages, serving what we can from the cache and reading
+// a run of pages from the source whenever we encounter a missing page.
+//
+   while(rlen > 0)
+        {pOff = offs % pageSize;
+         bLen = pageSize - pOff;
+         if (bLen > rlen) bLen = rlen;
+         if (shmCache->Find(fileKey, offs/pageSize, buff, pOff, bLen) == bLen)
+            {n = bLen; hits++;}
+            else {miss++;
+                  if ((n = Fetch(offs/pageSize, buff, pOff, rlen, fSize)) <= 0)
+                     {if (!totLen) totLen = n;
+                      break;
+                     }
+                 }
+         buff += n; offs += n; rlen -= n; totLen += n;
+        }
+
+// Update statistics
+//
+   Statistics.Lock();
+   Statistics.Hits += hits; Statistics.Miss += miss;
+   if (totLen > 0) Statistics.BytesRead += totLen;
+   Statistics.UnLock();
+   return totLen;
+}
+
+/******************************************************************************/
+
+void XrdPosixShmCacheIO::Read(XrdOucCacheIOCB &iocb, char *buff,
+                              long long offs, int rlen)
+{
+   int n;
+
+// Complete the read inline if everything is cached, otherwise pass it on
+//
+   if ((n = Cached(buff, offs, rlen)) >= 0) iocb.Done(n);
+      else ioP->Read(iocb, buff, offs, rlen);
+}
+
+/******************************************************************************/
+/*                                 R e a d V                                  */
+/******************************************************************************/
+
+int XrdPosixShmCacheIO::ReadV(const XrdOucIOVec *readV, int n)
+{
+   long long fSize;
+   int i, rc, totLen = 0;
+
+// If every element is in the cache we are done
+//
+   for (i = 0; i < n; i++)
+       {if (Cached(readV[i].data, readV[i].offset, readV[i].size)
+            != readV[i].size) break;
+        totLen += readV[i].size;
+       }
+   if (i >= n) return totLen;
+
+// Issue the vector read and cache any full pages that came back
+//
+   if ((rc = ioP->ReadV(readV, n)) > 0 && (fSize = ioP->FSize()) > 0)
+      for (i = 0; i < n; i++)
+          Insert(readV[i].data, readV[i].offset, readV[i].size, fSize);
+   return rc;
+}
+
+/******************************************************************************/
+
+void XrdPosixShmCacheIO::ReadV(XrdOucCacheIOCB &iocb, const XrdOucIOVec *readV,
+                               int n)
+{
+   int i, totLen = 0;
+
+// Complete the read inline if everything is cached, otherwise pass it on
+//
+   for (i = 0; i < n; i++)
+       {if (Cached(readV[i].data, readV[i].offset, readV[i].size)
+            != readV[i].size) break;
+        totLen += readV[i].size;
+       }
+   if (i >= n) iocb.Done(totLen);
+      else ioP->ReadV(iocb, readV, n);
+}
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPosixShmCache::XrdPosixShmCache(XrdPosixShmHdr *hP, size_t mSize)
+                 : shmHdr(hP), shmSize(mSize)
+{
+   long long slotBytes;
+
+   pageSize  = hP->pageSize;
+   setSize   = hP->setSize;
+   numSets   = hP->numSlots / setSize;
+   slotBytes = (long long)hP->numSlots * sizeof(XrdPosixShmSlot);
+   slotBytes = (slotBytes + shmHdrSize - 1) & ~(long long)(shmHdrSize - 1);
+   shmSlot   = (XrdPosixShmSlot *)((char *)hP + shmHdrSize);
+   shmPage   = (char *)hP + shmHdrSize + slotBytes;
+}
+
+/******************************************************************************/
+/*                            D e s t r u c t o r                             */
+/******************************************************************************/
+
+XrdPosixShmCache::~XrdPosixShmCache()
+{
+   munmap((char *)shmHdr, shmSize);
+}
+
+/******************************************************************************/
+/*                                A t t a c h                                 */
+/******************************************************************************/
+
+XrdOucCacheIO2 *XrdPosixShmCache::Attach(XrdOucCacheIO2 *ioP, int opts)
+{
+   struct stat sBuf;
+
+// Only files opened read-only with a known modification time are cached as
+// otherwise we cannot tell whether the cached pages are still valid.
+//
+   if (opts & XrdOucCache::optRW) return ioP;
+   memset(&sBuf, 0, sizeof(sBuf));
+   if (ioP->Fstat(sBuf) || !sBuf.st_mtime) return ioP;
+
+   return new XrdPosixShmCacheIO(this, ioP, MakeKey(ioP->Path(), sBuf));
+}
+
+/******************************************************************************/
+/*                                C r e a t e                                 */
+/******************************************************************************/
+
+XrdPosixShmCache *XrdPosixShmCache::Create(const char *eData)
+{
+#ifndef HAVE_ATOMICS
+   cerr <<"XrdPosix: shared memory cache not supported on this platform."
+        <<endl;
+   return 0;
+#else
+   XrdOucEnv theEnv(eData);
+   XrdPosixShmHdr *hP;
+   struct stat sBuf;
+   long long segSize, pgSize, slotBytes, numSlots;
+   char *tP, *eP, shmName[64];
+   void *mP;
+   int fd, i;
+   mode_t shmMode = 0600;
+   bool isNew = true;
+
+// Get the segment name, the default is private to the user
+//
+   if ((tP = theEnv.Get("name")) && *tP)
+      {if (*tP != '/' || strlen(tP) >= sizeof(shmName) || strchr(tP+1, '/'))
+          {cerr <<"XrdPosix: 'XRDPOSIX_SHMCACHE=name=" <<tP
+                <<"' is invalid." <<endl;
+           return 0;
+          }
+       strcpy(shmName, tP);
+      } else snprintf(shmName, sizeof(shmName), "/xrdposix.%d",
+                      static_cast<int>(geteuid()));
+
+// Get the permissions of a new segment. The owner must be able to use it.
+//
+   if ((tP = theEnv.Get("mode")) && *tP)
+      {long mVal = strtol(tP, &eP, 8);
+       if (*eP || mVal < 0 || mVal > 0777 || (mVal & 0600) != 0600)
+          {cerr <<"XrdPosix: 'XRDPOSIX_SHMCACHE=mode=" <<tP
+                <<"' is invalid." <<endl;
+           return 0;
+          }
+       shmMode = static_cast<mode_t>(mVal);
+      }
+
+// Get the page size, which must be a power of two, and the segment size
+//
+   pgSize  = getVal(theEnv, "pagesz", 65536);
+   if (pgSize < 4096 || pgSize > 16*1024*1024 || (pgSize & (pgSize-1)))
+      {cerr <<"XrdPosix: shared memory cache page size must be a power of "
+              "two between 4k and 16m." <<endl;
+       return 0;
+      }
+   segSize = getVal(theEnv, "size", 256*1024*1024);
+
+// Compute the number of slots the segment can hold
+//
+   numSlots  = (segSize - shmHdrSize) / (pgSize + sizeof(XrdPosixShmSlot));
+   numSlots -= numSlots % shmSetSize;
+   if (numSlots < shmSetSize * 16 || numSlots > 0x7fffffff)
+      {cerr <<"XrdPosix: shared memory cache size is invalid." <<endl;
+       return 0;
+      }
+   slotBytes = numSlots * sizeof(XrdPosixShmSlot);
+   slotBytes = (slotBytes + shmHdrSize - 1) & ~(long long)(shmHdrSize - 1);
+   segSize   = shmHdrSize + slotBytes + numSlots * pgSize;
+
+// Create the segment or, if it exists, attach to it. A new segment is zeroed
+// which means all slots are empty.
+//
+   if ((fd = shm_open(shmName, O_RDWR|O_CREAT|O_EXCL, shmMode)) >= 0)
+      {if (fchmod(fd, shmMode) || ftruncate(fd, segSize))
+          {cerr <<"XrdPosix: unable to size shared memory cache " <<shmName
+                <<"; " <<strerror(errno) <<endl;
+           close(fd); shm_unlink(shmName);
+           return 0;
+          }
+      } else {
+       if (errno != EEXIST
+       ||  (fd = shm_open(shmName, O_RDWR, 0)) < 0)
+          {cerr <<"XrdPosix: unable to open shared memory cache " <<shmName
+                <<"; " <<strerror(errno) <<endl;
+           return 0;
+          }
+       isNew = false;
+      }
+
+// An existing segment might still be sized by its creator; wait a bit
+//
+   if (!isNew)
+      {for (i = 0; i < 500; i++)
+           {if (fstat(fd, &sBuf)) {sBuf.st_size = 0; break;}
+            if (sBuf.st_size >= shmHdrSize) break;
+            XrdSysTimer::Wait(10);
+           }
+       if (sBuf.st_size < shmHdrSize)
+          {cerr <<"XrdPosix: shared memory cache " <<shmName
+                <<" is not usable." <<endl;
+           close(fd);
+           return 0;
+          }
+       segSize = sBuf.st_size;
+      }
+
+// Map the segment, we no longer need the file descriptor
+//
+   mP = mmap(0, segSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mP == MAP_FAILED)
+      {cerr <<"XrdPosix: unable to map shared memory cache " <<shmName
+            <<"; " <<strerror(errno) <<endl;
+       if (isNew) shm_unlink(shmName);
+       return 0;
+      }
+   hP = (XrdPosixShmHdr *)mP;
+
+// Initialize a new segment, indicating that it is ready last of all. Otherwise
+// wait for the creator to finish and use the geometry recorded in the segment.
+//
+   if (isNew)
+      {hP->magic    = shmMagic;
+       hP->version  = shmVersion;
+       hP->pageSize = static_cast<int>(pgSize);
+       hP->numSlots = static_cast<int>(numSlots);
+       hP->setSize  = shmSetSize;
+       AtomicInc(hP->ready);
+      } else {
+       for (i = 0; i < 500 && !AtomicGet(hP->ready); i++) XrdSysTimer::Wait(10);
+       slotBytes = (long long)hP->numSlots * sizeof(XrdPosixShmSlot);
+       slotBytes = (slotBytes + shmHdrSize - 1) & ~(long long)(shmHdrSize - 1);
+       if (!hP->ready || hP->magic != shmMagic || hP->version != shmVersion
+       ||  hP->setSize <= 0 || hP->numSlots <= 0
+       ||  hP->numSlots % hP->setSize
+       ||  segSize < shmHdrSize + slotBytes
+                   + (long long)hP->numSlots * hP->pageSize)
+          {cerr <<"XrdPosix: shared memory cache " <<shmName
+                <<" is not compatible." <<endl;
+           munmap((char *)mP, segSize);
+           return 0;
+          }
+      }
+
+// All done
+//
+   return new XrdPosixShmCache(hP, segSize);
+#endif
+}
+
+/******************************************************************************/
+/*                                  F i n d                                   */
+/******************************************************************************/
+
+int XrdPosixShmCache::Find(long long fileKey, long long pageNo, char *buff,
+                           int pOff, int len)
+{
+   XrdPosixShmSlot *sP = shmSlot + SetOf(fileKey, pageNo);
+   int seq, dLen;
+
+// Look for the page in its set. The sequence number is checked before and
+// after copying the data; if it changed the slot was reused and we treat it
+// as a miss. The atomic fetches also act as full memory barriers.
+//
+   for (int i = 0; i < setSize; i++, sP++)
+       {if (sP->fileKey != fileKey || sP->pageNo != pageNo) continue;
+        seq = AtomicGet(sP->seqNum);
+        if (seq & 1 || sP->fileKey != fileKey || sP->pageNo != pageNo)
+           continue;
+        dLen = sP->dataLen;
+        if (dLen < 0 || dLen > pageSize) return -1;
+        if (pOff >= dLen) len = 0;
+           else if (len > dLen - pOff) len = dLen - pOff;
+        if (len > 0)
+           memcpy(buff, shmPage + (sP - shmSlot)*(long long)pageSize + pOff,
+                  len);
+        if (AtomicGet(sP->seqNum) != seq) return -1;
+        sP->lastUse = shmHdr->clock;
+        return len;
+       }
+   return -1;
+}
+
+/******************************************************************************/
+/*                                I n s e r t                                 */
+/******************************************************************************/
+
+void XrdPosixShmCache::Insert(long long fileKey, long long pageNo,
+                              const char *data, int dLen)
+{
+   XrdPosixShmSlot *sP = shmSlot + SetOf(fileKey, pageNo), *vP = 0;
+   unsigned int now = shmHdr->clock, age, maxAge = 0;
+   int seq;
+
+// Find a victim: an empty slot if there is one, otherwise the slot used
+// least recently. Slots being replaced by someone else are skipped.
+//
+   if (dLen <= 0 || dLen > pageSize) return;
+   for (int i = 0; i < setSize; i++, sP++)
+       {if (sP->seqNum & 1) continue;
+        if (sP->fileKey == fileKey && sP->pageNo == pageNo) return;
+        if (!sP->fileKey) {if (!vP || vP->fileKey) vP = sP; continue;}
+        age = now - sP->lastUse;
+        if (!vP || (vP->fileKey && age >= maxAge)) {vP = sP; maxAge = age;}
+       }
+   if (!vP) return;
+
+// Claim the slot by making its sequence number odd. Should someone else have
+// claimed it first we simply don't cache the page.
+//
+   seq = vP->seqNum;
+   if (seq & 1) return;
+#ifdef HAVE_ATOMICS
+   if (!AtomicCAS(vP->seqNum, seq, seq+1)) return;
+#else
+   return;
+#endif
+
+// Replace the page and then publish it by making the sequence number even
+//
+   vP->fileKey = 0;
+   vP->pageNo  = pageNo;
+   memcpy(shmPage + (vP - shmSlot)*(long long)pageSize, data, dLen);
+   vP->dataLen = dLen;
+   vP->fileKey = fileKey;
+   vP->lastUse = AtomicInc(shmHdr->clock);
+   AtomicInc(vP->seqNum);
+}
+
+/******************************************************************************/
+/*                                 S e t O f                                  */
+/******************************************************************************/
+
+int XrdPosixShmCache::SetOf(long long fileKey, long long pageNo)
+{
+   unsigned long long h = (unsigned long long)fileKey
+                        ^ ((unsigned long long)pageNo * 0x9e3779b97f4a7c15ULL);
+
+   h ^= h >> 33; h *= 0xff51afd7ed558ccdULL; h ^= h >> 33;
+   return static_cast<int>(h % numSets) * setSize;
+}
@@ -0,0 +1,132 @@
+#ifndef __POSIX_SHMCACHE_HH__
+#define __POSIX_SHMCACHE_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                   X r d P o s i x S h m C a c h e . h h                    */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include "XrdOuc/XrdOucCache2.hh"
+
+/******************************************************************************/
+/*                X r d P o s i x S h m C a c h e   L a y o u t               */
+/******************************************************************************/
+
+// The shared memory cache is a POSIX shared memory segment that every process
+// using XrdPosix on the node may map. It has a header, a vector of slots, and
+// a page for each slot. Pages are identified by a file key (a hash of the url
+// without cgi, the modification time, the size, and the inode number) and the
+// page number. The slots form a set associative index: a page can only be held
+// in one of the slots of the set it hashes to. The index is lock-free. Each
+// slot carries a sequence number that is odd while the slot is being replaced;
+// a reader copies the page and then verifies that the sequence number did not
+// change and a writer claims a slot by atomically making its sequence number
+// odd.
+// Should a process die while replacing a page the slot simply stays unusable.
+
+struct XrdPosixShmHdr
+{
+int                magic;
+int                version;
+int                pageSize;
+int                numSlots;
+int                setSize;
+volatile int       ready;      // Set last by the creator of the segment
+volatile unsigned  clock;      // Incremented on each page insertion
+int                rsvd;
+};
+
+struct XrdPosixShmSlot
+{
+volatile long long fileKey;    // 0 when the slot is empty
+volatile long long pageNo;
+volatile int       seqNum;     // Odd while the slot is being replaced
+volatile int       dataLen;    // Number of valid bytes in the page
+volatile unsigned  lastUse;    // Clock value when last used
+int                rsvd;
+};
+
+/******************************************************************************/
+/*                  C l a s s   X r d P o s i x S h m C a c h e               */
+/******************************************************************************/
+
+// The cache is enabled via the XRDPOSIX_SHMCACHE envar whose value is a cgi
+// string with the following variables:
+
+// name=n   - name of the shared memory segment (default /xrdposix.<uid>).
+// pagesz=n - size of a page (default 64k, can be suffixed with k or m).
+// size=n   - size of the segment (default 256m, suffixed with k, m, or g).
+// mode=n   - octal permissions of a new segment (default 0600). The umask is
+//            not applied. The owner must have read and write access.
+
+// Only files opened read-only are cached. Since the segment is shared by all
+// processes that use the same name, the default name is private to the user.
+// Processes of different users may share a segment by specifying a common
+// name and a mode that grants them access but must then be able to trust each
+// other's data.
+
+class XrdPosixShmCache : public XrdOucCache2
+{
+public:
+
+virtual
+XrdOucCacheIO2 *Attach(XrdOucCacheIO2 *ioP, int opts=0);
+
+// Copy up to len bytes at offset pOff in the page into buff. Returns the
+// number of bytes copied or -1 if the page is not in the cache.
+//
+int             Find(long long fileKey, long long pageNo, char *buff,
+                     int pOff, int len);
+
+// Add a page to the cache unless it is already there or the set is busy.
+//
+void            Insert(long long fileKey, long long pageNo, const char *data,
+                       int dLen);
+
+int             PageSize() {return pageSize;}
+
+// Return a cache configured by the passed cgi string or nil upon failure.
+//
+static
+XrdPosixShmCache *Create(const char *eData);
+
+                XrdPosixShmCache(XrdPosixShmHdr *hP, size_t mSize);
+virtual        ~XrdPosixShmCache();
+
+private:
+
+int             SetOf(long long fileKey, long long pageNo);
+
+XrdPosixShmHdr  *shmHdr;
+XrdPosixShmSlot *shmSlot;
+char            *shmPage;
+size_t           shmSize;
+int              pageSize;
+int              numSets;
+int              setSize;
+};
+#endif
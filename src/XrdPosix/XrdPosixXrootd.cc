@@ -30,6 +30,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <sys/time.h>
 #include <sys/param.h>
@@ -58,7 +59,9 @@
 #include "XrdPosix/XrdPosixFile.hh"
 #include "XrdPosix/XrdPosixFileRH.hh"
 #include "XrdPosix/XrdPosixMap.hh"
+#include "XrdPosix/XrdPosixMeta.hh"
 #include "XrdPosix/XrdPosixPrepIO.hh"
+#include "XrdPosix/XrdPosixShmCache.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
 /******************************************************************************/
@@ -71,6 +74,7 @@ XrdScheduler   *schedP = 0;
 XrdOucCache2   *theCache = 0;
 XrdCl::DirListFlags::Flags dlFlag = XrdCl::DirListFlags::None;
 bool           psxDBG = (getenv("XRDPOSIX_DEBUG") != 0);
+XrdPosixMeta   *metaP = 0;
 };
 
 XrdOucCache   *XrdPosixXrootd::myCache  =  0;
@@ -85,6 +89,35 @@ int            XrdPosixXrootd::initDone  = 0;
 namespace
 {
 
+/******************************************************************************/
+/*                                L o c U r l                                 */
+/******************************************************************************/
+
+// Construct the url that directly addresses the data server that path was last
+// opened on. Return false if we don't know of any such data server.
+//
+bool LocUrl(const char *path, std::string &dsUrl)
+{
+   XrdCl::URL  url((std::string)path);
+   std::string loc;
+   size_t      pos;
+   int         port;
+
+// Get the location, it has the form [user@]host:port
+//
+   if (!url.IsValid() || !XrdPosixGlobals::metaP->FindLoc(path, loc))
+      return false;
+   if ((pos = loc.rfind('@')) != std::string::npos) loc.erase(0, pos+1);
+   if ((pos = loc.rfind(':')) == std::string::npos
+   ||  (port = atoi(loc.c_str()+pos+1)) <= 0) return false;
+
+// Replace the host and port in the original url
+//
+   url.SetHostPort(loc.substr(0, pos), port);
+   dsUrl = url.GetURL();
+   return true;
+}
+
 /******************************************************************************/
 /*                             O p e n D e f e r                              */
 /******************************************************************************/
@@ -122,6 +155,39 @@ int OpenDefer(XrdPosixFile           *fp,
    errno = EINPROGRESS;
    return -1;
 }
+
+/******************************************************************************/
+/*                              W r i t e v C B                               */
+/******************************************************************************/
+
+// Collects the completions of the parallel writes issued for a pwritev().
+//
+class WritevCB : public XrdOucCacheIOCB
+{
+public:
+
+void Done(int result)
+         {if (result < 0)
+             {cbMutex.Lock();
+              if (!ioRC) ioRC = -result;
+              cbMutex.UnLock();
+             }
+          ioSem.Post();
+         }
+
+int  Wait(int numIO) {while(numIO--) ioSem.Wait();
+                      return ioRC;
+                     }
+
+     WritevCB() : ioSem(0), ioRC(0) {}
+    ~WritevCB() {}
+
+private:
+
+XrdSysMutex     cbMutex;
+XrdSysSemaphore ioSem;
+int             ioRC;
+};
 };
   
 /******************************************************************************/
@@ -169,13 +235,20 @@ XrdPosixXrootd::~XrdPosixXrootd()
   
 int XrdPosixXrootd::Access(const char *path, int amode)
 {
-   XrdPosixAdmin admin(path);
    mode_t stMode;
    bool   aOK = true;
 
-// Issue the stat and verify that all went well
+// Issue the stat and verify that all went well. When we have a metadata cache
+// we do a full stat so that the result can be cached and reused.
 //
-   if (!admin.Stat(&stMode)) return -1;
+   if (XrdPosixGlobals::metaP)
+      {struct stat sBuf;
+       if (Stat(path, &sBuf)) return -1;
+       stMode = sBuf.st_mode;
+      } else {
+       XrdPosixAdmin admin(path);
+       if (!admin.Stat(&stMode)) return -1;
+      }
 
 // Translate the mode bits
 //
@@ -206,6 +279,11 @@ int XrdPosixXrootd::Close(int fildes)
    if (!(fP = XrdPosixObject::ReleaseFile(fildes)))
       {errno = EBADF; return -1;}
 
+// If the file may have been modified, whatever we know about it is stale
+//
+   if (XrdPosixGlobals::metaP && fP->isUpdate())
+      XrdPosixGlobals::metaP->Invalidate(fP->Path());
+
 // Close the file if there is no active I/O (possible caching). Delete the
 // object if the close was successful (it might not be).
 //
@@ -371,6 +449,7 @@ int XrdPosixXrootd::Ftruncate(int fildes, off_t offset)
 
 // Do the trunc
 //
+   if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->Invalidate(fp->Path());
    if (fp->XCio->Trunc(offset) < 0) return Fault(fp, errno);
    fp->UnLock();
    return 0;
@@ -464,6 +543,7 @@ int XrdPosixXrootd::Mkdir(const char *path, mode_t mode)
 
 // Issue the mkdir
 //
+   if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->Invalidate(path);
    return XrdPosixMap::Result(admin.Xrd.MkDir(admin.Url.GetPathWithParams(),
                                               flags,
                                               XrdPosixMap::Mode2Access(mode))
@@ -481,6 +561,8 @@ int XrdPosixXrootd::Open(const char *path, int oflags, mode_t mode,
    XrdPosixFile *fp;
    XrdCl::Access::Mode     XOmode = XrdCl::Access::None;
    XrdCl::OpenFlags::Flags XOflags;
+   std::string dsUrl;
+   bool dsOpen = false;
    int Opts;
 
 // Translate R/W and R/O flags
@@ -511,6 +593,11 @@ int XrdPosixXrootd::Open(const char *path, int oflags, mode_t mode,
       else if (oflags & O_TRUNC && Opts & XrdPosixFile::isUpdt)
               XOflags |= XrdCl::OpenFlags::Delete;
 
+// An open that may modify the file makes whatever we know about it stale
+//
+   if (XrdPosixGlobals::metaP && Opts & XrdPosixFile::isUpdt)
+      XrdPosixGlobals::metaP->Invalidate(path);
+
 // Allocate the new file object
 //
    if (!(fp = new XrdPosixFile(path, cbP, Opts)))
@@ -527,11 +614,27 @@ int XrdPosixXrootd::Open(const char *path, int oflags, mode_t mode,
        if (rc < 0) {errno = -rc; return -1;}
       }
 
+// A read-only sync open first tries the data server the file was last opened
+// on, if we know it. Should that fail, we forget the location and start over
+// with a new file object using the original url so the redirector has a say.
+//
+   if (!cbP && !(Opts & XrdPosixFile::isUpdt) && XrdPosixGlobals::metaP
+   &&  LocUrl(path, dsUrl))
+      {Status = fp->clFile.Open(dsUrl, XOflags, XOmode);
+       if (Status.IsOK()) dsOpen = true;
+          else {XrdPosixGlobals::metaP->DropLoc(path);
+                delete fp;
+                fp = new XrdPosixFile(path, cbP, Opts);
+               }
+      }
+
 // Open the file (sync or async)
 //
-   if (!cbP) Status = fp->clFile.Open((std::string)path, XOflags, XOmode);
-      else   Status = fp->clFile.Open((std::string)path, XOflags, XOmode,
-                                      (XrdCl::ResponseHandler *)fp);
+   if (!dsOpen)
+      {if (!cbP) Status = fp->clFile.Open((std::string)path, XOflags, XOmode);
+          else   Status = fp->clFile.Open((std::string)path, XOflags, XOmode,
+                                          (XrdCl::ResponseHandler *)fp);
+      }
 
 // If we failed, return the reason
 //
@@ -561,8 +664,13 @@ int XrdPosixXrootd::Open(const char *path, int oflags, mode_t mode,
 // finalization is defered until the callback happens.
 //
    if (cbP) {errno = EINPROGRESS; return -1;}
-   if (fp->Finalize(&Status)) return fp->FDNum();
-   return XrdPosixMap::Result(Status);
+   if (!fp->Finalize(&Status)) return XrdPosixMap::Result(Status);
+
+// Remember where a read-only file was found for the next open
+//
+   if (XrdPosixGlobals::metaP && !dsOpen && !(Opts & XrdPosixFile::isUpdt))
+      XrdPosixGlobals::metaP->AddLoc(path, fp->Location());
+   return fp->FDNum();
 }
   
 /******************************************************************************/
@@ -665,6 +773,31 @@ void XrdPosixXrootd::Pread(int fildes, void *buf, size_t nbyte, off_t offset,
    fp->XCio->Read(*cbp, (char *)buf, offs, (int)iosz);
 }
 
+/******************************************************************************/
+/*                                P r e a d v                                 */
+/******************************************************************************/
+  
+ssize_t XrdPosixXrootd::Preadv(int fildes, const struct iovec *iov, int iovcnt,
+                               off_t offset)
+{
+   XrdPosixFile *fp;
+   ssize_t       bytes;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) return -1;
+
+// Issue the read
+//
+   if ((bytes = doReadv(fp, iov, iovcnt, (long long)offset)) < 0)
+      return Fault(fp, errno);
+
+// All went well
+//
+   fp->UnLock();
+   return bytes;
+}
+
 /******************************************************************************/
 /*                                P w r i t e                                 */
 /******************************************************************************/
@@ -731,6 +864,31 @@ void XrdPosixXrootd::Pwrite(int fildes, const void *buf, size_t nbyte,
    fp->XCio->Write(*cbp, (char *)buf, offs, (int)iosz);
 }
 
+/******************************************************************************/
+/*                               P w r i t e v                                */
+/******************************************************************************/
+  
+ssize_t XrdPosixXrootd::Pwritev(int fildes, const struct iovec *iov, int iovcnt,
+                                off_t offset)
+{
+   XrdPosixFile *fp;
+   ssize_t       bytes;
+
+// Find the file object
+//
+   if (!(fp = XrdPosixObject::File(fildes))) return -1;
+
+// Issue the write
+//
+   if ((bytes = doWritev(fp, iov, iovcnt, (long long)offset)) < 0)
+      return Fault(fp, errno);
+
+// All went well
+//
+   fp->UnLock();
+   return bytes;
+}
+
 /******************************************************************************/
 /*                                  R e a d                                   */
 /******************************************************************************/
@@ -768,21 +926,23 @@ ssize_t XrdPosixXrootd::Read(int fildes, void *buf, size_t nbyte)
   
 ssize_t XrdPosixXrootd::Readv(int fildes, const struct iovec *iov, int iovcnt)
 {
-   ssize_t bytes, totbytes = 0;
-   int i;
+   XrdPosixFile *fp;
+   ssize_t       bytes;
 
-// Return the results of the read for each iov segment
+// Find the file object
 //
-   for (i = 0; i < iovcnt; i++)
-       {bytes = Read(fildes,(void *)iov[i].iov_base,(size_t)iov[i].iov_len);
-             if (bytes > 0) totbytes += bytes;
-        else if (bytes < 0) return -1;
-        else                break;
-       }
+   if (!(fp = XrdPosixObject::File(fildes))) return -1;
 
-// All done
+// Issue the read at the current offset
 //
-   return totbytes;
+   if ((bytes = doReadv(fp, iov, iovcnt, fp->Offset())) < 0)
+      return Fault(fp, errno);
+
+// All went well
+//
+   fp->addOffset(bytes);
+   fp->UnLock();
+   return bytes;
 }
 
 /******************************************************************************/
@@ -935,6 +1095,10 @@ int XrdPosixXrootd::Rename(const char *oldpath, const char *newpath)
 
 // Issue the rename
 //
+  if (XrdPosixGlobals::metaP)
+     {XrdPosixGlobals::metaP->Invalidate(oldpath);
+      XrdPosixGlobals::metaP->Invalidate(newpath);
+     }
   std::string urlp    = admin.Url.GetPathWithParams();
   std::string nurlp   = newUrl.GetPathWithParams();
   int res = XrdPosixMap::Result(admin.Xrd.Mv(urlp, nurlp));
@@ -975,6 +1139,7 @@ int XrdPosixXrootd::Rmdir(const char *path)
 
 // Issue the rmdir
 //
+   if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->Invalidate(path);
    std::string urlp = admin.Url.GetPathWithParams();
    int res = XrdPosixMap::Result(admin.Xrd.RmDir(urlp));
    if (!res && XrdPosixGlobals::theCache)
@@ -1027,6 +1192,17 @@ int XrdPosixXrootd::Stat(const char *path, struct stat *buf)
 //
    initStat(buf);
 
+// Check if we recently obtained the stat information
+//
+   if (XrdPosixGlobals::metaP)
+      {int rc;
+       if (XrdPosixGlobals::metaP->FindStat(path, *buf, rc))
+          {if (!rc) return 0;
+           errno = rc;
+           return -1;
+          }
+      }
+
 // Check if we can get the stat informatation from the cache
 //
   if (myCache2)
@@ -1038,7 +1214,11 @@ int XrdPosixXrootd::Stat(const char *path, struct stat *buf)
 
 // Issue the stat and verify that all went well
 //
-   if (!admin.Stat(&stFlags, &stMtime, &stSize, &stId, &stRdev)) return -1;
+   if (!admin.Stat(&stFlags, &stMtime, &stSize, &stId, &stRdev))
+      {if (XrdPosixGlobals::metaP && errno == ENOENT)
+          XrdPosixGlobals::metaP->AddStat(path, 0, ENOENT);
+       return -1;
+      }
 
 // Return what little we can
 //
@@ -1048,6 +1228,7 @@ int XrdPosixXrootd::Stat(const char *path, struct stat *buf)
    buf->st_ino    = stId;
    buf->st_rdev   = stRdev;
    buf->st_mode   = stFlags;
+   if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->AddStat(path, buf, 0);
    return 0;
 }
 
@@ -1190,6 +1371,7 @@ int XrdPosixXrootd::Truncate(const char *path, off_t Size)
 
 // Issue the truncate
 //
+  if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->Invalidate(path);
   std::string urlp = admin.Url.GetPathWithParams();
   int res = XrdPosixMap::Result(admin.Xrd.Truncate(urlp,tSize));
 
@@ -1214,6 +1396,7 @@ int XrdPosixXrootd::Unlink(const char *path)
 
 // Issue the UnLink
 //
+  if (XrdPosixGlobals::metaP) XrdPosixGlobals::metaP->Invalidate(path);
   std::string urlp = admin.Url.GetPathWithParams();
   int res = XrdPosixMap::Result(admin.Xrd.Rm(urlp));
   if (!res && XrdPosixGlobals::theCache)
@@ -1258,20 +1441,23 @@ ssize_t XrdPosixXrootd::Write(int fildes, const void *buf, size_t nbyte)
   
 ssize_t XrdPosixXrootd::Writev(int fildes, const struct iovec *iov, int iovcnt)
 {
-   ssize_t totbytes = 0;
-   int i;
+   XrdPosixFile *fp;
+   ssize_t       bytes;
 
-// Return the results of the write for each iov segment
+// Find the file object
 //
-   for (i = 0; i < iovcnt; i++)
-       {if (!Write(fildes,(void *)iov[i].iov_base,(size_t)iov[i].iov_len))
-           return -1;
-        totbytes += iov[i].iov_len;
-       }
+   if (!(fp = XrdPosixObject::File(fildes))) return -1;
 
-// All done
+// Issue the write at the current offset
 //
-   return totbytes;
+   if ((bytes = doWritev(fp, iov, iovcnt, fp->Offset())) < 0)
+      return Fault(fp, errno);
+
+// All went well
+//
+   fp->addOffset(bytes, 1);
+   fp->UnLock();
+   return bytes;
 }
   
 /******************************************************************************/
@@ -1287,10 +1473,18 @@ void XrdPosixXrootd::initEnv()
    if ((evar = getenv("XRDPOSIX_CACHE")) && *evar > '0')
       XrdPosixMap::SetDebug(true);
 
-// Now we must check if we have a new cache over-ride
+// Establish the metadata cache, if wanted
+//
+   if ((evar = getenv("XRDPOSIX_MCACHE")) && *evar)
+      XrdPosixGlobals::metaP = XrdPosixMeta::Create(evar);
+
+// Now we must check if we have a new cache over-ride. The node-local shared
+// memory cache, if wanted, takes precedence over a process-local cache.
 //
    if (!myCache2)
-      {if ((evar = getenv("XRDPOSIX_CACHE")) && *evar) initEnv(evar);
+      {if ((evar = getenv("XRDPOSIX_SHMCACHE")) && *evar
+       &&  (XrdPosixGlobals::theCache = XrdPosixShmCache::Create(evar))) return;
+       if ((evar = getenv("XRDPOSIX_CACHE")) && *evar) initEnv(evar);
           else if (myCache) {char ebuf[] = {0};        initEnv(ebuf);}
       } else XrdPosixGlobals::theCache = myCache2;
 }
@@ -1563,6 +1757,117 @@ void XrdPosixXrootd::setSched(XrdScheduler *sP)
 /******************************************************************************/
 /*                       P r i v a t e   M e t h o d s                        */
 /******************************************************************************/
+/******************************************************************************/
+/*                               d o R e a d v                                */
+/******************************************************************************/
+
+ssize_t XrdPosixXrootd::doReadv(XrdPosixFile *fp, const struct iovec *iov,
+                                int iovcnt, long long offs)
+{
+   XrdOucIOVec rdVec[rdVecMax];
+   long long   totbytes = 0, segOffs;
+   char       *segBuff;
+   int         i, n, bytes, segLen;
+
+// Validate the vector and compute the total length
+//
+   if (iovcnt < 0 || iovcnt > IOV_MAX) {errno = EINVAL; return -1;}
+   for (i = 0; i < iovcnt; i++)
+       {if (iov[i].iov_len > (size_t)0x7fffffff) {errno = EOVERFLOW; return -1;}
+        totbytes += iov[i].iov_len;
+       }
+   if (!totbytes) return 0;
+
+// If the read might extend past the end of file we cannot use a vector read
+// as it fails unless all of the data is there. So, read each segment in turn
+// and stop at the first short read, just as readv() would.
+//
+   if (iovcnt == 1 || offs + totbytes > fp->FSize())
+      {totbytes = 0;
+       for (i = 0; i < iovcnt; i++)
+           {if (!iov[i].iov_len) continue;
+            bytes = fp->XCio->Read((char *)iov[i].iov_base, offs,
+                                   (int)iov[i].iov_len);
+            if (bytes < 0) return -1;
+            totbytes += bytes; offs += bytes;
+            if (bytes < (int)iov[i].iov_len) break;
+           }
+       return (ssize_t)totbytes;
+      }
+
+// Map the segments onto as few vector reads as possible. Each vector read is
+// limited in the number of segments it can have and the size of each one.
+//
+   n = 0;
+   for (i = 0; i < iovcnt; i++)
+       {segBuff = (char *)iov[i].iov_base; segLen = (int)iov[i].iov_len;
+        segOffs = offs; offs += segLen;
+        while(segLen)
+             {rdVec[n].offset = segOffs;
+              rdVec[n].size   = (segLen > rdSegMax ? rdSegMax : segLen);
+              rdVec[n].info   = 0;
+              rdVec[n].data   = segBuff;
+              segOffs += rdVec[n].size; segBuff += rdVec[n].size;
+              segLen  -= rdVec[n].size;
+              if (++n >= rdVecMax)
+                 {if (fp->XCio->ReadV(rdVec, n) < 0) return -1;
+                  n = 0;
+                 }
+             }
+       }
+   if (n && fp->XCio->ReadV(rdVec, n) < 0) return -1;
+
+// All done
+//
+   return (ssize_t)totbytes;
+}
+
+/******************************************************************************/
+/*                              d o W r i t e v                               */
+/******************************************************************************/
+
+ssize_t XrdPosixXrootd::doWritev(XrdPosixFile *fp, const struct iovec *iov,
+                                 int iovcnt, long long offs)
+{
+   WritevCB  ioCB;
+   long long totbytes = 0;
+   int       i, numIO = 0, rc;
+
+// Validate the vector and compute the total length
+//
+   if (iovcnt < 0 || iovcnt > IOV_MAX) {errno = EINVAL; return -1;}
+   for (i = 0; i < iovcnt; i++)
+       {if (iov[i].iov_len > (size_t)0x7fffffff) {errno = EOVERFLOW; return -1;}
+        totbytes += iov[i].iov_len;
+       }
+   if (!totbytes) return 0;
+
+// A single segment is simply written
+//
+   if (iovcnt == 1)
+      {if (fp->XCio->Write((char *)iov[0].iov_base,offs,(int)totbytes) < 0)
+          return -1;
+       fp->UpdtSize(offs + totbytes);
+       return (ssize_t)totbytes;
+      }
+
+// Issue all of the writes at once so that they are pipelined on the
+// connection and then wait for all of them to complete.
+//
+   for (i = 0; i < iovcnt; i++)
+       {if (!iov[i].iov_len) continue;
+        fp->XCio->Write(ioCB, (char *)iov[i].iov_base, offs,
+                        (int)iov[i].iov_len);
+        offs += iov[i].iov_len; numIO++;
+       }
+   if ((rc = ioCB.Wait(numIO))) {errno = rc; return -1;}
+
+// All done
+//
+   fp->UpdtSize(offs);
+   return (ssize_t)totbytes;
+}
+
 /******************************************************************************/
 /*                                 F a u l t                                  */
 /******************************************************************************/
@@ -182,6 +182,15 @@ static ssize_t Pread(int fildes, void *buf, size_t nbyte, off_t offset);
 static void    Pread(int fildes, void *buf, size_t nbyte, off_t offset,
                      XrdPosixCallBackIO *cbp); // Async extension!
 
+//-----------------------------------------------------------------------------
+//! Preadv() conforms to preadv() as found in Linux and BSD. When the whole
+//! range lies within the file, segments are read using a single vector read
+//! per group of segments. Otherwise, segments are read in sequence.
+//-----------------------------------------------------------------------------
+
+static ssize_t Preadv(int fildes, const struct iovec *iov, int iovcnt,
+                      off_t offset);
+
 //-----------------------------------------------------------------------------
 //! Pwrite() conforms to POSIX.1-2001 pwrite()
 //-----------------------------------------------------------------------------
@@ -191,6 +200,14 @@ static ssize_t Pwrite(int fildes, const void *buf, size_t nbyte, off_t offset);
 static void    Pwrite(int fildes, const void *buf, size_t nbyte, off_t offset,
                       XrdPosixCallBackIO *cbp); // Async extension!
 
+//-----------------------------------------------------------------------------
+//! Pwritev() conforms to pwritev() as found in Linux and BSD. All segments
+//! are written in parallel and the call returns when all have completed.
+//-----------------------------------------------------------------------------
+
+static ssize_t Pwritev(int fildes, const struct iovec *iov, int iovcnt,
+                       off_t offset);
+
 //-----------------------------------------------------------------------------
 //! QueryChksum() is a POSIX extension and returns a file's modification time
 //! and its associated checksum value.
@@ -228,7 +245,7 @@ static long long QueryOpaque(const char *path, char *buff, int blen);
 static ssize_t Read(int fildes, void *buf, size_t nbyte);
 
 //-----------------------------------------------------------------------------
-//! Readv() conforms to POSIX.1-2001 readv()
+//! Readv() conforms to POSIX.1-2001 readv(), see Preadv() for the details.
 //-----------------------------------------------------------------------------
 
 static ssize_t Readv(int fildes, const struct iovec *iov, int iovcnt);
@@ -339,7 +356,7 @@ static void    VRead(int fildes, const XrdOucIOVec *readV, int n,
 static ssize_t Write(int fildes, const void *buf, size_t nbyte);
 
 //-----------------------------------------------------------------------------
-//! Writev() conforms to POSIX.1-2001 writev()
+//! Writev() conforms to POSIX.1-2001 writev(), see Pwritev() for the details.
 //-----------------------------------------------------------------------------
 
 static ssize_t Writev(int fildes, const struct iovec *iov, int iovcnt);
@@ -385,6 +402,10 @@ static void    setSched(XrdScheduler *sP);
 
 private:
 
+static ssize_t doReadv(XrdPosixFile *fp, const struct iovec *iov, int iovcnt,
+                       long long offs);
+static ssize_t doWritev(XrdPosixFile *fp, const struct iovec *iov, int iovcnt,
+                        long long offs);
 static void initEnv();
 static void initEnv(char *eData);
 static void initEnv(XrdOucEnv &, const char *, long long &);
@@ -395,5 +416,8 @@ static XrdOucCache   *myCache;
 static XrdOucCache2  *myCache2;
 static int            baseFD;
 static int            initDone;
+
+static const int      rdVecMax = 1024;     // Max segments per vector read
+static const int      rdSegMax = 262128;   // Max bytes per vector segment
 };
 #endif
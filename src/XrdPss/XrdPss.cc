@@ -37,6 +37,8 @@
 #include <signal.h>
 #include <strings.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/file.h>
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -50,6 +52,8 @@
 #include "XrdFfs/XrdFfsPosix.hh"
 #include "XrdNet/XrdNetSecurity.hh"
 #include "XrdPss/XrdPss.hh"
+#include "XrdPss/XrdPssMeta.hh"
+#include "XrdPss/XrdPssPool.hh"
 #include "XrdPosix/XrdPosixXrootd.hh"
 
 #include "XrdOss/XrdOssError.hh"
@@ -84,6 +88,10 @@ static XrdScheduler *schedP = 0;
 
        XrdOucSid    *sidP   = 0;
 
+       XrdPssMeta   *mcP    = 0;
+
+       XrdPssPool   *poolP  = 0;
+
 static const char *ofslclCGI = "ofs.lcl=1";
 static const int   ofslclCGL = strlen(ofslclCGI);
 
@@ -93,6 +101,8 @@ static const int   osslclCGL = strlen(osslclCGI);
 static const int   PBsz = 4096;
 
 static const int   CBsz = 2048;
+
+static const int   OBsz = 256;
 }
 
 using namespace XrdProxy;
@@ -130,7 +140,9 @@ XrdOss *XrdOssGetStorageSystem(XrdOss       *native_oss,
 XrdPssSys::XrdPssSys() : LocalRoot(0), N2NLib(0), N2NParms(0), theN2N(0),
                          DirFlags(0), cPath(0), cParm(0),
                          myVersion(&XrdVERSIONINFOVAR(XrdOssGetStorageSystem)),
-                         TraceLvl(0) {}
+                         TraceLvl(0), mcSize(0), mcPTTL(60), mcNTTL(10),
+                         mcRInt(0), plConns(0), plPerCn(64), plWait(5),
+                         plRInt(0) {}
 
 /******************************************************************************/
 /*                                  i n i t                                   */
@@ -225,6 +237,11 @@ void        XrdPssSys::EnvInfo(XrdOucEnv *envP)
    if (envP) schedP = (XrdScheduler *)envP->GetPtr("XrdScheduler*");
 
    XrdPosixXrootd::setSched(schedP);
+
+// Start periodic metadata cache reports, if so wanted
+//
+   if (mcP) mcP->StartReports(schedP);
+   if (poolP) poolP->StartReports(schedP);
 }
   
 /******************************************************************************/
@@ -279,7 +296,9 @@ int XrdPssSys::Mkdir(const char *path, mode_t mode, int mkpath, XrdOucEnv *eP)
 
 // Simply return the proxied result here
 //
-   return (XrdPosixXrootd::Mkdir(pbuff, mode) ? -errno : XrdOssOK);
+   retc = (XrdPosixXrootd::Mkdir(pbuff, mode) ? -errno : XrdOssOK);
+   if (mcP) mcP->Invalidate(path);
+   return retc;
 }
   
 /******************************************************************************/
@@ -329,7 +348,9 @@ int XrdPssSys::Remdir(const char *path, int Opts, XrdOucEnv *eP)
 
 // Return the result
 //
-   return (rc ? -errno : XrdOssOK);
+   rc = (rc ? -errno : XrdOssOK);
+   if (mcP) mcP->Invalidate(path);
+   return rc;
 }
 
 /******************************************************************************/
@@ -368,8 +389,12 @@ int XrdPssSys::Rename(const char *oldname, const char *newname,
 //
    if (allMv && *oldname == '/')
       {if (!cfgDone) return -EBUSY;
-       return (XrdFfsPosix_renameall(urlPlain, oldname, newname, myUid)
+       retc = (XrdFfsPosix_renameall(urlPlain, oldname, newname, myUid)
               ? -errno : XrdOssOK);
+       if (mcP) {mcP->Invalidate(oldname, true);
+                 mcP->Invalidate(newname, true);
+                }
+       return retc;
       }
 
 // Convert path to URL
@@ -380,7 +405,9 @@ int XrdPssSys::Rename(const char *oldname, const char *newname,
 
 // Execute the rename and return result
 //
-   return (XrdPosixXrootd::Rename(oldName, newName) ? -errno : XrdOssOK);
+   retc = (XrdPosixXrootd::Rename(oldName, newName) ? -errno : XrdOssOK);
+   if (mcP) {mcP->Invalidate(oldname, true); mcP->Invalidate(newname, true);}
+   return retc;
 }
 
 /******************************************************************************/
@@ -405,8 +432,10 @@ int XrdPssSys::Stat(const char *path, struct stat *buff, int Opts, XrdOucEnv *eP
 {
    int CgiLen = 0, retc;
    const char *Cgi = (eP ? eP->Env(CgiLen) : 0);
-   char *theID, idBuff[16], pbuff[PBsz], cbuff[CBsz];
+   char *theID, idBuff[16], pbuff[PBsz], cbuff[CBsz], oBuff[OBsz];
    XrdOucSid::theSid idVal;
+   unsigned int mcGen = 0;
+   int slot = -1;
 
 // Setup any required cgi information
 //
@@ -417,20 +446,41 @@ int XrdPssSys::Stat(const char *path, struct stat *buff, int Opts, XrdOucEnv *eP
                  }
       }
 
-// Generate an ID if we need to
+// Convert path to URL
 //
-   if (sidP) theID = P2ID(&idVal, idBuff, sizeof(idBuff));
-      else   theID = 0;
+   if (!P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen)) return retc;
+   if (mcP || poolP) P2ORG(pbuff, oBuff, sizeof(oBuff));
 
-// Convert path to URL
+// Check if the metadata cache already has the answer
 //
-   if (!P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen, theID)) return retc;
+   if (mcP && mcP->FindStat(path, Cgi, oBuff, *buff, retc, mcGen)) return retc;
+
+// Generate an ID if we need to. It either names a pooled connection or a
+// distinct stream.
+//
+   if (poolP)
+      {slot  = poolP->Obtain(oBuff);
+       theID = XrdPssPool::SlotID(slot, idBuff, sizeof(idBuff));
+      }
+      else if (sidP) theID = P2ID(&idVal, idBuff, sizeof(idBuff));
+              else   theID = 0;
+
+// Convert path to URL again if it needs to carry the ID
+//
+   if (theID && !P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen, theID))
+      {if (slot >= 0) poolP->Release(oBuff, slot);
+          else sidP->Release(&idVal);
+       return retc;
+      }
 
 // Return proxied stat
 //
    retc = XrdPosixXrootd::Stat(pbuff, buff);
-   if (theID) sidP->Release(&idVal);
-   return (retc ? -errno : XrdOssOK);
+   if (slot >= 0) poolP->Release(oBuff, slot);
+      else if (theID) sidP->Release(&idVal);
+   retc = (retc ? -errno : XrdOssOK);
+   if (mcP) mcP->AddStat(path, Cgi, oBuff, *buff, retc, mcGen);
+   return retc;
 }
 
 /******************************************************************************/
@@ -464,7 +514,9 @@ int XrdPssSys::Truncate(const char *path, unsigned long long flen,
 // Return proxied truncate. We only do this on a single machine because the
 // redirector will forbid the trunc() if multiple copies exist.
 //
-   return (XrdPosixXrootd::Truncate(pbuff, flen) ? -errno : XrdOssOK);
+   retc = (XrdPosixXrootd::Truncate(pbuff, flen) ? -errno : XrdOssOK);
+   if (mcP) mcP->Invalidate(path);
+   return retc;
 }
   
 /******************************************************************************/
@@ -514,7 +566,9 @@ int XrdPssSys::Unlink(const char *path, int Opts, XrdOucEnv *envP)
 
 // Return the result
 //
-   return (rc ? -errno : XrdOssOK);
+   rc = (rc ? -errno : XrdOssOK);
+   if (mcP) mcP->Invalidate(path);
+   return rc;
 }
 
 /******************************************************************************/
@@ -536,11 +590,12 @@ int XrdPssDir::Opendir(const char *dir_path, XrdOucEnv &Env)
 {
    int CgiLen, retc;
    const char *Cgi = Env.Env(CgiLen);
-   char pbuff[PBsz], *subPath;
+   char pbuff[PBsz], oBuff[OBsz], *subPath;
+   unsigned int mcGen = 0;
 
 // Return an error if this object is already open
 //
-   if (myDir) return -XRDOSS_E8001;
+   if (myDir || inCache) return -XRDOSS_E8001;
 
 // Open directories are not supported for object id's
 //
@@ -551,10 +606,40 @@ int XrdPssDir::Opendir(const char *dir_path, XrdOucEnv &Env)
    if (!(subPath = XrdPssSys::P2URL(retc,pbuff,PBsz,dir_path,0,Cgi,CgiLen)))
       return retc;
 
+// Check if the metadata cache has the listing
+//
+   if (mcP)
+      {XrdPssSys::P2ORG(pbuff, oBuff, sizeof(oBuff));
+       dirIdx = 0;
+       if (mcP->FindDir(dir_path, Cgi, oBuff, dirEnts, retc, mcGen))
+          {inCache = (retc == 0);
+           return retc;
+          }
+      }
+
 // Open the directory
 //
    myDir = XrdPosixXrootd::Opendir(pbuff);
-   if (!myDir) return -errno;
+   if (!myDir)
+      {retc = -errno;
+       if (mcP) mcP->AddDir(dir_path, Cgi, oBuff, dirEnts, retc, mcGen);
+       return retc;
+      }
+
+// When caching, read the whole listing now so that it can be reused. The
+// client fetches all of it at once anyway.
+//
+   if (mcP)
+      {dirent *entP, myEnt;
+       dirEnts.clear();
+       while(!(retc = XrdPosixXrootd::Readdir_r(myDir, &myEnt, &entP)) && entP)
+            dirEnts.push_back(myEnt.d_name);
+       XrdPosixXrootd::Closedir(myDir);
+       myDir = 0;
+       if (retc) {dirEnts.clear(); return -retc;}
+       mcP->AddDir(dir_path, Cgi, oBuff, dirEnts, 0, mcGen);
+       inCache = true;
+      }
    return XrdOssOK;
 }
 
@@ -590,6 +675,15 @@ int XrdPssDir::Readdir(char *buff, int blen)
        return XrdOssOK;
       }
 
+// Check if we are reading a listing from the metadata cache
+//
+   if (inCache)
+      {if (dirIdx < (int)dirEnts.size())
+          strlcpy(buff, dirEnts[dirIdx++].c_str(), blen);
+          else *buff = 0;
+       return XrdOssOK;
+      }
+
 // The directory is not open
 //
    return -XRDOSS_E8002;
@@ -617,6 +711,14 @@ int XrdPssDir::Close(long long *retsz)
        return XrdOssOK;
       }
 
+// Drop a cached listing
+//
+   if (inCache)
+      {std::vector<std::string>().swap(dirEnts);
+       inCache = false;
+       return XrdOssOK;
+      }
+
 // Directory is not open
 //
    return -XRDOSS_E8002;
@@ -642,8 +744,8 @@ int XrdPssDir::Close(long long *retsz)
 int XrdPssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
 {
    unsigned long long popts = XrdPssSys::XPList.Find(path);
-   const char *Cgi;
-   char pbuff[PBsz], cbuff[CBsz];
+   const char *Cgi, *theID = tident;
+   char pbuff[PBsz], cbuff[CBsz], oBuff[OBsz], idBuff[16];
    int CgiLen, retc;
 
 // Return an error if the object is already open
@@ -671,14 +773,41 @@ int XrdPssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
           }
       }
 
+// If connections are pooled, get a slot on the origin for the duration of
+// the open. The client keeps using the same slot for all of its files.
+//
+   if (poolP)
+      {if (!XrdPssSys::P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen))
+          return retc;
+       XrdPssSys::P2ORG(pbuff, oBuff, sizeof(oBuff));
+       poolSlot = poolP->Obtain(oBuff, tident);
+       poolOrg  = strdup(oBuff);
+       theID    = XrdPssPool::SlotID(poolSlot, idBuff, sizeof(idBuff));
+      }
+
 // Convert path to URL
 //
-   if (!XrdPssSys::P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen, tident))
-      return retc;
+   if (!XrdPssSys::P2URL(retc, pbuff, PBsz, path, 0, Cgi, CgiLen, theID))
+      {PoolRelease();
+       return retc;
+      }
 
 // Try to open and if we failed, return an error
 //
-   if ((fd = XrdPosixXrootd::Open(pbuff,Oflag,Mode)) < 0) return -errno;
+   if ((fd = XrdPosixXrootd::Open(pbuff,Oflag,Mode)) < 0)
+      {retc = -errno;
+       PoolRelease();
+       if (mcP && (Oflag & (O_WRONLY | O_RDWR | O_CREAT))) mcP->Invalidate(path);
+       return retc;
+      }
+
+// Cached metadata for files being written is stale now and will be again
+// once the file is closed.
+//
+   if (mcP && (Oflag & (O_WRONLY | O_RDWR | O_CREAT | O_TRUNC | O_APPEND)))
+      {mcP->Invalidate(path);
+       rwPath = strdup(path);
+      }
 
 // All done
 //
@@ -698,11 +827,30 @@ int XrdPssFile::Open(const char *path, int Oflag, mode_t Mode, XrdOucEnv &Env)
 */
 int XrdPssFile::Close(long long *retsz)
 {
+    int rc;
+
     if (fd < 0) return -XRDOSS_E8004;
     if (retsz) *retsz = 0;
-    if (XrdPosixXrootd::Close(fd)) return -errno;
-    fd = -1;
-    return XrdOssOK;
+    if (XrdPosixXrootd::Close(fd)) rc = -errno;
+       else {fd = -1; rc = XrdOssOK;}
+    if (rwPath)
+       {if (mcP) mcP->Invalidate(rwPath);
+        free(rwPath); rwPath = 0;
+       }
+    PoolRelease();
+    return rc;
+}
+
+/******************************************************************************/
+/*                           P o o l R e l e a s e                            */
+/******************************************************************************/
+
+void XrdPssFile::PoolRelease()
+{
+   if (poolOrg)
+      {poolP->Release(poolOrg, poolSlot, tident);
+       free(poolOrg); poolOrg = 0; poolSlot = -1;
+      }
 }
 
 /******************************************************************************/
@@ -997,6 +1145,28 @@ char *XrdPssSys::P2ID(XrdOucSid::theSid *idVal, char *idBuff, int idBsz)
    return idBuff;
 }
 
+/******************************************************************************/
+/*                                 P 2 O R G                                  */
+/******************************************************************************/
+
+// Extract the origin (i.e. host list) from a url for the purpose of keeping
+// per origin statistics.
+//
+char *XrdPssSys::P2ORG(const char *url, char *oBuff, int oBlen)
+{
+   const char *hP, *eP, *aP;
+   int n;
+
+   if (!(hP = strstr(url, "://"))) {strlcpy(oBuff, "?", oBlen); return oBuff;}
+   hP += 3;
+   eP = index(hP, '/');
+   if ((aP = index(hP, '@')) && (!eP || aP < eP)) hP = aP+1;
+   n = (eP ? eP - hP : strlen(hP));
+   if (n >= oBlen) n = oBlen-1;
+   strncpy(oBuff, hP, n); oBuff[n] = 0;
+   return oBuff;
+}
+
 /******************************************************************************/
 /*                                 P 2 O U T                                  */
 /******************************************************************************/
@@ -1011,9 +1181,12 @@ char *XrdPssSys::P2OUT(int &retc,  char *pbuff, int pblen,
 // If we have an Ident then use the fd number as the userid. This allows us to
 // have one stream per open connection.
 //
-   if (Ident && (Ident = index(Ident, ':')))
-      {strncpy(idBuff, Ident+1, 7); idBuff[7] = 0;
-       if ((idP = index(idBuff, '@'))) {*(idP+1) = 0; theID = idBuff;}
+   if (Ident)
+      {if (*Ident == '=') theID = Ident+1;
+          else if ((Ident = index(Ident, ':')))
+                  {strncpy(idBuff, Ident+1, 7); idBuff[7] = 0;
+                   if ((idP = index(idBuff, '@'))) {*(idP+1)=0; theID=idBuff;}
+                  }
       }
 
 // Prehandle the cgi information
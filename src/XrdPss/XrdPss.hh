@@ -33,6 +33,8 @@
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <string>
+#include <vector>
 #include "XrdSys/XrdSysHeaders.hh"
 #include "XrdOuc/XrdOucExport.hh"
 #include "XrdOuc/XrdOucName2Name.hh"
@@ -52,11 +54,15 @@ int     Opendir(const char *, XrdOucEnv &);
 int     Readdir(char *buff, int blen);
 
         // Constructor and destructor
-        XrdPssDir(const char *tid) : tident(tid), myDir(0) {}
-       ~XrdPssDir() {if (myDir) Close();}
+        XrdPssDir(const char *tid) : tident(tid), myDir(0), dirIdx(0),
+                                     inCache(false) {}
+       ~XrdPssDir() {if (myDir || inCache) Close();}
 private:
 const    char      *tident;
          DIR       *myDir;
+std::vector<std::string> dirEnts;   // Listing when the metadata cache is used
+         int        dirIdx;
+         bool       inCache;
 };
   
 /******************************************************************************/
@@ -91,13 +97,19 @@ ssize_t Write(const void *, off_t, size_t);
 int     Write(XrdSfsAio *aiop);
  
          // Constructor and destructor
-         XrdPssFile(const char *tid) : tident(tid) {fd = -1;}
+         XrdPssFile(const char *tid) : tident(tid), rwPath(0), poolOrg(0),
+                                        poolSlot(-1) {fd = -1;}
 
 virtual ~XrdPssFile() {if (fd >= 0) Close();}
 
 private:
 
+void        PoolRelease();
+
 const char *tident;
+      char *rwPath;   // Path of a file open for writing, see metadata cache
+      char *poolOrg;  // Origin whose connection pool slot we hold
+      int   poolSlot; // The slot itself
       int   crOpts;
 };
 
@@ -146,6 +158,7 @@ const  char *P2CGI(int &cgilen, char *cbuff, int cblen,
 static int   P2DST(int &retc, char *hBuff, int hBlen, PolAct pType,
                    const char *path);
 static char *P2ID (XrdOucSid::theSid *idVal, char *idBuff, int idBsz);
+static char *P2ORG(const char *url, char *oBuff, int oBlen);
 static char *P2OUT(int &retc,  char *pbuff, int pblen,
                    const char *path, const char *Cgi, const char *Ident);
 static char *P2URL(int &retc, char *pbuff, int pblen,
@@ -199,6 +212,14 @@ char              *cPath;    // -> Cache path
 char              *cParm;    // -> Cache parameters
 XrdVersionInfo    *myVersion;// -> Compilation version
 int                TraceLvl; // Tracing options
+int                mcSize;   // Metadata cache entries (0 -> no cache)
+int                mcPTTL;   // Metadata cache positive ttl
+int                mcNTTL;   // Metadata cache negative ttl
+int                mcRInt;   // Metadata cache report interval
+int                plConns;  // Connections per origin (0 -> no pool)
+int                plPerCn;  // Requests per connection before waiting
+int                plWait;   // Maximum seconds to wait for a connection
+int                plRInt;   // Connection pool report interval
 
 int    buildHdr();
 int    Configure(const char *);
@@ -215,7 +236,9 @@ int    xconf(XrdSysError *Eroute, XrdOucStream &Config);
 int    xdef( XrdSysError *Eroute, XrdOucStream &Config);
 int    xexp( XrdSysError *Eroute, XrdOucStream &Config);
 int    xinet(XrdSysError *errp,   XrdOucStream &Config);
+int    xmeta(XrdSysError *errp,   XrdOucStream &Config);
 int    xperm(XrdSysError *errp,   XrdOucStream &Config);
+int    xpool(XrdSysError *errp,   XrdOucStream &Config);
 int    xorig(XrdSysError *errp,   XrdOucStream &Config);
 int    xsopt(XrdSysError *Eroute, XrdOucStream &Config);
 int    xtrac(XrdSysError *Eroute, XrdOucStream &Config);
@@ -49,6 +49,8 @@
 #include "XrdNet/XrdNetSecurity.hh"
 
 #include "XrdPss/XrdPss.hh"
+#include "XrdPss/XrdPssMeta.hh"
+#include "XrdPss/XrdPssPool.hh"
 
 #include "XrdSys/XrdSysError.hh"
 #include "XrdSys/XrdSysHeaders.hh"
@@ -121,6 +123,10 @@ extern XrdSysError      eDest;
 
 extern XrdOucSid       *sidP;
 
+extern XrdPssMeta      *mcP;
+
+extern XrdPssPool      *poolP;
+
 static const int maxHLen = 1024;
 }
 
@@ -208,9 +214,10 @@ int XrdPssSys::Configure(const char *cfn)
        return 1;
       }
 
-// Tell xrootd to disable async I/O as it just will slow everything down.
+// Note that xrootd uses async I/O for all proxy requests unless configured
+// otherwise (see XRDXROOTD_PROXY below). Our aio path hands each request to
+// the client with a callback so no thread waits on the origin.
 //
-// XrdOucEnv::Export("XRDXROOTD_NOAIO", "1");
 
 // Thell xrootd to disable POSC mode as this is meaningless here
 //
@@ -230,6 +237,14 @@ int XrdPssSys::Configure(const char *cfn)
 //
    if (Streams) sidP = new XrdOucSid((Streams > 8192 ? 8192 : Streams));
 
+// Allocate the metadata cache if so wanted
+//
+   if (mcSize) mcP = new XrdPssMeta(&eDest, mcSize, mcPTTL, mcNTTL, mcRInt);
+
+// Allocate the origin connection pool if so wanted
+//
+   if (plConns) poolP = new XrdPssPool(&eDest,plConns,plPerCn,plWait,plRInt);
+
 // If this is an outgoing proxy then we are done
 //
    if (outProxy)
@@ -427,8 +442,10 @@ int XrdPssSys::ConfigXeq(char *var, XrdOucStream &Config)
    TS_Xeq("cachelib",      xcacl);
    TS_Xeq("config",        xconf);
    TS_Xeq("inetmode",      xinet);
+   TS_Xeq("metacache",     xmeta);
    TS_Xeq("origin",        xorig);
    TS_Xeq("permit",        xperm);
+   TS_Xeq("pool",          xpool);
    TS_Xeq("setopt",        xsopt);
    TS_Xeq("trace",         xtrac);
    TS_Xeq("namelib",       xnml);
@@ -828,6 +845,69 @@ int XrdPssSys::xinet(XrdSysError *Eroute, XrdOucStream &Config)
    XrdPosixXrootd::setIPV4(usev4);
    return 0;
 }
+
+/******************************************************************************/
+/*                                 x m e t a                                  */
+/******************************************************************************/
+
+/* Function: xmeta
+
+   Purpose:  To parse the directive: metacache {off | [size <n>] [ttl <sec>]
+                                                [negttl <sec>] [stats <sec>]}
+
+             off       do not cache stat and directory listing results (default).
+             size      maximum number of cached results (default 100000).
+             ttl       seconds a successful result is kept (default 60).
+             negttl    seconds a "not found" result is kept (default 10),
+                       zero disables negative caching.
+             stats     interval at which per origin statistics are logged
+                       (default 0, never).
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdPssSys::xmeta(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   char *val;
+   int   num, tval, *tLoc;
+
+// Get the first option
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute->Emsg("Config", "metacache option not specified"); return 1;}
+   if (!strcmp(val, "off")) {mcSize = 0; return 0;}
+   mcSize = 100000;
+
+// Process the options
+//
+   while(val && val[0])
+        {if (!strcmp(val, "size"))
+            {if (!(val = Config.GetWord()))
+                {Eroute->Emsg("Config", "metacache size not specified");
+                 return 1;
+                }
+             if (XrdOuca2x::a2i(*Eroute, "metacache size", val, &num, 1))
+                return 1;
+             mcSize = num;
+            }
+         else {     if (!strcmp(val, "ttl"))    tLoc = &mcPTTL;
+               else if (!strcmp(val, "negttl")) tLoc = &mcNTTL;
+               else if (!strcmp(val, "stats"))  tLoc = &mcRInt;
+               else {Eroute->Emsg("Config", "invalid metacache option -", val);
+                     return 1;
+                    }
+               if (!(val = Config.GetWord()))
+                  {Eroute->Emsg("Config", "metacache time value not specified");
+                   return 1;
+                  }
+               if (XrdOuca2x::a2tm(*Eroute, "metacache time", val, &tval, 0))
+                  return 1;
+               *tLoc = tval;
+              }
+         val = Config.GetWord();
+        }
+   return 0;
+}
   
 /******************************************************************************/
 /*                                  x n m l                                   */
@@ -988,6 +1068,68 @@ do {if (!(val = Config.GetWord()))
     return 0;
 }
 
+/******************************************************************************/
+/*                                 x p o o l                                  */
+/******************************************************************************/
+
+/* Function: xpool
+
+   Purpose:  To parse the directive: pool {off | [conns <n>] [perconn <n>]
+                                                 [wait <sec>] [stats <sec>]}
+
+             off       each client gets its own origin connection (default).
+             conns     number of connections made to each origin (default 8).
+                       Requests from all clients are multiplexed over these
+                       using the proxy's own credentials; a client sticks to
+                       the same connection while it has files open.
+             perconn   number of open files and metadata requests carried by
+                       a connection before new clients must wait (default 64).
+             wait      maximum seconds a client waits for a connection to
+                       become available before it is overcommitted
+                       (default 5, zero never waits).
+             stats     interval at which per origin occupancy and wait time
+                       statistics are logged (default 0, never).
+
+  Output: 0 upon success or !0 upon failure.
+*/
+
+int XrdPssSys::xpool(XrdSysError *Eroute, XrdOucStream &Config)
+{
+   char *val;
+   int   num, *nLoc, isTime;
+
+// Get the first option
+//
+   if (!(val = Config.GetWord()) || !val[0])
+      {Eroute->Emsg("Config", "pool option not specified"); return 1;}
+   if (!strcmp(val, "off")) {plConns = 0; return 0;}
+   plConns = 8;
+
+// Process the options
+//
+   while(val && val[0])
+        {     if (!strcmp(val, "conns"))   {nLoc = &plConns; isTime = 0;}
+         else if (!strcmp(val, "perconn")) {nLoc = &plPerCn; isTime = 0;}
+         else if (!strcmp(val, "wait"))    {nLoc = &plWait;  isTime = 1;}
+         else if (!strcmp(val, "stats"))   {nLoc = &plRInt;  isTime = 1;}
+         else {Eroute->Emsg("Config", "invalid pool option -", val);
+               return 1;
+              }
+         if (!(val = Config.GetWord()))
+            {Eroute->Emsg("Config", "pool value not specified"); return 1;}
+         if (isTime)
+            {if (XrdOuca2x::a2tm(*Eroute, "pool time", val, &num, 0))
+                return 1;
+            } else {
+             if (XrdOuca2x::a2i(*Eroute, "pool value", val, &num, 1, 4096))
+                return 1;
+            }
+         *nLoc = num;
+         val = Config.GetWord();
+        }
+   return 0;
+}
+
 /******************************************************************************/
 /*                                 x s o p t                                  */
 /******************************************************************************/
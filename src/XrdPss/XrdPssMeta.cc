@@ -0,0 +1,334 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s M e t a . c c                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "Xrd/XrdScheduler.hh"
+#include "XrdPss/XrdPssMeta.hh"
+#include "XrdSys/XrdSysError.hh"
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPssMeta::XrdPssMeta(XrdSysError *eP, int maxEnt, int pTTL, int nTTL,
+                       int rInt)
+                      : XrdJob("pss metadata cache"), eDest(eP), schedP(0),
+                        posTTL(pTTL), negTTL(nTTL), rptInt(rInt)
+{
+   maxPerShard = maxEnt / numShards;
+   if (maxPerShard < 1) maxPerShard = 1;
+}
+
+/******************************************************************************/
+/*                               A d d D i r                                  */
+/******************************************************************************/
+  
+void XrdPssMeta::AddDir(const char *path, const char *cgi, const char *origin,
+                        std::vector<std::string> &ents, int rc,
+                        unsigned int gen)
+{
+   Shard &sh = ShardOf(path, strlen(path));
+   std::string key = MakeKey('D', path, cgi);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+
+// The listing may predate a change made while it was being fetched
+//
+   if (gen != sh.Gen) return;
+   if ((eP = Add(sh, key, rc)) && !rc) eP->dEnts = ents;
+}
+
+/******************************************************************************/
+/*                               A d d S t a t                                */
+/******************************************************************************/
+  
+void XrdPssMeta::AddStat(const char *path, const char *cgi, const char *origin,
+                         struct stat &sbuf, int rc, unsigned int gen)
+{
+   Shard &sh = ShardOf(path, strlen(path));
+   std::string key = MakeKey('S', path, cgi);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+
+// The result may predate a change made while it was being fetched
+//
+   if (gen != sh.Gen) return;
+   if ((eP = Add(sh, key, rc)) && !rc) eP->sBuf = sbuf;
+}
+
+/******************************************************************************/
+/*                                  D o I t                                   */
+/******************************************************************************/
+  
+void XrdPssMeta::DoIt()
+{
+   Report();
+   if (schedP && rptInt > 0) schedP->Schedule((XrdJob *)this, time(0)+rptInt);
+}
+
+/******************************************************************************/
+/*                               F i n d D i r                                */
+/******************************************************************************/
+  
+bool XrdPssMeta::FindDir(const char *path, const char *cgi, const char *origin,
+                         std::vector<std::string> &ents, int &rc,
+                         unsigned int &gen)
+{
+   Shard &sh = ShardOf(path, strlen(path));
+   std::string key = MakeKey('D', path, cgi);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+
+   if (!(eP = Find(sh, key, origin))) {gen = sh.Gen; return false;}
+   if (!(rc = eP->rc)) ents = eP->dEnts;
+   return true;
+}
+
+/******************************************************************************/
+/*                              F i n d S t a t                               */
+/******************************************************************************/
+  
+bool XrdPssMeta::FindStat(const char *path, const char *cgi, const char *origin,
+                          struct stat &sbuf, int &rc, unsigned int &gen)
+{
+   Shard &sh = ShardOf(path, strlen(path));
+   std::string key = MakeKey('S', path, cgi);
+   XrdSysMutexHelper shLock(sh.Mutex);
+   Entry *eP;
+
+   if (!(eP = Find(sh, key, origin))) {gen = sh.Gen; return false;}
+   if (!(rc = eP->rc)) sbuf = eP->sBuf;
+   return true;
+}
+
+/******************************************************************************/
+/*                            I n v a l i d a t e                             */
+/******************************************************************************/
+  
+void XrdPssMeta::Invalidate(const char *path, bool tree)
+{
+   const char *slash;
+   int plen = strlen(path);
+
+// Drop the stat and listing of the path itself
+//
+   {Shard &sh = ShardOf(path, plen);
+    XrdSysMutexHelper shLock(sh.Mutex);
+    Drop(sh, MakeKey('S', path, 0));
+    Drop(sh, MakeKey('D', path, 0));
+    sh.Gen++;
+   }
+
+// Entries below a directory may be in any shard, so visit all of them
+//
+   if (tree)
+      {std::string dir(path);
+       if (dir.empty() || dir[dir.size()-1] != '/') dir += '/';
+       for (int i = 0; i < numShards; i++)
+           {XrdSysMutexHelper shLock(shards[i].Mutex);
+            Drop(shards[i], 'S' + dir);
+            Drop(shards[i], 'D' + dir);
+            shards[i].Gen++;
+           }
+      }
+
+// Drop the listing of the parent directory as it may have changed as well
+//
+   if ((slash = rindex(path, '/')) && plen > 1)
+      {std::string parent(path, (slash == path ? 1 : slash - path));
+       Shard &sh = ShardOf(parent.c_str(), parent.size());
+       XrdSysMutexHelper shLock(sh.Mutex);
+       Drop(sh, MakeKey('D', parent.c_str(), 0));
+       sh.Gen++;
+      }
+}
+
+/******************************************************************************/
+/*                                R e p o r t                                 */
+/******************************************************************************/
+  
+void XrdPssMeta::Report()
+{
+   OrgMap allOrgs;
+   long long nEnts = 0, nEvicts = 0, nDrops = 0;
+   char buff[512];
+
+// Collect the statistics from each shard
+//
+   for (int i = 0; i < numShards; i++)
+       {XrdSysMutexHelper shLock(shards[i].Mutex);
+        nEnts   += shards[i].Ents.size();
+        nEvicts += shards[i].Evicts;
+        nDrops  += shards[i].Drops;
+        for (OrgMap::iterator it  = shards[i].Orgs.begin();
+                              it != shards[i].Orgs.end(); ++it)
+            {OrgStats &os = allOrgs[it->first];
+             os.Hits    += it->second.Hits;
+             os.NegHits += it->second.NegHits;
+             os.Misses  += it->second.Misses;
+            }
+       }
+
+// Log them
+//
+   snprintf(buff, sizeof(buff), "%lld entries; %lld evicted; %lld invalidated",
+            nEnts, nEvicts, nDrops);
+   eDest->Say("Pss metacache: ", buff);
+
+   for (OrgMap::iterator it = allOrgs.begin(); it != allOrgs.end(); ++it)
+       {snprintf(buff, sizeof(buff), "hits %lld neghits %lld misses %lld",
+                 it->second.Hits, it->second.NegHits, it->second.Misses);
+        eDest->Say("Pss metacache: origin ", it->first.c_str(), " ", buff);
+       }
+}
+
+/******************************************************************************/
+/*                          S t a r t R e p o r t s                           */
+/******************************************************************************/
+  
+void XrdPssMeta::StartReports(XrdScheduler *sP)
+{
+   if ((schedP = sP) && rptInt > 0)
+      schedP->Schedule((XrdJob *)this, time(0)+rptInt);
+}
+
+/******************************************************************************/
+/*                     P r i v a t e   F u n c t i o n s                      */
+/******************************************************************************/
+/******************************************************************************/
+/*                                   A d d                                    */
+/******************************************************************************/
+
+// Must be called with the shard locked. Only success and ENOENT are cached.
+//
+XrdPssMeta::Entry *XrdPssMeta::Add(Shard &sh, const std::string &key, int rc)
+{
+   EntMap::iterator it;
+   int ttl;
+
+   if (rc && rc != -ENOENT) return 0;
+   if ((ttl = (rc ? negTTL : posTTL)) <= 0) return 0;
+
+// Replace any existing entry, otherwise make room for a new one
+//
+   if ((it = sh.Ents.find(key)) != sh.Ents.end()) Erase(sh, it);
+      else while((int)sh.Ents.size() >= maxPerShard && !sh.LRU.empty())
+                {Erase(sh, sh.Ents.find(sh.LRU.front())); sh.Evicts++;}
+
+   Entry &ent = sh.Ents[key];
+   ent.Expires = time(0) + ttl;
+   ent.rc      = rc;
+   ent.lruP    = sh.LRU.insert(sh.LRU.end(), key);
+   return &ent;
+}
+
+/******************************************************************************/
+/*                                  D r o p                                   */
+/******************************************************************************/
+
+// Must be called with the shard locked. Drops all entries whose key starts
+// with pfx, i.e. the entries for all cgi variants of a path.
+//
+void XrdPssMeta::Drop(Shard &sh, const std::string &pfx)
+{
+   EntMap::iterator it = sh.Ents.lower_bound(pfx);
+
+   while(it != sh.Ents.end() && !it->first.compare(0, pfx.size(), pfx))
+        {Erase(sh, it++); sh.Drops++;}
+}
+
+/******************************************************************************/
+/*                                 E r a s e                                  */
+/******************************************************************************/
+  
+void XrdPssMeta::Erase(Shard &sh, EntMap::iterator it)
+{
+   sh.LRU.erase(it->second.lruP);
+   sh.Ents.erase(it);
+}
+
+/******************************************************************************/
+/*                                  F i n d                                   */
+/******************************************************************************/
+
+// Must be called with the shard locked.
+//
+XrdPssMeta::Entry *XrdPssMeta::Find(Shard &sh, const std::string &key,
+                                    const char *origin)
+{
+   OrgStats &os = sh.Orgs[origin ? origin : "?"];
+   EntMap::iterator it = sh.Ents.find(key);
+
+// Check if we have an unexpired entry
+//
+   if (it == sh.Ents.end()) {os.Misses++; return 0;}
+   if (it->second.Expires <= time(0))
+      {Erase(sh, it); os.Misses++; return 0;}
+
+// Count this as a hit and make it the most recently used one
+//
+   if (it->second.rc) os.NegHits++;
+      else            os.Hits++;
+   sh.LRU.splice(sh.LRU.end(), sh.LRU, it->second.lruP);
+   return &(it->second);
+}
+
+/******************************************************************************/
+/*                               M a k e K e y                                */
+/******************************************************************************/
+
+// Keys are "<type><path>?<cgi>". Without cgi the key is a prefix matching all
+// of the entries for the path.
+//
+std::string XrdPssMeta::MakeKey(char type, const char *path, const char *cgi)
+{
+   std::string key(1, type);
+
+   key += path;
+   key += '?';
+   if (cgi) key += cgi;
+   return key;
+}
+
+/******************************************************************************/
+/*                               S h a r d O f                                */
+/******************************************************************************/
+  
+XrdPssMeta::Shard &XrdPssMeta::ShardOf(const char *path, int plen)
+{
+   unsigned int hval = 2166136261U;
+
+   for (int i = 0; i < plen; i++) {hval ^= (unsigned char)path[i]; hval *= 16777619U;}
+   return shards[hval % numShards];
+}
@@ -0,0 +1,146 @@
+#ifndef __PSS_META_HH__
+#define __PSS_META_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s M e t a . h h                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "Xrd/XrdJob.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdScheduler;
+class XrdSysError;
+
+/******************************************************************************/
+/*                       C l a s s   X r d P s s M e t a                      */
+/******************************************************************************/
+
+// The metadata cache holds the results of stat and directory listing requests
+// forwarded to the origin. Successful results are kept for a positive ttl and
+// ENOENT for a (usually shorter) negative ttl. Entries are spread over a fixed
+// number of shards, each with its own lock and LRU list, so that lookups on
+// different paths rarely contend. Results are keyed by path and cgi; all of
+// the entries for a path, as well as the listing of its parent directory, are
+// dropped whenever the path is modified through the proxy. Each shard also
+// counts these invalidations so that a result fetched from the origin before
+// one of them is not added afterwards.
+  
+class XrdPssMeta : public XrdJob
+{
+public:
+
+// Stat lookups return true if the path is cached, rc is 0 or -ENOENT. When
+// it is not, gen is set to the value that must be passed to AddStat().
+//
+bool     FindStat(const char *path, const char *cgi, const char *origin,
+                  struct stat &sbuf, int &rc, unsigned int &gen);
+
+void     AddStat (const char *path, const char *cgi, const char *origin,
+                  struct stat &sbuf, int rc, unsigned int gen);
+
+// Directory listing lookups, same conventions as above.
+//
+bool     FindDir (const char *path, const char *cgi, const char *origin,
+                  std::vector<std::string> &ents, int &rc, unsigned int &gen);
+
+void     AddDir  (const char *path, const char *cgi, const char *origin,
+                  std::vector<std::string> &ents, int rc, unsigned int gen);
+
+// Drop whatever is known about path and the listing of its parent. When tree
+// is true (e.g. rename) everything below path is dropped as well.
+//
+void     Invalidate(const char *path, bool tree=false);
+
+// Log per origin statistics and reschedule, if so wanted.
+//
+void     DoIt();
+
+void     Report();
+
+void     StartReports(XrdScheduler *sP);
+
+         XrdPssMeta(XrdSysError *eP, int maxEnt, int posTTL, int negTTL,
+                    int rptInt);
+        ~XrdPssMeta() {}
+
+private:
+
+struct OrgStats
+      {long long Hits;      // Positive results served from the cache
+       long long NegHits;   // Negative results served from the cache
+       long long Misses;    // Requests forwarded to the origin
+                 OrgStats() : Hits(0), NegHits(0), Misses(0) {}
+      };
+
+struct Entry
+      {time_t                          Expires;
+       int                             rc;
+       struct stat                     sBuf;
+       std::vector<std::string>        dEnts;
+       std::list<std::string>::iterator lruP;
+      };
+
+typedef std::map<std::string, Entry>    EntMap;
+typedef std::map<std::string, OrgStats> OrgMap;
+
+struct Shard
+      {XrdSysMutex            Mutex;
+       EntMap                 Ents;
+       std::list<std::string> LRU;
+       OrgMap                 Orgs;
+       long long              Evicts;
+       long long              Drops;
+       unsigned int           Gen;     // Bumped by each invalidation
+                              Shard() : Evicts(0), Drops(0), Gen(0) {}
+      };
+
+static const int numShards = 16;
+
+Entry   *Find(Shard &sh, const std::string &key, const char *origin);
+Entry   *Add (Shard &sh, const std::string &key, int rc);
+void     Drop(Shard &sh, const std::string &pfx);
+void     Erase(Shard &sh, EntMap::iterator it);
+std::string MakeKey(char type, const char *path, const char *cgi);
+Shard   &ShardOf(const char *path, int plen);
+
+Shard         shards[numShards];
+XrdSysError  *eDest;
+XrdScheduler *schedP;
+int           maxPerShard;
+int           posTTL;
+int           negTTL;
+int           rptInt;
+};
+#endif
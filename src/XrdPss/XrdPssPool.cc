@@ -0,0 +1,212 @@
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s P o o l . c c                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "Xrd/XrdScheduler.hh"
+#include "XrdPss/XrdPssPool.hh"
+#include "XrdSys/XrdSysError.hh"
+
+/******************************************************************************/
+/*                         L o c a l   F u n c t i o n s                      */
+/******************************************************************************/
+
+namespace
+{
+long long NowMS()
+{
+   struct timeval tv;
+
+   gettimeofday(&tv, 0);
+   return (long long)tv.tv_sec*1000 + tv.tv_usec/1000;
+}
+}
+
+/******************************************************************************/
+/*                           C o n s t r u c t o r                            */
+/******************************************************************************/
+
+XrdPssPool::XrdPssPool(XrdSysError *eP, int mConn, int pConn, int mWait,
+                       int rInt)
+                      : XrdJob("pss connection pool"), poolCV(0), eDest(eP),
+                        schedP(0), maxConn(mConn), perConn(pConn),
+                        maxWait(mWait), rptInt(rInt)
+{
+   if (maxConn < 1) maxConn = 1;
+   if (perConn < 1) perConn = 1;
+}
+
+/******************************************************************************/
+/*                                  D o I t                                   */
+/******************************************************************************/
+  
+void XrdPssPool::DoIt()
+{
+   Report();
+   if (schedP && rptInt > 0) schedP->Schedule((XrdJob *)this, time(0)+rptInt);
+}
+
+/******************************************************************************/
+/*                                O b t a i n                                 */
+/******************************************************************************/
+  
+int XrdPssPool::Obtain(const char *origin, const char *tident)
+{
+   std::map<std::string, Client>::iterator cit;
+   long long tBeg, tNow, waited;
+   int slot;
+
+   poolCV.Lock();
+   Origin &org = Origins[origin];
+   if (org.Load.empty()) org.Load.resize(maxConn, 0);
+   org.nReqs++;
+
+// If this client already has a slot, keep using it
+//
+   if (tident && (cit = org.Clients.find(tident)) != org.Clients.end())
+      {slot = cit->second.Slot;
+       cit->second.Refs++;
+      } else {
+
+// Find the least loaded slot. If it's fully loaded, wait a while for a slot
+// to be released. After that we simply overcommit the slot rather than fail.
+//
+       slot = Least(org);
+       if (org.Load[slot] >= perConn && maxWait > 0)
+          {org.nWaits++;
+           tBeg = tNow = NowMS();
+           do {if (poolCV.WaitMS((int)(maxWait*1000 - (tNow-tBeg)))) break;
+               slot = Least(org);
+               tNow = NowMS();
+              } while(org.Load[slot] >= perConn && tNow-tBeg < maxWait*1000);
+           slot = Least(org);
+           waited = NowMS() - tBeg;
+           org.WaitMS += waited;
+           if (waited > org.MaxWait) org.MaxWait = waited;
+          }
+       if (tident)
+          {Client &cl = org.Clients[tident];
+           cl.Slot = slot; cl.Refs = 1;
+          }
+      }
+
+// Account for this request
+//
+   org.Load[slot]++;
+   if (++org.Active > org.Peak) org.Peak = org.Active;
+   poolCV.UnLock();
+   return slot;
+}
+
+/******************************************************************************/
+/*                               R e l e a s e                                */
+/******************************************************************************/
+  
+void XrdPssPool::Release(const char *origin, int slot, const char *tident)
+{
+   std::map<std::string, Origin>::iterator oit;
+   std::map<std::string, Client>::iterator cit;
+
+   poolCV.Lock();
+   if ((oit = Origins.find(origin)) != Origins.end()
+   &&  slot >= 0 && slot < (int)oit->second.Load.size())
+      {Origin &org = oit->second;
+       if (org.Load[slot] > 0) org.Load[slot]--;
+       if (org.Active > 0) org.Active--;
+       if (tident && (cit = org.Clients.find(tident)) != org.Clients.end()
+       &&  --(cit->second.Refs) <= 0) org.Clients.erase(cit);
+       if (org.Load[slot] < perConn) poolCV.Broadcast();
+      }
+   poolCV.UnLock();
+}
+
+/******************************************************************************/
+/*                                R e p o r t                                 */
+/******************************************************************************/
+  
+void XrdPssPool::Report()
+{
+   std::map<std::string, Origin>::iterator it;
+   char buff[512];
+   int inUse;
+
+   poolCV.Lock();
+   for (it = Origins.begin(); it != Origins.end(); ++it)
+       {Origin &org = it->second;
+        inUse = 0;
+        for (int i = 0; i < (int)org.Load.size(); i++) if (org.Load[i]) inUse++;
+        snprintf(buff, sizeof(buff), "conns %d/%d active %d peak %d reqs %lld "
+                 "waits %lld waitms %lld maxwaitms %lld", inUse, maxConn,
+                 org.Active, org.Peak, org.nReqs, org.nWaits, org.WaitMS,
+                 org.MaxWait);
+        eDest->Say("Pss pool: origin ", it->first.c_str(), " ", buff);
+        org.Peak = org.Active;
+       }
+   poolCV.UnLock();
+}
+
+/******************************************************************************/
+/*                                S l o t I D                                 */
+/******************************************************************************/
+  
+char *XrdPssPool::SlotID(int slot, char *idBuff, int idBsz)
+{
+   if (idBsz <= snprintf(idBuff, idBsz, "=pool%d@", slot)) return 0;
+   return idBuff;
+}
+
+/******************************************************************************/
+/*                          S t a r t R e p o r t s                           */
+/******************************************************************************/
+  
+void XrdPssPool::StartReports(XrdScheduler *sP)
+{
+   if ((schedP = sP) && rptInt > 0)
+      schedP->Schedule((XrdJob *)this, time(0)+rptInt);
+}
+
+/******************************************************************************/
+/*                     P r i v a t e   F u n c t i o n s                      */
+/******************************************************************************/
+/******************************************************************************/
+/*                                 L e a s t                                  */
+/******************************************************************************/
+
+// Must be called with the pool locked.
+//
+int XrdPssPool::Least(Origin &org)
+{
+   int slot = 0;
+
+   for (int i = 1; i < (int)org.Load.size(); i++)
+       if (org.Load[i] < org.Load[slot]) slot = i;
+   return slot;
+}
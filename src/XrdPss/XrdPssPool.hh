@@ -0,0 +1,118 @@
+#ifndef __PSS_POOL_HH__
+#define __PSS_POOL_HH__
+/******************************************************************************/
+/*                                                                            */
+/*                         X r d P s s P o o l . h h                          */
+/*                                                                            */
+/* (c) 2026 by the Board of Trustees of the Leland Stanford, Jr., University  */
+/*                            All Rights Reserved                             */
+/*   Produced by Andrew Hanushevsky for Stanford University under contract    */
+/*              DE-AC02-76-SFO0515 with the Department of Energy              */
+/*                                                                            */
+/* This file is part of the XRootD software suite.                            */
+/*                                                                            */
+/* XRootD is free software: you can redistribute it and/or modify it under    */
+/* the terms of the GNU Lesser General Public License as published by the     */
+/* Free Software Foundation, either version 3 of the License, or (at your     */
+/* option) any later version.                                                 */
+/*                                                                            */
+/* XRootD is distributed in the hope that it will be useful, but WITHOUT      */
+/* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or      */
+/* FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public       */
+/* License for more details.                                                  */
+/*                                                                            */
+/* You should have received a copy of the GNU Lesser General Public License   */
+/* along with XRootD in a file called COPYING.LESSER (LGPL license) and file  */
+/* COPYING (GPL license).  If not, see <http://www.gnu.org/licenses/>.        */
+/*                                                                            */
+/* The copyright holder's institutional names and contributor's names may not */
+/* be used to endorse or promote products derived from this software without  */
+/* specific prior written permission of the institution or contributor.       */
+/******************************************************************************/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Xrd/XrdJob.hh"
+#include "XrdSys/XrdSysPthread.hh"
+
+class XrdScheduler;
+class XrdSysError;
+
+/******************************************************************************/
+/*                       C l a s s   X r d P s s P o o l                      */
+/******************************************************************************/
+
+// The connection pool bounds the number of connections (i.e. logins) made to
+// each origin. The client library opens one connection per distinct user name
+// in the url, so requests are tagged with the name of a pool slot rather than
+// one derived from the client's connection. Since all origin sessions are
+// made with the proxy's own credentials they may safely be shared by any
+// number of clients. A client is kept on the same slot while it has files
+// open; otherwise the least loaded slot is used. When every slot is carrying
+// its share of requests a new request waits, for a bounded amount of time,
+// until one becomes free.
+  
+class XrdPssPool : public XrdJob
+{
+public:
+
+// Obtain a slot for a request to origin. The tident, if any, makes the slot
+// sticky for that client. The returned slot must be passed to Release().
+//
+int      Obtain(const char *origin, const char *tident=0);
+
+void     Release(const char *origin, int slot, const char *tident=0);
+
+// Format the url user name for a slot, returns idBuff or 0 if it won't fit.
+//
+static
+char    *SlotID(int slot, char *idBuff, int idBsz);
+
+// Log occupancy and wait time statistics and reschedule, if so wanted.
+//
+void     DoIt();
+
+void     Report();
+
+void     StartReports(XrdScheduler *sP);
+
+         XrdPssPool(XrdSysError *eP, int maxConn, int perConn, int maxWait,
+                    int rptInt);
+        ~XrdPssPool() {}
+
+private:
+
+struct Client
+      {int       Slot;
+       int       Refs;
+                 Client() : Slot(0), Refs(0) {}
+      };
+
+struct Origin
+      {std::vector<int>              Load;    // Requests outstanding per slot
+       std::map<std::string, Client> Clients; // Sticky slot assignments
+       long long                     nReqs;   // Requests
+       long long                     nWaits;  // Requests that had to wait
+       long long                     WaitMS;  // Total time spent waiting
+       long long                     MaxWait; // Longest wait
+       int                           Peak;    // Most requests outstanding
+       int                           Active;  // Requests outstanding
+                                     Origin() : nReqs(0), nWaits(0), WaitMS(0),
+                                                MaxWait(0), Peak(0), Active(0)
+                                                {}
+      };
+
+int      Least(Origin &org);
+
+XrdSysCondVar                 poolCV;
+std::map<std::string, Origin> Origins;
+XrdSysError                  *eDest;
+XrdScheduler                 *schedP;
+int                           maxConn;
+int                           perConn;
+int                           maxWait;
+int                           rptInt;
+};
+#endif
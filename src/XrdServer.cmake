@@ -66,6 +66,7 @@ add_library(
   XrdOfs/XrdOfsStats.cc         XrdOfs/XrdOfsStats.hh
   XrdOfs/XrdOfsTPC.cc           XrdOfs/XrdOfsTPC.hh
   XrdOfs/XrdOfsTPCAuth.cc       XrdOfs/XrdOfsTPCAuth.hh
+                                XrdOfs/XrdOfsTPCEngine.hh
   XrdOfs/XrdOfsTPCJob.cc        XrdOfs/XrdOfsTPCJob.hh
   XrdOfs/XrdOfsTPCInfo.cc       XrdOfs/XrdOfsTPCInfo.hh
   XrdOfs/XrdOfsTPCProg.cc       XrdOfs/XrdOfsTPCProg.hh
@@ -108,12 +109,14 @@ add_library(
                                XrdOss/XrdOssMioFile.hh
   XrdOss/XrdOssMSS.cc
   XrdOss/XrdOssPath.cc         XrdOss/XrdOssPath.hh
+  XrdOss/XrdOssRdAhead.cc      XrdOss/XrdOssRdAhead.hh
   XrdOss/XrdOssReloc.cc
   XrdOss/XrdOssRename.cc
   XrdOss/XrdOssSpace.cc        XrdOss/XrdOssSpace.hh
   XrdOss/XrdOssStage.cc        XrdOss/XrdOssStage.hh
   XrdOss/XrdOssStat.cc         XrdOss/XrdOssStatInfo.hh
                                XrdOss/XrdOssUnlink.cc
+  XrdOss/XrdOssUring.cc        XrdOss/XrdOssUring.hh
                                XrdOss/XrdOssError.hh
                                XrdOss/XrdOss.hh
 
@@ -96,6 +96,7 @@
         XrdVERSIONPLUGIN_Rule(DoNotChk,  4,  0, XrdgetProtocol                )\
         XrdVERSIONPLUGIN_Rule(Required,  4,  0, XrdgetProtocolPort            )\
         XrdVERSIONPLUGIN_Rule(Optional,  4,  0, XrdHttpGetSecXtractor         )\
+        XrdVERSIONPLUGIN_Rule(Required,  4,  0, XrdOfsTPCGetEngine            )\
         XrdVERSIONPLUGIN_Rule(Required,  4,  0, XrdSysLogPInit                )\
         XrdVERSIONPLUGIN_Rule(Required,  4,  0, XrdOssGetStorageSystem        )\
         XrdVERSIONPLUGIN_Rule(Required,  4,  0, XrdOssStatInfoInit            )\
@@ -165,6 +166,7 @@
          "libXrdCryptossl.so",       \
          "libXrdFileCache.so",       \
          "libXrdHttp.so",            \
+         "libXrdOfsTPCCl.so",        \
          "libXrdOssSIgpfsT.so",      \
          "libXrdPss.so",             \
          "libXrdSec.so",             \
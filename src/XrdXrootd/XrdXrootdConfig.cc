@@ -325,6 +325,14 @@ int XrdXrootdProtocol::Configure(char *parms, XrdProtocol_Config *pi)
           } while(tP);
       }
 
+// A proxy waits on its origin, not on a local disk. Synchronous i/o would pin
+// a thread for each outstanding origin request while proxy aio holds none.
+// So, unless told otherwise, use aio for all proxy requests and only bound
+// the number outstanding by the server-wide limit.
+//
+   if (getenv("XRDXROOTD_PROXY") && !as_aioset)
+      {as_force = 1; as_miniosz = 1; as_maxperlnk = as_maxpersrv;}
+
 // Initialiaze for AIO
 //
         if (getenv("XRDXROOTD_NOAIO")) as_noaio = 1;
@@ -589,6 +597,10 @@ int XrdXrootdProtocol::ConfigSecurity(XrdOucEnv &xEnv, const char *cfn)
              off      Disables async i/o
              nosf     Disables use of sendfile to send data to the client.
 
+             When the file system is a proxy and this directive is not
+             specified, all requests use async i/o (force, minsize 1) and
+             the per link limit is the per server limit.
+
    Output: 0 upon success or 1 upon failure.
 */
 
@@ -676,6 +688,7 @@ int XrdXrootdProtocol::xasync(XrdOucStream &Config)
    if (V_syncw > 0) as_syncw     = 1;
    if (V_nosf  > 0) as_nosf      = 1;
    if (V_minsf > 0) as_minsfsz   = V_minsf;
+   as_aioset = 1;
 
    return 0;
 }
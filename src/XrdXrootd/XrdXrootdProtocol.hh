@@ -298,6 +298,7 @@ static int                 as_force;     // aio to be forced
 static int                 as_noaio;     // aio is disabled
 static int                 as_nosf;      // sendfile is disabled
 static int                 as_syncw;     // writes to be synchronous
+static int                 as_aioset;    // async directive was specified
 static int                 maxBuffsz;    // Maximum buffer size we can have
 static int                 maxTransz;    // Maximum transfer size we can have
 static const int           maxRvecsz = 1024;   // Maximum read vector size